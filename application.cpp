@@ -43,14 +43,7 @@
 
 #include "st7xsim.h"
 
-//
-//--------------------------------------------------------
-// simulator internals - io simulation mechanism definitions
-//--------------------------------------------------------
-//
-// for simulated peripheral - crc generator
-unsigned short crc_generator_output;
-unsigned int crc_generator_output_count;
+#include "batch.h"
 
 //
 //--------------------------------------------------------
@@ -70,8 +63,6 @@ struct hpair hpairs[] = {
 	{ 0x61,0xF6 }
 };
 
-unsigned int hindex = 0;
-
 //------------------------------------------------------------------
 // simulator internals - crc table used for simulated crc generator
 //------------------------------------------------------------------
@@ -123,8 +114,10 @@ unsigned char command_sequence_number = 0;
 unsigned char buf[256];
 unsigned char G_session_key5[16];
 unsigned char G_tags_session_key5[16];
-unsigned char G_InPacketLength0;
-unsigned char G_InPacketLength1;
+
+// host side of the session kept with the fork base (<k> in load_inbound_message)
+unsigned char fork_command_sequence_number;
+unsigned char fork_session_key5[16];
 
 // for mac test
 unsigned short rx_count;
@@ -143,33 +136,22 @@ void generate_mac(uint8 *input, uint32 length, uint8 status_byte, uint8 *prev, u
 //
 // this displays the hp252 tag codes "do loop" variables
 //
-void display_do_loop_vars(void)
+void display_do_loop_vars(struct machine *m)
 {
-	printf("DoLoopInput: %02x,%02x,%02x", prog_memory[0x33], prog_memory[0x34], prog_memory[0x35]);
-	printf(" DoLoopLength: %02x,%02x", prog_memory[0x39], prog_memory[0x3a]);
+	printf("DoLoopInput: %02x,%02x,%02x", get_memory_byte(m->prog_memory, 0x33), get_memory_byte(m->prog_memory, 0x34), get_memory_byte(m->prog_memory, 0x35));
+	printf(" DoLoopLength: %02x,%02x", get_memory_byte(m->prog_memory, 0x39), get_memory_byte(m->prog_memory, 0x3a));
 
-	printf(" DoLoopOutput: %02x,%02x,%02x\n\n", prog_memory[0x36], prog_memory[0x37], prog_memory[0x38]);
-}
-
-//
-// this logs the hp252 tag codes "do loop" variables
-//
-void display_do_loop_vars_to_run_log(void)
-{
-	fprintf(run_log_fp, "DoLoopInput: %02x,%02x,%02x", prog_memory[0x33], prog_memory[0x34], prog_memory[0x35]);
-	fprintf(run_log_fp, " DoLoopLength: %02x,%02x", prog_memory[0x39], prog_memory[0x3a]);
-
-	fprintf(run_log_fp, " DoLoopOutput: %02x,%02x,%02x\n\n", prog_memory[0x36], prog_memory[0x37], prog_memory[0x38]);
+	printf(" DoLoopOutput: %02x,%02x,%02x\n\n", get_memory_byte(m->prog_memory, 0x36), get_memory_byte(m->prog_memory, 0x37), get_memory_byte(m->prog_memory, 0x38));
 }
 
 //
 // called by simulator to reset any of our variables
 //
-void application_reset(void)
+void application_reset(struct machine *m)
 {
 	// rseset crc generator emulated peripheral
-	crc_generator_output = 0xffff;
-	crc_generator_output_count = 0;
+	m->crc_generator_output = 0xffff;
+	m->crc_generator_output_count = 0;
 }
 
 //
@@ -177,33 +159,43 @@ void application_reset(void)
 //
 // this can be used to patch memory
 //
-void application_load_io_and_memory_initial_values(void)
+void application_load_io_and_memory_initial_values(struct machine *m)
 {
 	// Io values
-	prog_memory[0x0000] = 0x00;	// I2C bit bang
+	put_memory_byte(m->prog_memory, 0x0000, 0x00);	// I2C bit bang
 
 	// extended IO values
 
 	// Flash values
 
 	// Program memory values
-	prog_memory[0x8031] = RET;		// patch a return instruction in here to simply bypass the 0x3d00-0x3d02 checker
-	prog2_memory[0xbaf8] = RETF;	// patch a return instruction in here to simply bypass the 0x3d00-0x3d02 checker
+	put_data_memory_byte_raw(m, 0x8031, RET);		// patch a return instruction in here to simply bypass the 0x3d00-0x3d02 checker
+	put_data_memory_byte_raw(m, 0x0010baf8, RETF);	// patch a return instruction in here to simply bypass the 0x3d00-0x3d02 checker
 
-	prog_memory[0x4d18] = RET; // patch write command so it simply returns - (saves time in multiple command simulations)
+	put_data_memory_byte_raw(m, 0x4d18, RET); // patch write command so it simply returns - (saves time in multiple command simulations)
 
 	// patch out random reg6 check in doloopstep
-	prog_memory[0x929a] = NOP;
-	prog_memory[0x929b] = NOP;
-	prog_memory[0x929c] = NOP;
+	put_data_memory_byte_raw(m, 0x929a, NOP);
+	put_data_memory_byte_raw(m, 0x929b, NOP);
+	put_data_memory_byte_raw(m, 0x929c, NOP);
 
 	// try patching out the funky crc check at the end of the auth command
-	prog_memory[0x658e] = JRA;
-	prog_memory[0x6599] = JRA;
+	put_data_memory_byte_raw(m, 0x658e, JRA);
+	put_data_memory_byte_raw(m, 0x6599, JRA);
 
 	printf("*** Application Initial Values loaded ***\n");
 }
 
+//
+// This is a simulated peripheral, a random number generator
+// every machine has its own so a batch of them gives the same answers every time
+//
+unsigned int generate_random(struct machine *m)
+{
+	m->random_seed = m->random_seed * 214013 + 2531011;
+	return((m->random_seed >> 16) & 0x7fff);
+}
+
 //
 // This is a simulated peripheral, a crc16 generator
 // this updates the running crc16
@@ -215,10 +207,11 @@ unsigned short generate_crc(unsigned char c, unsigned short oldcrc)
 
 //
 // called by simulator to all us to emulate I/O space peripheral reads
+// only for the addresses in application_device_addresses[]
 //
 // return 1 if we intercepted the i/o operation, 0 otherwise
 //
-int application_get_data_memory_byte(unsigned int address, unsigned char *data)
+int application_get_data_memory_byte(struct machine *m, unsigned int address, unsigned char *data)
 {
 	unsigned short crcval;
 
@@ -235,7 +228,7 @@ int application_get_data_memory_byte(unsigned int address, unsigned char *data)
 	// random number generator emulation
 	if(address == 0x7) {
 //		printf("\n*** READING FROM RND GENERATOR: pc=%08x, address=%08x\n", register_pc, address);
-		*data = (rand() & 0xff);
+		*data = (generate_random(m) & 0xff);
 		return(1);
 	}
 
@@ -249,17 +242,17 @@ int application_get_data_memory_byte(unsigned int address, unsigned char *data)
 	// CRC generator output
 	if(address == 0x0f) {
 //		printf("\n*** READING FROM CRC GENERATOR: pc=%08x, address=%08x\n", register_pc, address);
-		if(crc_generator_output_count == 0) {
+		if(m->crc_generator_output_count == 0) {
 			// out put the MSB
-			crc_generator_output_count++;			// next time output the LSB
-			crcval = ~crc_generator_output>>8; // MSB (the generator output is modified in the write to this peripheral
+			m->crc_generator_output_count++;			// next time output the LSB
+			crcval = ~m->crc_generator_output>>8; // MSB (the generator output is modified in the write to this peripheral
 			*data = (unsigned char)crcval;
 			return(1);
 		} else {
 			// output the LSB
-			crc_generator_output_count = 0;			// next time output the MSB
-			crcval = ~(crc_generator_output&0xff); //LSB
-			crc_generator_output = 0xffff;			// reset the output
+			m->crc_generator_output_count = 0;			// next time output the MSB
+			crcval = ~(m->crc_generator_output&0xff); //LSB
+			m->crc_generator_output = 0xffff;			// reset the output
 			*data = (unsigned char)crcval;
 			return(1);
 		}
@@ -267,12 +260,12 @@ int application_get_data_memory_byte(unsigned int address, unsigned char *data)
 
 	if(address == 0x3d01) {
 //		printf("\n*** READING FROM 3d01: pc=%08x, address=%08x, hindex=%02x\n", register_pc, address, hindex);
-		*data = hpairs[hindex].h3d01_val;	// hindex must be <=3
+		*data = hpairs[m->hindex].h3d01_val;	// hindex must be <=3
 		return(1);
 	}
 	if(address == 0x3d02) {
 //		printf("\n*** READING FROM 3d02: pc=%08x, address=%08x, hindex=%02x\n", register_pc, address, hindex);
-		*data = hpairs[hindex].h3d02_val;	// hindex must be <=3
+		*data = hpairs[m->hindex].h3d02_val;	// hindex must be <=3
 		return(1);
 	}
 
@@ -292,10 +285,11 @@ int application_get_data_memory_byte(unsigned int address, unsigned char *data)
 
 //
 // called by simulator to allow us to emulate I/O space peripheral writes
+// only for the addresses in application_device_addresses[]
 //
 // return 1 if we intercepted the i/o operation, 0 otherwise
 //
-int application_put_data_memory_byte(unsigned int address, unsigned char data)
+int application_put_data_memory_byte(struct machine *m, unsigned int address, unsigned char data)
 {
 	//
 	// simulated peripherals
@@ -304,321 +298,111 @@ int application_put_data_memory_byte(unsigned int address, unsigned char data)
 		// writes to the crc generator
 //		printf("\n*** WRITE TO CRC GENERATOR DETECTED: pc=%08x, data=%02x\n", register_pc, data);
 
-		crc_generator_output = generate_crc(data, crc_generator_output);
+		m->crc_generator_output = generate_crc(data, m->crc_generator_output);
 		return(1);
 	}
 
 	if(address == 0x3d00) {
 //		printf("\n*** WRITE TO 3d00 DETECTED: pc=%08x, data=%02x\n", register_pc, data);
-		hindex = data; // hindex must be <=3
+		m->hindex = data; // hindex must be <=3
 		return(1);
 	}
 	return(0);
 }
 
 //
-// called by simulator in function run_internals
-// to allow us to do things
+// every address the two above intercept, reads or writes, keep them in step
 //
-void application_triggers_and_breakpoints(void)
-{
-		if(register_pc == 0x5b42) {
-			printf("\n*** Generate MAC(5) entry - PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5b42, previous_register_pc);
-			if(run_log_enable) {
-				fprintf(run_log_fp, "\n*** Generate MAC(5) entry - PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5b42, previous_register_pc);
-
-				run_log_triggered = 1;
-			}
-		}
-
-		if(register_pc == 0x5b24) {
-			printf("\n*** Generate MAC(2 or 4) entry - PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5b24, previous_register_pc);
-			if(run_log_enable) {
-				fprintf(run_log_fp, "\n*** Generate MAC(2 or 4) entry - PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5b24, previous_register_pc);
-
-				run_log_triggered = 1;
-			}
-		}
-
-		if(register_pc == 0x5dc5) {
-			printf("\n*** Generate MAC(4) exit - PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5dc5, previous_register_pc);
-			if(run_log_enable) {
-				fprintf(run_log_fp, "\n*** Generate MAC(4) exit - PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5dc5, previous_register_pc);
-
-				run_log_triggered = 0;
-			}
-		}
-
-		if(register_pc == 0x5dc0) {
-			printf("\n*** Generate MAC(2) exit - PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5dc0, previous_register_pc);
-			if(run_log_enable) {
-				printf("run_log_fp, \n*** Generate MAC(2) exit - PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5dc0, previous_register_pc);
-
-				run_log_triggered = 0;
-			}
-		}
-
-		if(register_pc == 0x5b36) {
-			printf("\n*** Generate MAC(1) entry - PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5b36, previous_register_pc);
-			if(run_log_enable) {
-				fprintf(run_log_fp, "\n*** Generate MAC(1) entry - PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5b36, previous_register_pc);
-
-				run_log_triggered = 1;
-
-				G_InPacketLength0 = get_data_memory_byte_raw(0x20E);
-				G_InPacketLength1 = get_data_memory_byte_raw(0x20D);
-
-				fprintf(run_log_fp, "G_InPacketLength0 = %d\n", G_InPacketLength0);
-
-				fprintf(run_log_fp, "fe (packet): ");
-				display_data_memory_to_run_log(0xfe, G_InPacketLength0);
-			}
-		}
-
-		if(register_pc == 0x5ebf) {
-			printf("\n*** Generate MAC exit - PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5ebf, previous_register_pc);
-			if(run_log_enable) {
-				fprintf(run_log_fp, "\n*** Generate MAC exit - PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5ebf, previous_register_pc);
-
-				fprintf(run_log_fp, "251: ");
-				display_data_memory_to_run_log(0x251, 16);
-
-				run_log_triggered = 0;
-			}
-		}
-
-		// UnhandledException
-		if(register_pc == 0x99e2) {
-			printf("\n*** PERMANENT Breakpoint (Unhandled Exception) @ pc=%08x hit, previous_pc=%08x\n", 0x99e2, previous_register_pc);
-			stop_reason = STOP_INS_BREAK;
-			return;// go immediately to exit
-		}
-
-		// ThrowC5
-		if(register_pc == 0x9a90) {
-			printf("\n*** PERMANENT Breakpoint (ThrowC5) @ pc=%08x hit, previous_pc=%08x\n", 0x9a90, previous_register_pc);
-			stop_reason = STOP_INS_BREAK;
-			return;// go immediately to exit
-		}
-
-		if(register_pc == 0x7d42) {
-			printf("\n*** DoAesEncrypt entry PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x7d42, previous_register_pc);
-			if(run_log_triggered) {
-				fprintf(run_log_fp, "\n*** DoAesEncrypt entry PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x7d42, previous_register_pc);
-
-				display_do_loop_vars();
-				display_do_loop_vars_to_run_log();
-
-				// display input, and output to the do loop
-				fprintf(run_log_fp, "fc: ");
-				display_data_memory_to_run_log(0xfc, 24);
-
-				fprintf(run_log_fp, "221: ");
-				display_data_memory_to_run_log(0x221, 16);
-
-				fprintf(run_log_fp, "231: ");
-				display_data_memory_to_run_log(0x231, 16);
-
-				fprintf(run_log_fp, "251: ");
-				display_data_memory_to_run_log(0x251, 16);
-			}
-		}
-		if(register_pc == 0x7dc2) {
-			printf("\n*** DoAesEncrypt exit PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x7dc2, previous_register_pc);
-			if(run_log_triggered) {
-				fprintf(run_log_fp, "\n*** DoAesEncrypt exit PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x7dc2, previous_register_pc);
-
-				display_do_loop_vars();
-				display_do_loop_vars_to_run_log();
-
-				// display input, and output to the do loop
-				fprintf(run_log_fp, "fc: ");
-				display_data_memory_to_run_log(0xfc, 24);
-
-				fprintf(run_log_fp, "221: ");
-				display_data_memory_to_run_log(0x221, 16);
-
-				fprintf(run_log_fp, "231: ");
-				display_data_memory_to_run_log(0x231, 16);
-
-				fprintf(run_log_fp, "251: ");
-				display_data_memory_to_run_log(0x251, 16);
-			}
-		}
-
-/*
-		if(register_pc == 0x5cca) {
-			printf("\n*** clear rest of buffer branch PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5cca, previous_register_pc);
-			if(run_log_triggered) {
-				fprintf(run_log_fp, "\n*** clear rest of buffer branch PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5cca, previous_register_pc);
-
-				// display input, and the do loop vars
-				fprintf(run_log_fp, "fc: ");
-				display_data_memory_to_run_log(0xfc, 16);
-
-				fprintf(run_log_fp, "221: ");
-				display_data_memory_to_run_log(0x221, 16);
-			}
-		}
-
-		if(register_pc == 0x5cfa) {
-			printf("\n*** clear rest of buffer memset call PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5cfa, previous_register_pc);
-			if(run_log_triggered) {
-				fprintf(run_log_fp, "\n*** clear rest of buffer memset call PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5cfa, previous_register_pc);
-
-				display_do_loop_vars();
-				display_do_loop_vars_to_run_log();
-
-				// display input, and the do loop vars
-				fprintf(run_log_fp, "221: ");
-				display_data_memory_to_run_log(0x221, 16);
-			}
-		}
-
-		if(register_pc == 0x5cfd) {
-			printf("\n*** clear rest of buffer memset exit PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5cfd, previous_register_pc);
-			if(run_log_triggered) {
-				fprintf(run_log_fp, "\n*** clear rest of buffer memset exit PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5cfd, previous_register_pc);
-
-				display_do_loop_vars();
-				display_do_loop_vars_to_run_log();
-
-				// display input, and the do loop vars
-				fprintf(run_log_fp, "221: ");
-				display_data_memory_to_run_log(0x221, 16);
-			}
-		}
-*/
-
-		if(register_pc == 0x5d7c) {
-			printf("\n*** memcpy at 5d7c PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5d7c, previous_register_pc);
-			if(run_log_triggered) {
-				fprintf(run_log_fp, "\n*** memcpy at 5d7c PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5d7c, previous_register_pc);
-
-				display_do_loop_vars();
-				display_do_loop_vars_to_run_log();
-
-				// display input, and the do loop vars
-				fprintf(run_log_fp, "fc: ");
-				display_data_memory_to_run_log(0xfc, 24);
-
-				fprintf(run_log_fp, "221: ");
-				display_data_memory_to_run_log(0x221, 16);
-				fprintf(run_log_fp, "231: ");
-				display_data_memory_to_run_log(0x231, 16);
-			}
-		}
-
-		if(register_pc == 0x5d80) {
-			printf("\n*** after memcpy at 5d7c PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5d80, previous_register_pc);
-			if(run_log_triggered) {
-				fprintf(run_log_fp, "\n*** after memcpy at 5d7c PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5d80, previous_register_pc);
-
-				display_do_loop_vars();
-				display_do_loop_vars_to_run_log();
-
-				// display input, and the do loop vars
-				fprintf(run_log_fp, "fc: ");
-				display_data_memory_to_run_log(0xfc, 24);
-
-				fprintf(run_log_fp, "221: ");
-				display_data_memory_to_run_log(0x221, 16);
-				fprintf(run_log_fp, "231: ");
-				display_data_memory_to_run_log(0x231, 16);
-			}
-		}
-
-		// session key and sub keys printing
-		if(register_pc == 0x5ba8) {
-			printf("\n*** AesKeyExpansion exit PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5ba8, previous_register_pc);
-			if(run_log_triggered) {
-				fprintf(run_log_fp, "\n*** AesKeyExpansion exit PERMANENT Breakpoint @ pc=%08x hit, previous_pc=%08x\n", 0x5ba8, previous_register_pc);
-
-
-				fprintf(run_log_fp, "284 (sessionkey5): ");
-				display_data_memory_to_run_log(0x284, 16);
-
-				fprintf(run_log_fp, "618 (AesTmp0): ");
-				display_data_memory_to_run_log(618, 16);
+unsigned int application_device_addresses[] = {
+	0x04, 0x07, 0x0a, 0x0f,
+	0x3d00, 0x3d01, 0x3d02, 0x3d04, 0x3d05
+};
 
-				fprintf(run_log_fp, "628 (AesTmp1): ");
-				display_data_memory_to_run_log(628, 16);
+//
+// copy the peripheral addresses for the simulator (only they go to the two above)
+// returns how many were copied
+//
+int application_get_device_addresses(unsigned int *addresses, int max)
+{
+	int x;
 
-				fprintf(run_log_fp, "638 (AesTmp2): ");
-				display_data_memory_to_run_log(0x638, 16);
-			}
-		}
+	x = 0;
+	while((x != max) && (x != (int)(sizeof(application_device_addresses) / sizeof(application_device_addresses[0])))) {
+		addresses[x] = application_device_addresses[x];
+		x++;
+	}
+	return(x);
 }
 
 //
 // display relevant information from the tags memory
 //
-void tag_information(void)
+void tag_information(struct machine *m)
 {
 	printf("Tag Information:\n\n");
 
-	printf("Flash I2C Address: %02x\n", get_data_memory_byte_raw(0xc6ca));
+	printf("Flash I2C Address: %02x\n", get_data_memory_byte_raw(m, 0xc6ca));
 
-	printf("FlashSerialDriverMode: %02x\n", get_data_memory_byte_raw(0xc6cc));
+	printf("FlashSerialDriverMode: %02x\n", get_data_memory_byte_raw(m, 0xc6cc));
 
-	printf("FlashLockState: %02x\n", get_data_memory_byte_raw(0xc160));
+	printf("FlashLockState: %02x\n", get_data_memory_byte_raw(m, 0xc160));
 
-	printf("FlashSecretKeyScrambleDisable: %02x\n", get_data_memory_byte_raw(0xc161));
+	printf("FlashSecretKeyScrambleDisable: %02x\n", get_data_memory_byte_raw(m, 0xc161));
 
 	printf("FlashSecretKey1:");
-	display_data_memory(0xc163, 16);
+	display_data_memory(m, 0xc163, 16);
 
 	printf("FlashSecretKeyF1:");
-	display_data_memory(0xc174, 16);
+	display_data_memory(m, 0xc174, 16);
 
 	printf("FlashSecretKeySeed1:");
-	display_data_memory(0xc185, 8);
-	printf("FlashSecretKeySeed1CRC: %02x\n", get_data_memory_byte_raw(0xc184));
+	display_data_memory(m, 0xc185, 8);
+	printf("FlashSecretKeySeed1CRC: %02x\n", get_data_memory_byte_raw(m, 0xc184));
 
 	printf("FlashSecretKey2:");
-	display_data_memory(0xc196, 16);
+	display_data_memory(m, 0xc196, 16);
 
 	printf("FlashSecretKeyF2:");
-	display_data_memory(0xc1a7, 16);
+	display_data_memory(m, 0xc1a7, 16);
 
 	printf("FlashSecretKeySeed2:");
-	display_data_memory(0xc1b8, 8);
-	printf("FlashSecretKeySeedCRC: %02x\n", get_data_memory_byte_raw(0xc1b7));
+	display_data_memory(m, 0xc1b8, 8);
+	printf("FlashSecretKeySeedCRC: %02x\n", get_data_memory_byte_raw(m, 0xc1b7));
 
 	printf("FlashAuthCounter1: ");
-	display_data_memory(0xc191, 3);
+	display_data_memory(m, 0xc191, 3);
 
 	printf("FlashAuthCounter2: ");
-	display_data_memory(0xc1c4, 3);
+	display_data_memory(m, 0xc1c4, 3);
 
 	printf("\nRam Information:\n");
 
 	printf("AuthCounter:");
-	display_data_memory(0x29f, 3);
+	display_data_memory(m, 0x29f, 3);
 
-	printf("LockState=%02x\n",get_data_memory_byte_raw(0x2e0));
+	printf("LockState=%02x\n",get_data_memory_byte_raw(m, 0x2e0));
 
-	printf("CmdSeqNum=%02x\n",get_data_memory_byte_raw(0x2dc));
+	printf("CmdSeqNum=%02x\n",get_data_memory_byte_raw(m, 0x2dc));
 
-	printf("AuthMode=%02x\n",get_data_memory_byte_raw(0x2de));
-	printf("AuthState=%02x\n",get_data_memory_byte_raw(0x2dd));
+	printf("AuthMode=%02x\n",get_data_memory_byte_raw(m, 0x2de));
+	printf("AuthState=%02x\n",get_data_memory_byte_raw(m, 0x2dd));
 
-	printf("SessionKey05Valid=%02x\n",get_data_memory_byte_raw(0x283));
-	printf("SelectedSessionKey=%02x\n",get_data_memory_byte_raw(0x294));
+	printf("SessionKey05Valid=%02x\n",get_data_memory_byte_raw(m, 0x283));
+	printf("SelectedSessionKey=%02x\n",get_data_memory_byte_raw(m, 0x294));
 	printf("SessionKey05:");
-	display_data_memory(0x284, 16);
+	display_data_memory(m, 0x284, 16);
 
-	printf("SecretKeyValid=%02x\n",get_data_memory_byte_raw(0x2a4));
-	printf("SelectedSecretKey=%02x\n",get_data_memory_byte_raw(0x2a3));
+	printf("SecretKeyValid=%02x\n",get_data_memory_byte_raw(m, 0x2a4));
+	printf("SelectedSecretKey=%02x\n",get_data_memory_byte_raw(m, 0x2a3));
 
 	printf("SecretKey0:");
-	display_data_memory(0x295, 16);
+	display_data_memory(m, 0x295, 16);
 
 	printf("SecretKeyF:");
-	display_data_memory(0x2b6, 16);
+	display_data_memory(m, 0x2b6, 16);
 
-	printf("AesScrambledSboxValid=%02x\n",get_data_memory_byte_raw(0x324));
-	printf("AesRoundKeysValid=%02x\n",get_data_memory_byte_raw(0x323));
+	printf("AesScrambledSboxValid=%02x\n",get_data_memory_byte_raw(m, 0x324));
+	printf("AesRoundKeysValid=%02x\n",get_data_memory_byte_raw(m, 0x323));
 
 /*
 	RJS fix this to test run log enabled
@@ -640,61 +424,129 @@ void tag_information(void)
 */
 }
 
+//
+// where a command starts (exit from the jet driver) and ends (the jet driver wait loop)
+//
+#define COMMAND_START_PC			0x0010baa3
+#define COMMAND_DONE_PC				0x0010ba4f
+
+// packet buffer, 0xfe up to 0x1fc
+#define MAX_COMMAND_PACKET			255
+
 //
 // send a command to the tag and get a response
 //
-int send_command(void)
+int send_command(struct machine *m)
 {
 	printf("\nSending command...");
 
-	register_pc = 0x0010baa3;	// start execution at exit from jet driver, command assumed to be in correct place
+	m->register_pc = COMMAND_START_PC;	// start execution at exit from jet driver, command assumed to be in correct place
 
 	// set a trigger point to let us know when command is done
-	application_breakpoint.address = 0x0010ba4f; // set our application break/trigger point in the jet driver wait loop which will be hit upon completeion of command
-	application_breakpoint.enable = 1;
+	m->application_breakpoint.address = COMMAND_DONE_PC; // set our application break/trigger point in the jet driver wait loop which will be hit upon completeion of command
+	m->application_breakpoint.enable = 1;
 
 	// send it on it's way
-	run_internals();
+	run_internals(m);
 
-	if(stop_reason == STOP_APPLICATION_BREAK) {
+	if(m->stop_reason == STOP_APPLICATION_BREAK) {
 		// our trigger stopped it
 
 		// display/check results
-		printf("Command returned status: %02x, length=%d,%d\n", get_data_memory_byte_raw(0x00000fb), get_data_memory_byte_raw(0x000000fc), get_data_memory_byte_raw(0x000000fd)); 
+		printf("Command returned status: %02x, length=%d,%d\n", get_data_memory_byte_raw(m, 0x00000fb), get_data_memory_byte_raw(m, 0x000000fc), get_data_memory_byte_raw(m, 0x000000fd)); 
 
-		if((get_data_memory_byte_raw(0xfb) & STATUS_MASK) != 0x00) {
+		if((get_data_memory_byte_raw(m, 0xfb) & STATUS_MASK) != 0x00) {
 			return(0); // bad status does not return data
 		}
-		if(get_data_memory_byte_raw(0x000000fd) != 0) {
+		if(get_data_memory_byte_raw(m, 0x000000fd) != 0) {
 			// show returned data
 			printf("Returned data:\n");
-			display_data_memory(0x000000fe, get_data_memory_byte_raw(0x000000fd));
+			display_data_memory(m, 0x000000fe, get_data_memory_byte_raw(m, 0x000000fd));
 			printf("\n");
 		} else {
 			printf("\n");
-			application_breakpoint.enable = 0;
+			m->application_breakpoint.enable = 0;
 			return(1);
 		}
 	} else {
 		// any other stop condition (instruction breakpoints, call breakpoint, data breakpoints or abnormal termination), return failure
-		application_breakpoint.enable = 0;
-		display_registers(CURRENT);	
+		m->application_breakpoint.enable = 0;
+		display_registers(m, CURRENT);	
 		return(0);
 	}
 
-	application_breakpoint.enable = 0;
+	m->application_breakpoint.enable = 0;
 
 	// return success
 	return(1);
 }
 
+//
+// one command for the batch engine, see run_batch_command()
+//
+struct batch_command {
+	// what to send
+	unsigned char command;							// DrvCmdByte
+	unsigned int length;							// packet length
+	unsigned char packet[MAX_COMMAND_PACKET];
+
+	// what came back
+	int stop_reason;								// STOP_APPLICATION_BREAK if the command finished
+	unsigned char status;
+	unsigned int response_length;
+	unsigned char response[MAX_COMMAND_PACKET];		// returned data, starts with the chips MAC
+	unsigned long long sim_cycles;					// how long the tag took
+	unsigned long long instruction_count;			// and how many instructions
+};
+
+//
+// batch job, put the command in the input packet memory and run it like send_command() does
+//
+void run_batch_command(struct machine *m, void *job)
+{
+	struct batch_command *cmd;
+	unsigned long long start_cycles;
+	unsigned int x;
+
+	cmd = (struct batch_command *)job;
+
+	for(x = 0xfa; x < 0x1fd; x++) {
+		put_memory_byte(m->prog_memory, x, 0x00);
+	}
+
+	put_memory_byte(m->prog_memory, 0xfa, cmd->command);				// DrvCmdByte
+	put_memory_byte(m->prog_memory, 0xfc, (cmd->length >> 8) & 0xff);	// DrvPacketLength1
+	put_memory_byte(m->prog_memory, 0xfd, cmd->length & 0xff);			// DrvPacketLength0
+	for(x = 0; x != sizeof(cmd->packet); x++) {
+		put_memory_byte(m->prog_memory, 0xfe + x, cmd->packet[x]);
+	}
+
+	m->register_pc = COMMAND_START_PC;
+	m->application_breakpoint.address = COMMAND_DONE_PC;
+	m->application_breakpoint.enable = 1;
+
+	start_cycles = m->sim_cycles;
+
+	cmd->stop_reason = run_internals(m);
+
+	cmd->sim_cycles = m->sim_cycles - start_cycles;
+	cmd->instruction_count = m->instruction_count;		// run_internals() starts it from 0
+
+	cmd->status = get_data_memory_byte_raw(m, 0xfb);
+	cmd->response_length = get_data_memory_byte_raw(m, 0xfd);
+	for(x = 0; x != cmd->response_length; x++) {
+		cmd->response[x] = get_data_memory_byte_raw(m, 0xfe + x);
+	}
+}
+
 //
 // Load inbound message into I2c Rec buffer, and the execute code until stop trigger
 //
-void load_inbound_message(void)
+void load_inbound_message(struct machine *m)
 {
-	int c, x, len;
+	int c, x, len, workers;
 	unsigned char chips_mac[4];
+	struct batch_command *cmds;
 
 	printf("<s>tandard initialze (ECHO, aka DEADBEEF)\n");
 	printf("<A>uth\n");
@@ -707,6 +559,8 @@ void load_inbound_message(void)
 	printf("<3> Write (one bigger+16)\n");
 	printf("<t> try all sizes\n");
 	printf("<I>nbound MAC test\n");
+	printf("<k>eep this state to fork from (after <A>uth, say)\n");
+	printf("<f>ork from the kept state\n");
 
 	printf("cmd > ");
 	c = getchar();
@@ -717,12 +571,12 @@ void load_inbound_message(void)
 	case 'G':
 		// get info
 
-		prog_memory[0xfa] = CMD_GET_INFO;	// DrvCmdByte
-		prog_memory[0xfc] = 0x00;		// DrvPacketLength1 length=0
-		prog_memory[0xfd] = 0x01;		// DrvPacketLength0 length=8
-		prog_memory[0xfe] = 0x02;		// packet 
+		put_memory_byte(m->prog_memory, 0xfa, CMD_GET_INFO);	// DrvCmdByte
+		put_memory_byte(m->prog_memory, 0xfc, 0x00);		// DrvPacketLength1 length=0
+		put_memory_byte(m->prog_memory, 0xfd, 0x01);		// DrvPacketLength0 length=8
+		put_memory_byte(m->prog_memory, 0xfe, 0x02);		// packet 
 
-		if(!send_command()) {
+		if(!send_command(m)) {
 			printf("Send command failed.\n");
 		}
 		break;
@@ -741,16 +595,16 @@ void load_inbound_message(void)
 */
 		// AUTH
 		// 03 01 ad 24 62 68 
-		prog_memory[0xfa] = CMD_AUTH;	// DrvCmdByte
-		prog_memory[0xfc] = 0x00;		// DrvPacketLength1 length=0
-		prog_memory[0xfd] = 0x05;		// DrvPacketLength0 length=8
-		prog_memory[0xfe] = 0x01;		// packet auth mode 1
-		prog_memory[0xff] = 0xad;		// 4 byte random number
-		prog_memory[0x100] = 0x24;
-		prog_memory[0x101] = 0x62;
-		prog_memory[0x102] = 0x68;
-
-		if(!send_command()) {
+		put_memory_byte(m->prog_memory, 0xfa, CMD_AUTH);	// DrvCmdByte
+		put_memory_byte(m->prog_memory, 0xfc, 0x00);		// DrvPacketLength1 length=0
+		put_memory_byte(m->prog_memory, 0xfd, 0x05);		// DrvPacketLength0 length=8
+		put_memory_byte(m->prog_memory, 0xfe, 0x01);		// packet auth mode 1
+		put_memory_byte(m->prog_memory, 0xff, 0xad);		// 4 byte random number
+		put_memory_byte(m->prog_memory, 0x100, 0x24);
+		put_memory_byte(m->prog_memory, 0x101, 0x62);
+		put_memory_byte(m->prog_memory, 0x102, 0x68);
+
+		if(!send_command(m)) {
 			printf("Send command failed.\n");
 			break;
 		}
@@ -760,22 +614,22 @@ void load_inbound_message(void)
 		// get the session key from the tag here
 		mymemset(G_session_key5, 0x00, 16);
 
-		G_session_key5[0] = get_data_memory_byte_raw(0x284);
-		G_session_key5[1] = get_data_memory_byte_raw(0x285);
-		G_session_key5[2] = get_data_memory_byte_raw(0x286);
-		G_session_key5[3] = get_data_memory_byte_raw(0x287);
-		G_session_key5[4] = get_data_memory_byte_raw(0x288);
-		G_session_key5[5] = get_data_memory_byte_raw(0x289);
-		G_session_key5[6] = get_data_memory_byte_raw(0x28a);
-		G_session_key5[7] = get_data_memory_byte_raw(0x28b);
-		G_session_key5[8] = get_data_memory_byte_raw(0x28c);
-		G_session_key5[9] = get_data_memory_byte_raw(0x28d);
-		G_session_key5[10] = get_data_memory_byte_raw(0x28e);
-		G_session_key5[11] = get_data_memory_byte_raw(0x28f);
-		G_session_key5[12] = get_data_memory_byte_raw(0x290);
-		G_session_key5[13] = get_data_memory_byte_raw(0x291);
-		G_session_key5[14] = get_data_memory_byte_raw(0x292);
-		G_session_key5[15] = get_data_memory_byte_raw(0x293);
+		G_session_key5[0] = get_data_memory_byte_raw(m, 0x284);
+		G_session_key5[1] = get_data_memory_byte_raw(m, 0x285);
+		G_session_key5[2] = get_data_memory_byte_raw(m, 0x286);
+		G_session_key5[3] = get_data_memory_byte_raw(m, 0x287);
+		G_session_key5[4] = get_data_memory_byte_raw(m, 0x288);
+		G_session_key5[5] = get_data_memory_byte_raw(m, 0x289);
+		G_session_key5[6] = get_data_memory_byte_raw(m, 0x28a);
+		G_session_key5[7] = get_data_memory_byte_raw(m, 0x28b);
+		G_session_key5[8] = get_data_memory_byte_raw(m, 0x28c);
+		G_session_key5[9] = get_data_memory_byte_raw(m, 0x28d);
+		G_session_key5[10] = get_data_memory_byte_raw(m, 0x28e);
+		G_session_key5[11] = get_data_memory_byte_raw(m, 0x28f);
+		G_session_key5[12] = get_data_memory_byte_raw(m, 0x290);
+		G_session_key5[13] = get_data_memory_byte_raw(m, 0x291);
+		G_session_key5[14] = get_data_memory_byte_raw(m, 0x292);
+		G_session_key5[15] = get_data_memory_byte_raw(m, 0x293);
 
 		print_txt("session key=");
 		print_hex(G_session_key5, 16);
@@ -789,34 +643,34 @@ void load_inbound_message(void)
 
 		// clear 64 bytyes of input packet memory
 		for(x=0xfa; x < 0x13a; x++) {
-			prog_memory[x] = 0x00;
+			put_memory_byte(m->prog_memory, x, 0x00);
 		}
 
-		prog_memory[0xfa] = CMD_WRITE | JET_CMD_BIT6;	// DrvCmdByte
-		prog_memory[0xfc] = 0x00;		// DrvPacketLength1 length=0
-		prog_memory[0xfd] = 13;			// DrvPacketLength0 length=8
-		prog_memory[0xfe] = 0x00;		// packet 
-		prog_memory[0xff] = 0x01;
-		prog_memory[0x100] = 0x00;
-		prog_memory[0x101] = 0x00;
-		prog_memory[0x102] = 0x00;
-		prog_memory[0x103] = 0xa3;
-		prog_memory[0x104] = 0x44;
-		prog_memory[0x105] = 0x6e;
-		prog_memory[0x106] = 0x2f;
-		prog_memory[0x107] = 0x09;
-		prog_memory[0x108] = 0x61;
-		prog_memory[0x109] = 0x51;
-		prog_memory[0x10a] = 0xdd;
-
-		if(!send_command()) {
+		put_memory_byte(m->prog_memory, 0xfa, CMD_WRITE | JET_CMD_BIT6);	// DrvCmdByte
+		put_memory_byte(m->prog_memory, 0xfc, 0x00);		// DrvPacketLength1 length=0
+		put_memory_byte(m->prog_memory, 0xfd, 13);			// DrvPacketLength0 length=8
+		put_memory_byte(m->prog_memory, 0xfe, 0x00);		// packet 
+		put_memory_byte(m->prog_memory, 0xff, 0x01);
+		put_memory_byte(m->prog_memory, 0x100, 0x00);
+		put_memory_byte(m->prog_memory, 0x101, 0x00);
+		put_memory_byte(m->prog_memory, 0x102, 0x00);
+		put_memory_byte(m->prog_memory, 0x103, 0xa3);
+		put_memory_byte(m->prog_memory, 0x104, 0x44);
+		put_memory_byte(m->prog_memory, 0x105, 0x6e);
+		put_memory_byte(m->prog_memory, 0x106, 0x2f);
+		put_memory_byte(m->prog_memory, 0x107, 0x09);
+		put_memory_byte(m->prog_memory, 0x108, 0x61);
+		put_memory_byte(m->prog_memory, 0x109, 0x51);
+		put_memory_byte(m->prog_memory, 0x10a, 0xdd);
+
+		if(!send_command(m)) {
 			printf("Send command failed.\n");
 			break;
 		} else {
 
 			// get chips MAC
 			for(x=0; x<4; x++) {
-				chips_mac[x] = get_data_memory_byte_raw(0x000000fe+x);
+				chips_mac[x] = get_data_memory_byte_raw(m, 0x000000fe+x);
 			}
 
 			mymemset(prev_MAC, 0, 16);
@@ -868,34 +722,34 @@ void load_inbound_message(void)
 
 		// clear 64 bytyes of input packet memory
 		for(x=0xfa; x < 0x13a; x++) {
-			prog_memory[x] = 0x00;
+			put_memory_byte(m->prog_memory, x, 0x00);
 		}
 
-		prog_memory[0xfa] = CMD_WRITE | JET_CMD_BIT6;	// DrvCmdByte
-		prog_memory[0xfc] = 0x00;		// DrvPacketLength1 length=0
-		prog_memory[0xfd] = 14;		// DrvPacketLength0 length=8
-		prog_memory[0xfe] = 0x00;		// packet 
-		prog_memory[0xff] = 0x01;
-		prog_memory[0x100] = 0x00;
-		prog_memory[0x101] = 0x00;
-		prog_memory[0x102] = 0x00;
-		prog_memory[0x103] = 0xa3;
-		prog_memory[0x104] = 0x44;
-		prog_memory[0x105] = 0x6e;
-		prog_memory[0x106] = 0x2f;
-		prog_memory[0x107] = 0x09;
-		prog_memory[0x108] = 0x61;
-		prog_memory[0x109] = 0x51;
-		prog_memory[0x10a] = 0xdd;
-		prog_memory[0x10b] = 0x11;
-
-		if(!send_command()) {
+		put_memory_byte(m->prog_memory, 0xfa, CMD_WRITE | JET_CMD_BIT6);	// DrvCmdByte
+		put_memory_byte(m->prog_memory, 0xfc, 0x00);		// DrvPacketLength1 length=0
+		put_memory_byte(m->prog_memory, 0xfd, 14);		// DrvPacketLength0 length=8
+		put_memory_byte(m->prog_memory, 0xfe, 0x00);		// packet 
+		put_memory_byte(m->prog_memory, 0xff, 0x01);
+		put_memory_byte(m->prog_memory, 0x100, 0x00);
+		put_memory_byte(m->prog_memory, 0x101, 0x00);
+		put_memory_byte(m->prog_memory, 0x102, 0x00);
+		put_memory_byte(m->prog_memory, 0x103, 0xa3);
+		put_memory_byte(m->prog_memory, 0x104, 0x44);
+		put_memory_byte(m->prog_memory, 0x105, 0x6e);
+		put_memory_byte(m->prog_memory, 0x106, 0x2f);
+		put_memory_byte(m->prog_memory, 0x107, 0x09);
+		put_memory_byte(m->prog_memory, 0x108, 0x61);
+		put_memory_byte(m->prog_memory, 0x109, 0x51);
+		put_memory_byte(m->prog_memory, 0x10a, 0xdd);
+		put_memory_byte(m->prog_memory, 0x10b, 0x11);
+
+		if(!send_command(m)) {
 			printf("Send command failed.\n");
 		} else {
 
 			// get chips MAC
 			for(x=0; x<4; x++) {
-				chips_mac[x] = get_data_memory_byte_raw(0x000000fe+x);
+				chips_mac[x] = get_data_memory_byte_raw(m, 0x000000fe+x);
 			}
 
 			mymemset(prev_MAC, 0, 16);
@@ -947,34 +801,34 @@ void load_inbound_message(void)
 
 		// clear 64 bytyes of input packet memory
 		for(x=0xfa; x < 0x13a; x++) {
-			prog_memory[x] = 0x00;
+			put_memory_byte(m->prog_memory, x, 0x00);
 		}
 
-		prog_memory[0xfa] = CMD_WRITE | JET_CMD_BIT6;	// DrvCmdByte
-		prog_memory[0xfc] = 0x00;		// DrvPacketLength1 length=0
-		prog_memory[0xfd] = 15;		// DrvPacketLength0 length=8
-		prog_memory[0xfe] = 0x00;		// packet 
-		prog_memory[0xff] = 0x01;
-		prog_memory[0x100] = 0x00;
-		prog_memory[0x101] = 0x00;
-		prog_memory[0x102] = 0x00;
-		prog_memory[0x103] = 0xa3;
-		prog_memory[0x104] = 0x44;
-		prog_memory[0x105] = 0x6e;
-		prog_memory[0x106] = 0x2f;
-		prog_memory[0x107] = 0x09;
-		prog_memory[0x108] = 0x61;
-		prog_memory[0x109] = 0x51;
-		prog_memory[0x10a] = 0xdd;
-		prog_memory[0x10b] = 0x11;
-		prog_memory[0x10c] = 0x22;
-
-		if(!send_command()) {
+		put_memory_byte(m->prog_memory, 0xfa, CMD_WRITE | JET_CMD_BIT6);	// DrvCmdByte
+		put_memory_byte(m->prog_memory, 0xfc, 0x00);		// DrvPacketLength1 length=0
+		put_memory_byte(m->prog_memory, 0xfd, 15);		// DrvPacketLength0 length=8
+		put_memory_byte(m->prog_memory, 0xfe, 0x00);		// packet 
+		put_memory_byte(m->prog_memory, 0xff, 0x01);
+		put_memory_byte(m->prog_memory, 0x100, 0x00);
+		put_memory_byte(m->prog_memory, 0x101, 0x00);
+		put_memory_byte(m->prog_memory, 0x102, 0x00);
+		put_memory_byte(m->prog_memory, 0x103, 0xa3);
+		put_memory_byte(m->prog_memory, 0x104, 0x44);
+		put_memory_byte(m->prog_memory, 0x105, 0x6e);
+		put_memory_byte(m->prog_memory, 0x106, 0x2f);
+		put_memory_byte(m->prog_memory, 0x107, 0x09);
+		put_memory_byte(m->prog_memory, 0x108, 0x61);
+		put_memory_byte(m->prog_memory, 0x109, 0x51);
+		put_memory_byte(m->prog_memory, 0x10a, 0xdd);
+		put_memory_byte(m->prog_memory, 0x10b, 0x11);
+		put_memory_byte(m->prog_memory, 0x10c, 0x22);
+
+		if(!send_command(m)) {
 			printf("Send command failed.\n");
 		} else {
 			// get chips MAC
 			for(x=0; x<4; x++) {
-				chips_mac[x] = get_data_memory_byte_raw(0x000000fe+x);
+				chips_mac[x] = get_data_memory_byte_raw(m, 0x000000fe+x);
 			}
 
 			mymemset(prev_MAC, 0, 16);
@@ -1025,32 +879,32 @@ void load_inbound_message(void)
 
 		// clear 64 bytyes of input packet memory
 		for(x=0xfa; x < 0x13a; x++) {
-			prog_memory[x] = 0x00;
+			put_memory_byte(m->prog_memory, x, 0x00);
 		}
 
-		prog_memory[0xfa] = CMD_WRITE | JET_CMD_BIT6;	// DrvCmdByte
-		prog_memory[0xfc] = 0x00;		// DrvPacketLength1 length=0
-		prog_memory[0xfd] = 13+16;			// DrvPacketLength0 length=8
-		prog_memory[0xfe] = 0x00;		// packet 
-		prog_memory[0xff] = 0x01;
-		prog_memory[0x100] = 0x00;
-		prog_memory[0x101] = 0x00;
-		prog_memory[0x102] = 0x00;
-		prog_memory[0x103] = 0xa3;
-		prog_memory[0x104] = 0x44;
-		prog_memory[0x105] = 0x6e;
-		prog_memory[0x106] = 0x2f;
-		prog_memory[0x107] = 0x09;
-		prog_memory[0x108] = 0x61;
-		prog_memory[0x109] = 0x51;
-		prog_memory[0x10a] = 0xdd;
-
-		if(!send_command()) {
+		put_memory_byte(m->prog_memory, 0xfa, CMD_WRITE | JET_CMD_BIT6);	// DrvCmdByte
+		put_memory_byte(m->prog_memory, 0xfc, 0x00);		// DrvPacketLength1 length=0
+		put_memory_byte(m->prog_memory, 0xfd, 13+16);			// DrvPacketLength0 length=8
+		put_memory_byte(m->prog_memory, 0xfe, 0x00);		// packet 
+		put_memory_byte(m->prog_memory, 0xff, 0x01);
+		put_memory_byte(m->prog_memory, 0x100, 0x00);
+		put_memory_byte(m->prog_memory, 0x101, 0x00);
+		put_memory_byte(m->prog_memory, 0x102, 0x00);
+		put_memory_byte(m->prog_memory, 0x103, 0xa3);
+		put_memory_byte(m->prog_memory, 0x104, 0x44);
+		put_memory_byte(m->prog_memory, 0x105, 0x6e);
+		put_memory_byte(m->prog_memory, 0x106, 0x2f);
+		put_memory_byte(m->prog_memory, 0x107, 0x09);
+		put_memory_byte(m->prog_memory, 0x108, 0x61);
+		put_memory_byte(m->prog_memory, 0x109, 0x51);
+		put_memory_byte(m->prog_memory, 0x10a, 0xdd);
+
+		if(!send_command(m)) {
 			printf("Send command failed.\n");
 		} else {
 			// get chips MAC
 			for(x=0; x<4; x++) {
-				chips_mac[x] = get_data_memory_byte_raw(0x000000fe+x);
+				chips_mac[x] = get_data_memory_byte_raw(m, 0x000000fe+x);
 			}
 
 			mymemset(prev_MAC, 0, 16);
@@ -1099,34 +953,34 @@ void load_inbound_message(void)
 
 		// clear 64 bytyes of input packet memory
 		for(x=0xfa; x < 0x13a; x++) {
-			prog_memory[x] = 0x00;
+			put_memory_byte(m->prog_memory, x, 0x00);
 		}
 
 
-		prog_memory[0xfa] = CMD_WRITE | JET_CMD_BIT6;	// DrvCmdByte
-		prog_memory[0xfc] = 0x00;		// DrvPacketLength1 length=0
-		prog_memory[0xfd] = 14+16;		// DrvPacketLength0 length=8
-		prog_memory[0xfe] = 0x00;		// packet 
-		prog_memory[0xff] = 0x01;
-		prog_memory[0x100] = 0x00;
-		prog_memory[0x101] = 0x00;
-		prog_memory[0x102] = 0x00;
-		prog_memory[0x103] = 0xa3;
-		prog_memory[0x104] = 0x44;
-		prog_memory[0x105] = 0x6e;
-		prog_memory[0x106] = 0x2f;
-		prog_memory[0x107] = 0x09;
-		prog_memory[0x108] = 0x61;
-		prog_memory[0x109] = 0x51;
-		prog_memory[0x10a] = 0xdd;
-		prog_memory[0x10b] = 0x11;
-
-		if(!send_command()) {
+		put_memory_byte(m->prog_memory, 0xfa, CMD_WRITE | JET_CMD_BIT6);	// DrvCmdByte
+		put_memory_byte(m->prog_memory, 0xfc, 0x00);		// DrvPacketLength1 length=0
+		put_memory_byte(m->prog_memory, 0xfd, 14+16);		// DrvPacketLength0 length=8
+		put_memory_byte(m->prog_memory, 0xfe, 0x00);		// packet 
+		put_memory_byte(m->prog_memory, 0xff, 0x01);
+		put_memory_byte(m->prog_memory, 0x100, 0x00);
+		put_memory_byte(m->prog_memory, 0x101, 0x00);
+		put_memory_byte(m->prog_memory, 0x102, 0x00);
+		put_memory_byte(m->prog_memory, 0x103, 0xa3);
+		put_memory_byte(m->prog_memory, 0x104, 0x44);
+		put_memory_byte(m->prog_memory, 0x105, 0x6e);
+		put_memory_byte(m->prog_memory, 0x106, 0x2f);
+		put_memory_byte(m->prog_memory, 0x107, 0x09);
+		put_memory_byte(m->prog_memory, 0x108, 0x61);
+		put_memory_byte(m->prog_memory, 0x109, 0x51);
+		put_memory_byte(m->prog_memory, 0x10a, 0xdd);
+		put_memory_byte(m->prog_memory, 0x10b, 0x11);
+
+		if(!send_command(m)) {
 			printf("Send command failed.\n");
 		} else {
 			// get chips MAC
 			for(x=0; x<4; x++) {
-				chips_mac[x] = get_data_memory_byte_raw(0x000000fe+x);
+				chips_mac[x] = get_data_memory_byte_raw(m, 0x000000fe+x);
 			}
 
 			mymemset(prev_MAC, 0, 16);
@@ -1176,34 +1030,34 @@ void load_inbound_message(void)
 
 		// clear 64 bytyes of input packet memory
 		for(x=0xfa; x < 0x13a; x++) {
-			prog_memory[x] = 0x00;
+			put_memory_byte(m->prog_memory, x, 0x00);
 		}
 
-		prog_memory[0xfa] = CMD_WRITE | JET_CMD_BIT6;	// DrvCmdByte
-		prog_memory[0xfc] = 0x00;		// DrvPacketLength1 length=0
-		prog_memory[0xfd] = 15+16;		// DrvPacketLength0 length=8
-		prog_memory[0xfe] = 0x00;		// packet 
-		prog_memory[0xff] = 0x01;
-		prog_memory[0x100] = 0x00;
-		prog_memory[0x101] = 0x00;
-		prog_memory[0x102] = 0x00;
-		prog_memory[0x103] = 0xa3;
-		prog_memory[0x104] = 0x44;
-		prog_memory[0x105] = 0x6e;
-		prog_memory[0x106] = 0x2f;
-		prog_memory[0x107] = 0x09;
-		prog_memory[0x108] = 0x61;
-		prog_memory[0x109] = 0x51;
-		prog_memory[0x10a] = 0xdd;
-		prog_memory[0x10b] = 0x11;
-		prog_memory[0x10c] = 0x22;
-
-		if(!send_command()) {
+		put_memory_byte(m->prog_memory, 0xfa, CMD_WRITE | JET_CMD_BIT6);	// DrvCmdByte
+		put_memory_byte(m->prog_memory, 0xfc, 0x00);		// DrvPacketLength1 length=0
+		put_memory_byte(m->prog_memory, 0xfd, 15+16);		// DrvPacketLength0 length=8
+		put_memory_byte(m->prog_memory, 0xfe, 0x00);		// packet 
+		put_memory_byte(m->prog_memory, 0xff, 0x01);
+		put_memory_byte(m->prog_memory, 0x100, 0x00);
+		put_memory_byte(m->prog_memory, 0x101, 0x00);
+		put_memory_byte(m->prog_memory, 0x102, 0x00);
+		put_memory_byte(m->prog_memory, 0x103, 0xa3);
+		put_memory_byte(m->prog_memory, 0x104, 0x44);
+		put_memory_byte(m->prog_memory, 0x105, 0x6e);
+		put_memory_byte(m->prog_memory, 0x106, 0x2f);
+		put_memory_byte(m->prog_memory, 0x107, 0x09);
+		put_memory_byte(m->prog_memory, 0x108, 0x61);
+		put_memory_byte(m->prog_memory, 0x109, 0x51);
+		put_memory_byte(m->prog_memory, 0x10a, 0xdd);
+		put_memory_byte(m->prog_memory, 0x10b, 0x11);
+		put_memory_byte(m->prog_memory, 0x10c, 0x22);
+
+		if(!send_command(m)) {
 			printf("Send command failed.\n");
 		} else {
 			// get chips MAC
 			for(x=0; x<4; x++) {
-				chips_mac[x] = get_data_memory_byte_raw(0x000000fe+x);
+				chips_mac[x] = get_data_memory_byte_raw(m, 0x000000fe+x);
 			}
 
 			mymemset(prev_MAC, 0, 16);
@@ -1251,33 +1105,46 @@ void load_inbound_message(void)
 
 		printf("Trying every length command with outbouind MAC...\n");
 
-		// try every size message
+		// every length starts from where we are now, they all run at once
+		cmds = (struct batch_command *)calloc(188 - 6, sizeof(struct batch_command));
+		if(cmds == NULL) {
+			printf("Not enough memory\n");
+			break;
+		}
+
+		for(len=6;len < 188; len++) {
+			cmds[len - 6].command = CMD_WRITE | JET_CMD_BIT6;	// DrvCmdByte
+			cmds[len - 6].length = len;
+			cmds[len - 6].packet[0] = 0x00;		// packet 
+			cmds[len - 6].packet[1] = 0x01;
+			cmds[len - 6].packet[2] = 0x00;
+			cmds[len - 6].packet[3] = 0x00;
+			cmds[len - 6].packet[4] = 0x00;
+			cmds[len - 6].packet[5] = 0xa3;
+			cmds[len - 6].packet[6] = 0x44;
+			cmds[len - 6].packet[7] = 0x6e;
+			cmds[len - 6].packet[8] = 0x2f;
+			cmds[len - 6].packet[9] = 0x09;
+			cmds[len - 6].packet[10] = 0x61;
+			cmds[len - 6].packet[11] = 0x51;
+			cmds[len - 6].packet[12] = 0xdd;
+		}
+
+		workers = run_batch(m, cmds, sizeof(struct batch_command), 188 - 6, run_batch_command, 0);
+		if(!workers) {
+			free(cmds);
+			break;
+		}
+		printf("Ran %d lengths on %d workers\n", 188 - 6, workers);
+
+		// check them in order
 		for(len=6;len < 188; len++) {
 
 			printf("\nTrying length=%d...\n", len);
 
-			for(x=0xfa; x < 0x1fd; x++) {
-				prog_memory[x] = 0x00;
-			}
+			printf("Command returned status: %02x, length=%d, %lluns\n", cmds[len - 6].status, cmds[len - 6].response_length, cycles_to_ns(m, cmds[len - 6].sim_cycles));
 
-			prog_memory[0xfa] = CMD_WRITE | JET_CMD_BIT6;	// DrvCmdByte
-			prog_memory[0xfc] = 0x00;		// DrvPacketLength1 length=0
-			prog_memory[0xfd] = len;			// DrvPacketLength0 length=8
-			prog_memory[0xfe] = 0x00;		// packet 
-			prog_memory[0xff] = 0x01;
-			prog_memory[0x100] = 0x00;
-			prog_memory[0x101] = 0x00;
-			prog_memory[0x102] = 0x00;
-			prog_memory[0x103] = 0xa3;
-			prog_memory[0x104] = 0x44;
-			prog_memory[0x105] = 0x6e;
-			prog_memory[0x106] = 0x2f;
-			prog_memory[0x107] = 0x09;
-			prog_memory[0x108] = 0x61;
-			prog_memory[0x109] = 0x51;
-			prog_memory[0x10a] = 0xdd;
-
-			if(!send_command()) {
+			if((cmds[len - 6].stop_reason != STOP_APPLICATION_BREAK) || ((cmds[len - 6].status & STATUS_MASK) != 0x00)) {
 				printf("Send command failed.\n");
 				break;
 
@@ -1285,7 +1152,7 @@ void load_inbound_message(void)
 
 				// get chips MAC
 				for(x=0; x<4; x++) {
-					chips_mac[x] = get_data_memory_byte_raw(0x000000fe+x);
+					chips_mac[x] = cmds[len - 6].response[x];
 				}
 
 				mymemset(prev_MAC, 0, 16);
@@ -1328,6 +1195,7 @@ void load_inbound_message(void)
 				}
 			}
 		}
+		free(cmds);
 		if(len == 188) {
 			printf("\n\n**** ALL TESTS PASSED ****\n");
 		}
@@ -1338,22 +1206,22 @@ void load_inbound_message(void)
 			print_hex(G_session_key5, 16);
 
 			// tags session key
-			G_tags_session_key5[0] = get_data_memory_byte_raw(0x284);
-			G_tags_session_key5[1] = get_data_memory_byte_raw(0x285);
-			G_tags_session_key5[2] = get_data_memory_byte_raw(0x286);
-			G_tags_session_key5[3] = get_data_memory_byte_raw(0x287);
-			G_tags_session_key5[4] = get_data_memory_byte_raw(0x288);
-			G_tags_session_key5[5] = get_data_memory_byte_raw(0x289);	
-			G_tags_session_key5[6] = get_data_memory_byte_raw(0x28a);
-			G_tags_session_key5[7] = get_data_memory_byte_raw(0x28b);
-			G_tags_session_key5[8] = get_data_memory_byte_raw(0x28c);
-			G_tags_session_key5[9] = get_data_memory_byte_raw(0x28d);
-			G_tags_session_key5[10] = get_data_memory_byte_raw(0x28e);
-			G_tags_session_key5[11] = get_data_memory_byte_raw(0x28f);
-			G_tags_session_key5[12] = get_data_memory_byte_raw(0x290);
-			G_tags_session_key5[13] = get_data_memory_byte_raw(0x291);
-			G_tags_session_key5[14] = get_data_memory_byte_raw(0x292);
-			G_tags_session_key5[15] = get_data_memory_byte_raw(0x293);
+			G_tags_session_key5[0] = get_data_memory_byte_raw(m, 0x284);
+			G_tags_session_key5[1] = get_data_memory_byte_raw(m, 0x285);
+			G_tags_session_key5[2] = get_data_memory_byte_raw(m, 0x286);
+			G_tags_session_key5[3] = get_data_memory_byte_raw(m, 0x287);
+			G_tags_session_key5[4] = get_data_memory_byte_raw(m, 0x288);
+			G_tags_session_key5[5] = get_data_memory_byte_raw(m, 0x289);	
+			G_tags_session_key5[6] = get_data_memory_byte_raw(m, 0x28a);
+			G_tags_session_key5[7] = get_data_memory_byte_raw(m, 0x28b);
+			G_tags_session_key5[8] = get_data_memory_byte_raw(m, 0x28c);
+			G_tags_session_key5[9] = get_data_memory_byte_raw(m, 0x28d);
+			G_tags_session_key5[10] = get_data_memory_byte_raw(m, 0x28e);
+			G_tags_session_key5[11] = get_data_memory_byte_raw(m, 0x28f);
+			G_tags_session_key5[12] = get_data_memory_byte_raw(m, 0x290);
+			G_tags_session_key5[13] = get_data_memory_byte_raw(m, 0x291);
+			G_tags_session_key5[14] = get_data_memory_byte_raw(m, 0x292);
+			G_tags_session_key5[15] = get_data_memory_byte_raw(m, 0x293);
 
 			print_txt("tags session key=");
 			print_hex(G_tags_session_key5, 16);
@@ -1361,26 +1229,26 @@ void load_inbound_message(void)
 			len = 14;
 
 			for(x=0xfa; x < 0x1fd; x++) {
-				prog_memory[x] = 0x00;
+				put_memory_byte(m->prog_memory, x, 0x00);
 			}
 
-			prog_memory[0xfa] = CMD_WRITE | JET_CMD_BIT7 | JET_CMD_BIT6;	// DrvCmdByte
-			prog_memory[0xfc] = 0x00;						// DrvPacketLength1 length=0
-			prog_memory[0xfd] = len+4;						// DrvPacketLength0 length=8
-			prog_memory[0xfe] = 0x00;						// packet 
-			prog_memory[0xff] = 0x01;
-			prog_memory[0x100] = 0x00;
-			prog_memory[0x101] = 0x00;
-			prog_memory[0x102] = 0x00;
-			prog_memory[0x103] = 0xa3;
-			prog_memory[0x104] = 0x44;
-			prog_memory[0x105] = 0x6e;
-			prog_memory[0x106] = 0x2f;
-			prog_memory[0x107] = 0x09;
-			prog_memory[0x108] = 0x61;
-			prog_memory[0x109] = 0x51;
-			prog_memory[0x10a] = 0xdd;
-			prog_memory[0x10b] = 0x33;
+			put_memory_byte(m->prog_memory, 0xfa, CMD_WRITE | JET_CMD_BIT7 | JET_CMD_BIT6);	// DrvCmdByte
+			put_memory_byte(m->prog_memory, 0xfc, 0x00);						// DrvPacketLength1 length=0
+			put_memory_byte(m->prog_memory, 0xfd, len+4);						// DrvPacketLength0 length=8
+			put_memory_byte(m->prog_memory, 0xfe, 0x00);						// packet 
+			put_memory_byte(m->prog_memory, 0xff, 0x01);
+			put_memory_byte(m->prog_memory, 0x100, 0x00);
+			put_memory_byte(m->prog_memory, 0x101, 0x00);
+			put_memory_byte(m->prog_memory, 0x102, 0x00);
+			put_memory_byte(m->prog_memory, 0x103, 0xa3);
+			put_memory_byte(m->prog_memory, 0x104, 0x44);
+			put_memory_byte(m->prog_memory, 0x105, 0x6e);
+			put_memory_byte(m->prog_memory, 0x106, 0x2f);
+			put_memory_byte(m->prog_memory, 0x107, 0x09);
+			put_memory_byte(m->prog_memory, 0x108, 0x61);
+			put_memory_byte(m->prog_memory, 0x109, 0x51);
+			put_memory_byte(m->prog_memory, 0x10a, 0xdd);
+			put_memory_byte(m->prog_memory, 0x10b, 0x33);
 
 			// generate MAC on this packet
 			mymemset(txbuf, 0, 256);
@@ -1404,10 +1272,10 @@ void load_inbound_message(void)
 
 			// append the calculated MAC onto the packet being sent
 			for(x=0; x<4; x++) {
-				prog_memory[0xfe+len+x] = inbound_MAC[x];
+				put_memory_byte(m->prog_memory, 0xfe+len+x, inbound_MAC[x]);
 			}
 
-			if(!send_command()) {
+			if(!send_command(m)) {
 				printf("Send command failed.\n");
 				break;
 
@@ -1415,7 +1283,7 @@ void load_inbound_message(void)
 
 				// get chips MAC
 				for(x=0; x<4; x++) {
-					chips_mac[x] = get_data_memory_byte_raw(0x000000fe+x);
+					chips_mac[x] = get_data_memory_byte_raw(m, 0x000000fe+x);
 				}
 
 				command_sequence_number++;
@@ -1447,20 +1315,50 @@ void load_inbound_message(void)
 			}
 		break;
 
+	case 'k':
+		if(m->fork_base == NULL) {
+			m->fork_base = new_machine();
+			if(m->fork_base == NULL) {
+				printf("Not enough memory\n");
+				break;
+			}
+		}
+		fork_machine(m->fork_base, m);
+
+		// the host side of the session goes with it
+		fork_command_sequence_number = command_sequence_number;
+		mymemcpy(fork_session_key5, G_session_key5, 16);
+
+		printf("State kept\n");
+		break;
+
+	case 'f':
+		if(m->fork_base == NULL) {
+			printf("No state kept yet\n");
+			break;
+		}
+		fork_machine(m, m->fork_base);
+
+		command_sequence_number = fork_command_sequence_number;
+		mymemcpy(G_session_key5, fork_session_key5, 16);
+
+		printf("Forked from the kept state\n");
+		break;
+
 	case 's':
-		prog_memory[0xfa] = CMD_ECHO;	// DrvCmdByte cmd=20
-		prog_memory[0xfc] = 0x00;		// DrvPacketLength1 length=0
-		prog_memory[0xfd] = 0x08;		// DrvPacketLength0 length=8
-		prog_memory[0xfe] = 0x64;		// packet deadbeef
-		prog_memory[0xff] = 0x65;
-		prog_memory[0x100] = 0x61;
-		prog_memory[0x101] = 0x64;
-		prog_memory[0x102] = 0x62;
-		prog_memory[0x103] = 0x65;
-		prog_memory[0x104] = 0x65;
-		prog_memory[0x105] = 0x66;
-		prog_memory[0x106] = 0x00;
-		if(!send_command()) {
+		put_memory_byte(m->prog_memory, 0xfa, CMD_ECHO);	// DrvCmdByte cmd=20
+		put_memory_byte(m->prog_memory, 0xfc, 0x00);		// DrvPacketLength1 length=0
+		put_memory_byte(m->prog_memory, 0xfd, 0x08);		// DrvPacketLength0 length=8
+		put_memory_byte(m->prog_memory, 0xfe, 0x64);		// packet deadbeef
+		put_memory_byte(m->prog_memory, 0xff, 0x65);
+		put_memory_byte(m->prog_memory, 0x100, 0x61);
+		put_memory_byte(m->prog_memory, 0x101, 0x64);
+		put_memory_byte(m->prog_memory, 0x102, 0x62);
+		put_memory_byte(m->prog_memory, 0x103, 0x65);
+		put_memory_byte(m->prog_memory, 0x104, 0x65);
+		put_memory_byte(m->prog_memory, 0x105, 0x66);
+		put_memory_byte(m->prog_memory, 0x106, 0x00);
+		if(!send_command(m)) {
 			printf("Send command failed.\n");
 		}
 		break;
@@ -1854,9 +1752,9 @@ void mac_test(void)
 //
 // this is easy to effect, simply clear the trigger variable
 //
-void application_specific_trace(void)
+void application_specific_trace(struct machine *m)
 {
-	run_log_triggered = 0;	// clear the trigger variable
+	m->run_log_triggered = 0;	// clear the trigger variable
 }
 
 //
@@ -1876,33 +1774,33 @@ void application_ui_help(void)
 // called by simulator command parser
 // returns 1 if we handled the command, 0 otherwise
 //
-int application_ui_parse(int c)
+int application_ui_parse(struct machine *m, int c)
 {
 	int handled = 0;
 
 	switch(c) {
 	case '!':
-		application_load_io_and_memory_initial_values();
+		application_load_io_and_memory_initial_values(m);
 		handled = 1;
 		break;
 	
 	case 'j':
-		tag_information();
+		tag_information(m);
 		handled = 1;
 		break;
 
 	case 'i':
-		load_inbound_message();
+		load_inbound_message(m);
 		handled = 1;
 		break;
 
 	case 'v':
-		display_do_loop_vars();
+		display_do_loop_vars(m);
 		handled = 1;
 		break;
 
 	case 'f':
-		application_specific_trace();	// logging to file will only occur after application
+		application_specific_trace(m);	// logging to file will only occur after application
 										// specific trigger condition is met
 		handled = 1;
 		break;
@@ -15,19 +15,22 @@
 //--------------------------------------------------------
 //
 void application_ui_help(void);
-int application_ui_parse(int c);
+int application_ui_parse(struct machine *m, int c);
 
 // for i/o emulation
-void application_reset(void);
-void application_load_io_and_memory_initial_values(void);
-int application_get_data_memory_byte(unsigned int address, unsigned char *data);
-int application_put_data_memory_byte(unsigned int address, unsigned char data);
+void application_reset(struct machine *m);
+void application_load_io_and_memory_initial_values(struct machine *m);
+int application_get_data_memory_byte(struct machine *m, unsigned int address, unsigned char *data);
+int application_put_data_memory_byte(struct machine *m, unsigned int address, unsigned char data);
 
-void application_triggers_and_breakpoints(void);
+// most addresses the two above may intercept
+#define MAX_APPLICATION_DEVICES		64
+
+int application_get_device_addresses(unsigned int *addresses, int max);
 
 // specifc application stuff (tag)
-void load_inbound_message(void);
-void tag_information(void);
+void load_inbound_message(struct machine *m);
+void tag_information(struct machine *m);
 
-void display_do_loop_vars(void);
+void display_do_loop_vars(struct machine *m);
 
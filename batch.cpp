@@ -0,0 +1,258 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - batch engine
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+// History:
+//
+//----------------------------------------------------------------------------
+//
+
+//
+// Runs a list of independent jobs (commands to the tag, mostly) on a pool of
+// worker threads. Every worker has its own machine and every job starts on a
+// fresh fork of the base machine, so a job sees exactly what it would have seen
+// run alone from the base state, in whatever order and on whatever worker it ends up.
+// The results go back into the job itself, the caller reads them in job order.
+//
+// Each worker starts with an even share of the jobs and works through it from
+// the front. A worker that runs out steals the back half of what somebody else
+// has left, so a few slow jobs don't leave the other cores sitting idle.
+//
+// When the base machine is profiling every worker profiles into its own, it
+// goes into the base once the batch is done, the host stats and the
+// instruction scoreboard the same way.
+//
+
+#include "stdafx.h"
+#include <stdio.h>
+#include <memory.h>
+#include <string.h>
+#include <stdlib.h>
+#include <windows.h>
+
+#include "st7xcpu.h"
+
+#include "machine.h"
+
+#include "batch.h"
+#include "profile.h"
+#include "scoreboard.h"
+#include "stats.h"
+
+struct batch;
+
+struct batch_worker {
+	struct batch *batch;
+	struct machine *m;
+	CRITICAL_SECTION lock;		// next and end, thieves take it too
+	int next;					// next job to run
+	int end;					// one past the last job we have
+	HANDLE thread;
+};
+
+struct batch {
+	struct machine *base;
+	char *jobs;
+	unsigned int job_size;
+	batch_function function;
+	int num_workers;
+	struct batch_worker workers[MAX_BATCH_WORKERS];
+};
+
+//
+// how many workers to use by default, one per processor
+//
+int batch_workers(void)
+{
+	SYSTEM_INFO info;
+	int count;
+
+	GetSystemInfo(&info);
+	count = (int)info.dwNumberOfProcessors;
+	if(count < 1) {
+		count = 1;
+	}
+	if(count > MAX_BATCH_WORKERS) {
+		count = MAX_BATCH_WORKERS;
+	}
+	return(count);
+}
+
+//
+// take the back half of the jobs another worker has left
+// returns the first one, the rest become ours, -1 if everybody is done
+//
+int steal_jobs(struct batch_worker *worker)
+{
+	struct batch *batch;
+	struct batch_worker *victim;
+	int x, count, first;
+
+	batch = worker->batch;
+
+	for(x = 1; x != batch->num_workers; x++) {
+		victim = &batch->workers[((worker - batch->workers) + x) % batch->num_workers];
+
+		EnterCriticalSection(&victim->lock);
+		count = (victim->end - victim->next + 1) / 2;
+		first = victim->end - count;
+		victim->end = first;
+		LeaveCriticalSection(&victim->lock);
+
+		if(count) {
+			EnterCriticalSection(&worker->lock);
+			worker->next = first + 1;
+			worker->end = first + count;
+			LeaveCriticalSection(&worker->lock);
+			return(first);
+		}
+	}
+	return(-1);
+}
+
+//
+// next job for a worker, -1 if there are none left anywhere
+//
+int next_job(struct batch_worker *worker)
+{
+	int job;
+
+	job = -1;
+
+	EnterCriticalSection(&worker->lock);
+	if(worker->next != worker->end) {
+		job = worker->next++;
+	}
+	LeaveCriticalSection(&worker->lock);
+
+	if(job == -1) {
+		job = steal_jobs(worker);
+	}
+	return(job);
+}
+
+//
+// worker thread, runs jobs until there are none left
+//
+DWORD WINAPI batch_worker_thread(LPVOID parameter)
+{
+	struct batch_worker *worker;
+	struct batch *batch;
+	int job;
+
+	worker = (struct batch_worker *)parameter;
+	batch = worker->batch;
+
+	while((job = next_job(worker)) != -1) {
+		fork_machine(worker->m, batch->base);
+
+		// nobody is watching, so nothing to trace or step over and the run takes the fast loops
+		worker->m->quiet = 1;
+		worker->m->trace = 0;
+		worker->m->step_over = 0;
+		worker->m->break_on_calls = 0;
+		worker->m->enable_pre_instruction_register_display = 0;
+		worker->m->enable_post_instruction_register_display = 0;
+
+		batch->function(worker->m, batch->jobs + (job * batch->job_size));
+	}
+	return(0);
+}
+
+//
+// Run num_jobs jobs of job_size bytes each on num_workers threads (0 for one per processor)
+//
+// every job gets its own fork of base, base itself isn't touched but for its profile
+// returns the number of workers used, 0 if they couldn't be set up
+//
+int run_batch(struct machine *base, void *jobs, unsigned int job_size, int num_jobs, batch_function function, int num_workers)
+{
+	struct batch *batch;
+	struct batch_worker *worker;
+	int x, used;
+
+	if(num_jobs <= 0) {
+		return(0);
+	}
+
+	if(num_workers <= 0) {
+		num_workers = batch_workers();
+	}
+	if(num_workers > MAX_BATCH_WORKERS) {
+		num_workers = MAX_BATCH_WORKERS;
+	}
+	if(num_workers > num_jobs) {
+		num_workers = num_jobs;
+	}
+
+	batch = (struct batch *)calloc(1, sizeof(struct batch));
+	if(batch == NULL) {
+		return(0);
+	}
+
+	batch->base = base;
+	batch->jobs = (char *)jobs;
+	batch->job_size = job_size;
+	batch->function = function;
+
+	// everybody gets an even share to start with
+	for(x = 0; x != num_workers; x++) {
+		worker = &batch->workers[x];
+		worker->batch = batch;
+		worker->next = (num_jobs * x) / num_workers;
+		worker->end = (num_jobs * (x + 1)) / num_workers;
+		worker->m = new_machine();
+		if(worker->m == NULL) {
+			break;
+		}
+		if(base->profile_mask && !start_profile(worker->m)) {
+			free_machine(worker->m);
+			break;
+		}
+		InitializeCriticalSection(&worker->lock);
+	}
+	used = x;
+
+	if(used == num_workers) {
+		batch->num_workers = num_workers;
+
+		for(x = 0; x != num_workers; x++) {
+			batch->workers[x].thread = CreateThread(NULL, 0, batch_worker_thread, &batch->workers[x], 0, NULL);
+		}
+
+		// one that didn't start leaves its jobs to be stolen by the others
+		for(x = 0; x != num_workers; x++) {
+			if(batch->workers[x].thread == NULL) {
+				batch_worker_thread(&batch->workers[x]);
+			}
+		}
+
+		for(x = 0; x != num_workers; x++) {
+			if(batch->workers[x].thread != NULL) {
+				WaitForSingleObject(batch->workers[x].thread, INFINITE);
+				CloseHandle(batch->workers[x].thread);
+			}
+		}
+	} else {
+		printf("*** Not enough memory for %d batch workers\n", num_workers);
+		num_workers = 0;
+	}
+
+	for(x = 0; x != used; x++) {
+		DeleteCriticalSection(&batch->workers[x].lock);
+		if(num_workers) {
+			add_profile(base, batch->workers[x].m);
+			add_host_stats(base, batch->workers[x].m);
+			add_scoreboard(base, batch->workers[x].m);
+		}
+		free_machine(batch->workers[x].m);
+	}
+	free(batch);
+
+	return(num_workers);
+}
@@ -0,0 +1,19 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - batch engine header
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+//----------------------------------------------------------------------------
+//
+
+#define MAX_BATCH_WORKERS		64
+
+// runs one job on a worker's fork of the base machine
+typedef void (*batch_function)(struct machine *m, void *job);
+
+int batch_workers(void);
+int run_batch(struct machine *base, void *jobs, unsigned int job_size, int num_jobs, batch_function function, int num_workers);
@@ -0,0 +1,527 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - breakpoints
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+// History:
+//
+//----------------------------------------------------------------------------
+//
+
+//
+// Instruction breakpoints are a bitmap with a bit for every address code can
+// run from, page 00 and page 10. There is no limit on how many there are and
+// the run loop checks the pc against all of them with one test.
+//
+// A breakpoint file has an address (hex) per line to set, an address with a -
+// in front of it to clear, # starts a comment. save_ins_breakpoints() writes
+// one that sets exactly the breakpoints there are now.
+//
+// An instruction breakpoint can have a condition (see condition.cpp), it then
+// only breaks when the condition holds. The few that have one are kept in a
+// list next to the bitmap, the run loop only looks there once the bit of the
+// pc is set. In a breakpoint file the condition follows the address.
+//
+// Data breakpoints watch a range of addresses for reads, writes or both, and
+// can be narrowed down to the value read or written (DBRK_TYPE_VAL), the value
+// the byte held before (DBRK_TYPE_SUB), writes that change it
+// (DBRK_TYPE_CHANGE), to a condition and to the n'th hit (BRK_TYPE_COUNT). There can be any
+// number of them. The memory bus only calls check_data_breakpoints() for the
+// pages they cover (see update_watched_pages()), everything else doesn't pay
+// for them at all.
+//
+// The call breakpoint breaks on calls, all of them or only the ones to a set
+// of targets, from a range of callers, that go a number of calls deep
+// (call_depth counts from where it was set) and from the n'th one on.
+//
+
+#include "stdafx.h"
+#include <stdio.h>
+#include <memory.h>
+#include <string.h>
+#include <stdlib.h>
+#include <windows.h>
+
+#include "st7xcpu.h"
+
+#include "breakpoints.h"
+#include "condition.h"
+
+//
+// set a breakpoint at address
+// returns 0 if address isn't in page 00 or page 10
+//
+int set_ins_breakpoint(struct machine *m, unsigned int address)
+{
+	unsigned int index;
+
+	if(!INS_BREAKPOINT_ADDRESS(address)) {
+		return(0);
+	}
+
+	if(!ins_breakpoint(m, address)) {
+		index = INS_BREAKPOINT_INDEX(address);
+		m->ins_breakpoint_map[index >> 5] |= (1U << (index & 31));
+		m->num_ins_breakpoints++;
+		m->ins_breakpoints_changed = 1;
+	}
+	return(1);
+}
+
+//
+// take the condition off the breakpoint at address, if it has one
+//
+void remove_ins_condition(struct machine *m, unsigned int address)
+{
+	int x;
+
+	for(x = 0; x != m->num_ins_conditions; x++) {
+		if(m->ins_conditions[x].address == address) {
+			m->ins_conditions[x] = m->ins_conditions[--m->num_ins_conditions];
+			return;
+		}
+	}
+}
+
+//
+// clear the breakpoint at address
+// returns 0 if there wasn't one
+//
+int clear_ins_breakpoint(struct machine *m, unsigned int address)
+{
+	unsigned int index;
+
+	if(!INS_BREAKPOINT_ADDRESS(address) || !ins_breakpoint(m, address)) {
+		return(0);
+	}
+
+	index = INS_BREAKPOINT_INDEX(address);
+	m->ins_breakpoint_map[index >> 5] &= ~(1U << (index & 31));
+	m->num_ins_breakpoints--;
+	m->ins_breakpoints_changed = 1;
+
+	remove_ins_condition(m, address);
+	return(1);
+}
+
+//
+// clear them all
+//
+void clear_all_ins_breakpoints(struct machine *m)
+{
+	if(m->num_ins_breakpoints) {
+		memset(m->ins_breakpoint_map, 0, INS_BREAKPOINT_WORDS * sizeof(unsigned int));
+		m->num_ins_breakpoints = 0;
+		m->ins_breakpoints_changed = 1;
+	}
+	m->num_ins_conditions = 0;
+}
+
+//
+// first address at or after address with its bit set in a map laid out like
+// the instruction breakpoints (page 00 comes before page 10)
+// returns NO_INS_BREAKPOINT if there are none
+//
+unsigned int next_map_address(unsigned int *map, unsigned int address)
+{
+	unsigned int index, word, bits;
+
+	if(address >= 0x00110000) {
+		return(NO_INS_BREAKPOINT);
+	}
+	if(!INS_BREAKPOINT_ADDRESS(address)) {
+		// in between the pages, next one is page 10
+		address = 0x00100000;
+	}
+
+	index = INS_BREAKPOINT_INDEX(address);
+	word = index >> 5;
+	bits = map[word] & ~((1U << (index & 31)) - 1);
+
+	while(1) {
+		if(bits) {
+			index = word << 5;
+			while(!(bits & 1)) {
+				bits >>= 1;
+				index++;
+			}
+			return(((index & 0x00010000) << 4) | (index & 0x0000ffff));
+		}
+		if(++word == INS_BREAKPOINT_WORDS) {
+			return(NO_INS_BREAKPOINT);
+		}
+		bits = map[word];
+	}
+}
+
+//
+// first breakpoint at or after address
+// returns NO_INS_BREAKPOINT if there are none
+//
+unsigned int next_ins_breakpoint(struct machine *m, unsigned int address)
+{
+	return(next_map_address(m->ins_breakpoint_map, address));
+}
+
+//
+// give dst the breakpoints of src (fork_machine), dst->ins_conditions has to
+// be its own already
+//
+void copy_ins_breakpoints(struct machine *dst, struct machine *src)
+{
+	struct ins_condition *conditions;
+
+	if(src->num_ins_conditions > dst->max_ins_conditions) {
+		conditions = (struct ins_condition *)realloc(dst->ins_conditions, src->max_ins_conditions * sizeof(struct ins_condition));
+		if(conditions == NULL) {
+			printf("*** Out of memory for breakpoint conditions\n");
+			exit(1);
+		}
+		dst->ins_conditions = conditions;
+		dst->max_ins_conditions = src->max_ins_conditions;
+	}
+
+	if(src->num_ins_conditions) {
+		memcpy(dst->ins_conditions, src->ins_conditions, src->num_ins_conditions * sizeof(struct ins_condition));
+	}
+	dst->num_ins_conditions = src->num_ins_conditions;
+
+	if(!dst->num_ins_breakpoints && !src->num_ins_breakpoints) {
+		return;
+	}
+	if(memcmp(dst->ins_breakpoint_map, src->ins_breakpoint_map, INS_BREAKPOINT_WORDS * sizeof(unsigned int))) {
+		memcpy(dst->ins_breakpoint_map, src->ins_breakpoint_map, INS_BREAKPOINT_WORDS * sizeof(unsigned int));
+		dst->ins_breakpoints_changed = 1;
+	}
+	dst->num_ins_breakpoints = src->num_ins_breakpoints;
+}
+
+//
+// set the breakpoint at address and have it break only when condition holds,
+// no condition (length 0) and it breaks every time
+// returns 0 if address isn't in page 00 or page 10 or there isn't enough memory
+//
+int set_ins_breakpoint_condition(struct machine *m, unsigned int address, struct condition *condition)
+{
+	struct ins_condition *conditions;
+	int max;
+
+	if(!set_ins_breakpoint(m, address)) {
+		return(0);
+	}
+
+	remove_ins_condition(m, address);
+	if(!condition->length) {
+		return(1);
+	}
+
+	if(m->num_ins_conditions == m->max_ins_conditions) {
+		max = m->max_ins_conditions ? (m->max_ins_conditions * 2) : 8;
+		conditions = (struct ins_condition *)realloc(m->ins_conditions, max * sizeof(struct ins_condition));
+		if(conditions == NULL) {
+			return(0);
+		}
+		m->ins_conditions = conditions;
+		m->max_ins_conditions = max;
+	}
+
+	m->ins_conditions[m->num_ins_conditions].address = address;
+	m->ins_conditions[m->num_ins_conditions].condition = *condition;
+	m->num_ins_conditions++;
+	return(1);
+}
+
+//
+// condition of the breakpoint at address, NULL if it breaks every time
+//
+struct condition *ins_breakpoint_condition(struct machine *m, unsigned int address)
+{
+	int x;
+
+	for(x = 0; x != m->num_ins_conditions; x++) {
+		if(m->ins_conditions[x].address == address) {
+			return(&m->ins_conditions[x].condition);
+		}
+	}
+	return(NULL);
+}
+
+//
+// the pc is on a breakpoint, does it break
+//
+int ins_breakpoint_hit(struct machine *m, unsigned int address)
+{
+	struct condition *condition;
+
+	if(!m->num_ins_conditions) {
+		return(1);
+	}
+
+	condition = ins_breakpoint_condition(m, address);
+	return((condition == NULL) || evaluate_condition(m, condition, 0, 0));
+}
+
+//
+// set and clear breakpoints from a breakpoint file
+//
+void load_ins_breakpoints(struct machine *m, char *filename)
+{
+	char line[128], *p;
+	FILE *fp;
+	struct condition condition;
+	unsigned int address;
+	int set, cleared, offset;
+
+	if((fp = fopen(filename, "r")) == (FILE *)NULL) {
+		printf("Can't open %s!\n", filename);
+		return;
+	}
+
+	set = 0;
+	cleared = 0;
+	while(fgets(line, sizeof(line), fp) != NULL) {
+		p = line;
+		while((*p == ' ') || (*p == '\t')) {
+			p++;
+		}
+		if((*p == '#') || (*p == '\r') || (*p == '\n') || (*p == '\0')) {
+			continue;
+		}
+
+		if(*p == '-') {
+			if(sscanf(p + 1, "%x", &address) == 1) {
+				if(clear_ins_breakpoint(m, address)) {
+					cleared++;
+				}
+				continue;
+			}
+		} else if(sscanf(p, "%x%n", &address, &offset) == 1) {
+			// the rest of the line is its condition
+			if(compile_condition(p + offset, &condition) && set_ins_breakpoint_condition(m, address, &condition)) {
+				set++;
+				continue;
+			}
+		}
+		printf("Bad breakpoint line: %s", p);
+	}
+	fclose(fp);
+
+	printf("%d set, %d cleared, %d breakpoints\n", set, cleared, m->num_ins_breakpoints);
+}
+
+//
+// write the breakpoints to a breakpoint file
+//
+void save_ins_breakpoints(struct machine *m, char *filename)
+{
+	FILE *fp;
+	struct condition *condition;
+	unsigned int address;
+
+	if((fp = fopen(filename, "w")) == (FILE *)NULL) {
+		printf("Can't open %s!\n", filename);
+		return;
+	}
+
+	for(address = next_ins_breakpoint(m, 0); address != NO_INS_BREAKPOINT; address = next_ins_breakpoint(m, address + 1)) {
+		condition = ins_breakpoint_condition(m, address);
+		if(condition != NULL) {
+			fprintf(fp, "%08x %s\n", address, condition->text);
+		} else {
+			fprintf(fp, "%08x\n", address);
+		}
+	}
+	fclose(fp);
+
+	printf("%d breakpoints written to %s\n", m->num_ins_breakpoints, filename);
+}
+
+//
+// add a data breakpoint, returns its number (-1 if there isn't enough memory)
+//
+int add_data_breakpoint(struct machine *m, struct breakpoint *breakpoint)
+{
+	struct breakpoint *breakpoints;
+	int bn, max;
+
+	// a free slot first
+	for(bn = 0; bn != m->num_data_breakpoints; bn++) {
+		if(!m->data_breakpoints[bn].used) {
+			break;
+		}
+	}
+
+	if(bn == m->max_data_breakpoints) {
+		max = m->max_data_breakpoints ? (m->max_data_breakpoints * 2) : 8;
+		breakpoints = (struct breakpoint *)realloc(m->data_breakpoints, max * sizeof(struct breakpoint));
+		if(breakpoints == NULL) {
+			return(-1);
+		}
+		m->data_breakpoints = breakpoints;
+		m->max_data_breakpoints = max;
+	}
+	if(bn == m->num_data_breakpoints) {
+		m->num_data_breakpoints++;
+	}
+
+	m->data_breakpoints[bn] = *breakpoint;
+	if(m->data_breakpoints[bn].end_address < m->data_breakpoints[bn].address) {
+		m->data_breakpoints[bn].end_address = m->data_breakpoints[bn].address;
+	}
+	m->data_breakpoints[bn].used = 1;
+	m->data_breakpoints[bn].enable = 1;
+	m->data_breakpoints[bn].count = 0;
+	m->data_breakpoints[bn].triggered = 0;
+
+	return(bn);
+}
+
+//
+// delete a data breakpoint, returns 0 if there is no such breakpoint
+//
+int delete_data_breakpoint(struct machine *m, int number)
+{
+	if((number < 0) || (number >= m->num_data_breakpoints) || !m->data_breakpoints[number].used) {
+		return(0);
+	}
+
+	memset(&m->data_breakpoints[number], 0, sizeof(struct breakpoint));
+
+	// the slots at the end are given back
+	while(m->num_data_breakpoints && !m->data_breakpoints[m->num_data_breakpoints - 1].used) {
+		m->num_data_breakpoints--;
+	}
+
+	if(m->data_breakpoint_triggered_number == number) {
+		m->data_breakpoint_triggered_number = -1;
+	}
+	return(1);
+}
+
+//
+// delete them all
+//
+void clear_all_data_breakpoints(struct machine *m)
+{
+	m->num_data_breakpoints = 0;
+	m->data_breakpoint_triggered_number = -1;
+}
+
+//
+// a watched page was accessed, see if a data breakpoint wants to stop on it
+//
+// access is DBRK_TYPE_READ or DBRK_TYPE_WRITE, old_data is what the byte held
+// before and data what was read or written
+//
+void check_data_breakpoints(struct machine *m, unsigned int address, int access, unsigned char old_data, unsigned char data)
+{
+	struct breakpoint *breakpoint;
+	int x;
+
+	for(x = 0; x != m->num_data_breakpoints; x++) {
+		breakpoint = &m->data_breakpoints[x];
+
+		if(!breakpoint->enable || !(breakpoint->type & access) || (address < breakpoint->address) || (address > breakpoint->end_address)) {
+			continue;
+		}
+		if((breakpoint->type & DBRK_TYPE_VAL) && ((data & breakpoint->mask) != breakpoint->value)) {
+			continue;
+		}
+		if((breakpoint->type & DBRK_TYPE_SUB) && ((old_data & breakpoint->old_mask) != breakpoint->old_value)) {
+			continue;
+		}
+		if((breakpoint->type & DBRK_TYPE_CHANGE) && (old_data == data)) {
+			continue;
+		}
+		if(breakpoint->condition.length && !evaluate_condition(m, &breakpoint->condition, data, old_data)) {
+			continue;
+		}
+
+		breakpoint->count++;
+		if((breakpoint->type & BRK_TYPE_COUNT) && (breakpoint->count < breakpoint->terminal_count)) {
+			continue;
+		}
+
+		// Break triggered
+		breakpoint->triggered = 1;
+		breakpoint->hit_address = address;
+		breakpoint->hit_old_data = old_data;
+		breakpoint->hit_data = data;
+		m->data_breakpoint_triggered_number = x;
+	}
+}
+
+//
+// give dst the data breakpoints of src (fork_machine), dst->data_breakpoints
+// has to be its own already
+//
+void copy_data_breakpoints(struct machine *dst, struct machine *src)
+{
+	struct breakpoint *breakpoints;
+
+	if(src->num_data_breakpoints > dst->max_data_breakpoints) {
+		breakpoints = (struct breakpoint *)realloc(dst->data_breakpoints, src->max_data_breakpoints * sizeof(struct breakpoint));
+		if(breakpoints == NULL) {
+			printf("*** Out of memory for data breakpoints\n");
+			exit(1);
+		}
+		dst->data_breakpoints = breakpoints;
+		dst->max_data_breakpoints = src->max_data_breakpoints;
+	}
+
+	if(src->num_data_breakpoints) {
+		memcpy(dst->data_breakpoints, src->data_breakpoints, src->num_data_breakpoints * sizeof(struct breakpoint));
+	}
+	dst->num_data_breakpoints = src->num_data_breakpoints;
+}
+
+//
+// break on calls like breakpoint, the depth counts from here
+//
+void set_call_breakpoint(struct machine *m, struct call_breakpoint *breakpoint)
+{
+	m->call_breakpoint = *breakpoint;
+	m->call_breakpoint.count = 0;
+	m->call_depth = 0;
+	m->break_on_calls = 1;
+}
+
+//
+// a call was just executed, does the call breakpoint break on it
+//
+int call_breakpoint_hit(struct machine *m)
+{
+	struct call_breakpoint *breakpoint;
+	int x;
+
+	breakpoint = &m->call_breakpoint;
+
+	if(breakpoint->type & CBRK_TYPE_CALLER) {
+		if((m->previous_register_pc < breakpoint->caller_start) || (m->previous_register_pc > breakpoint->caller_end)) {
+			return(0);
+		}
+	}
+	if(breakpoint->type & CBRK_TYPE_DEPTH) {
+		if((m->call_depth < breakpoint->min_depth) || (m->call_depth > breakpoint->max_depth)) {
+			return(0);
+		}
+	}
+	if(breakpoint->type & CBRK_TYPE_TARGET) {
+		for(x = 0; (x != breakpoint->num_targets) && (breakpoint->targets[x] != m->register_pc); x++) {
+			;
+		}
+		if(x == breakpoint->num_targets) {
+			return(0);
+		}
+	}
+
+	breakpoint->count++;
+	if((breakpoint->type & BRK_TYPE_COUNT) && (breakpoint->count < breakpoint->terminal_count)) {
+		return(0);
+	}
+	return(1);
+}
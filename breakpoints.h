@@ -27,19 +27,12 @@
 //#include "utils.h"
 //#include "debug.h"
 
+#include "machine.h"
+
 #include "processor_externs.h"
 
 #include "application.h"
 
-//
-//---------------------------------
-// Simulator configuration
-//---------------------------------
-//
-
-#define NUM_INS_BREAKPOINTS 8
-#define NUM_DATA_BREAKPOINTS 8
-
 //
 //--------------------------------------------------------
 // simulator internals - breakpoint mechanism definitions
@@ -53,26 +46,74 @@
 #define STOP_DATA_BREAK				4
 #define STOP_CALL_INS_BREAK			5
 #define STOP_APPLICATION_BREAK		6
+#define STOP_STEP_OVER				7		// a single step over a call came back
+
+// in_function_call_pc when not stepping over a call, no pc is ever there
+#define NO_STEP_OVER_PC				0xffffffff
 
 // Breakpoint type flags
 #define DBRK_TYPE_READ		0x01
 #define DBRK_TYPE_WRITE		0x02
 #define DBRK_TYPE_RW		(DBRK_TYPE_READ|DBRK_TYPE_WRITE)
 
-#define DBRK_TYPE_VAL		0x10
-#define DBRK_TYPE_SUB		0x20
+#define DBRK_TYPE_VAL		0x10		// the value read or written has to match value under mask
+#define DBRK_TYPE_SUB		0x20		// the value the byte held before has to match old_value under old_mask
+#define DBRK_TYPE_CHANGE	0x40		// only writes that change the byte
 
 #define IBRK_TYPE			0x04
-#define BRK_TYPE_COUNT		0x08
-
-// breakpoint struct
-struct breakpoint {
-	int used;
-	int enable;
-	int type;
-	int terminal_count;
-	int count;
-	int triggered;
-	unsigned int value;
-	unsigned int address;
-};
+#define BRK_TYPE_COUNT		0x08		// no break before the terminal_count'th hit
+
+#define CBRK_TYPE_TARGET	0x100		// calls to one of targets
+#define CBRK_TYPE_CALLER	0x200		// calls from caller_start to caller_end
+#define CBRK_TYPE_DEPTH		0x400		// calls that go min_depth to max_depth deep
+
+
+//
+// Instruction breakpoints, one bit for every address of page 00 and page 10,
+// so the run loop decides with a single test. Addresses anywhere else share
+// those bits and are only told apart once one of them is set.
+//
+#define INS_BREAKPOINT_ADDRESS(address)		(!((address) & 0xffef0000))
+#define INS_BREAKPOINT_INDEX(address)		((((address) >> 4) & 0x00010000) | ((address) & 0x0000ffff))
+#define INS_BREAKPOINT_WORDS				(0x00020000 / 32)
+
+// next_ins_breakpoint() when there are no more
+#define NO_INS_BREAKPOINT					0xffffffff
+
+//
+// is there a breakpoint at address
+//
+inline int ins_breakpoint(struct machine *m, unsigned int address)
+{
+	unsigned int index;
+
+	index = INS_BREAKPOINT_INDEX(address);
+	return((m->ins_breakpoint_map[index >> 5] & (1U << (index & 31))) && INS_BREAKPOINT_ADDRESS(address));
+}
+
+int set_ins_breakpoint(struct machine *m, unsigned int address);
+int clear_ins_breakpoint(struct machine *m, unsigned int address);
+void clear_all_ins_breakpoints(struct machine *m);
+unsigned int next_map_address(unsigned int *map, unsigned int address);
+unsigned int next_ins_breakpoint(struct machine *m, unsigned int address);
+void copy_ins_breakpoints(struct machine *dst, struct machine *src);
+int set_ins_breakpoint_condition(struct machine *m, unsigned int address, struct condition *condition);
+struct condition *ins_breakpoint_condition(struct machine *m, unsigned int address);
+int ins_breakpoint_hit(struct machine *m, unsigned int address);
+void load_ins_breakpoints(struct machine *m, char *filename);
+void save_ins_breakpoints(struct machine *m, char *filename);
+
+//
+// Data breakpoints (watchpoints), any number of them, each on a range of addresses
+//
+int add_data_breakpoint(struct machine *m, struct breakpoint *breakpoint);
+int delete_data_breakpoint(struct machine *m, int number);
+void clear_all_data_breakpoints(struct machine *m);
+void check_data_breakpoints(struct machine *m, unsigned int address, int access, unsigned char old_data, unsigned char data);
+void copy_data_breakpoints(struct machine *dst, struct machine *src);
+
+//
+// The call breakpoint (break_on_calls)
+//
+void set_call_breakpoint(struct machine *m, struct call_breakpoint *breakpoint);
+int call_breakpoint_hit(struct machine *m);
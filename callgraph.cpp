@@ -0,0 +1,529 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - call graph profiler
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+// History:
+//
+//----------------------------------------------------------------------------
+//
+
+//
+// Keeps a shadow of the call stack from the calls and returns the
+// instruction handlers report (call_event(), CALL, CALLR, CALLF, RET, RETF,
+// TRAP and IRET) and adds up, in simulated cycles:
+//
+//	per function	cycles spent in it (exclusive) and in it and what it
+//					called (inclusive, counted once when it recurses)
+//	per call site	calls and inclusive cycles, caller -> callee
+//
+// A function is the address a call went to. What ran in between two events
+// is charged to the function on top of the shadow stack.
+//
+// Every frame remembers the sp from before its call, a return only pops the
+// frame it gets back to. A return to a lower sp than that (firmware that
+// pushes an address and returns to jump there) pops nothing, a return to a
+// higher sp closes the frames that were left without returning first.
+//
+// save_callgrind() writes it in callgrind format, for KCachegrind, with the
+// names from the profile symbols (see profile.cpp).
+//
+// Batch workers don't build one. When the machine forks from somewhere else
+// its shadow stack ends where it was and starts over where it is now.
+//
+
+#include "stdafx.h"
+#include <stdio.h>
+#include <memory.h>
+#include <string.h>
+#include <stdlib.h>
+#include <windows.h>
+
+#include "st7xcpu.h"
+
+#include "machine.h"
+
+#include "calls.h"
+#include "callgraph.h"
+#include "profile.h"
+
+// hash tables, twice the size of what goes in them
+#define CALLGRAPH_FUNCTION_HASH		(MAX_CALLGRAPH_FUNCTIONS * 2)
+#define CALLGRAPH_EDGE_HASH			(MAX_CALLGRAPH_EDGES * 2)
+
+// the shadow stack's own frame at the bottom, it never returns
+#define CALLGRAPH_ROOT_SP			0xffffffff
+
+struct callgraph_function {
+	unsigned int address;
+	unsigned int calls;
+	unsigned long long exclusive_cycles;
+	unsigned long long inclusive_cycles;
+	int active;						// frames of it on the shadow stack
+};
+
+// a call site, caller -> callee
+struct callgraph_edge {
+	int caller;
+	int callee;
+	unsigned int site;				// pc of the call
+	unsigned int calls;
+	unsigned long long inclusive_cycles;
+};
+
+struct callgraph_frame {
+	int function;
+	int edge;						// -1 for the root
+	unsigned int return_sp;			// sp before the call, where its return gets back to
+	unsigned long long entry_cycles;
+};
+
+struct callgraph {
+	struct callgraph_function functions[MAX_CALLGRAPH_FUNCTIONS];
+	int num_functions;
+	int function_hash[CALLGRAPH_FUNCTION_HASH];		// index + 1, 0 is empty
+
+	struct callgraph_edge edges[MAX_CALLGRAPH_EDGES];
+	int num_edges;
+	int edge_hash[CALLGRAPH_EDGE_HASH];
+
+	struct callgraph_frame frames[MAX_CALLGRAPH_DEPTH];
+	int depth;
+	int lost_depth;					// calls that aren't on it, too deep or no room
+	unsigned int lost_calls;		// calls with no room in the tables
+
+	unsigned long long last_cycles;	// clock at the last event
+	unsigned long long total_cycles;
+};
+
+//
+// the function at address, made if it isn't there yet
+// returns -1 if there is no room for it
+//
+int callgraph_function(struct callgraph *graph, unsigned int address)
+{
+	struct callgraph_function *function;
+	unsigned int slot;
+
+	for(slot = (address * 2654435761U) & (CALLGRAPH_FUNCTION_HASH - 1); graph->function_hash[slot]; slot = (slot + 1) & (CALLGRAPH_FUNCTION_HASH - 1)) {
+		if(graph->functions[graph->function_hash[slot] - 1].address == address) {
+			return(graph->function_hash[slot] - 1);
+		}
+	}
+
+	if(graph->num_functions == MAX_CALLGRAPH_FUNCTIONS) {
+		return(-1);
+	}
+
+	function = &graph->functions[graph->num_functions];
+	memset(function, 0, sizeof(struct callgraph_function));
+	function->address = address;
+	graph->function_hash[slot] = ++graph->num_functions;
+	return(graph->num_functions - 1);
+}
+
+//
+// the call site, made if it isn't there yet
+// returns -1 if there is no room for it
+//
+int callgraph_edge(struct callgraph *graph, int caller, unsigned int site, int callee)
+{
+	struct callgraph_edge *edge;
+	unsigned int slot;
+
+	slot = ((site * 2654435761U) ^ (caller * 40503U) ^ callee) & (CALLGRAPH_EDGE_HASH - 1);
+	for(; graph->edge_hash[slot]; slot = (slot + 1) & (CALLGRAPH_EDGE_HASH - 1)) {
+		edge = &graph->edges[graph->edge_hash[slot] - 1];
+		if((edge->site == site) && (edge->caller == caller) && (edge->callee == callee)) {
+			return(graph->edge_hash[slot] - 1);
+		}
+	}
+
+	if(graph->num_edges == MAX_CALLGRAPH_EDGES) {
+		return(-1);
+	}
+
+	edge = &graph->edges[graph->num_edges];
+	memset(edge, 0, sizeof(struct callgraph_edge));
+	edge->caller = caller;
+	edge->callee = callee;
+	edge->site = site;
+	graph->edge_hash[slot] = ++graph->num_edges;
+	return(graph->num_edges - 1);
+}
+
+//
+// what ran since the last event goes to the function on top
+//
+void charge_callgraph(struct machine *m, struct callgraph *graph)
+{
+	unsigned long long cycles;
+
+	cycles = m->sim_cycles - graph->last_cycles;
+	graph->last_cycles = m->sim_cycles;
+
+	graph->functions[graph->frames[graph->depth - 1].function].exclusive_cycles += cycles;
+	graph->total_cycles += cycles;
+}
+
+//
+// take the frame on top off the shadow stack
+//
+void close_callgraph_frame(struct machine *m, struct callgraph *graph)
+{
+	struct callgraph_frame *frame;
+	struct callgraph_function *function;
+	unsigned long long cycles;
+
+	frame = &graph->frames[--graph->depth];
+	function = &graph->functions[frame->function];
+
+	cycles = m->sim_cycles - frame->entry_cycles;
+	if(frame->edge != -1) {
+		graph->edges[frame->edge].inclusive_cycles += cycles;
+	}
+
+	// the outermost one when it recursed
+	if(!--function->active) {
+		function->inclusive_cycles += cycles;
+	}
+}
+
+//
+// put the function the pc is in at the bottom of the shadow stack
+//
+void push_callgraph_root(struct machine *m, struct callgraph *graph)
+{
+	struct callgraph_frame *frame;
+	int function;
+
+	function = callgraph_function(graph, m->register_pc);
+	if(function == -1) {
+		// the tables are full, the first function takes it
+		function = 0;
+	}
+
+	frame = &graph->frames[0];
+	frame->function = function;
+	frame->edge = -1;
+	frame->return_sp = CALLGRAPH_ROOT_SP;
+	frame->entry_cycles = m->sim_cycles;
+
+	graph->functions[function].active++;
+	graph->depth = 1;
+	graph->lost_depth = 0;
+	graph->last_cycles = m->sim_cycles;
+}
+
+//
+// a call or return was just executed (see call_event())
+//
+void callgraph_event(struct machine *m, unsigned int type)
+{
+	struct callgraph *graph;
+	struct callgraph_frame *frame;
+	int callee, edge;
+
+	graph = m->callgraph;
+
+	charge_callgraph(m, graph);
+
+	if(type & CALL_EVENT_CALL) {
+		// once one is lost what it calls is as well
+		if(graph->lost_depth || (graph->depth == MAX_CALLGRAPH_DEPTH)) {
+			graph->lost_depth++;
+			return;
+		}
+
+		callee = callgraph_function(graph, m->register_pc);
+		edge = (callee != -1) ? callgraph_edge(graph, graph->frames[graph->depth - 1].function, m->previous_register_pc, callee) : -1;
+		if(edge == -1) {
+			// no room, it runs as part of the caller
+			graph->lost_calls++;
+			graph->lost_depth++;
+			return;
+		}
+
+		graph->functions[callee].calls++;
+		graph->functions[callee].active++;
+		graph->edges[edge].calls++;
+
+		frame = &graph->frames[graph->depth++];
+		frame->function = callee;
+		frame->edge = edge;
+		frame->return_sp = m->previous_register_sp;
+		frame->entry_cycles = m->sim_cycles;
+		return;
+	}
+
+	if(graph->lost_depth) {
+		graph->lost_depth--;
+		return;
+	}
+
+	// frames that were left without a return, then the one this gets back to
+	while((graph->depth > 1) && (graph->frames[graph->depth - 1].return_sp < m->register_sp)) {
+		close_callgraph_frame(m, graph);
+	}
+	if((graph->depth > 1) && (graph->frames[graph->depth - 1].return_sp == m->register_sp)) {
+		close_callgraph_frame(m, graph);
+	}
+}
+
+//
+// start the call graph from nothing, at the pc
+// returns 0 if there isn't enough memory
+//
+int start_callgraph(struct machine *m)
+{
+	stop_callgraph(m);
+
+	m->callgraph = (struct callgraph *)calloc(1, sizeof(struct callgraph));
+	if(m->callgraph == NULL) {
+		return(0);
+	}
+	push_callgraph_root(m, m->callgraph);
+	return(1);
+}
+
+void stop_callgraph(struct machine *m)
+{
+	free(m->callgraph);
+	m->callgraph = NULL;
+}
+
+//
+// everything on the shadow stack returns now
+//
+void close_callgraph_frames(struct machine *m, struct callgraph *graph)
+{
+	charge_callgraph(m, graph);
+	while(graph->depth) {
+		close_callgraph_frame(m, graph);
+	}
+}
+
+//
+// the machine is going somewhere else (fork_machine()), what is on the shadow
+// stack ends here, open_callgraph_stack() starts it over once it is there
+//
+void close_callgraph_stack(struct machine *m)
+{
+	close_callgraph_frames(m, m->callgraph);
+}
+
+void open_callgraph_stack(struct machine *m)
+{
+	push_callgraph_root(m, m->callgraph);
+}
+
+//
+// a copy of the call graph with every frame closed as of now, for the reports
+// returns NULL if there isn't enough memory
+//
+struct callgraph *settled_callgraph(struct machine *m)
+{
+	struct callgraph *graph;
+
+	graph = (struct callgraph *)malloc(sizeof(struct callgraph));
+	if(graph == NULL) {
+		printf("Not enough memory for the call graph\n");
+		return(NULL);
+	}
+	memcpy(graph, m->callgraph, sizeof(struct callgraph));
+
+	close_callgraph_frames(m, graph);
+	return(graph);
+}
+
+//
+// sorting for display_callgraph(), the graph being sorted
+//
+struct callgraph *sorting_callgraph;
+
+int compare_callgraph_functions(const void *a, const void *b)
+{
+	unsigned long long cycles_a, cycles_b;
+
+	cycles_a = sorting_callgraph->functions[*(const int *)a].inclusive_cycles;
+	cycles_b = sorting_callgraph->functions[*(const int *)b].inclusive_cycles;
+	if(cycles_a != cycles_b) {
+		return((cycles_a < cycles_b) ? 1 : -1);
+	}
+	return(*(const int *)a - *(const int *)b);
+}
+
+int compare_callgraph_edges(const void *a, const void *b)
+{
+	unsigned long long cycles_a, cycles_b;
+
+	cycles_a = sorting_callgraph->edges[*(const int *)a].inclusive_cycles;
+	cycles_b = sorting_callgraph->edges[*(const int *)b].inclusive_cycles;
+	if(cycles_a != cycles_b) {
+		return((cycles_a < cycles_b) ? 1 : -1);
+	}
+	return(*(const int *)a - *(const int *)b);
+}
+
+// callers together, in the order they were found
+int compare_callgraph_callers(const void *a, const void *b)
+{
+	const struct callgraph_edge *edge_a, *edge_b;
+
+	edge_a = &sorting_callgraph->edges[*(const int *)a];
+	edge_b = &sorting_callgraph->edges[*(const int *)b];
+	if(edge_a->caller != edge_b->caller) {
+		return(edge_a->caller - edge_b->caller);
+	}
+	return(*(const int *)a - *(const int *)b);
+}
+
+//
+// the functions by inclusive cycles and then the call sites, top lines of each
+//
+void display_callgraph(struct machine *m, int lines)
+{
+	struct callgraph *graph;
+	struct callgraph_function *function;
+	struct callgraph_edge *edge;
+	char name[PROFILE_NAME_SIZE], callee_name[PROFILE_NAME_SIZE];
+	int order[MAX_CALLGRAPH_EDGES];
+	int x, count;
+	double total;
+
+	if(m->callgraph == NULL) {
+		printf("Call graph not active.\n");
+		return;
+	}
+
+	graph = settled_callgraph(m);
+	if(graph == NULL) {
+		return;
+	}
+	sorting_callgraph = graph;
+
+	printf("Call graph: %llu cycles, %d functions, %d call sites", graph->total_cycles, graph->num_functions, graph->num_edges);
+	if(graph->lost_calls) {
+		printf(", %u calls with no room in the tables", graph->lost_calls);
+	}
+	printf("\n");
+	total = graph->total_cycles ? (double)graph->total_cycles : 1.0;
+
+	for(x = 0; x != graph->num_functions; x++) {
+		order[x] = x;
+	}
+	qsort(order, graph->num_functions, sizeof(int), compare_callgraph_functions);
+	count = (graph->num_functions < lines) ? graph->num_functions : lines;
+
+	printf("\n   inclusive       %%    exclusive       %%      calls  function\n");
+	for(x = 0; x != count; x++) {
+		function = &graph->functions[order[x]];
+		profile_address_name(function->address, name);
+		printf("%12llu %6.2f%% %12llu %6.2f%% %10u  %s\n", function->inclusive_cycles, (function->inclusive_cycles * 100.0) / total,
+			function->exclusive_cycles, (function->exclusive_cycles * 100.0) / total, function->calls, name);
+	}
+
+	for(x = 0; x != graph->num_edges; x++) {
+		order[x] = x;
+	}
+	qsort(order, graph->num_edges, sizeof(int), compare_callgraph_edges);
+	count = (graph->num_edges < lines) ? graph->num_edges : lines;
+
+	printf("\n   inclusive       %%      calls  call site\n");
+	for(x = 0; x != count; x++) {
+		edge = &graph->edges[order[x]];
+		profile_address_name(graph->functions[edge->caller].address, name);
+		profile_address_name(graph->functions[edge->callee].address, callee_name);
+		printf("%12llu %6.2f%% %10u  %s @ %08x -> %s\n", edge->inclusive_cycles, (edge->inclusive_cycles * 100.0) / total,
+			edge->calls, name, edge->site, callee_name);
+	}
+
+	free(graph);
+}
+
+//
+// a function name in callgrind's compressed form, the name the first time only
+//
+void write_callgrind_name(FILE *fp, struct callgraph *graph, const char *key, int function, char *named)
+{
+	char name[PROFILE_NAME_SIZE];
+
+	if(named[function]) {
+		fprintf(fp, "%s=(%d)\n", key, function + 1);
+	} else {
+		profile_address_name(graph->functions[function].address, name);
+		fprintf(fp, "%s=(%d) %s\n", key, function + 1, name);
+		named[function] = 1;
+	}
+}
+
+//
+// the call graph in callgrind format, positions are addresses
+// returns 0 if it couldn't
+//
+int save_callgrind(struct machine *m, char *filename)
+{
+	struct callgraph *graph;
+	struct callgraph_function *function;
+	struct callgraph_edge *edge;
+	FILE *fp;
+	char named[MAX_CALLGRAPH_FUNCTIONS];
+	int order[MAX_CALLGRAPH_EDGES];
+	int x, y;
+
+	if(m->callgraph == NULL) {
+		printf("Call graph not active.\n");
+		return(0);
+	}
+
+	fp = fopen(filename, "w");
+	if(fp == NULL) {
+		printf("Can't open %s!\n", filename);
+		return(0);
+	}
+
+	graph = settled_callgraph(m);
+	if(graph == NULL) {
+		fclose(fp);
+		return(0);
+	}
+	sorting_callgraph = graph;
+
+	for(x = 0; x != graph->num_edges; x++) {
+		order[x] = x;
+	}
+	qsort(order, graph->num_edges, sizeof(int), compare_callgraph_callers);
+	memset(named, 0, sizeof(named));
+
+	fprintf(fp, "# callgrind format\n");
+	fprintf(fp, "version: 1\n");
+	fprintf(fp, "creator: st7xsim\n");
+	fprintf(fp, "positions: instr\n");
+	fprintf(fp, "events: Cycles\n");
+	fprintf(fp, "summary: %llu\n", graph->total_cycles);
+
+	y = 0;
+	for(x = 0; x != graph->num_functions; x++) {
+		function = &graph->functions[x];
+
+		fprintf(fp, "\n");
+		write_callgrind_name(fp, graph, "fn", x, named);
+		fprintf(fp, "0x%08x %llu\n", function->address, function->exclusive_cycles);
+
+		// what it called
+		for(; (y != graph->num_edges) && (graph->edges[order[y]].caller == x); y++) {
+			edge = &graph->edges[order[y]];
+			write_callgrind_name(fp, graph, "cfn", edge->callee, named);
+			fprintf(fp, "calls=%u 0x%08x\n", edge->calls, graph->functions[edge->callee].address);
+			fprintf(fp, "0x%08x %llu\n", edge->site, edge->inclusive_cycles);
+		}
+	}
+
+	fclose(fp);
+	free(graph);
+	return(1);
+}
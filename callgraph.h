@@ -0,0 +1,25 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - call graph profiler header
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+//----------------------------------------------------------------------------
+//
+
+#define MAX_CALLGRAPH_FUNCTIONS		4096
+#define MAX_CALLGRAPH_EDGES			16384
+#define MAX_CALLGRAPH_DEPTH			256
+
+// lines display_callgraph() shows of each table when nobody says otherwise
+#define CALLGRAPH_LINES				20
+
+int start_callgraph(struct machine *m);
+void stop_callgraph(struct machine *m);
+void close_callgraph_stack(struct machine *m);
+void open_callgraph_stack(struct machine *m);
+void display_callgraph(struct machine *m, int lines);
+int save_callgrind(struct machine *m, char *filename);
@@ -0,0 +1,146 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - call log
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+// History:
+//
+//----------------------------------------------------------------------------
+//
+
+//
+// The call log keeps the last calls and returns (traps and irets too) a
+// machine executed, where from, where to, the stack pointer and the sim time,
+// in a ring so it can stay on for a whole run. The instruction handlers write
+// it themselves (see call_event()), it costs a pointer test per call when it
+// is off and works the same in block and recompiled mode. It tells which
+// routines a command went through without stepping through it.
+//
+// Shown or saved oldest first, nested the way the calls were.
+//
+
+#include "stdafx.h"
+#include <stdio.h>
+#include <memory.h>
+#include <string.h>
+#include <stdlib.h>
+#include <windows.h>
+
+#include "st7xcpu.h"
+
+#include "machine.h"
+
+#include "simulator.h"
+#include "calls.h"
+
+// deepest the nesting is shown
+#define CALL_LOG_MAX_INDENT		32
+
+//
+// start the call log with room for size events (rounded up to a power of 2), throws out what it had
+// returns 0 if there isn't enough memory
+//
+int start_call_log(struct machine *m, unsigned int size)
+{
+	unsigned int call_log_size;
+
+	stop_call_log(m);
+
+	for(call_log_size = 1; call_log_size < size; call_log_size <<= 1) {
+		;
+	}
+
+	m->call_log = (struct call_event *)calloc(call_log_size, sizeof(struct call_event));
+	if(m->call_log == NULL) {
+		return(0);
+	}
+	m->call_log_size = call_log_size;
+	m->call_log_head = 0;
+	return(1);
+}
+
+void stop_call_log(struct machine *m)
+{
+	free(m->call_log);
+	m->call_log = NULL;
+	m->call_log_size = 0;
+	m->call_log_head = 0;
+}
+
+//
+// the last count events to fp, oldest first
+//
+void write_call_log(struct machine *m, FILE *fp, unsigned int count)
+{
+	struct call_event *event;
+	unsigned int x, first;
+	int indent;
+
+	if(count > m->call_log_size) {
+		count = m->call_log_size;
+	}
+	if(count > m->call_log_head) {
+		count = m->call_log_head;
+	}
+
+	first = m->call_log_head - count;
+	indent = 0;
+
+	for(x = first; x != m->call_log_head; x++) {
+		event = &m->call_log[x & (m->call_log_size - 1)];
+
+		if(event->type & CALL_EVENT_RETURN) {
+			if(indent) {
+				indent--;
+			}
+			fprintf(fp, "%12lluns %*s%s %08x -> %08x sp=%04x\n", cycles_to_ns(m, event->sim_cycles), indent * 2, "", (event->type & CALL_EVENT_INTERRUPT) ? "iret  " : "return",
+				event->pc, event->target, event->sp);
+		} else {
+			fprintf(fp, "%12lluns %*s%s %08x -> %08x sp=%04x\n", cycles_to_ns(m, event->sim_cycles), indent * 2, "", (event->type & CALL_EVENT_INTERRUPT) ? "trap  " : "call  ",
+				event->pc, event->target, event->sp);
+			if(indent != CALL_LOG_MAX_INDENT) {
+				indent++;
+			}
+		}
+	}
+	fprintf(fp, "%u of %u calls and returns\n", count, m->call_log_head);
+}
+
+//
+// the last count events to the console
+//
+void display_call_log(struct machine *m, unsigned int count)
+{
+	if(m->call_log == NULL) {
+		printf("Call log not active.\n");
+		return;
+	}
+	write_call_log(m, stdout, count);
+}
+
+//
+// everything the call log holds to a file
+// returns 0 if it couldn't
+//
+int save_call_log(struct machine *m, char *filename)
+{
+	FILE *fp;
+
+	if(m->call_log == NULL) {
+		printf("Call log not active.\n");
+		return(0);
+	}
+
+	fp = fopen(filename, "w");
+	if(fp == NULL) {
+		printf("Can't open %s!\n", filename);
+		return(0);
+	}
+	write_call_log(m, fp, m->call_log_size);
+	fclose(fp);
+	return(1);
+}
@@ -0,0 +1,56 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - call log header
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+//----------------------------------------------------------------------------
+//
+
+// call_event types, a trap is a call and an iret a return as well
+#define CALL_EVENT_CALL			0x01
+#define CALL_EVENT_RETURN		0x02
+#define CALL_EVENT_INTERRUPT	0x04
+#define CALL_EVENT_TRAP			(CALL_EVENT_CALL | CALL_EVENT_INTERRUPT)
+#define CALL_EVENT_IRET			(CALL_EVENT_RETURN | CALL_EVENT_INTERRUPT)
+
+// events the call log holds when nobody says otherwise
+#define CALL_LOG_SIZE			4096
+
+void callgraph_event(struct machine *m, unsigned int type);
+
+//
+// a call or return was just executed, from the instruction handlers, keeps
+// the call depth and puts it in the call log and the call graph if there are
+//
+inline void call_event(struct machine *m, unsigned int type)
+{
+	struct call_event *event;
+
+	if(type & CALL_EVENT_CALL) {
+		m->call_depth++;
+	} else {
+		m->call_depth--;
+	}
+
+	if(m->call_log != NULL) {
+		event = &m->call_log[m->call_log_head++ & (m->call_log_size - 1)];
+		event->type = type;
+		event->pc = m->previous_register_pc;
+		event->target = m->register_pc;
+		event->sp = m->register_sp;
+		event->sim_cycles = m->sim_cycles;
+	}
+
+	if(m->callgraph != NULL) {
+		callgraph_event(m, type);
+	}
+}
+
+int start_call_log(struct machine *m, unsigned int size);
+void stop_call_log(struct machine *m);
+void display_call_log(struct machine *m, unsigned int count);
+int save_call_log(struct machine *m, char *filename);
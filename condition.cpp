@@ -0,0 +1,404 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - breakpoint conditions
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+// History:
+//
+//----------------------------------------------------------------------------
+//
+
+//
+// A condition narrows an instruction or data breakpoint down, it only breaks
+// when the condition holds, e.g.
+//
+//	a == 0x05 && [0x2dd] != 0
+//	[0x20e] > 0x40
+//	w[0xfc] >= 0x100 || count > 100000
+//
+// It is C, numbers are decimal or 0x hex, [address] is the byte and w[address]
+// the word (high byte first) at address. a, x, y, cc, sp and pc are the
+// registers, time the sim time in ns, cycles in instruction cycles and count
+// the instructions of this run. It works in 64 bits, so time and cycles don't
+// wrap and numbers can be as big as they need to be.
+// count is exact for instruction breakpoints. The block and recompiled loops only
+// add to it after each burst of instructions, so a data breakpoint hit inside
+// one sees the count from when the burst started, step with trace or register
+// display on for it to the instruction.
+// For data breakpoints value is the byte read or written and old what it held
+// before.
+//
+// A condition is compiled once, when the breakpoint is set, to code for a
+// little stack machine, and only run when its breakpoint is hit. The code is
+// kept in the breakpoint itself, so breakpoints copy with memcpy and a fork
+// gets its own.
+//
+
+#include "stdafx.h"
+#include <stdio.h>
+#include <memory.h>
+#include <string.h>
+#include <stdlib.h>
+#include <ctype.h>
+#include <windows.h>
+
+#include "st7xcpu.h"
+
+#include "machine.h"
+
+#include "simulator.h"
+#include "condition.h"
+
+// binary operators, longest first so << isn't taken for <
+struct condition_operator {
+	const char *token;
+	int code;
+	int level;						// precedence, 0 binds least
+};
+
+static const struct condition_operator condition_operators[] = {
+	{ "||", COND_LOR, 0 },
+	{ "&&", COND_LAND, 1 },
+	{ "==", COND_EQ, 5 },
+	{ "!=", COND_NE, 5 },
+	{ "<=", COND_LE, 6 },
+	{ ">=", COND_GE, 6 },
+	{ "<<", COND_SHL, 7 },
+	{ ">>", COND_SHR, 7 },
+	{ "|", COND_OR, 2 },
+	{ "^", COND_XOR, 3 },
+	{ "&", COND_AND, 4 },
+	{ "<", COND_LT, 6 },
+	{ ">", COND_GT, 6 },
+	{ "+", COND_ADD, 8 },
+	{ "-", COND_SUB, 8 },
+	{ "*", COND_MUL, 9 },
+	{ "/", COND_DIV, 9 },
+	{ "%", COND_MOD, 9 },
+	{ NULL, 0, 0 }
+};
+
+#define CONDITION_LEVELS		10
+
+// names for the registers and the rest
+struct condition_name {
+	const char *name;
+	int code;
+};
+
+static const struct condition_name condition_names[] = {
+	{ "a", COND_A },
+	{ "x", COND_X },
+	{ "y", COND_Y },
+	{ "cc", COND_CC },
+	{ "sp", COND_SP },
+	{ "pc", COND_PC },
+	{ "time", COND_TIME },
+	{ "count", COND_COUNT },
+	{ "cycles", COND_CYCLES },
+	{ "value", COND_VALUE },
+	{ "old", COND_OLD },
+	{ NULL, 0 }
+};
+
+struct condition_parser {
+	const char *text;				// where we are
+	struct condition *condition;
+	int depth;						// stack depth of the code so far
+	int error;
+};
+
+int parse_condition_binary(struct condition_parser *parser, int level);
+
+//
+// add a word of code
+//
+void emit_condition(struct condition_parser *parser, unsigned int code, int depth)
+{
+	if(parser->condition->length == MAX_CONDITION_CODE) {
+		parser->error = 1;
+		return;
+	}
+	parser->condition->code[parser->condition->length++] = code;
+
+	parser->depth += depth;
+	if(parser->depth > MAX_CONDITION_STACK) {
+		parser->error = 1;
+	}
+}
+
+void skip_condition_space(struct condition_parser *parser)
+{
+	while(isspace((unsigned char)*parser->text)) {
+		parser->text++;
+	}
+}
+
+//
+// the operator at the text, NULL if there isn't one
+//
+const struct condition_operator *condition_operator_at(struct condition_parser *parser)
+{
+	const struct condition_operator *op;
+
+	for(op = condition_operators; op->token != NULL; op++) {
+		if(!strncmp(parser->text, op->token, strlen(op->token))) {
+			return(op);
+		}
+	}
+	return(NULL);
+}
+
+//
+// a number, a name, a memory reference, a unary operator or something in parentheses
+//
+int parse_condition_unary(struct condition_parser *parser)
+{
+	const struct condition_name *name;
+	char word[16];
+	char *end;
+	unsigned long long number;
+	int x, code;
+
+	skip_condition_space(parser);
+
+	switch(*parser->text) {
+	case '!':
+	case '-':
+	case '~':
+		code = (*parser->text == '!') ? COND_NOT : ((*parser->text == '-') ? COND_NEG : COND_COMPL);
+		parser->text++;
+		if(!parse_condition_unary(parser)) {
+			return(0);
+		}
+		emit_condition(parser, code, 0);
+		return(!parser->error);
+
+	case '(':
+	case '[':
+		code = (*parser->text == '(') ? 0 : COND_BYTE;
+		parser->text++;
+		if(!parse_condition_binary(parser, 0)) {
+			return(0);
+		}
+		skip_condition_space(parser);
+		if(*parser->text != (code ? ']' : ')')) {
+			return(0);
+		}
+		parser->text++;
+		if(code) {
+			emit_condition(parser, code, 0);
+		}
+		return(!parser->error);
+	}
+
+	if(isdigit((unsigned char)*parser->text)) {
+		number = strtoull(parser->text, &end, 0);
+		parser->text = end;
+		if(number >> 32) {
+			emit_condition(parser, COND_CONST64, 1);
+			emit_condition(parser, (unsigned int)(number >> 32), 0);
+		} else {
+			emit_condition(parser, COND_CONST, 1);
+		}
+		emit_condition(parser, (unsigned int)number, 0);
+		return(!parser->error);
+	}
+
+	for(x = 0; (x != sizeof(word) - 1) && isalpha((unsigned char)parser->text[x]); x++) {
+		word[x] = (char)tolower((unsigned char)parser->text[x]);
+	}
+	word[x] = '\0';
+
+	if(!strcmp(word, "w") && (parser->text[1] == '[')) {
+		parser->text++;
+		if(!parse_condition_unary(parser)) {
+			return(0);
+		}
+		// that put the byte there, make it the word
+		parser->condition->code[parser->condition->length - 1] = COND_WORD;
+		return(1);
+	}
+
+	for(name = condition_names; name->name != NULL; name++) {
+		if(!strcmp(word, name->name)) {
+			parser->text += x;
+			emit_condition(parser, name->code, 1);
+			return(!parser->error);
+		}
+	}
+	return(0);
+}
+
+//
+// operators of level and up
+//
+int parse_condition_binary(struct condition_parser *parser, int level)
+{
+	const struct condition_operator *op;
+
+	if(level == CONDITION_LEVELS) {
+		return(parse_condition_unary(parser));
+	}
+
+	if(!parse_condition_binary(parser, level + 1)) {
+		return(0);
+	}
+
+	while(1) {
+		skip_condition_space(parser);
+		op = condition_operator_at(parser);
+		if((op == NULL) || (op->level != level)) {
+			return(1);
+		}
+		parser->text += strlen(op->token);
+
+		if(!parse_condition_binary(parser, level + 1)) {
+			return(0);
+		}
+		emit_condition(parser, op->code, -1);
+		if(parser->error) {
+			return(0);
+		}
+	}
+}
+
+//
+// compile text into condition, an empty text is no condition
+// returns 0 (and says why) if it isn't one
+//
+int compile_condition(const char *text, struct condition *condition)
+{
+	struct condition_parser parser;
+
+	memset(condition, 0, sizeof(struct condition));
+
+	parser.text = text;
+	parser.condition = condition;
+	parser.depth = 0;
+	parser.error = 0;
+
+	skip_condition_space(&parser);
+	if(*parser.text == '\0') {
+		return(1);
+	}
+
+	if(strcspn(parser.text, "\r\n") >= MAX_CONDITION_TEXT) {
+		printf("*** Condition too long, at most %d characters\n", MAX_CONDITION_TEXT - 1);
+		return(0);
+	}
+	strncpy(condition->text, parser.text, MAX_CONDITION_TEXT - 1);
+	condition->text[strcspn(condition->text, "\r\n")] = '\0';
+
+	if(parse_condition_binary(&parser, 0)) {
+		skip_condition_space(&parser);
+		if(*parser.text == '\0') {
+			return(1);
+		}
+	}
+
+	if(parser.error) {
+		printf("*** Condition too complicated\n");
+	} else {
+		printf("*** Bad condition at: %s\n", (*parser.text != '\0') ? parser.text : "the end");
+	}
+	memset(condition, 0, sizeof(struct condition));
+	return(0);
+}
+
+//
+// run a condition, value and old_value are what a data breakpoint saw
+// returns non zero if it holds, no condition always does
+//
+int evaluate_condition(struct machine *m, struct condition *condition, unsigned int value, unsigned int old_value)
+{
+	unsigned long long stack[MAX_CONDITION_STACK];
+	unsigned int *code, *end;
+	int sp;
+
+	sp = 0;
+	code = condition->code;
+	end = code + condition->length;
+
+	if(code == end) {
+		return(1);
+	}
+
+	while(code != end) {
+		switch(*code++) {
+		case COND_CONST:	stack[sp++] = *code++;									break;
+		case COND_CONST64:	stack[sp] = (unsigned long long)*code++ << 32; stack[sp++] |= *code++;	break;
+		case COND_A:		stack[sp++] = m->register_a;							break;
+		case COND_X:		stack[sp++] = m->register_x;							break;
+		case COND_Y:		stack[sp++] = m->register_y;							break;
+		case COND_CC:		stack[sp++] = m->register_cc;							break;
+		case COND_SP:		stack[sp++] = m->register_sp;							break;
+		case COND_PC:		stack[sp++] = m->register_pc;							break;
+		case COND_TIME:		stack[sp++] = cycles_to_ns(m, m->sim_cycles);			break;
+		case COND_COUNT:	stack[sp++] = m->instruction_count;						break;
+		case COND_CYCLES:	stack[sp++] = m->sim_cycles;							break;
+		case COND_VALUE:	stack[sp++] = value;									break;
+		case COND_OLD:		stack[sp++] = old_value;								break;
+
+		case COND_BYTE:
+			stack[sp - 1] = get_data_memory_byte_raw(m, (unsigned int)stack[sp - 1]);
+			break;
+		case COND_WORD:
+			stack[sp - 1] = (get_data_memory_byte_raw(m, (unsigned int)stack[sp - 1]) << 8) | get_data_memory_byte_raw(m, (unsigned int)stack[sp - 1] + 1);
+			break;
+
+		case COND_NOT:		stack[sp - 1] = !stack[sp - 1];							break;
+		case COND_NEG:		stack[sp - 1] = 0 - stack[sp - 1];						break;
+		case COND_COMPL:	stack[sp - 1] = ~stack[sp - 1];							break;
+
+		case COND_DIV:
+		case COND_MOD:
+			sp--;
+			if(stack[sp] == 0) {
+				stack[sp - 1] = 0;
+			} else if(code[-1] == COND_DIV) {
+				stack[sp - 1] /= stack[sp];
+			} else {
+				stack[sp - 1] %= stack[sp];
+			}
+			break;
+
+		case COND_MUL:		sp--; stack[sp - 1] *= stack[sp];						break;
+		case COND_ADD:		sp--; stack[sp - 1] += stack[sp];						break;
+		case COND_SUB:		sp--; stack[sp - 1] -= stack[sp];						break;
+		case COND_SHL:		sp--; stack[sp - 1] <<= (stack[sp] & 63);				break;
+		case COND_SHR:		sp--; stack[sp - 1] >>= (stack[sp] & 63);				break;
+		case COND_LT:		sp--; stack[sp - 1] = (stack[sp - 1] < stack[sp]);		break;
+		case COND_LE:		sp--; stack[sp - 1] = (stack[sp - 1] <= stack[sp]);		break;
+		case COND_GT:		sp--; stack[sp - 1] = (stack[sp - 1] > stack[sp]);		break;
+		case COND_GE:		sp--; stack[sp - 1] = (stack[sp - 1] >= stack[sp]);		break;
+		case COND_EQ:		sp--; stack[sp - 1] = (stack[sp - 1] == stack[sp]);		break;
+		case COND_NE:		sp--; stack[sp - 1] = (stack[sp - 1] != stack[sp]);		break;
+		case COND_AND:		sp--; stack[sp - 1] &= stack[sp];						break;
+		case COND_XOR:		sp--; stack[sp - 1] ^= stack[sp];						break;
+		case COND_OR:		sp--; stack[sp - 1] |= stack[sp];						break;
+		case COND_LAND:		sp--; stack[sp - 1] = (stack[sp - 1] && stack[sp]);		break;
+		case COND_LOR:		sp--; stack[sp - 1] = (stack[sp - 1] || stack[sp]);		break;
+		}
+	}
+	return(stack[0] != 0);
+}
+
+//
+// ask for a condition on the console, empty for none
+// returns 0 if what was typed isn't one
+//
+int read_condition(struct condition *condition)
+{
+	char line[128];
+
+	printf("Condition (empty for none)? ");
+	if(fgets(line, sizeof(line), stdin) == NULL) {
+		line[0] = '\0';
+	}
+	return(compile_condition(line, condition));
+}
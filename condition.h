@@ -0,0 +1,56 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - breakpoint conditions header
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+//----------------------------------------------------------------------------
+//
+
+// deepest a condition can go
+#define MAX_CONDITION_STACK		16
+
+// condition code, the operands are on the stack
+#define COND_CONST				1		// next word
+#define COND_A					2
+#define COND_X					3
+#define COND_Y					4
+#define COND_CC					5
+#define COND_SP					6
+#define COND_PC					7
+#define COND_TIME				8		// sim time, ns
+#define COND_COUNT				9		// instructions this run
+#define COND_CYCLES				10		// sim time, instruction cycles
+#define COND_VALUE				11		// data breakpoints, the byte read or written
+#define COND_OLD				12		// data breakpoints, what it held before
+#define COND_BYTE				13		// [address]
+#define COND_WORD				14		// w[address], high byte first
+#define COND_NOT				15
+#define COND_NEG				16
+#define COND_COMPL				17
+#define COND_MUL				18
+#define COND_DIV				19
+#define COND_MOD				20
+#define COND_ADD				21
+#define COND_SUB				22
+#define COND_SHL				23
+#define COND_SHR				24
+#define COND_LT					25
+#define COND_LE					26
+#define COND_GT					27
+#define COND_GE					28
+#define COND_EQ					29
+#define COND_NE					30
+#define COND_AND				31
+#define COND_XOR				32
+#define COND_OR					33
+#define COND_LAND				34
+#define COND_LOR				35
+#define COND_CONST64			36		// next two words, high then low
+
+int compile_condition(const char *text, struct condition *condition);
+int evaluate_condition(struct machine *m, struct condition *condition, unsigned int value, unsigned int old_value);
+int read_condition(struct condition *condition);
@@ -0,0 +1,62 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - deferred disassembly
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+// History:
+//
+//----------------------------------------------------------------------------
+//
+
+//
+// The processor used to sprintf() the disassembly of every executed instruction
+// into the print buffer whether or not anybody was going to look at it.
+// Now each handler just drops the format and the values it computed into the
+// decode record, and simulator_output() only turns that into text when
+// tracing is on.
+//
+
+// the decode record itself lives in the machine (machine.h)
+#include "machine.h"
+
+// an instruction as the decoder sees it, see describe_instruction()
+struct insn_description {
+	unsigned int space;			// SPACE_xxx
+	unsigned char precode;		// 0 if none
+	unsigned char opcode;
+	unsigned char operand[4];	// bytes following the opcode
+	const char *name;			// handler is op_<name>()
+	unsigned int length;		// bytes, precode included
+	unsigned int flags;			// INSN_xxx
+};
+
+//
+// record the disassembly of the current instruction, no formatting done here
+//
+template<typename... Args> inline void disasm(struct machine *m, const char *format, Args... args)
+{
+	static_assert(sizeof...(Args) <= DECODE_MAX_ARGS, "too many disassembly arguments");
+	unsigned int values[] = { (unsigned int)args..., 0 };
+	unsigned int x;
+
+	m->decode_record.format = format;
+	for(x = 0; x != sizeof...(Args); x++) {
+		m->decode_record.args[x] = values[x];
+	}
+}
+
+//
+// same thing for conditional branches
+//
+template<typename... Args> inline void disasm_branch(struct machine *m, int taken, const char *format, Args... args)
+{
+	m->decode_record.branch = (signed char)taken;
+	disasm(m, format, args...);
+}
+
+// turn the decode record into text, returns the number of characters
+int format_decode_record(struct machine *m, char *buffer, int size);
@@ -0,0 +1,348 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - pc hooks
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+// History:
+//
+//----------------------------------------------------------------------------
+//
+
+//
+// Things to do when the pc gets to an address of the firmware: say so, start
+// or stop the run log, dump memory, stop. They come from a hook file that goes
+// with the firmware (PC_HOOK_FILENAME is loaded at startup), so a new firmware
+// build only needs a new hook file.
+//
+// Hook file lines, # starts a comment, addresses are hex and lengths decimal
+// (or [address] for the byte at that address):
+//
+//	range <name> <address> <length>		name a memory range for dump and show
+//	<pc> message <text>					*** <text> @ pc=... on the console and in the run log
+//	<pc> log_on							start the run log, if it is enabled
+//	<pc> log_off						stop it
+//	<pc> dump <name>|<address> <length>	memory to the run log, while it is running
+//	<pc> show <name>|<address> <length>	memory to the console
+//	<pc> stop							stop the run
+//
+// The hooks at a pc run in the order of the file. There is one set for all
+// machines, it is only changed in between runs.
+//
+
+#include "stdafx.h"
+#include <stdio.h>
+#include <memory.h>
+#include <string.h>
+#include <stdlib.h>
+#include <windows.h>
+
+#include "st7xcpu.h"
+
+#include "breakpoints.h"
+#include "simulator.h"
+#include "hooks.h"
+
+// a named memory range
+struct hook_range {
+	char name[MAX_HOOK_NAME];
+	unsigned int address;
+	unsigned int length;
+	int length_at;						// length is the address of a byte holding it
+	struct hook_range *next;
+};
+
+struct pc_hook {
+	unsigned int pc;
+	int action;
+	char text[MAX_HOOK_TEXT];			// message, or the name of the range
+	unsigned int address;				// range of dump and show
+	unsigned int length;
+	int length_at;
+	struct pc_hook *next;				// next one in the same bucket, in file order
+};
+
+// hooks by pc
+#define PC_HOOK_BUCKETS			256
+#define PC_HOOK_BUCKET(pc)		(((pc) ^ ((pc) >> 8)) & (PC_HOOK_BUCKETS - 1))
+
+struct pc_hook *pc_hooks[PC_HOOK_BUCKETS];
+struct hook_range *hook_ranges;
+
+unsigned int pc_hook_map[PC_HOOK_WORDS];
+unsigned int pc_hook_generation;
+int num_pc_hooks;
+
+//
+// throw away all hooks and ranges
+//
+void clear_pc_hooks(void)
+{
+	struct pc_hook *hook;
+	struct hook_range *range;
+	int x;
+
+	for(x = 0; x != PC_HOOK_BUCKETS; x++) {
+		while((hook = pc_hooks[x]) != NULL) {
+			pc_hooks[x] = hook->next;
+			free(hook);
+		}
+	}
+	while((range = hook_ranges) != NULL) {
+		hook_ranges = range->next;
+		free(range);
+	}
+
+	memset(pc_hook_map, 0, sizeof(pc_hook_map));
+	num_pc_hooks = 0;
+	pc_hook_generation++;
+}
+
+//
+// range by name, NULL if there is no such range
+//
+struct hook_range *find_hook_range(char *name)
+{
+	struct hook_range *range;
+
+	for(range = hook_ranges; range != NULL; range = range->next) {
+		if(!strcmp(range->name, name)) {
+			return(range);
+		}
+	}
+	return(NULL);
+}
+
+//
+// a length, decimal or [address]
+// returns 0 if it isn't one
+//
+int parse_hook_length(char *text, unsigned int *length, int *length_at)
+{
+	*length_at = (*text == '[');
+	if(*length_at) {
+		return(sscanf(text + 1, "%x", length) == 1);
+	}
+	return(sscanf(text, "%u", length) == 1);
+}
+
+//
+// one line of a hook file
+// returns 0 if it didn't make sense
+//
+int parse_pc_hook(char *line)
+{
+	struct pc_hook *hook, **tail;
+	struct hook_range *range;
+	char action[MAX_HOOK_NAME], name[MAX_HOOK_NAME], length[MAX_HOOK_NAME];
+	unsigned int pc, index;
+	int offset;
+
+	if(sscanf(line, "range %31s %x %31s", name, &pc, length) == 3) {
+		range = (struct hook_range *)calloc(1, sizeof(struct hook_range));
+		if(range == NULL) {
+			return(0);
+		}
+		strcpy(range->name, name);
+		range->address = pc;
+		if(!parse_hook_length(length, &range->length, &range->length_at)) {
+			free(range);
+			return(0);
+		}
+		range->next = hook_ranges;
+		hook_ranges = range;
+		return(1);
+	}
+
+	if((sscanf(line, "%x %31s %n", &pc, action, &offset) < 2) || !PC_HOOK_ADDRESS(pc)) {
+		return(0);
+	}
+	line += offset;
+
+	hook = (struct pc_hook *)calloc(1, sizeof(struct pc_hook));
+	if(hook == NULL) {
+		return(0);
+	}
+	hook->pc = pc;
+
+	if(!strcmp(action, "message")) {
+		hook->action = HOOK_MESSAGE;
+		strncpy(hook->text, line, MAX_HOOK_TEXT - 1);
+		hook->text[strcspn(hook->text, "\r\n")] = '\0';
+	} else if(!strcmp(action, "log_on")) {
+		hook->action = HOOK_LOG_ON;
+	} else if(!strcmp(action, "log_off")) {
+		hook->action = HOOK_LOG_OFF;
+	} else if(!strcmp(action, "stop")) {
+		hook->action = HOOK_STOP;
+	} else if(!strcmp(action, "dump") || !strcmp(action, "show")) {
+		hook->action = strcmp(action, "dump") ? HOOK_SHOW : HOOK_DUMP;
+
+		if((sscanf(line, "%31s", name) == 1) && ((range = find_hook_range(name)) != NULL)) {
+			strcpy(hook->text, range->name);
+			hook->address = range->address;
+			hook->length = range->length;
+			hook->length_at = range->length_at;
+		} else if((sscanf(line, "%x %31s", &hook->address, length) == 2) && parse_hook_length(length, &hook->length, &hook->length_at)) {
+			sprintf(hook->text, "%x", hook->address);
+		} else {
+			hook->action = 0;
+		}
+	}
+
+	if(!hook->action) {
+		free(hook);
+		return(0);
+	}
+
+	// at the end of its bucket, so the hooks at a pc run in file order
+	tail = &pc_hooks[PC_HOOK_BUCKET(pc)];
+	while(*tail != NULL) {
+		tail = &(*tail)->next;
+	}
+	*tail = hook;
+
+	index = PC_HOOK_INDEX(pc);
+	pc_hook_map[index >> 5] |= (1U << (index & 31));
+	num_pc_hooks++;
+	return(1);
+}
+
+//
+// replace the hooks with the ones in a hook file
+// returns the number of hooks, -1 if the file couldn't be opened
+//
+int load_pc_hooks(char *filename)
+{
+	char line[256], *p;
+	FILE *fp;
+
+	if((fp = fopen(filename, "r")) == (FILE *)NULL) {
+		return(-1);
+	}
+
+	clear_pc_hooks();
+
+	while(fgets(line, sizeof(line), fp) != NULL) {
+		p = line;
+		while((*p == ' ') || (*p == '\t')) {
+			p++;
+		}
+		if((*p == '#') || (*p == '\r') || (*p == '\n') || (*p == '\0')) {
+			continue;
+		}
+
+		if(!parse_pc_hook(p)) {
+			printf("Bad hook line: %s", p);
+		}
+	}
+	fclose(fp);
+
+	return(num_pc_hooks);
+}
+
+//
+// first hooked pc at or after address, NO_PC_HOOK if there are none
+//
+unsigned int next_pc_hook(unsigned int address)
+{
+	return(next_map_address(pc_hook_map, address));
+}
+
+//
+// list the hooks in pc order
+//
+void display_pc_hooks(void)
+{
+	static const char *action_names[] = { "", "message", "log_on", "log_off", "dump", "show", "stop" };
+	struct pc_hook *hook;
+	struct hook_range *range;
+	unsigned int pc;
+
+	for(range = hook_ranges; range != NULL; range = range->next) {
+		printf("range %s %x %s%u%s\n", range->name, range->address, range->length_at ? "[" : "", range->length, range->length_at ? "]" : "");
+	}
+
+	for(pc = next_pc_hook(0); pc != NO_PC_HOOK; pc = next_pc_hook(pc + 1)) {
+		for(hook = pc_hooks[PC_HOOK_BUCKET(pc)]; hook != NULL; hook = hook->next) {
+			if(hook->pc == pc) {
+				printf("%08x %s %s\n", pc, action_names[hook->action], hook->text);
+			}
+		}
+	}
+}
+
+//
+// a range of memory to the console or the run log
+//
+void dump_hook_range(struct machine *m, struct pc_hook *hook, int to_run_log)
+{
+	unsigned int length;
+
+	length = hook->length;
+	if(hook->length_at) {
+		length = get_data_memory_byte_raw(m, hook->length);
+	}
+
+	if(to_run_log) {
+		fprintf(m->run_log_fp, "%s: ", hook->text);
+		display_data_memory_to_run_log(m, hook->address, length);
+	} else {
+		printf("%s: ", hook->text);
+		display_data_memory(m, hook->address, length);
+	}
+}
+
+//
+// the pc is on a hooked address, do what the hooks there say
+// returns 1 if one of them stops the run
+//
+int run_pc_hooks(struct machine *m)
+{
+	struct pc_hook *hook;
+	int stop;
+
+	stop = 0;
+
+	for(hook = pc_hooks[PC_HOOK_BUCKET(m->register_pc)]; hook != NULL; hook = hook->next) {
+		if(hook->pc != m->register_pc) {
+			continue;
+		}
+
+		switch(hook->action) {
+		case HOOK_MESSAGE:
+			sim_printf(m, "\n*** %s @ pc=%08x hit, previous_pc=%08x\n", hook->text, m->register_pc, m->previous_register_pc);
+			if(m->run_log_enable && m->run_log_triggered) {
+				fprintf(m->run_log_fp, "\n*** %s @ pc=%08x hit, previous_pc=%08x\n", hook->text, m->register_pc, m->previous_register_pc);
+			}
+			break;
+		case HOOK_LOG_ON:
+			if(m->run_log_enable) {
+				m->run_log_triggered = 1;
+			}
+			break;
+		case HOOK_LOG_OFF:
+			if(m->run_log_enable) {
+				m->run_log_triggered = 0;
+			}
+			break;
+		case HOOK_DUMP:
+			if(m->run_log_enable && m->run_log_triggered) {
+				dump_hook_range(m, hook, 1);
+			}
+			break;
+		case HOOK_SHOW:
+			if(!m->quiet) {
+				dump_hook_range(m, hook, 0);
+			}
+			break;
+		case HOOK_STOP:
+			stop = 1;
+			break;
+		}
+	}
+	return(stop);
+}
@@ -0,0 +1,61 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - pc hooks header
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+//----------------------------------------------------------------------------
+//
+
+// hook file loaded at startup, has to go with the firmware that is loaded
+#define PC_HOOK_FILENAME		"st7xsim.hooks"
+
+// hook actions
+#define HOOK_MESSAGE			1		// say it was hit, on the console and in the run log
+#define HOOK_LOG_ON				2		// start the run log (if it is enabled)
+#define HOOK_LOG_OFF			3		// and stop it
+#define HOOK_DUMP				4		// memory range to the run log
+#define HOOK_SHOW				5		// memory range to the console
+#define HOOK_STOP				6		// stop the run
+
+#define MAX_HOOK_NAME			32
+#define MAX_HOOK_TEXT			96
+
+// next_pc_hook() when there are no more
+#define NO_PC_HOOK				0xffffffff
+
+//
+// A bit for every hooked address of page 00 and page 10, same layout as the
+// instruction breakpoint map, so the run loop needs just one test to pass by
+//
+#define PC_HOOK_ADDRESS(address)	(!((address) & 0xffef0000))
+#define PC_HOOK_INDEX(address)		((((address) >> 4) & 0x00010000) | ((address) & 0x0000ffff))
+#define PC_HOOK_WORDS				(0x00020000 / 32)
+
+extern unsigned int pc_hook_map[PC_HOOK_WORDS];
+
+// goes up every time the hooks change, see set_block_splits()
+extern unsigned int pc_hook_generation;
+
+// how many hooks there are, none and the run loop doesn't look for them
+extern int num_pc_hooks;
+
+//
+// is there a hook at address
+//
+inline int pc_hooked(unsigned int address)
+{
+	unsigned int index;
+
+	index = PC_HOOK_INDEX(address);
+	return((pc_hook_map[index >> 5] & (1U << (index & 31))) && PC_HOOK_ADDRESS(address));
+}
+
+int load_pc_hooks(char *filename);
+void clear_pc_hooks(void);
+void display_pc_hooks(void);
+unsigned int next_pc_hook(unsigned int address);
+int run_pc_hooks(struct machine *m);
@@ -0,0 +1,401 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - machine context
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+// History:
+//
+//----------------------------------------------------------------------------
+//
+
+//
+// Everything one simulated tag is made of, the cpu, its memory, the simulated
+// peripherals and the simulator state that goes with them (breakpoints, run
+// control, the clock). The processor, the memory bus and the application hooks
+// all get the machine they work on passed in, so any number of tags can be run
+// side by side in one process.
+//
+// main() makes the one the user interface works on.
+//
+
+#if !defined(MACHINE_H)
+#define MACHINE_H
+
+#include "st7xcpu.h"
+
+//
+//---------------------------------
+// Simulator configuration
+//---------------------------------
+//
+
+//
+// a breakpoint condition compiled to code for a little stack machine (see condition.cpp)
+//
+#define MAX_CONDITION_TEXT		80
+#define MAX_CONDITION_CODE		64
+
+struct condition {
+	char text[MAX_CONDITION_TEXT];		// as it was typed in
+	int length;							// words of code, 0 is no condition
+	unsigned int code[MAX_CONDITION_CODE];
+};
+
+// breakpoint struct
+struct breakpoint {
+	int used;
+	int enable;
+	int type;
+	int terminal_count;
+	int count;
+	int triggered;
+	unsigned int value;
+	unsigned int address;
+
+	// data breakpoints only (see breakpoints.cpp)
+	unsigned int end_address;		// last address of the range, address itself for just the one
+	unsigned int mask;				// bits of the value DBRK_TYPE_VAL compares
+	unsigned int old_value;			// DBRK_TYPE_SUB
+	unsigned int old_mask;
+	unsigned int hit_address;		// what the last hit was
+	unsigned char hit_old_data;
+	unsigned char hit_data;
+	struct condition condition;		// has to hold as well
+};
+
+// the call breakpoint, what a call has to be to break (see breakpoints.cpp)
+#define MAX_CALL_TARGETS		16
+
+struct call_breakpoint {
+	int type;								// CBRK_TYPE_* and BRK_TYPE_COUNT, 0 breaks on every call
+	unsigned int targets[MAX_CALL_TARGETS];	// CBRK_TYPE_TARGET, where it calls
+	int num_targets;
+	unsigned int caller_start;				// CBRK_TYPE_CALLER, where the call instruction is
+	unsigned int caller_end;
+	int min_depth;							// CBRK_TYPE_DEPTH, call_depth inside the callee
+	int max_depth;
+	int terminal_count;
+	int count;
+};
+
+struct callgraph;
+
+// a call or return in the call log (see calls.cpp)
+struct call_event {
+	unsigned int type;						// CALL_EVENT_*
+	unsigned int pc;						// the call or return instruction
+	unsigned int target;					// the callee, or where it returned to
+	unsigned int sp;						// after it
+	unsigned long long sim_cycles;
+};
+
+// condition of an instruction breakpoint
+struct ins_condition {
+	unsigned int address;
+	struct condition condition;
+};
+
+//
+// what the simulator itself did to run the tag, for throughput (see stats.cpp)
+//
+
+// parts of the memory bus the accesses are counted by, see build_memory_bus()
+#define BUS_REGION_SHORT		0		// 0000-00ff, the io registers and the short addressed ram
+#define BUS_REGION_RAM			1
+#define BUS_REGION_XIO			2
+#define BUS_REGION_ROM			3
+#define BUS_REGION_FLASH		4
+#define BUS_REGION_OTHER		5		// nothing there
+#define NUM_BUS_REGIONS			6
+
+struct host_stats {
+	unsigned long long runs;
+	unsigned long long wall_ns;								// host time spent running
+	unsigned long long instructions;
+	unsigned long long sim_cycles;
+	unsigned long long bus_reads[NUM_BUS_REGIONS];			// through the memory bus, raw ones too
+	unsigned long long bus_writes[NUM_BUS_REGIONS];
+	unsigned long long device_calls;						// reads and writes the simulated peripherals were asked for
+	unsigned long long pc_hook_calls;
+	unsigned long long ins_breakpoint_checks;				// pc looked up in the breakpoint map
+	unsigned long long data_breakpoint_checks;
+	unsigned long long trace_bytes;							// to the console and the run log
+};
+
+// an instruction scoreboard slot, one per [space][opcode] (see scoreboard.cpp)
+struct scoreboard_entry {
+	unsigned long long executions;
+	unsigned long long cycles;
+};
+
+#define SCOREBOARD_SIZE			(NUM_OPCODE_SPACES * 256 * sizeof(struct scoreboard_entry))
+
+// a flat profile counter, one per pc (see profile.cpp)
+struct profile_counter {
+	unsigned long long executions;
+	unsigned long long cycles;
+};
+
+// addresses the block cache has to stop in front of, see set_block_splits()
+#define MAX_BLOCK_SPLITS		64
+
+// commands the console can have waiting for a running machine, power of 2 (see simthread.cpp)
+#define SIM_COMMAND_QUEUE		16
+
+//
+// deferred disassembly, see disasm.h
+//
+#define DECODE_MAX_ARGS		8
+
+// branch field
+#define DECODE_NOT_A_BRANCH	-1
+#define DECODE_NOT_TAKEN	0
+#define DECODE_TAKEN		1
+
+// decode record, one per executed instruction
+struct decode_record {
+	unsigned int pc;						// address of the instruction (the precode if there is one)
+	unsigned char precode;					// precode byte in effect, 0 if none
+	unsigned char opcode;
+	signed char branch;						// DECODE_NOT_A_BRANCH, DECODE_NOT_TAKEN, DECODE_TAKEN
+	const char *format;						// printf style, all arguments are ints, NULL if nothing to say
+	unsigned int args[DECODE_MAX_ARGS];		// operands, effective addresses and results as the handler saw them
+};
+
+//
+// Memory is kept in pages that machines can share. A fork of a machine starts
+// out with the same pages as the one it came from, a page is only copied when
+// one of them writes to it (see pages.cpp). Anything that changes memory has
+// to go through put_memory_byte() for that to work.
+//
+#define MEMORY_PAGE_SHIFT		8
+#define MEMORY_PAGE_SIZE		(1 << MEMORY_PAGE_SHIFT)
+#define MEMORY_PAGES			(0x10000 >> MEMORY_PAGE_SHIFT)
+
+struct memory_page {
+	volatile long refs;							// machines using it, written in place only if there is just one
+	unsigned char data[MEMORY_PAGE_SIZE];
+};
+
+// the memories of a machine by number, see the memory bus in st7xsim.cpp
+#define PROG_MEMORY				0
+#define PROG2_MEMORY			1
+#define FLASH_MEMORY			2
+#define NUM_MEMORIES			3
+
+// pages of the 24 bit address space
+#define BUS_PAGES				(0x1000000 >> MEMORY_PAGE_SHIFT)
+
+// private to processor.cpp
+struct decode_entry;
+struct processor_caches;
+
+struct machine {
+	// Processor registers
+	unsigned char register_a;
+	unsigned char register_x;
+	unsigned char register_y;
+	unsigned int register_pc;
+	unsigned short register_sp;
+	unsigned char register_cc;
+	unsigned int previous_register_pc;
+	unsigned int previous_register_sp;
+
+	// for function call deliniation
+	int	executed_call_instruction;
+	int	executed_return_instruction;
+
+	unsigned int aabnormal_termination;
+
+	// What the last instruction did, for the trace (see disasm.h)
+	struct decode_record decode_record;
+
+	// Processor memory, by name or by number
+	union {
+		struct memory_page *memory[NUM_MEMORIES][MEMORY_PAGES];
+		struct {
+			struct memory_page *prog_memory[MEMORY_PAGES];		// Page 00
+			struct memory_page *prog2_memory[MEMORY_PAGES];		// Page 10
+			struct memory_page *flash_memory[MEMORY_PAGES];		// Flash memory
+		};
+	};
+
+	// instruction scoreboard, [space][opcode], every machine has its own, forks too
+	struct scoreboard_entry (*scoreboard)[256];
+
+	// operand window of the instruction being executed, see OPERAND()
+	struct decode_entry *decoded;
+	unsigned int operand_pc;
+	unsigned int operand_count;
+
+	// decode, block and recompiled code bookkeeping (processor.cpp)
+	struct processor_caches *caches;
+
+	// addresses the run loop has to see
+	unsigned int block_splits[MAX_BLOCK_SPLITS];
+	int num_block_splits;
+
+	// compare each block instruction with what execute() would have run,
+	// block_check_machine runs the block again through execute() (see run_block())
+	int block_check;
+	struct machine *block_check_machine;
+
+	// recompiled ROM state and the run in progress
+	int recompiled_state;
+	unsigned int recompiled_budget;
+	unsigned int recompiled_executed;
+
+	// Execution breakpoints, a bit for every address of page 00 and page 10 (see breakpoints.cpp)
+	unsigned int *ins_breakpoint_map;
+	unsigned int num_ins_breakpoints;
+	int ins_breakpoints_changed;							// the block cache hasn't seen the map since it changed
+	struct ins_condition *ins_conditions;					// the ones that only break when their condition holds
+	int num_ins_conditions;
+	int max_ins_conditions;
+
+	// Application Trigger/break point
+	struct breakpoint application_breakpoint;
+
+	// Data Breakpoints, a free slot has used clear
+	struct breakpoint *data_breakpoints;
+	int num_data_breakpoints;								// slots handed out so far
+	int max_data_breakpoints;								// slots allocated
+	int data_breakpoint_triggered_number;					// number of the data breakpoint that triggered the stop, -1 = none
+
+	// a bit for every bus page with part of a data breakpoint or the capture address on it,
+	// only those take the slow way through the memory bus (see update_watched_pages())
+	unsigned int watched_pages[BUS_PAGES / 32];
+
+	// stepping over a call, the callee runs at full speed up to the return address
+	// at the stack level of the call (see run_loop())
+	int in_function_call;
+	unsigned int in_function_call_sp;
+	unsigned int in_function_call_pc;					// return address, NO_STEP_OVER_PC if not in a call
+	int in_function_call_trace;							// trace before the call
+	int in_function_call_stop;							// stop when it comes back, a single step over
+
+	// capture io writes to a file
+	unsigned int capture_address;
+	int capture_enable;
+	FILE *capture_fp;
+
+	// trace execution to a file
+	int run_log_enable;
+	int run_log_triggered;
+	FILE *run_log_fp;
+
+	// true if we are in run mode
+	int running;
+
+	int stop_reason;
+
+	int trace; // for selective printing
+
+	int step_over;
+
+	unsigned long long instruction_count;
+
+	int break_on_calls;
+	struct call_breakpoint call_breakpoint;
+
+	// calls less returns since the call breakpoint was set
+	int call_depth;
+
+	// flat profile (see profile.cpp), when it is off profile is profile_sink and profile_mask 0
+	struct profile_counter *profile;
+	unsigned int profile_mask;
+	struct profile_counter profile_sink;
+
+	// shadow call stack and what it found (see callgraph.cpp), NULL when it is off
+	struct callgraph *callgraph;
+
+	// every call and return goes in here when there is one, call_log_head counts them all
+	struct call_event *call_log;
+	unsigned int call_log_size;								// a power of 2
+	unsigned int call_log_head;
+
+	int enable_pre_instruction_register_display;
+	int enable_post_instruction_register_display;
+
+	// run a basic block at a time when nobody is watching
+	int block_mode;
+
+	// same thing with the recompiled ROM (see recompiler.cpp)
+	int recompiled_mode;
+
+	// batch worker (see batch.cpp), nothing goes to the console and the keyboard isn't looked at
+	int quiet;
+
+	// commands from the console while the machine runs on the sim thread (see simthread.cpp)
+	volatile long sim_command_head;						// only the console moves it
+	volatile long sim_command_tail;						// only the sim thread moves it
+	int sim_commands[SIM_COMMAND_QUEUE];
+
+	// host side counters, stats since the machine was made (batch workers add theirs), run_stats the last run
+	struct host_stats stats;
+	struct host_stats run_stats;
+
+	// timers, the clock counts instruction cycles, cycles_to_ns() makes time out of them
+	unsigned long long sim_cycles;
+	unsigned int clock_frequency_hz;					// CLOCK_FREQUENCY unless someone changed it
+
+	unsigned char print_buffer[1024]; // the processor prints stuff to here
+
+	// for simulated peripheral - crc generator
+	unsigned short crc_generator_output;
+	unsigned int crc_generator_output_count;
+
+	// For simulating hardware at 3d00,3d01,3d02
+	unsigned int hindex;
+
+	// for simulated peripheral - random number generator
+	unsigned int random_seed;
+
+	// state kept to fork from (application.cpp), not handed on to forks
+	struct machine *fork_base;
+};
+
+struct machine *new_machine(void);
+void free_machine(struct machine *m);
+void fork_machine(struct machine *dst, struct machine *src);
+
+// processor side of a machine
+struct processor_caches *alloc_processor_caches(void);
+void free_processor_caches(struct processor_caches *caches);
+void fork_processor_caches(struct machine *dst, struct machine *src);
+
+// paged memory
+int alloc_memory_pages(struct memory_page **memory);
+void free_memory_pages(struct memory_page **memory);
+void share_memory_pages(struct memory_page **dst, struct memory_page **src);
+int compare_memory_pages(struct memory_page **a, struct memory_page **b);
+void fill_memory_pages(struct memory_page **memory, unsigned int address, unsigned int length, unsigned char data);
+struct memory_page *unshare_memory_page(struct memory_page **entry);
+
+//
+// read a byte of paged memory
+//
+inline unsigned char get_memory_byte(struct memory_page **memory, unsigned int address)
+{
+	return(memory[(address >> MEMORY_PAGE_SHIFT) & (MEMORY_PAGES - 1)]->data[address & (MEMORY_PAGE_SIZE - 1)]);
+}
+
+//
+// write a byte of paged memory, a shared page gets copied first
+//
+inline void put_memory_byte(struct memory_page **memory, unsigned int address, unsigned char data)
+{
+	struct memory_page **entry;
+
+	entry = &memory[(address >> MEMORY_PAGE_SHIFT) & (MEMORY_PAGES - 1)];
+	if((*entry)->refs != 1) {
+		unshare_memory_page(entry);
+	}
+	(*entry)->data[address & (MEMORY_PAGE_SIZE - 1)] = data;
+}
+
+#endif
@@ -0,0 +1,184 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - paged memory
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+// History:
+//
+//----------------------------------------------------------------------------
+//
+
+//
+// Each of a machine's memories is a table of pointers to 256 byte pages. A page
+// counts the machines using it, fork_machine() just hands the child the same
+// pages with one more reference each. Whoever writes to a page that somebody
+// else still uses gets a copy of their own first (copy on write), so a fork
+// costs a few thousand pointer copies instead of all three memories, and a child
+// only ever has copies of the pages it has written.
+//
+// A page with one user belongs to that machine alone and is written in place.
+// The reference counts are changed with interlocked operations so machines
+// running on different threads (batch.cpp) can let go of pages they shared.
+// A machine must not run while it is being forked from.
+//
+
+#include "stdafx.h"
+#include <stdio.h>
+#include <memory.h>
+#include <string.h>
+#include <stdlib.h>
+#include <windows.h>
+
+#include "st7xcpu.h"
+
+#include "machine.h"
+
+//
+// a page with nobody else using it, contents undefined
+//
+struct memory_page *new_memory_page(void)
+{
+	struct memory_page *page;
+
+	page = (struct memory_page *)malloc(sizeof(struct memory_page));
+	if(page == NULL) {
+		printf("*** Out of memory for memory pages\n");
+		exit(1);
+	}
+	page->refs = 1;
+	return(page);
+}
+
+//
+// one less user of a page, the last one out frees it
+//
+void release_memory_page(struct memory_page *page)
+{
+	if(page == NULL) {
+		return;
+	}
+	if(InterlockedDecrement(&page->refs) == 0) {
+		free(page);
+	}
+}
+
+//
+// give a memory all zero pages of its own
+// returns 0 if there isn't enough memory
+//
+int alloc_memory_pages(struct memory_page **memory)
+{
+	int x;
+
+	for(x = 0; x != MEMORY_PAGES; x++) {
+		memory[x] = (struct memory_page *)calloc(1, sizeof(struct memory_page));
+		if(memory[x] == NULL) {
+			free_memory_pages(memory);
+			return(0);
+		}
+		memory[x]->refs = 1;
+	}
+	return(1);
+}
+
+//
+// let go of all the pages of a memory
+//
+void free_memory_pages(struct memory_page **memory)
+{
+	int x;
+
+	for(x = 0; x != MEMORY_PAGES; x++) {
+		release_memory_page(memory[x]);
+		memory[x] = NULL;
+	}
+}
+
+//
+// make dst use the same pages as src
+//
+void share_memory_pages(struct memory_page **dst, struct memory_page **src)
+{
+	int x;
+
+	for(x = 0; x != MEMORY_PAGES; x++) {
+		if(dst[x] != src[x]) {
+			InterlockedIncrement(&src[x]->refs);
+			release_memory_page(dst[x]);
+			dst[x] = src[x];
+		}
+	}
+}
+
+//
+// the first address where a and b differ, -1 if they are the same
+//
+// pages they still share are the same without looking
+//
+int compare_memory_pages(struct memory_page **a, struct memory_page **b)
+{
+	int x, y;
+
+	for(x = 0; x != MEMORY_PAGES; x++) {
+		if((a[x] != b[x]) && memcmp(a[x]->data, b[x]->data, MEMORY_PAGE_SIZE)) {
+			for(y = 0; a[x]->data[y] == b[x]->data[y]; y++) {
+			}
+			return((x << MEMORY_PAGE_SHIFT) | y);
+		}
+	}
+	return(-1);
+}
+
+//
+// the page behind entry is about to be written and somebody else uses it too,
+// replace it with a copy of our own
+//
+struct memory_page *unshare_memory_page(struct memory_page **entry)
+{
+	struct memory_page *page;
+
+	page = new_memory_page();
+	memcpy(page->data, (*entry)->data, MEMORY_PAGE_SIZE);
+
+	release_memory_page(*entry);
+	*entry = page;
+
+	return(page);
+}
+
+//
+// set length bytes from address on to data
+//
+void fill_memory_pages(struct memory_page **memory, unsigned int address, unsigned int length, unsigned char data)
+{
+	struct memory_page **entry;
+	unsigned int offset, count;
+
+	while(length) {
+		entry = &memory[(address >> MEMORY_PAGE_SHIFT) & (MEMORY_PAGES - 1)];
+		offset = address & (MEMORY_PAGE_SIZE - 1);
+
+		count = MEMORY_PAGE_SIZE - offset;
+		if(count > length) {
+			count = length;
+		}
+
+		if((*entry)->refs != 1) {
+			if(count == MEMORY_PAGE_SIZE) {
+				// all of it goes, no point copying it
+				release_memory_page(*entry);
+				*entry = new_memory_page();
+			} else {
+				unshare_memory_page(entry);
+			}
+		}
+		memset(&(*entry)->data[offset], data, count);
+
+		address += count;
+		length -= count;
+	}
+}
@@ -23,65 +23,243 @@
 
 #include "st7xcpu.h"
 
+#include "disasm.h"
+
 #include "processor.h"
 
 #include "breakpoints.h"
+#include "calls.h"
+#include "hooks.h"
+#include "scoreboard.h"
 #include "simulator.h"	// for access to simulation variables
 #include "types.h"
 #include "debug.h"
 
-// instruction scoreboard mechanism
-unsigned char primarys[256];
-unsigned char precode_90s[256];
-unsigned char precode_91s[256];
-unsigned char precode_92s[256];
-unsigned char precode_72s[256];
+//
+//----------------------------------------------
+// Decode cache
+//----------------------------------------------
+//
+// The firmware above ROM_START in page 00 and page 10 doesn't change during a run,
+// so each instruction is fetched and decoded once and kept here keyed by its pc.
+// Entries are only thrown away when something writes into the covered range.
+//
+
+// last pc we cache, leaves room for a precode, the opcode and 4 operand bytes in the same page
+#define DECODE_CACHE_END		0x0000fffa
+#define DECODE_CACHE_SIZE		(DECODE_CACHE_END - ROM_START + 1)
+
+// bytes an entry depends on: precode, opcode and 4 operands
+#define DECODE_WINDOW			6
+
+// true if the decode cache covers address
+#define DECODE_CACHED(address)	(!((address) & 0xffef0000) && (((address) & 0x0000ffff) >= ROM_START) && (((address) & 0x0000ffff) <= DECODE_CACHE_END))
+
+struct decode_entry {
+	unsigned char valid;
+	unsigned char space;		// opcode space, SPACE_PRIMARY if not precoded
+	unsigned char precode;		// 0 if not precoded
+	unsigned char opcode;
+	unsigned char operand[4];	// operand bytes following the opcode
+};
+
+// every opcode handler looks like this, see the opcode dispatch below
+typedef void (*opcode_handler)(struct machine *m, unsigned char instruction);
+
+#define MAX_BLOCKS				16384
+#define MAX_BLOCK_INSNS			131072
+#define MAX_BLOCK_LENGTH		64		// instructions
+
+struct block_insn {
+	unsigned int pc;				// address of the instruction (the precode if there is one)
+	opcode_handler handler;
+	struct decode_entry *decoded;
+	struct scoreboard_entry *scoreboard;	// scoreboard slot of the instruction
+	unsigned char instruction;
+	unsigned char precode;
+	unsigned char cycles;			// from opcode_cycles[]
+};
+
+struct block {
+	unsigned int pc;
+	unsigned int count;				// instructions
+	int split;						// starts on a split address, back to the run loop first
+	struct block_insn *insns;
+	unsigned int chain_pc[2];		// last two places we went from here
+	struct block *chain[2];
+	unsigned int chain_next;		// chain slot to replace next
+};
+
+//
+// everything a machine decodes and records about its firmware, too big for
+// struct machine itself so it hangs off it (m->caches)
+//
+struct processor_caches {
+	// [0] is page 00, [1] is page 10
+	struct decode_entry decode_cache[2][DECODE_CACHE_SIZE];
+
+	struct block blocks[MAX_BLOCKS];
+	struct block_insn block_insns[MAX_BLOCK_INSNS];
+	unsigned int num_blocks;
+	unsigned int num_block_insns;
+
+	// block starting at each cached pc, same layout as the decode cache
+	struct block *block_map[2][DECODE_CACHE_SIZE];
+
+	// 1 where a block instruction starts, for invalidation
+	unsigned char block_code[2][DECODE_CACHE_SIZE];
+
+	// set when the blocks got thrown away under a running block
+	int blocks_flushed;
+
+	// 1 at every cached split address, the list is only searched for the rest
+	unsigned char block_split_map[2][DECODE_CACHE_SIZE];
+	unsigned int block_split_hooks;				// pc_hook_generation the map was built with
+
+	// 1 where a recompiled instruction starts, for invalidation
+	unsigned char recompiled_code[2][DECODE_CACHE_SIZE];
+
+	// the instruction being executed when it isn't cached
+	struct decode_entry fetched;
+};
+
+//
+// operand bytes of the current instruction come out of what was fetched with it,
+// anything else still goes to the data bus
+//
+#define OPERAND(address)	((((unsigned int)(address) - m->operand_pc - 1) < m->operand_count) ? m->decoded->operand[(unsigned int)(address) - m->operand_pc - 1] : get_data_memory_byte(m, address))
+
+// cycles a taken branch adds, built with the other opcode tables (see build_opcode_spaces())
+extern unsigned char opcode_taken_cycles[NUM_OPCODE_SPACES][256];
+
+//
+// the conditional branch being executed goes, charge what that costs on top of the instruction
+//
+inline void branch_taken(struct machine *m)
+{
+	unsigned int cycles;
+
+	cycles = opcode_taken_cycles[m->decoded->space][m->decoded->opcode];
+	if(cycles) {
+		inc_sim_time_branch(m, cycles);
+		m->scoreboard[m->decoded->space][m->decoded->opcode].cycles += cycles;
+	}
+}
+
+//
+// which opcode space a precode selects, SPACE_PRIMARY for anything else
+//
+inline unsigned int opcode_space(unsigned char opcode)
+{
+	switch(opcode) {
+	case PRECODE_90:
+		return(SPACE_90);
+	case PRECODE_91:
+		return(SPACE_91);
+	case PRECODE_92:
+		return(SPACE_92);
+	case PRECODE_72:
+		return(SPACE_72);
+	}
+	return(SPACE_PRIMARY);
+}
+
+//
+// flush the whole decode cache, for loaders that write memory directly
+//
+void invalidate_decode_cache(struct machine *m)
+{
+	memset(m->caches->decode_cache, 0, sizeof(m->caches->decode_cache));
+
+	flush_blocks(m);
+	invalidate_recompiled(m);
+}
 
 //
-// Clear scoreboard
+// a byte at address changed, drop every entry that depends on it
 //
-void clear_scoreboard(void)
+// flash is read through the data side so both pages are done
+//
+void invalidate_decode_cache_address(struct machine *m, unsigned int address)
 {
-	memset(primarys, 0, 256);
-	memset(precode_90s, 0, 256);
-	memset(precode_91s, 0, 256);
-	memset(precode_92s, 0, 256);
-	memset(precode_72s, 0, 256);
+	unsigned int offset, x;
+
+	offset = address & 0x0000ffff;
+
+	for(x = 0; x != DECODE_WINDOW; x++) {
+		if((offset >= (ROM_START + x)) && ((offset - x) <= DECODE_CACHE_END)) {
+			m->caches->decode_cache[0][offset - x - ROM_START].valid = 0;
+			m->caches->decode_cache[1][offset - x - ROM_START].valid = 0;
+		}
+	}
+
+	invalidate_blocks_address(m, address);
+	invalidate_recompiled_address(m, address);
 }
 
 //
-// display scoreboard (on stdout only), called by simulator
+// Fetch the instruction at address, precode, opcode and operands, into entry
 //
-void display_scoreboard(void)
+// opcodes come from program memory, operands from the instruction stream as
+// the bus has it (flash!), neither goes near the peripherals or the data breakpoints
+// returns 0 if the fetch failed (running is cleared)
+//
+int fetch_instruction(struct machine *m, unsigned int address, struct decode_entry *entry)
 {
-	printf("Non-precoded instructions:\n");
-	print_hex(primarys, 256);	
+	entry->precode = 0;
+	entry->opcode = get_prog_memory_byte(m, address);	// can fail, clears running flag
+	if(!m->running && m->aabnormal_termination) {
+		return(0);
+	}
+
+	entry->space = opcode_space(entry->opcode);
+	if(entry->space != SPACE_PRIMARY) {
+		entry->precode = entry->opcode;
+		entry->opcode = get_prog_memory_byte(m, ++address);
+		if(!m->running && m->aabnormal_termination) {
+			return(0);
+		}
+	}
 
-	printf("precode_90s instructions:\n");
-	print_hex(precode_90s, 256);	
+	get_instruction_bytes(m, address + 1, entry->operand, sizeof(entry->operand));
+	entry->valid = 1;
 
-	printf("precode_91s instructions:\n");
-	print_hex(precode_91s, 256);
+	return(1);
+}
+
+//
+// find the decoded instruction at address, decoding it on a miss
+//
+// returns NULL if the address isn't covered by the cache
+//
+struct decode_entry *lookup_decode_cache(struct machine *m, unsigned int address)
+{
+	struct decode_entry *entry;
 
-	printf("precode_92s instructions:\n");
-	print_hex(precode_92s, 256);
+	// only page 00 and page 10 firmware
+	if(!DECODE_CACHED(address)) {
+		return(NULL);
+	}
 
-	printf("precode_72s instructions:\n");
-	print_hex(precode_72s, 256);
+	entry = &m->caches->decode_cache[(address >> 20) & 1][(address & 0x0000ffff) - ROM_START];
+	if(!entry->valid) {
+		fetch_instruction(m, address, entry);
+	}
+	return(entry);
 }
 
 //
 // Reset the simulated cpu
 //
-void reset_cpu(void)
+void reset_cpu(struct machine *m)
 {
 	// initialize processor registers
-	register_pc = PC_INITIAL_VALUE;
-	register_a = 0;
-	register_x = 0;
-	register_y = 0;
-	register_sp = SP_INITIAL_VALUE;
-	register_cc = (0xe0 | (INTERRUPT_MASK_L0_BIT|INTERRUPT_MASK_L1_BIT));
+	m->register_pc = PC_INITIAL_VALUE;
+	m->register_a = 0;
+	m->register_x = 0;
+	m->register_y = 0;
+	m->register_sp = SP_INITIAL_VALUE;
+	m->register_cc = (0xe0 | (INTERRUPT_MASK_L0_BIT|INTERRUPT_MASK_L1_BIT));
 
 	printf("*** CPU Reset ***\n"); // (on stdout only)
 }
@@ -89,14 +267,13 @@ void reset_cpu(void)
 //
 // Reset the processor
 //
-void reset_processor(void)
+void reset_processor(struct machine *m)
 {
-	clear_scoreboard();
+	clear_scoreboard(m);
 
-	reset_cpu();
+	build_opcode_spaces();
 
-	// reset precode flags
-	precode_90 = precode_91 = precode_92 = precode_72 = 0;
+	reset_cpu(m);
 
 	printf("*** Processor Reset ***\n"); // (on stdout only)
 }
@@ -104,18 +281,18 @@ void reset_processor(void)
 //
 // Set processor flags
 //
-inline void set_flags(unsigned char reg)
+inline void set_flags(struct machine *m, unsigned char reg)
 {
 	if(reg) {
-		register_cc &= ~ZERO_BIT;
+		m->register_cc &= ~ZERO_BIT;
 	} else {
-		register_cc |= ZERO_BIT;
+		m->register_cc |= ZERO_BIT;
 	}
 
 	if(reg & 0x80) {
-		register_cc |= NEGATIVE_BIT;
+		m->register_cc |= NEGATIVE_BIT;
 	} else {
-		register_cc &= ~NEGATIVE_BIT;
+		m->register_cc &= ~NEGATIVE_BIT;
 	}
 }
 
@@ -128,135 +305,135 @@ inline void set_flags(unsigned char reg)
 //
 // Divide
 //
-void div(void)
+void div(struct machine *m)
 {
 	unsigned short alu_temp, alu_temp1, alu_temp2;
 
 	// form 16 bit value from x:a register pair
-	alu_temp = register_x << 8;
-	alu_temp |= register_a;
+	alu_temp = m->register_x << 8;
+	alu_temp |= m->register_a;
 
 	// get intermediates
-	alu_temp1 = alu_temp / register_y;
-	alu_temp2 = alu_temp % register_y;
+	alu_temp1 = alu_temp / m->register_y;
+	alu_temp2 = alu_temp % m->register_y;
 
 //	alu_temp1 = alu_temp * register_y;	// debug for testing result
 	
 	// set result into x:a regiser pair
-	register_x = alu_temp2;
-	register_a = alu_temp1;
+	m->register_x = alu_temp2;
+	m->register_a = alu_temp1;
 }
 
 //
 // Add setting condition code flags
 //
-void add(unsigned char val)
+void add(struct machine *m, unsigned char val)
 {
 	unsigned short alu_temp;
 
 	// for half-carry bit setting
-	alu_temp = register_a & 0x0f;
+	alu_temp = m->register_a & 0x0f;
 	alu_temp += (unsigned short)(val &0x0f);
 	if(alu_temp & 0x0010) {
-		register_cc |= HALF_CARRY_BIT;
+		m->register_cc |= HALF_CARRY_BIT;
 	} else {
-		register_cc &= ~HALF_CARRY_BIT;
+		m->register_cc &= ~HALF_CARRY_BIT;
 	}
 
-	alu_temp = register_a;
+	alu_temp = m->register_a;
 	alu_temp += (unsigned short)val;
 	if(alu_temp & 0x0100) {
-		register_cc |= CARRY_BIT;
+		m->register_cc |= CARRY_BIT;
 	} else {
-		register_cc &= ~CARRY_BIT;
+		m->register_cc &= ~CARRY_BIT;
 	}
-	register_a = (unsigned char)(alu_temp & 0x00ff);
+	m->register_a = (unsigned char)(alu_temp & 0x00ff);
 
-	set_flags(register_a);
+	set_flags(m, m->register_a);
 }
 
 //
 // Add with Carry setting condition code flags
 //
-void adc(unsigned char val)
+void adc(struct machine *m, unsigned char val)
 {
 	unsigned short alu_temp;
 
 	// for half-carry bit setting
-	alu_temp = register_a & 0x0f;
+	alu_temp = m->register_a & 0x0f;
 	alu_temp += (unsigned short)(val & 0x0f);
-	if(register_cc & CARRY_BIT) {
+	if(m->register_cc & CARRY_BIT) {
 		alu_temp += 1;
 	}
 	if(alu_temp & 0x0010) {
-		register_cc |= HALF_CARRY_BIT;
+		m->register_cc |= HALF_CARRY_BIT;
 	} else {
-		register_cc &= ~HALF_CARRY_BIT;
+		m->register_cc &= ~HALF_CARRY_BIT;
 	}
 	
-	alu_temp = register_a;
+	alu_temp = m->register_a;
 	alu_temp += (unsigned short)val;
 
-	if(register_cc & CARRY_BIT) {
+	if(m->register_cc & CARRY_BIT) {
 		alu_temp += 1;
 	}
 
 	if(alu_temp & 0x0100) {
-		register_cc |= CARRY_BIT;
+		m->register_cc |= CARRY_BIT;
 	} else {
-		register_cc &= ~CARRY_BIT;
+		m->register_cc &= ~CARRY_BIT;
 	}
-	register_a = (unsigned char)(alu_temp & 0x00ff);
+	m->register_a = (unsigned char)(alu_temp & 0x00ff);
 
-	set_flags(register_a);
+	set_flags(m, m->register_a);
 }
 
 //
 // Subtract setting condition code flags
 //
-void sub(unsigned char val)
+void sub(struct machine *m, unsigned char val)
 {
 	unsigned short alu_temp;
 
-	alu_temp = register_a;
+	alu_temp = m->register_a;
 	alu_temp -= (unsigned short)val;
 
 	if(alu_temp & 0x0100) {
-		register_cc |= CARRY_BIT;
+		m->register_cc |= CARRY_BIT;
 	} else {
-		register_cc &= ~CARRY_BIT;
+		m->register_cc &= ~CARRY_BIT;
 	}
-	register_a = (unsigned char)(alu_temp & 0x00ff);
+	m->register_a = (unsigned char)(alu_temp & 0x00ff);
 
-	set_flags(register_a);
+	set_flags(m, m->register_a);
 }
 
 //
 // Subtract with carry (borrow) setting condition code flags
 //
-void sbc(unsigned char val)
+void sbc(struct machine *m, unsigned char val)
 {
 	unsigned short alu_temp;
 
-	alu_temp = register_a;
+	alu_temp = m->register_a;
 	alu_temp -= (unsigned short)val;
-	if(register_cc & CARRY_BIT) {
+	if(m->register_cc & CARRY_BIT) {
 		alu_temp -= 1;
 	}
 	if(alu_temp & 0x0100) {
-		register_cc |= CARRY_BIT;
+		m->register_cc |= CARRY_BIT;
 	} else {
-		register_cc &= ~CARRY_BIT;
+		m->register_cc &= ~CARRY_BIT;
 	}
-	register_a = (unsigned char)(alu_temp & 0x00ff);
+	m->register_a = (unsigned char)(alu_temp & 0x00ff);
 
-	set_flags(register_a);
+	set_flags(m, m->register_a);
 }
 
 //
 // Rotate left through carry setting condition code flags
 //
-unsigned char rlc(unsigned char val)
+unsigned char rlc(struct machine *m, unsigned char val)
 {
 	unsigned short alu_temp;
 	unsigned char retval;
@@ -265,21 +442,21 @@ unsigned char rlc(unsigned char val)
 
 	alu_temp <<= 1;
 
-	if(register_cc & CARRY_BIT) {
+	if(m->register_cc & CARRY_BIT) {
 		alu_temp |= 0x0001;
 	} else {
 		alu_temp &= 0xfffe;
 	}
 
 	if(alu_temp & 0x0100) {
-		register_cc |= CARRY_BIT;
+		m->register_cc |= CARRY_BIT;
 	} else {
-		register_cc &= ~CARRY_BIT;
+		m->register_cc &= ~CARRY_BIT;
 	}
 
 	retval = (unsigned char)(alu_temp & 0x00ff);
 
-	set_flags(retval);
+	set_flags(m, retval);
 
 	return(retval);
 }
@@ -287,7 +464,7 @@ unsigned char rlc(unsigned char val)
 //
 // Rotate Right through Carry setting condition code flags
 //
-unsigned char rrc(unsigned char val)
+unsigned char rrc(struct machine *m, unsigned char val)
 {
 	unsigned short alu_temp;
 	unsigned char retval;
@@ -304,21 +481,21 @@ unsigned char rrc(unsigned char val)
 	// do the shift
 	alu_temp >>= 1;
 
-	if(register_cc & CARRY_BIT) {
+	if(m->register_cc & CARRY_BIT) {
 		alu_temp |= 0x80;
 	} else {
 		alu_temp &= 0x7f;
 	}
 
 	if(saved_bit) {
-		register_cc |= CARRY_BIT;
+		m->register_cc |= CARRY_BIT;
 	} else {
-		register_cc &= ~CARRY_BIT;
+		m->register_cc &= ~CARRY_BIT;
 	}
 
 	retval = (unsigned char)(alu_temp & 0x00ff);
 
-	set_flags(retval);
+	set_flags(m, retval);
 	
 	return(retval);
 }
@@ -326,7 +503,7 @@ unsigned char rrc(unsigned char val)
 //
 // Shift Left Arithmetic setting condition code flags
 //
-unsigned char sla(unsigned char val)
+unsigned char sla(struct machine *m, unsigned char val)
 {
 	unsigned short alu_temp;
 	unsigned char retval;
@@ -334,19 +511,19 @@ unsigned char sla(unsigned char val)
 	alu_temp = (unsigned short)val;
 	alu_temp <<= 1;
 	if(alu_temp & 0x0100) {
-		register_cc |= CARRY_BIT;
+		m->register_cc |= CARRY_BIT;
 	} else {
-		register_cc &= ~CARRY_BIT;
+		m->register_cc &= ~CARRY_BIT;
 	}
 	retval = (unsigned char)(alu_temp & 0x00ff);
-	set_flags(retval);
+	set_flags(m, retval);
 	return(retval);
 }
 
 //
 // Shift Right Arithmetic setting condition code flags
 //
-unsigned char sra(unsigned char val)
+unsigned char sra(struct machine *m, unsigned char val)
 {
 	unsigned short alu_temp;
 	unsigned char retval;
@@ -355,9 +532,9 @@ unsigned char sra(unsigned char val)
 	alu_temp = (unsigned short)val;
 
 	if(alu_temp & 0x0001) {
-		register_cc |= CARRY_BIT;
+		m->register_cc |= CARRY_BIT;
 	} else {
-		register_cc &= ~CARRY_BIT;
+		m->register_cc &= ~CARRY_BIT;
 	}
 	if(alu_temp & 0x0080) {
 		signbit = 1;
@@ -374,7 +551,7 @@ unsigned char sra(unsigned char val)
 
 	retval = (unsigned char)(alu_temp & 0x00ff);
 
-	set_flags(retval);
+	set_flags(m, retval);
 
 	return(retval);
 }
@@ -382,6094 +559,6376 @@ unsigned char sra(unsigned char val)
 //
 // Shift Right Logical setting condition code flags
 //
-unsigned char srl(unsigned char val)
+unsigned char srl(struct machine *m, unsigned char val)
 {
 	unsigned short alu_temp;
 	unsigned char retval;
 
 	alu_temp = (unsigned short)val;
 	if(alu_temp & 0x0001) {
-		register_cc |= CARRY_BIT;
+		m->register_cc |= CARRY_BIT;
 	} else {
-		register_cc &= ~CARRY_BIT;
+		m->register_cc &= ~CARRY_BIT;
 	}
 	alu_temp >>= 1;
 	retval = (unsigned char)(alu_temp & 0x00ff);
-	set_flags(retval);
+	set_flags(m, retval);
 	return(retval);
 }
 
 //
-// Execute an instruction, return 0 if done, 1 to fetch and execute the next byte
-// This os the heart of the simulator
-// can set global abnormal termination flag
+//----------------------------------------------
+// Opcode handlers
+//----------------------------------------------
+//
+// One handler per instruction, st7xisa.h says which opcodes and which of the
+// five opcode spaces each one serves.
+//
+// Handlers are instantiated once per precode (0 is the primary space) so the
+// precode tests fold away at compile time. execute() produces the output after
+// the handler returns.
 //
 // any printing output should go the the simulators print buffer
 // so it can decide what to do with it
 //
-int execute(void)
+template<unsigned int PRECODE_SPACE> void op_exgw(struct machine *m, unsigned char instruction)
 {
-	register unsigned char instruction, short_address, indirect_address, short_src_address, short_dst_address;
-	unsigned char temp, bcp_temp, bit_mask;
-	unsigned int long_address, multiply_result, long_src_address, long_dst_address;
-	unsigned int dest, bit, dword_address;
-	short displacement;
-	unsigned short short_indirect_address;
-
-	print_buffer[0] = 0;	// so i can catch empty buffer in output guy
+	unsigned char temp;
+
+	disasm(m, "EXGW  X,Y\n");
+	temp = m->register_y;
+	m->register_y = m->register_x;
+	m->register_x = temp;
+	// increment pc
+	m->register_pc++;
+}
 
-	executed_call_instruction = 0;
-	executed_return_instruction = 0;
-	aabnormal_termination = 0;
+template<unsigned int PRECODE_SPACE> void op_exg_a_x(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
 
-	// Save pc to previous_pc
-	previous_register_pc = register_pc;
+	disasm(m, "EXG  A,XL\n");
+	
+	temp = m->register_a;
+	m->register_a = m->register_x;
+	m->register_x = temp;
+	// increment pc
+	m->register_pc++;
+}
 
-	// Save pc to previous_sp
-	previous_register_sp = register_sp;
+template<unsigned int PRECODE_SPACE> void op_exg_a_y(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
 
-	// Fetch next instruction
-	instruction = get_prog_memory_byte(register_pc); // can fail, clears running flag
-	if(!running) {									// if it failed, and its an abnormal termination event stop simulator
-		if(aabnormal_termination) {
-			return(0);	// tell caller we are done, don't call us again
-		}
-	}
+	disasm(m, "EXG	 A,YL\n");
+	
+	temp = m->register_a;
+	m->register_a = m->register_y;
+	m->register_y = temp;
+	// increment pc
+	m->register_pc++;
+}
 
-	// handle precodes
-	//
-	// precodes are handled by setting the appropiate global variable and telling the caller to call us again
-	// to get the next byte (which is the instruction)
-	//
-	switch(instruction) {
-	case PRECODE_72:
-		sprintf((char *)print_buffer, "PRECODE_72 ");
-		simulator_output();
+template<unsigned int PRECODE_SPACE> void op_exg_a_long(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
+	unsigned int long_address;
 
-		precode_72 = 1;
-		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		return(1); // tell caller to  call us again
-		break;
+	long_address = OPERAND(m->register_pc+1) << 8;
+	long_address |= OPERAND(m->register_pc+2);
+	temp = get_data_memory_byte(m, long_address);
 
-	case PRECODE_90:
-		sprintf((char *)print_buffer, "PRECODE_90 ");
-		simulator_output();
+	disasm(m, "EXG	 A,%08x\n", long_address);
+	
+	put_data_memory_byte(m, long_address, m->register_a);
+	m->register_a = temp;
+	// increment pc
+	m->register_pc +=3;
+}
 
-		precode_90 = 1;
-		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		return(1); // tell caller to  call us again
-		break;
+// LDF	A,x
+template<unsigned int PRECODE_SPACE> void op_ldf_a_far(struct machine *m, unsigned char instruction)
+{
+	unsigned int long_address;
 
-	case PRECODE_91:
-		sprintf((char *)print_buffer, "PRECODE_91 ");
-		simulator_output();
+	long_address = OPERAND(m->register_pc+1) << 16;
+	long_address |= OPERAND(m->register_pc+2) << 8;
+	long_address |= OPERAND(m->register_pc+3);
 
-		precode_91 = 1;
-		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		return(1); // tell caller to  call us again
-		break;
+	disasm(m, "LDF	 A,%08x\n", long_address);
+	
+	m->register_a = get_data_memory_byte(m, long_address);
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 4;
+}
 
-	case PRECODE_92:
-		sprintf((char *)print_buffer, "PRECODE_92 ");
-		simulator_output();
+template<unsigned int PRECODE_SPACE> void op_ldf_a_reg_ind(struct machine *m, unsigned char instruction)
+{
+	unsigned int long_address;
+	unsigned short short_indirect_address;
 
-		precode_92 = 1;
-		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		return(1);; // tell caller to  call us again
-		break;
-	}
-
-	// scoreboard the instruction
-	if(precode_90) {
-		precode_90s[instruction] = 1;
-	} else if(precode_91) {
-		precode_91s[instruction] = 1;
-	} else if(precode_92) {
-		precode_92s[instruction] = 1;
-	} else if(precode_72) {
-		precode_72s[instruction] = 1;
-	} else {
-		primarys[instruction] = 1;
-	}
-
-	// decode and execute the instruction
-	switch(instruction) {
-	case EXGW:
-		sprintf((char *)print_buffer, "EXGW  X,Y\n");
-		temp = register_y;
-		register_y = register_x;
-		register_x = temp;
-		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		break;
+	if(PRECODE_SPACE == PRECODE_72) {
+		// not in standard st8
+		short_indirect_address = OPERAND(m->register_pc+1) << 8;
+		short_indirect_address |= OPERAND(m->register_pc+2);
 
-	case EXG_A_X:
-		sprintf((char *)print_buffer, "EXG  A,XL\n");
+		disasm(m, "LDF	 A,([%04x],X)\n", short_indirect_address);
 		
-		temp = register_a;
-		register_a = register_x;
-		register_x = temp;
-		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		break;
+		long_address = get_data_memory_byte(m, short_indirect_address) << 16;
+		long_address |= get_data_memory_byte(m, short_indirect_address+1) << 8;
+		long_address |= get_data_memory_byte(m, short_indirect_address+2);
+		m->register_a = get_data_memory_byte(m, long_address+m->register_x);
+		set_flags(m, m->register_a);	// increment pc
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_90) {
+		// standard st8 has this
+		disasm(m, "LDF A, (extoff,Y) goes here\n");
+		
+		// unhandled precode handler will catch this
 
-	case EXG_A_Y:
-		sprintf((char *)print_buffer, "EXG	 A,YL\n");
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		// standard st8 has this
+		disasm(m, "LDF A, ([longptr.e],Y) goes here\n");
 		
-		temp = register_a;
-		register_a = register_y;
-		register_y = temp;
-		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		break;
+		// unhandled precode handler will catch this
 
-	case EXG_A_LONG:
-		long_address = get_data_memory_byte(register_pc+1) << 8;
-		long_address |= get_data_memory_byte(register_pc+2);
-		temp = get_data_memory_byte(long_address);
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		// standard st8 has this
+		disasm(m, "LDF A, ([longptr.e],Y) goes here\n");
 
-		sprintf((char *)print_buffer, "EXG	 A,%08x\n", long_address);
-		
-		put_data_memory_byte(long_address, register_a);
-		register_a = temp;
-		// increment pc
-		register_pc +=3;
-		inc_sim_time(2);
-		break;
+		// unhandled precode handler will catch this
 
-	// LDF	A,x
-	case LDF_A_FAR:				//0xbc
-		long_address = get_data_memory_byte(register_pc+1) << 16;
-		long_address |= get_data_memory_byte(register_pc+2) << 8;
-		long_address |= get_data_memory_byte(register_pc+3);
+	} else {
+		long_address = OPERAND(m->register_pc+1) << 16;
+		long_address |= OPERAND(m->register_pc+2) << 8;
+		long_address |= OPERAND(m->register_pc+3);
 
-		sprintf((char *)print_buffer, "LDF	 A,%08x\n", long_address);
+		disasm(m, "LDF	 A,(%08x,X)\n", long_address);
 		
-		register_a = get_data_memory_byte(long_address);
-		set_flags(register_a);
-		// increment pc
-		register_pc += 4;
-		inc_sim_time(1);
-		break;
 
-	case LDF_A_REG_IND:			//0xaf
-		if(precode_72) {
-			// not in standard st8
-			short_indirect_address = get_data_memory_byte(register_pc+1) << 8;
-			short_indirect_address |= get_data_memory_byte(register_pc+2);
+		m->register_a = get_data_memory_byte(m, long_address+m->register_x);
+		set_flags(m, m->register_a);	// increment pc
+		m->register_pc += 4;
+	}
+}
 
-			sprintf((char *)print_buffer, "LDF	 A,([%04x],X)\n", short_indirect_address);
-			
-			long_address = get_data_memory_byte(short_indirect_address) << 16;
-			long_address |= get_data_memory_byte(short_indirect_address+1) << 8;
-			long_address |= get_data_memory_byte(short_indirect_address+2);
-			register_a = get_data_memory_byte(long_address+register_x);
-			set_flags(register_a);	// increment pc
-			register_pc += 3;
-			inc_sim_time(1);
-			precode_72 = 0;
-		} else if(precode_90) {
-			// standard st8 has this
-			sprintf((char *)print_buffer, "LDF A, (extoff,Y) goes here\n");
-			
-			// unhandled precode handler will catch this
+// LDF x,A
+template<unsigned int PRECODE_SPACE> void op_ldf_far_a(struct machine *m, unsigned char instruction)
+{
+	unsigned int long_address;
 
-		} else if(precode_91) {
-			// standard st8 has this
-			sprintf((char *)print_buffer, "LDF A, ([longptr.e],Y) goes here\n");
-			
-			// unhandled precode handler will catch this
+	if(PRECODE_SPACE == PRECODE_91) {
+		// standard st8 has this: LDF([xxxx.e,Y),A
+		disasm(m, "LDF [longptr.e], A)  goes here\n");
 
-		} else if(precode_92) {
-			// standard st8 has this
-			sprintf((char *)print_buffer, "LDF A, ([longptr.e],Y) goes here\n");
+		// unhandled precode handler will catch this
 
-			// unhandled precode handler will catch this
+	} else {
+		long_address = OPERAND(m->register_pc+1) << 16;
+		long_address |= OPERAND(m->register_pc+2) << 8;
+		long_address |= OPERAND(m->register_pc+3);
 
-		} else {
-			long_address = get_data_memory_byte(register_pc+1) << 16;
-			long_address |= get_data_memory_byte(register_pc+2) << 8;
-			long_address |= get_data_memory_byte(register_pc+3);
+		disasm(m, "LDF	 %08x,A\n", long_address);
 
-			sprintf((char *)print_buffer, "LDF	 A,(%08x,X)\n", long_address);
-			
+		put_data_memory_byte(m, long_address, m->register_a);
+		set_flags(m, m->register_a);
+		// increment pc
+		m->register_pc += 4;
+	}
+}
 
-			register_a = get_data_memory_byte(long_address+register_x);
-			set_flags(register_a);	// increment pc
-			register_pc += 4;
-			inc_sim_time(1);
-		}
-		break;
+template<unsigned int PRECODE_SPACE> void op_ldf_reg_ind_a(struct machine *m, unsigned char instruction)
+{
+	unsigned int long_address;
+	unsigned short short_indirect_address;
 
-	// LDF x,A
-	case LDF_FAR_A:				//0xbd
-		if(precode_91) {
-			// standard st8 has this: LDF([xxxx.e,Y),A
-			sprintf((char *)print_buffer, "LDF [longptr.e], A)  goes here\n");
+	if(PRECODE_SPACE == PRECODE_72) {
+		// not standard in ST7/8
+		short_indirect_address = OPERAND(m->register_pc+1) << 8;
+		short_indirect_address |= OPERAND(m->register_pc+2);
 
-			// unhandled precode handler will catch this
+		disasm(m, "LDF	([%04x],X),A\n", short_indirect_address);
+		
+		long_address = get_data_memory_byte(m, short_indirect_address) << 16;
+		long_address |= get_data_memory_byte(m, short_indirect_address+1) << 8;
+		long_address |= get_data_memory_byte(m, short_indirect_address+2);
+		put_data_memory_byte(m, long_address+m->register_x, m->register_a);
+		set_flags(m, m->register_a);	// increment pc
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_90) {
+		// standard st8 has this
+		disasm(m, "LDF (extoff,Y), A goes here\n");
 
-		} else {
-			long_address = get_data_memory_byte(register_pc+1) << 16;
-			long_address |= get_data_memory_byte(register_pc+2) << 8;
-			long_address |= get_data_memory_byte(register_pc+3);
+		// unhandled precode handler will catch this
+		
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		// standard st8 has this
+		disasm(m, "LDF ([longptr.e],Y), A goes here\n");
 
-			sprintf((char *)print_buffer, "LDF	 %08x,A\n", long_address);
+		// unhandled precode handler will catch this
+		
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		// standard st8 has this
+		disasm(m, "LDF ([longptr.e],Y), A goes here\n");
+		
+		// unhandled precode handler will catch this
+	
+	} else {
+		long_address = OPERAND(m->register_pc+1) << 16;
+		long_address |= OPERAND(m->register_pc+2) << 8;
+		long_address |= OPERAND(m->register_pc+3);
 
-			put_data_memory_byte(long_address, register_a);
-			set_flags(register_a);
-			// increment pc
-			register_pc += 4;
-			inc_sim_time(1);
-		}
-		break;
+		disasm(m, "LDF	 (%08x,X),A\n", long_address);
+		
+		put_data_memory_byte(m, (long_address+m->register_x), m->register_a );
+		set_flags(m, m->register_a);
+		// increment pc
+		m->register_pc += 4;
+	}
+}
 
-	case LDF_REG_IND_A:			//0xa7
-		if(precode_72) {
-			// not standard in ST7/8
-			short_indirect_address = get_data_memory_byte(register_pc+1) << 8;
-			short_indirect_address |= get_data_memory_byte(register_pc+2);
+template<unsigned int PRECODE_SPACE> void op_mov_long_immed(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
+	unsigned int long_address;
 
-			sprintf((char *)print_buffer, "LDF	([%04x],X),A\n", short_indirect_address);
-			
-			long_address = get_data_memory_byte(short_indirect_address) << 16;
-			long_address |= get_data_memory_byte(short_indirect_address+1) << 8;
-			long_address |= get_data_memory_byte(short_indirect_address+2);
-			put_data_memory_byte(long_address+register_x, register_a);
-			set_flags(register_a);	// increment pc
-			register_pc += 3;
-			inc_sim_time(1);
-			precode_72 = 0;
-		} else if(precode_90) {
-			// standard st8 has this
-			sprintf((char *)print_buffer, "LDF (extoff,Y), A goes here\n");
-
-			// unhandled precode handler will catch this
-			
-		} else if(precode_91) {
-			// standard st8 has this
-			sprintf((char *)print_buffer, "LDF ([longptr.e],Y), A goes here\n");
+	temp = OPERAND(m->register_pc+1);
+	long_address = OPERAND(m->register_pc+2) << 8;
+	long_address |= OPERAND(m->register_pc+3);
+	disasm(m, "MOV	 %08x,#%02x\n", long_address, temp);
+	
+	put_data_memory_byte(m, long_address, temp);
+	// increment pc
+	m->register_pc += 4;
+}
 
-			// unhandled precode handler will catch this
-			
-		} else if(precode_92) {
-			// standard st8 has this
-			sprintf((char *)print_buffer, "LDF ([longptr.e],Y), A goes here\n");
-			
-			// unhandled precode handler will catch this
-		
-		} else {
-			long_address = get_data_memory_byte(register_pc+1) << 16;
-			long_address |= get_data_memory_byte(register_pc+2) << 8;
-			long_address |= get_data_memory_byte(register_pc+3);
+template<unsigned int PRECODE_SPACE> void op_mov_short_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_src_address, short_dst_address;
+	unsigned char temp;
 
-			sprintf((char *)print_buffer, "LDF	 (%08x,X),A\n", long_address);
-			
-			put_data_memory_byte((long_address+register_x), register_a );
-			set_flags(register_a);
-			// increment pc
-			register_pc += 4;
-			inc_sim_time(1);
-		}
-		break;
+	short_src_address = OPERAND(m->register_pc+1) ;
+	short_dst_address = OPERAND(m->register_pc+2);
+	temp = get_data_memory_byte(m, short_src_address);
+	disasm(m, "MOV %02x,%02x (%02x)\n", short_dst_address, short_src_address, temp);
+	
+	put_data_memory_byte(m, short_dst_address, temp);
+	m->register_pc += 3;
+}
 
-	case MOV_LONG_IMMED: // 35
-		temp = get_data_memory_byte(register_pc+1);
-		long_address = get_data_memory_byte(register_pc+2) << 8;
-		long_address |= get_data_memory_byte(register_pc+3);
-		sprintf((char *)print_buffer, "MOV	 %08x,#%02x\n", long_address, temp);
-		
-		put_data_memory_byte(long_address, temp);
-		// increment pc
-		register_pc += 4;
-		inc_sim_time(1);
-		break;
-
-	case MOV_SHORT_SHORT:	// 45
-		short_src_address = get_data_memory_byte(register_pc+1) ;
-		short_dst_address = get_data_memory_byte(register_pc+2);
-		temp = get_data_memory_byte(short_src_address);
-		sprintf((char *)print_buffer, "MOV %02x,%02x (%02x)\n", short_dst_address, short_src_address, temp);
-		
-		put_data_memory_byte(short_dst_address, temp);
-		register_pc += 3;
-		inc_sim_time(2);
-		break;
-
-	case MOV_LONG_LONG:	// 55
-		long_src_address = get_data_memory_byte(register_pc+1) << 8;
-		long_src_address |= get_data_memory_byte(register_pc+2);
-		long_dst_address = get_data_memory_byte(register_pc+3) << 8;
-		long_dst_address |= get_data_memory_byte(register_pc+4);
-		temp = get_data_memory_byte(long_src_address);
-		put_data_memory_byte(long_dst_address, temp);
-		sprintf((char *)print_buffer, "MOV %08x,%08x (%02x)\n", long_dst_address, long_src_address, temp);
-		
-		register_pc += 5;
-		inc_sim_time(2);
-		break;
+template<unsigned int PRECODE_SPACE> void op_mov_long_long(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
+	unsigned int long_src_address, long_dst_address;
+
+	long_src_address = OPERAND(m->register_pc+1) << 8;
+	long_src_address |= OPERAND(m->register_pc+2);
+	long_dst_address = OPERAND(m->register_pc+3) << 8;
+	long_dst_address |= OPERAND(m->register_pc+4);
+	temp = get_data_memory_byte(m, long_src_address);
+	put_data_memory_byte(m, long_dst_address, temp);
+	disasm(m, "MOV %08x,%08x (%02x)\n", long_dst_address, long_src_address, temp);
+	
+	m->register_pc += 5;
+}
 
-	case OPCODE_0x65:
-		sprintf((char *)print_buffer, "*** Unimplemented opcode @ %08x - %02x (DIVW)\n", register_pc, instruction);
-		
-		register_pc++;
-		inc_sim_time(2);
-		running = 0;
-		break;
+template<unsigned int PRECODE_SPACE> void op_opcode_0x65(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "*** Unimplemented opcode @ %08x - %02x (DIVW)\n", m->register_pc, instruction);
+	
+	m->register_pc++;
+	m->running = 0;
+}
 
-	case OPCODE_0x75:
-		sprintf((char *)print_buffer, "*** Unimplemented opcode @ %08x - %02x\n", register_pc, instruction);
-		
-		register_pc++;
-		inc_sim_time(2);
-		running = 0;
-		break;
+template<unsigned int PRECODE_SPACE> void op_opcode_0x75(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "*** Unimplemented opcode @ %08x - %02x\n", m->register_pc, instruction);
+	
+	m->register_pc++;
+	m->running = 0;
+}
 
 /*
-	case OPCODE_0x19:
-		// on ST8 this is ADC A.(shortoff,SP) on ours it is like ST7 -> BRES_4
-		sprintf((char *)print_buffer, "*** Unimplemented opcode @ %08x - %02x\n", register_pc, instruction);
-		
-		sprintf((char *)print_buffer, "ST8 -> ADC A.(shortoff,SP)\n");
-		
-		register_pc++;
-		inc_sim_time(2);
-		running =0;
-		break;
+case OPCODE_0x19:
+	// on ST8 this is ADC A.(shortoff,SP) on ours it is like ST7 -> BRES_4
+	disasm("*** Unimplemented opcode @ %08x - %02x\n", register_pc, instruction);
+	
+	disasm("ST8 -> ADC A.(shortoff,SP)\n");
+	
+	register_pc++;
+	inc_sim_time(2);
+	running =0;
+	break;
 */
-	case HALT:
-		sprintf((char *)print_buffer, "HALT\n");
-		
-		register_cc &= ~(INTERRUPT_MASK_L0_BIT|INTERRUPT_MASK_L1_BIT);
-		inc_sim_time(2);
-		running = 0;
+template<unsigned int PRECODE_SPACE> void op_halt(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "HALT\n");
+	
+	m->register_cc &= ~(INTERRUPT_MASK_L0_BIT|INTERRUPT_MASK_L1_BIT);
+	m->running = 0;
 //		while(1)
 //			;
-		break;
+}
 
-	case ADD_SP:	//					0x5b
-		// custom non-st7/8 implementation
-		temp = get_data_memory_byte(register_pc+1);
-		sprintf((char *)print_buffer, "LD  X:A,SP\n");
-		
-		register_x = (register_sp >> 8) & 0xff;
-		register_a = register_sp & 0xff;
-		// increment pc
-		register_pc += 1;
-		inc_sim_time(2);
-		break;
+template<unsigned int PRECODE_SPACE> void op_add_sp(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
 
-	case RSP:
-		sprintf((char *)print_buffer, "RSP\n");
-		
-		register_sp = SP_INITIAL_VALUE;
-		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		break;
-
-	case LDW_SP_X:
-		// this is non standard - this is BREAK on the ST8
-		long_address = register_x << 8;
-		long_address |= register_a;
-		sprintf((char *)print_buffer, "LDW	SP,X:A (%04x)\n", long_address);
-		
-		register_sp = long_address;
-		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		break;
+	// custom non-st7/8 implementation
+	temp = OPERAND(m->register_pc+1);
+	disasm(m, "LD  X:A,SP\n");
+	
+	m->register_x = (m->register_sp >> 8) & 0xff;
+	m->register_a = m->register_sp & 0xff;
+	// increment pc
+	m->register_pc += 1;
+}
 
-	case DIV:
-		sprintf((char *)print_buffer, "DIV X,A\n");
-		
-		div();
-		inc_sim_time(17);
-		// increment pc
-		register_pc++;
-		break;
+template<unsigned int PRECODE_SPACE> void op_rsp(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "RSP\n");
+	
+	m->register_sp = SP_INITIAL_VALUE;
+	// increment pc
+	m->register_pc++;
+}
 
-	case MUL:
-	case MUL1:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "MUL Y,A\n");
-			
-			multiply_result = register_y*register_a;
-			register_y = (unsigned char)(multiply_result >> 8);
-			register_a = (unsigned char)(multiply_result & 0x00ff);
-			inc_sim_time(12);
-			precode_90 = 0;
+template<unsigned int PRECODE_SPACE> void op_ldw_sp_x(struct machine *m, unsigned char instruction)
+{
+	unsigned int long_address;
 
-		} else {
-			sprintf((char *)print_buffer, "MUL X,A\n");
-			
-			multiply_result = register_x*register_a;
-			register_x = (unsigned char)(multiply_result >> 8);
-			register_a = (unsigned char)(multiply_result & 0x00ff);
-			inc_sim_time(11);
+	// this is non standard - this is BREAK on the ST8
+	long_address = m->register_x << 8;
+	long_address |= m->register_a;
+	disasm(m, "LDW	SP,X:A (%04x)\n", long_address);
+	
+	m->register_sp = long_address;
+	// increment pc
+	m->register_pc++;
+}
 
-		}
-		register_cc &= ~CARRY_BIT;
-		register_cc &= ~HALF_CARRY_BIT;
-		// increment pc
-		register_pc++;
-		break;
+template<unsigned int PRECODE_SPACE> void op_div(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "DIV X,A\n");
+	
+	div(m);
+	// increment pc
+	m->register_pc++;
+}
 
-	case RCF:
-		sprintf((char *)print_buffer, "RCF\n");
-		
-		register_cc &= ~CARRY_BIT;
-		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		break;
+template<unsigned int PRECODE_SPACE> void op_mul(struct machine *m, unsigned char instruction)
+{
+	unsigned int multiply_result;
 
-	case SCF:
-		sprintf((char *)print_buffer, "SCF\n");
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "MUL Y,A\n");
 		
-		register_cc |= CARRY_BIT;
-		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		break;
-
-	case CCF:
-		sprintf((char *)print_buffer, "CCF\n");
+		multiply_result = m->register_y*m->register_a;
+		m->register_y = (unsigned char)(multiply_result >> 8);
+		m->register_a = (unsigned char)(multiply_result & 0x00ff);
+	} else {
+		disasm(m, "MUL X,A\n");
 		
-		if(register_cc & CARRY_BIT) {
-			register_cc &= ~CARRY_BIT;
-		} else {
-			register_cc |= CARRY_BIT;
-		}
-		// increment pc
-		register_pc++;
-		inc_sim_time(3);
-		break;
+		multiply_result = m->register_x*m->register_a;
+		m->register_x = (unsigned char)(multiply_result >> 8);
+		m->register_a = (unsigned char)(multiply_result & 0x00ff);
+	}
+	m->register_cc &= ~CARRY_BIT;
+	m->register_cc &= ~HALF_CARRY_BIT;
+	// increment pc
+	m->register_pc++;
+}
 
-	case RIM:
-		sprintf((char *)print_buffer, "RIM\n");
-		
-		register_cc &= ~(INTERRUPT_MASK_L0_BIT|INTERRUPT_MASK_L1_BIT);
-		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		break;
+template<unsigned int PRECODE_SPACE> void op_rcf(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "RCF\n");
+	
+	m->register_cc &= ~CARRY_BIT;
+	// increment pc
+	m->register_pc++;
+}
 
-	case SIM:
-		sprintf((char *)print_buffer, "SIM\n");
-		
-		register_cc |= (INTERRUPT_MASK_L0_BIT|INTERRUPT_MASK_L1_BIT);
-		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		break;
-
-	case BRES_0:	// 0x11
-	case BRES_1:	// 0x13
-	case BRES_2:	// 0x15
-	case BRES_3:	// 0x17
-	case BRES_4:	// 0x19
-	case BRES_5:	// 0x1b
-	case BRES_6:	// 0x1d
-	case BRES_7:	// 0x1f
-		if(precode_90) {
-			// st8 this is BCCM #xxx,#x Copy Carry Bit to Memory
-			bit = get_data_memory_byte(register_pc);
-			bit = (bit & 0x0f) / 2;
-			bit--;
-			
-			long_address = get_data_memory_byte(register_pc+1) << 8;
-			long_address |= get_data_memory_byte(register_pc+2);
+template<unsigned int PRECODE_SPACE> void op_scf(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "SCF\n");
+	
+	m->register_cc |= CARRY_BIT;
+	// increment pc
+	m->register_pc++;
+}
 
-			sprintf((char *)print_buffer, "BCCM %04x,#%d\n", long_address, bit);
-			
-			temp = get_data_memory_byte(long_address);
-			temp &= ~(1 << bit);	// clear the target bit
-			temp |= (register_cc & CARRY_BIT) << bit;	// move carry bit to correct bit position
-			put_data_memory_byte(long_address, temp);
-
-			// inc pc
-			register_pc += 2;
-			inc_sim_time(1);
-			precode_90 = 0;
-		} else if(precode_92) {
-			// st7 this is "BRES [short]
-			sprintf((char *)print_buffer, "BRES [short] (st7) goes here\n");
-
-			// unhandled precode will catch this
-
-		} else if(precode_72) {
-			// like the ST8, we have this
-			bit = (instruction & 0x0f) / 2;
-			
-			long_address = get_data_memory_byte(register_pc+1) << 8;
-			long_address |= get_data_memory_byte(register_pc+2);
+template<unsigned int PRECODE_SPACE> void op_ccf(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "CCF\n");
+	
+	if(m->register_cc & CARRY_BIT) {
+		m->register_cc &= ~CARRY_BIT;
+	} else {
+		m->register_cc |= CARRY_BIT;
+	}
+	// increment pc
+	m->register_pc++;
+}
 
-			sprintf((char *)print_buffer, "BRES %04x,#%d\n", long_address, bit);
-			
-			inc_sim_time(5);
+template<unsigned int PRECODE_SPACE> void op_rim(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "RIM\n");
+	
+	m->register_cc &= ~(INTERRUPT_MASK_L0_BIT|INTERRUPT_MASK_L1_BIT);
+	// increment pc
+	m->register_pc++;
+}
 
-			precode_72 = 0;
+template<unsigned int PRECODE_SPACE> void op_sim(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "SIM\n");
+	
+	m->register_cc |= (INTERRUPT_MASK_L0_BIT|INTERRUPT_MASK_L1_BIT);
+	// increment pc
+	m->register_pc++;
+}
 
-			temp = get_data_memory_byte(long_address);	
-			temp &= ~1 << bit;
-			put_data_memory_byte(long_address, temp);
+template<unsigned int PRECODE_SPACE> void op_bres(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address;
+	unsigned char temp;
+	unsigned int long_address;
+	unsigned int bit;
 
-			// inc pc
-			register_pc += 3;
-		} else {
-			// st7 has this, we have this too
-			bit = (instruction & 0x0f) / 2;
+	if(PRECODE_SPACE == PRECODE_90) {
+		// st8 this is BCCM #xxx,#x Copy Carry Bit to Memory
+		bit = instruction;							// the bit number is in the opcode
+		bit = (bit & 0x0f) / 2;
+		bit--;
+		
+		long_address = OPERAND(m->register_pc+1) << 8;
+		long_address |= OPERAND(m->register_pc+2);
 
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "BRES %02x,#%d\n", short_address, bit);
-			
-			inc_sim_time(5);
+		disasm(m, "BCCM %04x,#%d\n", long_address, bit);
+		
+		temp = get_data_memory_byte(m, long_address);
+		temp &= ~(1 << bit);	// clear the target bit
+		temp |= (m->register_cc & CARRY_BIT) << bit;	// move carry bit to correct bit position
+		put_data_memory_byte(m, long_address, temp);
 
-			temp = get_data_memory_byte(short_address);
-			temp &= ~1 << bit;
-			put_data_memory_byte(short_address, temp);
+		// inc pc
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		// st7 this is "BRES [short]
+		disasm(m, "BRES [short] (st7) goes here\n");
 
-			// inc pc
-			register_pc += 2;
-		}
-		break;
-
-	case BSET_0:	// 0x10
-	case BSET_1:	// 0x12
-	case BSET_2:	// 0x14
-	case BSET_3:	// 0x16
-	case BSET_4:	// 0x18
-	case BSET_5:	// 0x1a
-	case BSET_6:	// 0x1c
-	case BSET_7:	// 0x1e
-		if(precode_90) {
-			// st8 this is BCPL #xxx,#x Bit complement
-			bit = get_data_memory_byte(register_pc);
-			bit = (bit & 0x0f) / 2;
-			
-			long_address = get_data_memory_byte(register_pc+1) << 8;
-			long_address |= get_data_memory_byte(register_pc+2);
+		// unhandled precode will catch this
 
-			sprintf((char *)print_buffer, "BCPL %04x,#%d\n", long_address, bit);
-			
-			temp = get_data_memory_byte(long_address);
-			bit_mask = (1 << bit);
-			if(temp & bit_mask) {
-				// bit is a 1, make it a 0
-				temp &= ~bit_mask;
-			} else {
-				// bit is a 0, make it a 1
-				temp |= bit_mask;
-			}
+	} else if(PRECODE_SPACE == PRECODE_72) {
+		// like the ST8, we have this
+		bit = (instruction & 0x0f) / 2;
+		
+		long_address = OPERAND(m->register_pc+1) << 8;
+		long_address |= OPERAND(m->register_pc+2);
 
-			put_data_memory_byte(long_address, temp);
+		disasm(m, "BRES %04x,#%d\n", long_address, bit);
 
-			// inc pc
-			register_pc += 2;
-			inc_sim_time(1);
-			precode_90 = 0;
-		} else if(precode_92) {
-			// st7 this is "BSET [short]
-			sprintf((char *)print_buffer, "BSET [short] (st7)\n");
+		temp = get_data_memory_byte(m, long_address);	
+		temp &= ~1 << bit;
+		put_data_memory_byte(m, long_address, temp);
 
-			// unhandled precode handler will catch this
+		// inc pc
+		m->register_pc += 3;
+	} else {
+		// st7 has this, we have this too
+		bit = (instruction & 0x0f) / 2;
 
-		} else if(precode_72) {
-			// like the ST8, we have this
-			bit = (instruction & 0x0f) / 2;
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "BRES %02x,#%d\n", short_address, bit);
 
-			long_address = get_data_memory_byte(register_pc+1) << 8;
-			long_address |= get_data_memory_byte(register_pc+2);
+		temp = get_data_memory_byte(m, short_address);
+		temp &= ~1 << bit;
+		put_data_memory_byte(m, short_address, temp);
 
-			sprintf((char *)print_buffer, "BSET %04x,#%d\n", long_address, bit);
-			
-			inc_sim_time(5);
+		// inc pc
+		m->register_pc += 2;
+	}
+}
 
-			precode_72 = 0;
+template<unsigned int PRECODE_SPACE> void op_bset(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address;
+	unsigned char temp, bit_mask;
+	unsigned int long_address;
+	unsigned int bit;
 
-			temp = get_data_memory_byte(long_address);	
-			temp |= 1 << bit;
-			put_data_memory_byte(long_address, temp);
+	if(PRECODE_SPACE == PRECODE_90) {
+		// st8 this is BCPL #xxx,#x Bit complement
+		bit = instruction;							// the bit number is in the opcode
+		bit = (bit & 0x0f) / 2;
+		
+		long_address = OPERAND(m->register_pc+1) << 8;
+		long_address |= OPERAND(m->register_pc+2);
 
-			// inc pc
-			register_pc += 3;
+		disasm(m, "BCPL %04x,#%d\n", long_address, bit);
 		
-		}  else {
-			// st7 has this, we have this too
-			bit = (instruction & 0x0f) / 2;
+		temp = get_data_memory_byte(m, long_address);
+		bit_mask = (1 << bit);
+		if(temp & bit_mask) {
+			// bit is a 1, make it a 0
+			temp &= ~bit_mask;
+		} else {
+			// bit is a 0, make it a 1
+			temp |= bit_mask;
+		}
 
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "BSET %02x,#%d\n", short_address, bit);
-			
-			inc_sim_time(5);
-
-			temp = get_data_memory_byte(short_address);	
-			temp |= 1 << bit;
-			put_data_memory_byte(short_address, temp);
-
-			// inc pc
-			register_pc += 2;
-		}
-		break;
-
-	case BTJF_0:
-	case BTJF_1:
-	case BTJF_2:
-	case BTJF_3:
-	case BTJF_4:
-	case BTJF_5:
-	case BTJF_6:
-	case BTJF_7:
-		bit = (instruction & 0x0f) / 2;
-		if(precode_72) {
-			long_address = get_data_memory_byte(register_pc+1) << 8;
-			long_address |= get_data_memory_byte(register_pc+2);
-			displacement = get_data_memory_byte(register_pc+3);
-			if(displacement & 0x0080) {
-				displacement |= 0xff00;
-			}
-
-			// inc pc
-			register_pc += 4;
-
-			temp = get_data_memory_byte(long_address);
-			if((temp & (1 << bit)) == 0) {
-				register_pc += displacement;
-				register_cc &= ~CARRY_BIT;
-				sprintf((char *)print_buffer, "BTJF %08x,#%d,%d EA=%04x (Branch Taken)\n", long_address, bit, displacement, register_pc);
-			} else {
-				register_cc |= CARRY_BIT;
-				sprintf((char *)print_buffer, "BTJF %08x,#%d,%d (Branch NOT Taken)\n", long_address, bit, displacement);
-			}
-			precode_72 = 0;
-		} else {
-			displacement = get_data_memory_byte(register_pc+2);
-			if(displacement & 0x0080) {
-				displacement |= 0xff00;
-			}
-			short_address = get_data_memory_byte(register_pc+1);
+		put_data_memory_byte(m, long_address, temp);
 
-			inc_sim_time(5);
+		// inc pc
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		// st7 this is "BSET [short]
+		disasm(m, "BSET [short] (st7)\n");
 
-			// inc pc
-			register_pc += 3;
+		// unhandled precode handler will catch this
 
-			temp = get_data_memory_byte(short_address);
-			if((temp & (1 << bit)) == 0) {
-				register_pc += displacement;
-				register_cc &= ~CARRY_BIT;
-				sprintf((char *)print_buffer, "BTJF %02x,#%d,%d EA=%04x (Branch Taken)\n", short_address, bit, displacement, register_pc);
-			} else {
-				register_cc |= CARRY_BIT;
-				sprintf((char *)print_buffer, "BTJF %02x,#%d,%d (Branch NOT Taken)\n", short_address, bit, displacement);
-			}
-		}
-		break;
-
-	case BTJT_0:
-	case BTJT_1:
-	case BTJT_2:
-	case BTJT_3:
-	case BTJT_4:
-	case BTJT_5:
-	case BTJT_6:
-	case BTJT_7:
+	} else if(PRECODE_SPACE == PRECODE_72) {
+		// like the ST8, we have this
 		bit = (instruction & 0x0f) / 2;
 
-		if(precode_72) {
-			long_address = get_data_memory_byte(register_pc+1) << 8;
-			long_address |= get_data_memory_byte(register_pc+2);
-			displacement = get_data_memory_byte(register_pc+3);
-			if(displacement & 0x0080) {
-				displacement |= 0xff00;
-			}
-
-			// inc pc
-			register_pc += 4;
-
-			temp = get_data_memory_byte(long_address);
-			if((temp & (1 << bit))) {
-				register_pc += displacement;
-				register_cc |= CARRY_BIT;
-				sprintf((char *)print_buffer, "BTJT %08x,#%d,%d EA=%04x (Branch Taken)\n", long_address, bit, displacement, register_pc);
-			} else {
-				register_cc &= ~CARRY_BIT;
-				sprintf((char *)print_buffer, "BTJT %08x,#%d,%d (Branch NOT Taken)\n", long_address, bit, displacement);
-			}
-			precode_72 = 0;
-		} else {
-			displacement = get_data_memory_byte(register_pc+2);
-			if(displacement & 0x0080) {
-				displacement |= 0xff00;
-			}
-			short_address = get_data_memory_byte(register_pc+1);
-			
-			inc_sim_time(5);
-
-			// inc pc
-			register_pc += 3;
-
-			temp = get_data_memory_byte(short_address);
-			if((temp & (1 << bit))) {
-				register_pc += displacement;
-				register_cc |= CARRY_BIT;
-				sprintf((char *)print_buffer, "BTJT %02x,#%d,%d EA=%04x (Branch Taken)\n", short_address, bit, displacement, register_pc);
-				
-			} else {
-				register_cc &= ~CARRY_BIT;
-				sprintf((char *)print_buffer, "BTJT %02x,#%d,%d (Branch NOT Taken)\n", short_address, bit, displacement);
-			}
-		}
-		break;
-
-	// JR's
-	case JRC:
-	case JREQ:
-	case JRF:
-	case JRH:
-	case JRIH:
-	case JRIL:
-	case JRM:
-	case JRMI:
-	case JRNC:
-	case JRNE:
-	case JRNH:
-	case JRNM:
-	case JRPL:
-	case JRUGT:
-	case JRULE:
-		inc_sim_time(5);
-
-		switch(instruction) {
-
-		case JRC:
-			if(register_cc & CARRY_BIT) {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
-				register_pc += 2;
-				register_pc += displacement;
-
-				sprintf((char *)print_buffer, "JRC %04x (Branch Taken)\n", register_pc);
-			} else {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
-				// increment pc
-				register_pc += 2;
-				sprintf((char *)print_buffer, "JRC %04x (Branch NOT Taken)\n", register_pc+displacement);
-			}
-			break;
-
-		case JREQ:
-			if(register_cc & ZERO_BIT) {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
-				register_pc += 2;
-				register_pc += displacement;
-				sprintf((char *)print_buffer, "JREQ %04x (Branch Taken)\n", register_pc);
-			} else {
-				// increment pc
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
-				register_pc += 2;
-				sprintf((char *)print_buffer, "JREQ %04x (Branch NOT Taken)\n", register_pc+displacement);
-			}
-			break;
-
-		case JRF:
-			displacement = get_data_memory_byte(register_pc+1);
-			if(displacement & 0x0080) {
-				displacement |= 0xff00;
-			}
-			register_pc += 2;
-//			register_pc += displacement;	// never jump!
-			sprintf((char *)print_buffer, "JRF %04x (Branch NOT Taken)\n", register_pc+displacement);
-			break;
-
-		case JRH:
-			if(register_cc & HALF_CARRY_BIT) {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
-				register_pc += 2;
-				register_pc += displacement;
-				sprintf((char *)print_buffer, "JRH %04x (Branch Taken)\n", register_pc);
-				
-			} else {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
-				// increment pc
-				register_pc += 2;
-				sprintf((char *)print_buffer, "JRH %04x (Branch NOT Taken)\n", register_pc+displacement);
-			}
-			break;
+		long_address = OPERAND(m->register_pc+1) << 8;
+		long_address |= OPERAND(m->register_pc+2);
 
-		case JRIH:
-			// this is not implemented verbatim, we have no interrupt line so alway take the jump for now
-			displacement = get_data_memory_byte(register_pc+1);
-			if(displacement & 0x0080) {
-				displacement |= 0xff00;
-			}
-			register_pc += 2;
-			register_pc += displacement;
-			sprintf((char *)print_buffer, "JRIH %04x (Branch Taken)\n", register_pc);
-			break;
+		disasm(m, "BSET %04x,#%d\n", long_address, bit);
 
-		case JRIL:
-			// this is not implemented verbatim, we have no interrupt line so alway take the jump for now
-			displacement = get_data_memory_byte(register_pc+1);
-			if(displacement & 0x0080) {
-				displacement |= 0xff00;
-			}
-			register_pc += 2;
-			register_pc += displacement;
-			sprintf((char *)print_buffer, "JRIL %04x (Branch Taken)\n", register_pc);
-			
-			break;
+		temp = get_data_memory_byte(m, long_address);	
+		temp |= 1 << bit;
+		put_data_memory_byte(m, long_address, temp);
 
-		case JRM:
-			if(register_cc & (INTERRUPT_MASK_L0_BIT|INTERRUPT_MASK_L1_BIT)) {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
-				register_pc += 2;
-				register_pc += displacement;
-				sprintf((char *)print_buffer, "JRM %04x (Branch Taken)\n", register_pc);
-			} else {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
+		// inc pc
+		m->register_pc += 3;
+	
+	}  else {
+		// st7 has this, we have this too
+		bit = (instruction & 0x0f) / 2;
 
-				// increment pc
-				register_pc += 2;
-				sprintf((char *)print_buffer, "JRM %04x (Branch NOT Taken)\n", register_pc+displacement);
-			}
-			break;
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "BSET %02x,#%d\n", short_address, bit);
 
-		case JRMI:
-			if(register_cc & NEGATIVE_BIT) {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
-				register_pc += 2;
-				register_pc += displacement;
-				sprintf((char *)print_buffer, "JRMI %04x (Branch Taken)\n", register_pc);
-			} else {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
+		temp = get_data_memory_byte(m, short_address);	
+		temp |= 1 << bit;
+		put_data_memory_byte(m, short_address, temp);
 
-				// increment pc
-				register_pc += 2;
-				sprintf((char *)print_buffer, "JRMI %04x (Branch NOT Taken)\n", register_pc+displacement);
-			}
-			break;
+		// inc pc
+		m->register_pc += 2;
+	}
+}
 
-		case JRNC:
-			if((register_cc & CARRY_BIT) == 0) {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
-				register_pc += 2;
-				register_pc += displacement;
-				sprintf((char *)print_buffer, "JRNC %04x (Branch Taken)\n", register_pc);
-			} else {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
+template<unsigned int PRECODE_SPACE> void op_btjf(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address;
+	unsigned char temp;
+	unsigned int long_address;
+	unsigned int bit;
+	short displacement;
 
-				// increment pc
-				register_pc += 2;
-				sprintf((char *)print_buffer, "JRNC %04x (Branch NOT Taken)\n", register_pc+displacement);
-			}
-			break;
+	bit = (instruction & 0x0f) / 2;
+	if(PRECODE_SPACE == PRECODE_72) {
+		long_address = OPERAND(m->register_pc+1) << 8;
+		long_address |= OPERAND(m->register_pc+2);
+		displacement = OPERAND(m->register_pc+3);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
+		}
 
-		case JRNE:
-			if((register_cc & ZERO_BIT) == 0) {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
-				register_pc += 2;
-				register_pc += displacement;
-				sprintf((char *)print_buffer, "JRNE %04x (Branch Taken)\n", register_pc);
-			} else {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
+		// inc pc
+		m->register_pc += 4;
 
-				// increment pc
-				register_pc += 2;
-				sprintf((char *)print_buffer, "JRNE %04x (Branch NOT Taken)\n", register_pc+displacement);
-			}
-			break;
+		temp = get_data_memory_byte(m, long_address);
+		if((temp & (1 << bit)) == 0) {
+			m->register_pc += displacement;
+			m->register_cc &= ~CARRY_BIT;
+			branch_taken(m);
+			disasm_branch(m, DECODE_TAKEN, "BTJF %08x,#%d,%d EA=%04x (Branch Taken)\n", long_address, bit, displacement, m->register_pc);
+		} else {
+			m->register_cc |= CARRY_BIT;
+			disasm_branch(m, DECODE_NOT_TAKEN, "BTJF %08x,#%d,%d (Branch NOT Taken)\n", long_address, bit, displacement);
+		}
+	} else {
+		displacement = OPERAND(m->register_pc+2);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
+		}
+		short_address = OPERAND(m->register_pc+1);
 
-		case JRNH:
-			if((register_cc & HALF_CARRY_BIT) == 0) {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
-				register_pc += 2;
-				register_pc += displacement;	
-				sprintf((char *)print_buffer, "JRNH %04x (Branch Taken)\n", register_pc);
-			} else {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
+		// inc pc
+		m->register_pc += 3;
 
-				// increment pc
-				register_pc += 2;
-				sprintf((char *)print_buffer, "JRNH %04x (Branch NOT Taken)\n", register_pc+displacement);
-			}
-			break;
+		temp = get_data_memory_byte(m, short_address);
+		if((temp & (1 << bit)) == 0) {
+			m->register_pc += displacement;
+			m->register_cc &= ~CARRY_BIT;
+			branch_taken(m);
+			disasm_branch(m, DECODE_TAKEN, "BTJF %02x,#%d,%d EA=%04x (Branch Taken)\n", short_address, bit, displacement, m->register_pc);
+		} else {
+			m->register_cc |= CARRY_BIT;
+			disasm_branch(m, DECODE_NOT_TAKEN, "BTJF %02x,#%d,%d (Branch NOT Taken)\n", short_address, bit, displacement);
+		}
+	}
+}
 
-		case JRNM:
-			if((register_cc & (INTERRUPT_MASK_L0_BIT|INTERRUPT_MASK_L1_BIT)) == 0) {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
-				register_pc += 2;
-				register_pc += displacement;
-				sprintf((char *)print_buffer, "JRNM %04x (Branch Taken)\n", register_pc);
-				
-			} else {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
-				// increment pc
-				register_pc += 2;
-				sprintf((char *)print_buffer, "JRNM %04x (Branch NOT Taken)\n", register_pc+displacement);
-				
-			}
+template<unsigned int PRECODE_SPACE> void op_btjt(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address;
+	unsigned char temp;
+	unsigned int long_address;
+	unsigned int bit;
+	short displacement;
 
-			break;
+	bit = (instruction & 0x0f) / 2;
 
-		case JRPL:
-			if((register_cc & NEGATIVE_BIT) == 0) {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
-				register_pc += 2;
-				register_pc += displacement;
-
-				sprintf((char *)print_buffer, "JRPL %04x (Branch Taken)\n", register_pc);
-				
-			} else {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
-				// increment pc
-				register_pc += 2;
-				sprintf((char *)print_buffer, "JRPL %04x (Branch NOT Taken)\n", register_pc+ displacement);
-				
-			}
-			break;
+	if(PRECODE_SPACE == PRECODE_72) {
+		long_address = OPERAND(m->register_pc+1) << 8;
+		long_address |= OPERAND(m->register_pc+2);
+		displacement = OPERAND(m->register_pc+3);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
+		}
 
-		case JRUGT:
-			if(((register_cc & CARRY_BIT) | (register_cc & ZERO_BIT)) == 0) {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
-				register_pc += 2;
-				register_pc += displacement;
-				sprintf((char *)print_buffer, "JRUGT %04x (Branch Taken)\n", register_pc);
-				
-			} else {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
-				// increment pc
-				register_pc += 2;
-				sprintf((char *)print_buffer, "JRUGT %04x (Branch NOT Taken)\n", register_pc+ displacement);
-				
-			}
-			break;
+		// inc pc
+		m->register_pc += 4;
 
-		case JRULE:
-			if(((register_cc & CARRY_BIT) || (register_cc & ZERO_BIT))) {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
-				register_pc += 2;
-				register_pc += displacement;
-				sprintf((char *)print_buffer, "JRULE %04x (Branch Taken)\n", register_pc);
-				
-			} else {
-				displacement = get_data_memory_byte(register_pc+1);
-				if(displacement & 0x0080) {
-					displacement |= 0xff00;
-				}
-				// increment pc
-				register_pc += 2;
-				sprintf((char *)print_buffer, "JRULE %04x (Branch NOT Taken)\n", register_pc+displacement);
-				
-			}
-			break;
+		temp = get_data_memory_byte(m, long_address);
+		if((temp & (1 << bit))) {
+			m->register_pc += displacement;
+			m->register_cc |= CARRY_BIT;
+			branch_taken(m);
+			disasm_branch(m, DECODE_TAKEN, "BTJT %08x,#%d,%d EA=%04x (Branch Taken)\n", long_address, bit, displacement, m->register_pc);
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+			disasm_branch(m, DECODE_NOT_TAKEN, "BTJT %08x,#%d,%d (Branch NOT Taken)\n", long_address, bit, displacement);
 		}
-		break;
-
-	case JRA:	// samae as JRT
-		displacement = get_data_memory_byte(register_pc+1);
+	} else {
+		displacement = OPERAND(m->register_pc+2);
 		if(displacement & 0x0080) {
 			displacement |= 0xff00;
 		}
-		register_pc += 2;
-		register_pc += displacement;
-		sprintf((char *)print_buffer, "JRA %04x (Branch Taken)\n", register_pc);
-		inc_sim_time(3);
-		break;
-
-
-	case JP_LONG:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			dest = get_data_memory_byte(indirect_address) << 8;
-			dest |= get_data_memory_byte(indirect_address+1);
-			register_pc &= 0xffff0000;
-			register_pc |= dest;
-			sprintf((char *)print_buffer, "JP [%02x.w]=%04x : pc=%08x\n", indirect_address, dest, register_pc);
-			inc_sim_time(5);
-			precode_92 = 0;
+		short_address = OPERAND(m->register_pc+1);
 
-		} else {
-			dest = get_data_memory_byte(register_pc+1) << 8;
-			dest |= get_data_memory_byte(register_pc+2);
-			register_pc &= 0xffff0000;
-			register_pc |= dest;
-			sprintf((char *)print_buffer, "JP %04x : pc=%08x\n", dest, register_pc);
-			inc_sim_time(3);
-		}
-		break;
-
-	case JP_FAR:
-		if(precode_92) {
-			short_indirect_address = get_data_memory_byte(register_pc+1) << 8;
-			short_indirect_address |= get_data_memory_byte(register_pc+2);
-			dest = get_data_memory_byte(short_indirect_address) << 16;
-			dest |= get_data_memory_byte(short_indirect_address+1) << 8;
-			dest |= get_data_memory_byte(short_indirect_address+1);
-			register_pc = dest;
-			sprintf((char *)print_buffer, "JPF [%04x.w]=%08x : pc=%08x\n", short_indirect_address, dest, register_pc);
-			inc_sim_time(6);
-			precode_92 = 0;
+		// inc pc
+		m->register_pc += 3;
 
+		temp = get_data_memory_byte(m, short_address);
+		if((temp & (1 << bit))) {
+			m->register_pc += displacement;
+			m->register_cc |= CARRY_BIT;
+			branch_taken(m);
+			disasm_branch(m, DECODE_TAKEN, "BTJT %02x,#%d,%d EA=%04x (Branch Taken)\n", short_address, bit, displacement, m->register_pc);
+			
 		} else {
-			dest = get_data_memory_byte(register_pc+1) << 16;
-			dest |= get_data_memory_byte(register_pc+2) << 8;
-			dest |= get_data_memory_byte(register_pc+3);
-			register_pc = dest;
-			sprintf((char *)print_buffer, "JPF %04x : pc=%08x\n", dest, register_pc);
-			inc_sim_time(2);
+			m->register_cc &= ~CARRY_BIT;
+			disasm_branch(m, DECODE_NOT_TAKEN, "BTJT %02x,#%d,%d (Branch NOT Taken)\n", short_address, bit, displacement);
 		}
-		break;
-
-	case JP_REG_IND:
-		if(precode_90) {
-			// (Y)
-			dest = register_y;
-			register_pc &= 0xffff0000;
-			register_pc |= dest;
-			sprintf((char *)print_buffer, "JP (Y)=%04x : pc=%08x\n", dest, register_pc);
-			inc_sim_time(3);
-			precode_90 = 0;
+	}
+}
 
-		} else {
-			// (X)
-			dest = register_x;
-			register_pc &= 0xffff0000;
-			register_pc |= dest;
-			sprintf((char *)print_buffer, "JP (X)=%04x : pc=%08x\n", dest, register_pc);
-			inc_sim_time(2);
+// JR's
+template<unsigned int PRECODE_SPACE> void op_jrc(struct machine *m, unsigned char instruction)
+{
+	short displacement;
 
+	if(m->register_cc & CARRY_BIT) {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
 		}
-		break;
-
-	case JP_REG_IND_OFF_SHORT:
-		if(precode_90) {
-			// (short,Y)
-			short_address = get_data_memory_byte(register_pc+1);
-		
-			temp = register_y;
-
-			dest = short_address;
-			dest += temp;
-		
-			register_pc &= 0xffff0000;
-			register_pc |= dest;
-
-			sprintf((char *)print_buffer, "JP (%02x,Y)=%04x : pc=%08x\n", short_address, dest, register_pc);
+		m->register_pc += 2;
+		m->register_pc += displacement;
 
-			inc_sim_time(3);
-			precode_90 = 0;
-
-		} else if(precode_92) {
-			// ([short],X)
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			
-			temp = register_x;
-			dest = short_address;
-			dest += temp;
-		
-			register_pc &= 0xffff0000;
-			register_pc |= dest;
-
-			sprintf((char *)print_buffer, "JP ([%02x],X)=%04x : pc=%08x\n", indirect_address, dest, register_pc);
+		branch_taken(m);
+		disasm_branch(m, DECODE_TAKEN, "JRC %04x (Branch Taken)\n", m->register_pc);
+	} else {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
+		}
+		// increment pc
+		m->register_pc += 2;
+		disasm_branch(m, DECODE_NOT_TAKEN, "JRC %04x (Branch NOT Taken)\n", m->register_pc+displacement);
+	}
+}
 
-			inc_sim_time(5);
-			precode_92 = 0;
+template<unsigned int PRECODE_SPACE> void op_jreq(struct machine *m, unsigned char instruction)
+{
+	short displacement;
 
-		} else if(precode_91) {
-			// ([short],Y)
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			
-			temp = register_y;
-			dest = short_address;
-			dest += temp;
-		
-			register_pc &= 0xffff0000;
-			register_pc |= dest;
+	if(m->register_cc & ZERO_BIT) {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
+		}
+		m->register_pc += 2;
+		m->register_pc += displacement;
+		branch_taken(m);
+		disasm_branch(m, DECODE_TAKEN, "JREQ %04x (Branch Taken)\n", m->register_pc);
+	} else {
+		// increment pc
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
+		}
+		m->register_pc += 2;
+		disasm_branch(m, DECODE_NOT_TAKEN, "JREQ %04x (Branch NOT Taken)\n", m->register_pc+displacement);
+	}
+}
 
-			sprintf((char *)print_buffer, "JP ([%02x],Y)=%04x : pc=%08x\n", indirect_address, dest, register_pc);
+template<unsigned int PRECODE_SPACE> void op_jrf(struct machine *m, unsigned char instruction)
+{
+	short displacement;
 
-			inc_sim_time(5);
-			precode_91 = 0;
+	displacement = OPERAND(m->register_pc+1);
+	if(displacement & 0x0080) {
+		displacement |= 0xff00;
+	}
+	m->register_pc += 2;
+//			register_pc += displacement;	// never jump!
+	disasm_branch(m, DECODE_NOT_TAKEN, "JRF %04x (Branch NOT Taken)\n", m->register_pc+displacement);
+}
 
-		} else {
-			// (short,X)
-			short_address = get_data_memory_byte(register_pc+1);
-			
-			temp = register_x;
-			dest = short_address;
-			dest += temp;
-		
-			register_pc &= 0xffff0000;
-			register_pc |= dest;
-			sprintf((char *)print_buffer, "JP (%02x,X)=%04x : pc=%08x\n", short_address, dest, register_pc);
+template<unsigned int PRECODE_SPACE> void op_jrh(struct machine *m, unsigned char instruction)
+{
+	short displacement;
 
-			inc_sim_time(3);
+	if(m->register_cc & HALF_CARRY_BIT) {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
 		}
-		break;
-
-	case JP_REG_IND_OFF_LONG:	// 0xdc
-		if(precode_90) {
-			// (longoff,Y)
-			long_address = get_data_memory_byte(register_pc+1) << 8;
-			long_address |= get_data_memory_byte(register_pc+2);
-			
-			temp = register_y;
-
-			dest = long_address;
-			dest += temp;
+		m->register_pc += 2;
+		m->register_pc += displacement;
+		branch_taken(m);
+		disasm_branch(m, DECODE_TAKEN, "JRH %04x (Branch Taken)\n", m->register_pc);
 		
-			register_pc &= 0xffff0000;
-			register_pc |= dest;
-
-			sprintf((char *)print_buffer, "JP (%04x,Y)  [la=%04x temp=%02x]=%04x : pc=%08x\n", long_address, long_address, temp, dest, register_pc);
+	} else {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
+		}
+		// increment pc
+		m->register_pc += 2;
+		disasm_branch(m, DECODE_NOT_TAKEN, "JRH %04x (Branch NOT Taken)\n", m->register_pc+displacement);
+	}
+}
 
-			precode_90 = 0;
+template<unsigned int PRECODE_SPACE> void op_jrih(struct machine *m, unsigned char instruction)
+{
+	short displacement;
 
-		} else if(precode_92) {
-			// ([shortptr.w],X)
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = get_data_memory_byte(indirect_address) << 8;
-			long_address |= get_data_memory_byte(indirect_address+1);
-			
-			temp = register_x;
+	// this is not implemented verbatim, we have no interrupt line so alway take the jump for now
+	displacement = OPERAND(m->register_pc+1);
+	if(displacement & 0x0080) {
+		displacement |= 0xff00;
+	}
+	m->register_pc += 2;
+	m->register_pc += displacement;
+	disasm_branch(m, DECODE_TAKEN, "JRIH %04x (Branch Taken)\n", m->register_pc);
+}
 
-			dest = long_address;
-			dest += temp;
-		
-			register_pc &= 0xffff0000;
-			register_pc |= dest;
-			sprintf((char *)print_buffer, "JP ([%02x.w],X)  [la=%04x temp=%02x]=%04x : pc=%08x\n", indirect_address, long_address, temp, dest, register_pc);
+template<unsigned int PRECODE_SPACE> void op_jril(struct machine *m, unsigned char instruction)
+{
+	short displacement;
 
-			precode_92 = 0;
+	// this is not implemented verbatim, we have no interrupt line so alway take the jump for now
+	displacement = OPERAND(m->register_pc+1);
+	if(displacement & 0x0080) {
+		displacement |= 0xff00;
+	}
+	m->register_pc += 2;
+	m->register_pc += displacement;
+	disasm_branch(m, DECODE_TAKEN, "JRIL %04x (Branch Taken)\n", m->register_pc);
+}
 
-		} else if(precode_91) {
-			// ([shortptr.w],Y)
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = get_data_memory_byte(indirect_address) << 8;
-			long_address = get_data_memory_byte(indirect_address)+1;
-			
-			temp = register_y;
-		
-			dest = long_address;
-			dest += temp;
-		
-			register_pc &= 0xffff0000;
-			register_pc |= dest;
-			sprintf((char *)print_buffer, "JP ([%02x.w],Y)  [la=%04x temp=%02x]=%04x : pc=%08x\n", indirect_address, long_address, temp, dest, register_pc);
+template<unsigned int PRECODE_SPACE> void op_jrm(struct machine *m, unsigned char instruction)
+{
+	short displacement;
 
-			precode_91= 0;
+	if(m->register_cc & (INTERRUPT_MASK_L0_BIT|INTERRUPT_MASK_L1_BIT)) {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
+		}
+		m->register_pc += 2;
+		m->register_pc += displacement;
+		branch_taken(m);
+		disasm_branch(m, DECODE_TAKEN, "JRM %04x (Branch Taken)\n", m->register_pc);
+	} else {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
+		}
 
-		} else {
-			// (longoff,X)
-			long_address = get_data_memory_byte(register_pc+1) << 8;
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "JP (%04x,X)", long_address);
-			
-			temp = register_x;
+		// increment pc
+		m->register_pc += 2;
+		disasm_branch(m, DECODE_NOT_TAKEN, "JRM %04x (Branch NOT Taken)\n", m->register_pc+displacement);
+	}
+}
 
-			dest = long_address;
-			dest += temp;
-		
-			register_pc &= 0xffff0000;
-			register_pc |= dest;
+template<unsigned int PRECODE_SPACE> void op_jrmi(struct machine *m, unsigned char instruction)
+{
+	short displacement;
 
-			sprintf((char *)print_buffer, "JP (%04x,X)  [la=%04x temp=%02x]=%04x : pc=%08x\n", long_address, long_address, temp, dest, register_pc);
-			
+	if(m->register_cc & NEGATIVE_BIT) {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
+		}
+		m->register_pc += 2;
+		m->register_pc += displacement;
+		branch_taken(m);
+		disasm_branch(m, DECODE_TAKEN, "JRMI %04x (Branch Taken)\n", m->register_pc);
+	} else {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
 		}
-		inc_sim_time(6);
-		break;
 
-	// NOP
-	case NOP:
-		sprintf((char *)print_buffer, "NOP\n");
-		
 		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		break;
-
-	// ADC A,x
-	case ADC_IMMED: // 0xa9
-		sprintf((char *)print_buffer, "ADC A,#%02x\n", get_data_memory_byte(register_pc+1));
-		adc(get_data_memory_byte(register_pc+1));
-		// increment pc
-		register_pc += 2;
-		inc_sim_time(2);
-		
-		break;
+		m->register_pc += 2;
+		disasm_branch(m, DECODE_NOT_TAKEN, "JRMI %04x (Branch NOT Taken)\n", m->register_pc+displacement);
+	}
+}
 
-	case ADC_SHORT: // 0xb9
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "ADC A,[%02x]\n", indirect_address);
-			
-			inc_sim_time(5);
-			precode_92 = 0;
+template<unsigned int PRECODE_SPACE> void op_jrnc(struct machine *m, unsigned char instruction)
+{
+	short displacement;
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "ADC A,%02x\n", short_address);
-			
-			inc_sim_time(3);
+	if((m->register_cc & CARRY_BIT) == 0) {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
+		}
+		m->register_pc += 2;
+		m->register_pc += displacement;
+		branch_taken(m);
+		disasm_branch(m, DECODE_TAKEN, "JRNC %04x (Branch Taken)\n", m->register_pc);
+	} else {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
 		}
-		adc(get_data_memory_byte(short_address));
+
 		// increment pc
-		register_pc += 2;
-		break;
-
-	case ADC_LONG:	// 0xc9
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "ADC A,[%02x.w]\n", indirect_address);
-			
-			adc(get_data_memory_byte(long_address));
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(6);
-			precode_92 = 0;
+		m->register_pc += 2;
+		disasm_branch(m, DECODE_NOT_TAKEN, "JRNC %04x (Branch NOT Taken)\n", m->register_pc+displacement);
+	}
+}
 
-		} else {
-			// longmem
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "ADC A,%04x\n", long_address);
-			
-			adc(get_data_memory_byte(long_address));
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(4);
+template<unsigned int PRECODE_SPACE> void op_jrne(struct machine *m, unsigned char instruction)
+{
+	short displacement;
 
+	if((m->register_cc & ZERO_BIT) == 0) {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
 		}
-		break;
-
-	case ADC_REG_IND:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "ADC A,(Y)\n");
-			adc(get_data_memory_byte(register_y));
-			inc_sim_time(4);
-			precode_90 = 0;
-		} else {
-			sprintf((char *)print_buffer, "ADC A,(X)\n");
-			adc(get_data_memory_byte(register_x));
-			inc_sim_time(3);
+		m->register_pc += 2;
+		m->register_pc += displacement;
+		branch_taken(m);
+		disasm_branch(m, DECODE_TAKEN, "JRNE %04x (Branch Taken)\n", m->register_pc);
+	} else {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
 		}
-		// increment pc
-		register_pc++;
-		
-		break;
-
-	case ADC_REG_IND_OFF_SHORT:	// 0xe9
-		if(precode_90) {
-			// shortoff,y
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "ADC A,(%02x,Y)\n", short_address);
-			adc(get_data_memory_byte(short_address+register_y));
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			// [shortptr.w],y
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "ADC A,([%02x],Y)\n", indirect_address);
-			adc(get_data_memory_byte(short_address+register_y));
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			// [shortptr.w],x
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "ADC A,([%02x],X)\n", indirect_address);
-			adc(get_data_memory_byte(short_address+register_x));
-			precode_92 = 0;
 
-		} else {
-			// shortoff,X
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "ADC A,(%02x,X)\n", short_address);
-			adc(get_data_memory_byte(short_address+register_x));
-			register_a += get_data_memory_byte(short_address+register_x);
-		}
 		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case ADC_REG_IND_OFF_LONG:	// 0xd9
-		if(precode_90) {
-			// longoff,y
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "ADC A,(%04x,Y)\n", long_address);
-			adc(get_data_memory_byte(long_address+register_y));
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(4);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			// [shortptr.w],y
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "ADC A,([%02x.w],Y)\n", indirect_address);
-			adc(get_data_memory_byte(long_address+register_y));
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(6);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			//[shortptr.w],x
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "ADC A,([%02x.w],X)\n", indirect_address);
-			adc(get_data_memory_byte(long_address+register_x));
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(6);
-			precode_92 = 0;
+		m->register_pc += 2;
+		disasm_branch(m, DECODE_NOT_TAKEN, "JRNE %04x (Branch NOT Taken)\n", m->register_pc+displacement);
+	}
+}
 
-		} else {
-			// longoff,X
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "ADC A,(%04x, X)\n", long_address);
-			adc(get_data_memory_byte(long_address+register_x));
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(4);
+template<unsigned int PRECODE_SPACE> void op_jrnh(struct machine *m, unsigned char instruction)
+{
+	short displacement;
 
+	if((m->register_cc & HALF_CARRY_BIT) == 0) {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
 		}
-		break;
-
-	// ADD A,x
-	case ADD_IMMED:
-		sprintf((char *)print_buffer, "ADD A,#%02x\n", get_data_memory_byte(register_pc+1));
-		add(get_data_memory_byte(register_pc+1));
-		// increment pc
-		register_pc += 2;
-		inc_sim_time(2);
-		break;
-
-	case ADD_SHORT:	// 0xbb
-		if(precode_92) {
-			// [short]
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "ADD A,[%02x]\n", indirect_address);
-			inc_sim_time(5);
-			precode_92 = 0;
-		} else {
-			// short
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "ADD A,%02x\n", short_address);
-			inc_sim_time(3);
-		}
-		add(get_data_memory_byte(short_address));
-		// increment pc
-		register_pc += 2;
-		break;
-
-	case ADD_LONG:	// 0xcb
-		if(precode_92) {
-			// [shortptr.w]
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "ADD A,[%02x.w]\n", indirect_address);
-			add(get_data_memory_byte(long_address));
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(6);
-			precode_92 = 0;
-		} else {
-			// longmem
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "ADD A,%04x\n", long_address);
-			add(get_data_memory_byte(long_address));
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(4);
-		}
-		break;
-
-	case ADD_REG_IND:	// 0xfb
-		if(precode_90) {
-			// (Y)
-			sprintf((char *)print_buffer, "ADD A,(Y)\n");
-			add(get_data_memory_byte(register_y));
-			inc_sim_time(4);
-			precode_90 = 0;
-		} else {
-			// (X)
-			sprintf((char *)print_buffer, "ADD A,(X)\n");
-			add(get_data_memory_byte(register_x));
-			inc_sim_time(3);
-		}
-		// increment pc
-		register_pc++;
-		break;
-
-	case ADD_REG_IND_OFF_SHORT:	// 0xeb
-		if(precode_90) {
-			// (shortoff,Y)
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "ADD A,(%02x,Y)\n", short_address);
-			add(get_data_memory_byte(short_address+register_y));
-			inc_sim_time(4);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			// ([short],Y) - Present in ST7, but not ST8
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "ADD A,([%02x],Y)\n", indirect_address);
-			add(get_data_memory_byte(short_address+register_y));
-			inc_sim_time(6);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			// ([short],X) - Present in ST7, but not ST8
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "ADD A,([%02x],X)\n", indirect_address);
-			add(get_data_memory_byte(short_address+register_x));
-			inc_sim_time(6);
-			precode_92 = 0;
-
-		} else {
-			// (shortoff,X)
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "ADD A,(%02x,X)\n", short_address);
-			add(get_data_memory_byte(short_address+register_x));
-			inc_sim_time(4);
-		}
-		// increment pc
-		register_pc += 2;
-		break;
-
-	case ADD_REG_IND_OFF_LONG:	// 0xdb
-		if(precode_90) {
-			// (longoff,Y)
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "ADD A,(%04x,Y)\n", long_address);
-			add(get_data_memory_byte(long_address+register_y));
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(6);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			// ([shortptr.w],Y)
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "ADD A,([%02x.w],Y)\n", indirect_address);
-			add(get_data_memory_byte(long_address+register_y));
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			// ([shortptr.w],X)
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "ADD A,([%02x.w],X)\n", indirect_address);
-			add(get_data_memory_byte(long_address+register_x));
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_92 = 0;
-
-		} else {
-			// (longoff,X)
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "ADD A,(%04x, X)\n", long_address);
-			add(get_data_memory_byte(long_address+register_x));
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(6);
-
+		m->register_pc += 2;
+		m->register_pc += displacement;	
+		branch_taken(m);
+		disasm_branch(m, DECODE_TAKEN, "JRNH %04x (Branch Taken)\n", m->register_pc);
+	} else {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
 		}
-		break;
-
-	// AND A,x
-	case AND_IMMED:	// 0xa4
-		sprintf((char *)print_buffer, "AND A,#%02x\n", get_data_memory_byte(register_pc+1));
-		register_a &= get_data_memory_byte(register_pc+1);
-		set_flags(register_a);
-		// increment pc
-		register_pc += 2;
-		inc_sim_time(2);
-		break;
-
-	case AND_SHORT:	// 0xb4
-		if(precode_92) {
-			// [short] - Present in ST7, but not ST8
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "AND A,[%02x]\n", indirect_address);
-			inc_sim_time(5);
-			precode_92 = 0;
-
-		} else {
-			// shortmem
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "AND A,%02x\n", short_address);
-			inc_sim_time(3);
 
-		}
-		register_a &= get_data_memory_byte(short_address);
-		set_flags(register_a);
 		// increment pc
-		register_pc += 2;
-		break;
-
-	case AND_LONG:	// 0xc4
-		if(precode_92) {
-			// [shortptr.w]
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "AND A,[%02x.w]\n", indirect_address);
-			register_a &= get_data_memory_byte(long_address);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(6);
-			precode_92 = 0;
+		m->register_pc += 2;
+		disasm_branch(m, DECODE_NOT_TAKEN, "JRNH %04x (Branch NOT Taken)\n", m->register_pc+displacement);
+	}
+}
 
-		} else {
-			// longmem
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "AND A,%04x\n", long_address);
-			register_a &= get_data_memory_byte(long_address);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(4);
+template<unsigned int PRECODE_SPACE> void op_jrnm(struct machine *m, unsigned char instruction)
+{
+	short displacement;
 
+	if((m->register_cc & (INTERRUPT_MASK_L0_BIT|INTERRUPT_MASK_L1_BIT)) == 0) {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
 		}
-		set_flags(register_a);
+		m->register_pc += 2;
+		m->register_pc += displacement;
+		branch_taken(m);
+		disasm_branch(m, DECODE_TAKEN, "JRNM %04x (Branch Taken)\n", m->register_pc);
 		
-		break;
-
-	case AND_REG_IND:
-		if(precode_90) {
-			// (Y)
-			sprintf((char *)print_buffer, "AND A,(Y)\n");
-			register_a &= get_data_memory_byte(register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
-
-		} else {
-			// (X)
-			sprintf((char *)print_buffer, "AND A,(X)\n");
-			register_a &= get_data_memory_byte(register_x);
-			inc_sim_time(3);
-
+	} else {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
 		}
-		set_flags(register_a);
 		// increment pc
-		register_pc++;
+		m->register_pc += 2;
+		disasm_branch(m, DECODE_NOT_TAKEN, "JRNM %04x (Branch NOT Taken)\n", m->register_pc+displacement);
 		
-		break;
-
-	case AND_REG_IND_OFF_SHORT:	// 0xe4
-		if(precode_90) {
-			// (shortoff,Y)
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "AND A,(%02x,Y)\n", short_address);
-			register_a &= get_data_memory_byte(short_address+register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			// ([short],Y) - Present in ST7 but not st8
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "AND A,([%02x],Y)\n", indirect_address);
-			register_a &= get_data_memory_byte(short_address+register_y);
-			inc_sim_time(6);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			// ([short],X) - - Present in ST7 but not st8
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "AND A,([%02x],X)\n", indirect_address);
-			register_a &= get_data_memory_byte(short_address+register_x);
-			inc_sim_time(6);
-			precode_92 = 0;
+	}
+}
 
-		} else {
-			// (shortoff,X)
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "AND A,(%02x,X)\n", short_address);
-			register_a &= get_data_memory_byte(short_address+register_x);
-			inc_sim_time(4);
+template<unsigned int PRECODE_SPACE> void op_jrpl(struct machine *m, unsigned char instruction)
+{
+	short displacement;
 
+	if((m->register_cc & NEGATIVE_BIT) == 0) {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
 		}
-		set_flags(register_a);
-		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case AND_REG_IND_OFF_LONG:	// 0xd4
-		if(precode_90) {
-			// (longoff,Y)
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "AND A,(%04x,Y)\n", long_address);
-			register_a &= get_data_memory_byte(long_address+register_y);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(5);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			// ([shortptr.w],Y)
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "AND A,([%02x.w],Y)\n", indirect_address);
-			register_a &= get_data_memory_byte(long_address+register_y);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			// ([shortptr.w],X)
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "AND A,([%02x.w],X)\n", indirect_address);
-			register_a &= get_data_memory_byte(long_address+register_x);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_92 = 0;
-
-		} else {
-			// (longoff,X)
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "AND A,(%04x, X)\n", long_address);
-			register_a &= get_data_memory_byte(long_address+register_x);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(5);
+		m->register_pc += 2;
+		m->register_pc += displacement;
 
-		}
-		set_flags(register_a);
-		
-		break;
-
-	// BCP A,x
-	case BCP_IMMED:
-		sprintf((char *)print_buffer, "BCP A,#%02x\n", get_data_memory_byte(register_pc+1));
-		bcp_temp = register_a;
-		bcp_temp &= get_data_memory_byte(register_pc+1);
-		set_flags(bcp_temp);
-		// increment pc
-		register_pc += 2;
-		inc_sim_time(2);
+		branch_taken(m);
+		disasm_branch(m, DECODE_TAKEN, "JRPL %04x (Branch Taken)\n", m->register_pc);
 		
-		break;
-
-	case BCP_SHORT:
-		if(precode_92) {
-			// [short] - Present in ST7, but not ST8
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "BCP A,[%02x]\n", indirect_address);
-			inc_sim_time(5);
-			precode_92 = 0;
-
-		} else {
-			// shortmem
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "BCP A,%02x\n", short_address);
-			inc_sim_time(3);
-
+	} else {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
 		}
-		bcp_temp = register_a;
-		bcp_temp &= get_data_memory_byte(short_address);
-		set_flags(bcp_temp);
 		// increment pc
-		register_pc += 2;
+		m->register_pc += 2;
+		disasm_branch(m, DECODE_NOT_TAKEN, "JRPL %04x (Branch NOT Taken)\n", m->register_pc+ displacement);
 		
-		break;
-
-	case BCP_LONG:
-		if(precode_92) {
-			// [shortptr.w]
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "BCP A,[%02x.w]\n", indirect_address);
-			bcp_temp = register_a;
-			bcp_temp &= get_data_memory_byte(long_address);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(6);
-			precode_92 = 0;
+	}
+}
 
-		} else {
-			// longmem
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "BCP A,%04x\n", long_address);
-			bcp_temp = register_a;
-			bcp_temp &= get_data_memory_byte(long_address);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(4);
+template<unsigned int PRECODE_SPACE> void op_jrugt(struct machine *m, unsigned char instruction)
+{
+	short displacement;
 
+	if(((m->register_cc & CARRY_BIT) | (m->register_cc & ZERO_BIT)) == 0) {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
 		}
-		set_flags(bcp_temp);
+		m->register_pc += 2;
+		m->register_pc += displacement;
+		branch_taken(m);
+		disasm_branch(m, DECODE_TAKEN, "JRUGT %04x (Branch Taken)\n", m->register_pc);
 		
-		break;
-
-	case BCP_REG_IND:
-		if(precode_90) {
-			// (Y)
-			sprintf((char *)print_buffer, "BCP A,(Y)\n");
-			bcp_temp = register_a;
-			bcp_temp &= get_data_memory_byte(register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
-
-		} else {
-			// (X)
-			sprintf((char *)print_buffer, "BCP A,(X)\n");
-			bcp_temp = register_a;
-			bcp_temp &= get_data_memory_byte(register_x);
-			inc_sim_time(3);
-
+	} else {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
 		}
-		set_flags(bcp_temp);
-		// increment pc
-		register_pc++;
-		
-		break;
-
-	case BCP_REG_IND_OFF_SHORT:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "BCP A,(%02x,Y)\n", short_address);
-			bcp_temp = register_a;
-			bcp_temp &= get_data_memory_byte(short_address+register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "BCP A,([%02x],Y)\n", indirect_address);
-			bcp_temp = register_a;
-			bcp_temp &= get_data_memory_byte(short_address+register_y);
-			inc_sim_time(6);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "BCP A,([%02x],X)\n", indirect_address);
-			bcp_temp = register_a;
-			bcp_temp &= get_data_memory_byte(short_address+register_x);
-			inc_sim_time(6);
-			precode_92 = 0;
-
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "BCP A,(%02x,X)\n", short_address);
-			bcp_temp = register_a;
-			bcp_temp &= get_data_memory_byte(short_address+register_x);
-			inc_sim_time(4);
-		}		
-		set_flags(bcp_temp);
 		// increment pc
-		register_pc += 2;
+		m->register_pc += 2;
+		disasm_branch(m, DECODE_NOT_TAKEN, "JRUGT %04x (Branch NOT Taken)\n", m->register_pc+ displacement);
 		
-		break;
-
-	case BCP_REG_IND_OFF_LONG:
-		if(precode_90) {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "BCP A,(%04x,Y)\n", long_address);
-			bcp_temp = register_a;
-			bcp_temp &= get_data_memory_byte(long_address+register_y);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(5);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "BCP A,([%02x.w],Y)\n", indirect_address);
-			bcp_temp = register_a;
-			bcp_temp &= get_data_memory_byte(long_address+register_y);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "BCP A,([%02x.w],X)\n", indirect_address);
-			bcp_temp = register_a;
-			bcp_temp &= get_data_memory_byte(long_address+register_x);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(6);
-			precode_92 = 0;
+	}
+}
 
-		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "BCP A,(%04x, X)\n", long_address);
-			bcp_temp = register_a;
-			bcp_temp &= get_data_memory_byte(long_address+register_x);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(5);
+template<unsigned int PRECODE_SPACE> void op_jrule(struct machine *m, unsigned char instruction)
+{
+	short displacement;
 
+	if(((m->register_cc & CARRY_BIT) || (m->register_cc & ZERO_BIT))) {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
 		}
-		set_flags(bcp_temp);
+		m->register_pc += 2;
+		m->register_pc += displacement;
+		branch_taken(m);
+		disasm_branch(m, DECODE_TAKEN, "JRULE %04x (Branch Taken)\n", m->register_pc);
 		
-		break;
-
-	// CP A,x
-	case CP_IMMED:
-		sprintf((char *)print_buffer, "CP A,#%02x\n", get_data_memory_byte(register_pc+1));
-		bcp_temp = get_data_memory_byte(register_pc+1);
-		if(bcp_temp > register_a) {
-			register_cc |= CARRY_BIT;
-		} else {
-			register_cc &= ~CARRY_BIT;
+	} else {
+		displacement = OPERAND(m->register_pc+1);
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
 		}
-		bcp_temp = register_a - bcp_temp;
-		set_flags(bcp_temp);
 		// increment pc
-		register_pc += 2;
-		inc_sim_time(2);
+		m->register_pc += 2;
+		disasm_branch(m, DECODE_NOT_TAKEN, "JRULE %04x (Branch NOT Taken)\n", m->register_pc+displacement);
 		
-		break;
-
-	case CP_SHORT:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "CP A,[%02x]\n", indirect_address);
-			inc_sim_time(5);
-			precode_92 = 0;
+	}
+}
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "CP A,%02x\n", short_address);
-			inc_sim_time(3);
+template<unsigned int PRECODE_SPACE> void op_jra(struct machine *m, unsigned char instruction)
+{
+	short displacement;
 
-		}
-		bcp_temp = get_data_memory_byte(short_address);
-		if(bcp_temp > register_a) {
-			register_cc |= CARRY_BIT;
-		} else {
-			register_cc &= ~CARRY_BIT;
-		}
-		bcp_temp = register_a - bcp_temp;
-		set_flags(bcp_temp);
-		// increment pc
-		register_pc += 2;
-		
-		break;
+	displacement = OPERAND(m->register_pc+1);
+	if(displacement & 0x0080) {
+		displacement |= 0xff00;
+	}
+	m->register_pc += 2;
+	m->register_pc += displacement;
+	disasm_branch(m, DECODE_TAKEN, "JRA %04x (Branch Taken)\n", m->register_pc);
+}
 
-	case CP_LONG:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
+template<unsigned int PRECODE_SPACE> void op_jp_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int dest;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		dest = get_data_memory_byte(m, indirect_address) << 8;
+		dest |= get_data_memory_byte(m, indirect_address+1);
+		m->register_pc &= 0xffff0000;
+		m->register_pc |= dest;
+		disasm(m, "JP [%02x.w]=%04x : pc=%08x\n", indirect_address, dest, m->register_pc);
+	} else {
+		dest = OPERAND(m->register_pc+1) << 8;
+		dest |= OPERAND(m->register_pc+2);
+		m->register_pc &= 0xffff0000;
+		m->register_pc |= dest;
+		disasm(m, "JP %04x : pc=%08x\n", dest, m->register_pc);
+	}
+}
 
-			
-			bcp_temp = get_data_memory_byte(long_address);
-			if(bcp_temp > register_a) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_a - bcp_temp;
-			sprintf((char *)print_buffer, "CP A,[%02x.w] []=%04x (%04x)=%02x {%02x-%02x=%02x}\n", indirect_address, long_address, long_address, get_data_memory_byte(long_address), register_a, get_data_memory_byte(long_address), bcp_temp);
-			
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(6);
-			precode_92 = 0;
+template<unsigned int PRECODE_SPACE> void op_jp_far(struct machine *m, unsigned char instruction)
+{
+	unsigned int dest;
+	unsigned short short_indirect_address;
 
-		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			
-			bcp_temp = get_data_memory_byte(long_address);
-			if(bcp_temp > register_a) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_a - bcp_temp;
-			sprintf((char *)print_buffer, "CP A,%04x {%02x-%02x=%02x}\n", long_address, register_a, get_data_memory_byte(long_address), bcp_temp);
-			
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(4);
+	if(PRECODE_SPACE == PRECODE_92) {
+		short_indirect_address = OPERAND(m->register_pc+1) << 8;
+		short_indirect_address |= OPERAND(m->register_pc+2);
+		dest = get_data_memory_byte(m, short_indirect_address) << 16;
+		dest |= get_data_memory_byte(m, short_indirect_address+1) << 8;
+		dest |= get_data_memory_byte(m, short_indirect_address+1);
+		m->register_pc = dest;
+		disasm(m, "JPF [%04x.w]=%08x : pc=%08x\n", short_indirect_address, dest, m->register_pc);
+	} else {
+		dest = OPERAND(m->register_pc+1) << 16;
+		dest |= OPERAND(m->register_pc+2) << 8;
+		dest |= OPERAND(m->register_pc+3);
+		m->register_pc = dest;
+		disasm(m, "JPF %04x : pc=%08x\n", dest, m->register_pc);
+	}
+}
 
-		}
-		set_flags(bcp_temp);
-		break;
-
-	case CP_REG_IND:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "CP A,(Y)\n");
-			bcp_temp = get_data_memory_byte(register_y);
-			if(bcp_temp > register_a) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_a - bcp_temp;
-			inc_sim_time(4);
-			precode_90 = 0;
+template<unsigned int PRECODE_SPACE> void op_jp_reg_ind(struct machine *m, unsigned char instruction)
+{
+	unsigned int dest;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		// (Y)
+		dest = m->register_y;
+		m->register_pc &= 0xffff0000;
+		m->register_pc |= dest;
+		disasm(m, "JP (Y)=%04x : pc=%08x\n", dest, m->register_pc);
+	} else {
+		// (X)
+		dest = m->register_x;
+		m->register_pc &= 0xffff0000;
+		m->register_pc |= dest;
+		disasm(m, "JP (X)=%04x : pc=%08x\n", dest, m->register_pc);
+	}
+}
 
-		} else {
-			sprintf((char *)print_buffer, "CP A,(X)\n");
-			bcp_temp = get_data_memory_byte(register_x);
-			if(bcp_temp > register_a) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_a - bcp_temp;
-			inc_sim_time(4);
+template<unsigned int PRECODE_SPACE> void op_jp_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned char temp;
+	unsigned int dest;
 
-		}
-		set_flags(bcp_temp);
-		// increment pc
-		register_pc++;
-		
-		break;
-
-	case CP_REG_IND_OFF_SHORT:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "CP A,(%02x,Y)\n", short_address);
-			bcp_temp = get_data_memory_byte(short_address+register_y);
-			if(bcp_temp > register_a) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_a - bcp_temp;
-			inc_sim_time(4);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "CP A,([%02x],Y)\n", indirect_address);
-			bcp_temp = get_data_memory_byte(short_address+register_y);
-			if(bcp_temp > register_a) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_a - bcp_temp;
-			inc_sim_time(6);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "CP A,([%02x],X)\n", indirect_address);
-			bcp_temp = get_data_memory_byte(short_address+register_x);
-			if(bcp_temp > register_a) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_a - bcp_temp;
-			inc_sim_time(6);
-			precode_92 = 0;
+	if(PRECODE_SPACE == PRECODE_90) {
+		// (short,Y)
+		short_address = OPERAND(m->register_pc+1);
+	
+		temp = m->register_y;
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "CP A,(%02x,X)\n", short_address);
-			bcp_temp = get_data_memory_byte(short_address+register_x);
-			if(bcp_temp > register_a) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_a - bcp_temp;
-			inc_sim_time(4);
+		dest = short_address;
+		dest += temp;
+	
+		m->register_pc &= 0xffff0000;
+		m->register_pc |= dest;
+
+		disasm(m, "JP (%02x,Y)=%04x : pc=%08x\n", short_address, dest, m->register_pc);
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		// ([short],X)
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		
+		temp = m->register_x;
+		dest = short_address;
+		dest += temp;
+	
+		m->register_pc &= 0xffff0000;
+		m->register_pc |= dest;
+
+		disasm(m, "JP ([%02x],X)=%04x : pc=%08x\n", indirect_address, dest, m->register_pc);
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		// ([short],Y)
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		
+		temp = m->register_y;
+		dest = short_address;
+		dest += temp;
+	
+		m->register_pc &= 0xffff0000;
+		m->register_pc |= dest;
 
-		}
-		set_flags(bcp_temp);
-		// increment pc
-		register_pc += 2;
+		disasm(m, "JP ([%02x],Y)=%04x : pc=%08x\n", indirect_address, dest, m->register_pc);
+	} else {
+		// (short,X)
+		short_address = OPERAND(m->register_pc+1);
 		
-		break;
-
-	case CP_REG_IND_OFF_LONG:
-		if(precode_72) {
-
-			short_indirect_address = (get_data_memory_byte(register_pc+1) << 8);
-			short_indirect_address |= get_data_memory_byte(register_pc+2);
-
-			long_address = get_data_memory_byte(short_indirect_address) << 8;
-			long_address |= get_data_memory_byte(short_indirect_address+1);
-			sprintf((char *)print_buffer, "CP A,([%04x],X) (LA=%08x, EA=%08x)\n", short_indirect_address, long_address, long_address+register_x);
-			bcp_temp = get_data_memory_byte(long_address+register_x);
-			if(bcp_temp > register_a) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_a - bcp_temp;
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(8);
-			precode_72 = 0;
-
-		} else if(precode_90) {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "CP A,(%04x,Y)\n", long_address);
-			bcp_temp = get_data_memory_byte(long_address+register_y);
-			if(bcp_temp > register_a) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_a - bcp_temp;
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(5);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "CP A,([%02x.w],Y)\n", indirect_address);
-			bcp_temp = get_data_memory_byte(long_address+register_y);
-			if(bcp_temp > register_a) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_a - bcp_temp;
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "CP A,([%02x.w],X)\n", indirect_address);
-			bcp_temp = get_data_memory_byte(long_address+register_x);
-			if(bcp_temp > register_a) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_a - bcp_temp;
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_92 = 0;
+		temp = m->register_x;
+		dest = short_address;
+		dest += temp;
+	
+		m->register_pc &= 0xffff0000;
+		m->register_pc |= dest;
+		disasm(m, "JP (%02x,X)=%04x : pc=%08x\n", short_address, dest, m->register_pc);
+	}
+}
 
-		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "CP A,(%04x, X)\n", long_address);
-			bcp_temp = get_data_memory_byte(long_address+register_x);
-			if(bcp_temp > register_a) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_a - bcp_temp;
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(5);
+template<unsigned int PRECODE_SPACE> void op_jp_reg_ind_off_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned char temp;
+	unsigned int long_address;
+	unsigned int dest;
 
-		}
-		set_flags(bcp_temp);
-		if(bcp_temp > register_a) {
-			register_cc |= CARRY_BIT;
-		} else {
-			register_cc &= ~CARRY_BIT;
-		}
+	if(PRECODE_SPACE == PRECODE_90) {
+		// (longoff,Y)
+		long_address = OPERAND(m->register_pc+1) << 8;
+		long_address |= OPERAND(m->register_pc+2);
 		
-		break;
-
-	// CP X,x
-	case CP_X_IMMED:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "CP Y,#%02x\n", get_data_memory_byte(register_pc+1));
-			bcp_temp = get_data_memory_byte(register_pc+1);
-			if(bcp_temp > register_y) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_y - bcp_temp;
-			set_flags(bcp_temp);
-			inc_sim_time(3);
-			precode_90 = 0;
+		temp = m->register_y;
 
-		} else {
-			sprintf((char *)print_buffer, "CP X,#%02x\n", get_data_memory_byte(register_pc+1));
-			bcp_temp = get_data_memory_byte(register_pc+1);
-			if(bcp_temp > register_x) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_x - bcp_temp;
-			set_flags(bcp_temp);
-			inc_sim_time(2);
-		}
-		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case CP_X_SHORT:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "CP Y,%02x\n", short_address);
-			bcp_temp = get_data_memory_byte(short_address);
-			if(bcp_temp > register_y) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_y - bcp_temp;
-			set_flags(bcp_temp);
-			inc_sim_time(4);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "CP Y,[%02x]\n", indirect_address);
-			bcp_temp = get_data_memory_byte(short_address);
-			if(bcp_temp > register_y) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_y - bcp_temp;
-			set_flags(bcp_temp);
-			inc_sim_time(5);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "CP X,[%02x]\n", indirect_address);
-			bcp_temp = get_data_memory_byte(short_address);
-			if(bcp_temp > register_x) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_x - bcp_temp;
-			set_flags(bcp_temp);
-			inc_sim_time(5);
-			precode_92 = 0;
+		dest = long_address;
+		dest += temp;
+	
+		m->register_pc &= 0xffff0000;
+		m->register_pc |= dest;
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "CP X,%02x\n", short_address);
-			bcp_temp = get_data_memory_byte(short_address);
-			if(bcp_temp > register_x) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_x - bcp_temp;
-			set_flags(bcp_temp);
-			inc_sim_time(3);
-		}
-		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case CP_X_LONG:
-		if(precode_90) {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "CP Y,%04x\n", long_address);
-			bcp_temp = get_data_memory_byte(long_address);
-			if(bcp_temp > register_y) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_y - bcp_temp;
-			set_flags(bcp_temp);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(5);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "CP Y,[%02x.w]\n", indirect_address);
-			bcp_temp = get_data_memory_byte(long_address);
-			if(bcp_temp > register_a) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_y - bcp_temp;
-			set_flags(bcp_temp);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(6);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "CP X,[%02x.w]\n", indirect_address);
-			bcp_temp = get_data_memory_byte(long_address);
-			if(bcp_temp > register_x) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_x - bcp_temp;
-			set_flags(bcp_temp);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(6);
-			precode_92 = 0;
+		disasm(m, "JP (%04x,Y)  [la=%04x temp=%02x]=%04x : pc=%08x\n", long_address, long_address, temp, dest, m->register_pc);
 
-		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "CP X,%04x\n", long_address);
-			bcp_temp = get_data_memory_byte(long_address);
-			if(bcp_temp > register_x) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_x - bcp_temp;
-			set_flags(bcp_temp);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(4);
 
-		}
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		// ([shortptr.w],X)
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = get_data_memory_byte(m, indirect_address) << 8;
+		long_address |= get_data_memory_byte(m, indirect_address+1);
 		
-		break;
-
-	case CP_X_REG_IND:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "CP Y,(Y)\n");
-			bcp_temp = get_data_memory_byte(register_y);
-			if(bcp_temp > register_y) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_y - bcp_temp;
-			set_flags(bcp_temp);
-			inc_sim_time(4);
-			precode_90 = 0;
+		temp = m->register_x;
 
-		} else {
-			sprintf((char *)print_buffer, "CP X,(X)\n");
-			bcp_temp = get_data_memory_byte(register_x);
-			if(bcp_temp > register_x) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_x - bcp_temp;
-			set_flags(bcp_temp);
-			inc_sim_time(3);
-		}
-		// increment pc
-		register_pc++;
-		
-		break;
-
-	case CP_X_REG_IND_OFF_SHORT:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "CP Y,(%02x,Y)\n", short_address);
-			bcp_temp = get_data_memory_byte(short_address+register_y);
-			if(bcp_temp > register_y) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_y - bcp_temp;
-			inc_sim_time(5);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "CP Y,([%02x],Y)\n", indirect_address);
-			bcp_temp = get_data_memory_byte(short_address+register_y);
-			if(bcp_temp > register_y) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_y - bcp_temp;
-			inc_sim_time(5);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "CP X,([%02x],X)\n", indirect_address);
-			bcp_temp = get_data_memory_byte(short_address+register_x);
-			if(bcp_temp > register_x) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_x - bcp_temp;
-			inc_sim_time(4);
-			precode_92 = 0;
+		dest = long_address;
+		dest += temp;
+	
+		m->register_pc &= 0xffff0000;
+		m->register_pc |= dest;
+		disasm(m, "JP ([%02x.w],X)  [la=%04x temp=%02x]=%04x : pc=%08x\n", indirect_address, long_address, temp, dest, m->register_pc);
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "CP X,(%02x,X)\n", short_address);
-			bcp_temp = get_data_memory_byte(short_address+register_x);
-			if(bcp_temp > register_x) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_x - bcp_temp;
-			inc_sim_time(4);
 
-		}
-		set_flags(bcp_temp);
-		// increment pc
-		register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		// ([shortptr.w],Y)
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = get_data_memory_byte(m, indirect_address) << 8;
+		long_address = get_data_memory_byte(m, indirect_address)+1;
 		
-		break;
-
-	case CP_X_REG_IND_OFF_LONG:
-		if(precode_90) {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "CP Y,(%04x,Y)\n", long_address);
-			bcp_temp = get_data_memory_byte(long_address+register_y);
-			if(bcp_temp > register_y) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_y - bcp_temp;
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(6);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "CP Y,([%02x.w],Y)\n", indirect_address);
-			bcp_temp = get_data_memory_byte(long_address+register_y);
-			if(bcp_temp > register_y) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_y - bcp_temp;
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "CP X,([%02x.w],X)\n", indirect_address);
-			bcp_temp = get_data_memory_byte(long_address+register_x);
-			if(bcp_temp > register_x) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_x - bcp_temp;
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(5);
-			precode_92 = 0;
-
-		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "CP X,(%04x, X)\n", long_address);
-			bcp_temp = get_data_memory_byte(long_address+register_x);
-			if(bcp_temp > register_x) {
-				register_cc |= CARRY_BIT;
-			} else {
-				register_cc &= ~CARRY_BIT;
-			}
-			bcp_temp = register_x - bcp_temp;
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(5);
+		temp = m->register_y;
+	
+		dest = long_address;
+		dest += temp;
+	
+		m->register_pc &= 0xffff0000;
+		m->register_pc |= dest;
+		disasm(m, "JP ([%02x.w],Y)  [la=%04x temp=%02x]=%04x : pc=%08x\n", indirect_address, long_address, temp, dest, m->register_pc);
 
-		}
-		set_flags(bcp_temp);
-		
-		break;
 
-	// OR A,x
-	case OR_IMMED:
-		sprintf((char *)print_buffer, "OR A,#%02x\n", get_data_memory_byte(register_pc+1));
-		register_a |= get_data_memory_byte(register_pc+1);
-		set_flags(register_a);
-		// increment pc
-		register_pc += 2;
-		inc_sim_time(2);
+	} else {
+		// (longoff,X)
+		long_address = OPERAND(m->register_pc+1) << 8;
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "JP (%04x,X)", long_address);
 		
-		break;
-
-	case OR_SHORT:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "OR A,[%02x]\n", indirect_address);
-			inc_sim_time(4);
-			precode_92 = 0;
+		temp = m->register_x;
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "OR A,%02x\n", short_address);
-			inc_sim_time(3);
+		dest = long_address;
+		dest += temp;
+	
+		m->register_pc &= 0xffff0000;
+		m->register_pc |= dest;
 
-		}
-		register_a |= get_data_memory_byte(short_address);
-		set_flags(register_a);
-		// increment pc
-		register_pc += 2;
+		disasm(m, "JP (%04x,X)  [la=%04x temp=%02x]=%04x : pc=%08x\n", long_address, long_address, temp, dest, m->register_pc);
 		
-		break;
+	}
+}
 
-	case OR_LONG:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "OR A,[%02x.w]\n", indirect_address);
-			register_a |= get_data_memory_byte(long_address);
+// NOP
+template<unsigned int PRECODE_SPACE> void op_nop(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "NOP\n");
+	
+	// increment pc
+	m->register_pc++;
+}
 
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_92 = 0;
+// ADC A,x
+template<unsigned int PRECODE_SPACE> void op_adc_immed(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
 
-		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "OR A,%04x\n", long_address);
-			register_a |= get_data_memory_byte(long_address);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(5);
+	temp = OPERAND(m->register_pc+1);
+	disasm(m, "ADC A,#%02x\n", temp);
+	adc(m, temp);
+	// increment pc
+	m->register_pc += 2;
+}
 
-		}
-		set_flags(register_a);
-		
-		break;
+template<unsigned int PRECODE_SPACE> void op_adc_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
 
-	case OR_REG_IND:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "OR A,(Y)\n");
-			register_a |= get_data_memory_byte(register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "ADC A,[%02x]\n", indirect_address);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "ADC A,%02x\n", short_address);
+	}
+	adc(m, get_data_memory_byte(m, short_address));
+	// increment pc
+	m->register_pc += 2;
+}
 
-		} else {
-			sprintf((char *)print_buffer, "OR A,(X)\n");
-			register_a |= get_data_memory_byte(register_x);
-			inc_sim_time(3);
+template<unsigned int PRECODE_SPACE> void op_adc_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
 
-		}
-		set_flags(register_a);
-		// increment pc
-		register_pc++;
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "ADC A,[%02x.w]\n", indirect_address);
 		
-		break;
-
-	case OR_REG_IND_OFF_SHORT:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "OR A,(%02x,Y)\n", short_address);
-			register_a |= get_data_memory_byte(short_address+register_y);
-			inc_sim_time(5);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "OR A,([%02x],Y)\n", indirect_address);
-			register_a |= get_data_memory_byte(short_address+register_y);
-			inc_sim_time(6);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "OR A,([%02x],X)\n", indirect_address);
-			register_a |= get_data_memory_byte(short_address+register_x);
-			inc_sim_time(6);
-			precode_92 = 0;
-
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "OR A,(%02x,X)\n", short_address);
-			register_a |= get_data_memory_byte(short_address+register_x);
-			inc_sim_time(4);
-
-		}
-		set_flags(register_a);
+		adc(m, get_data_memory_byte(m, long_address));
 		// increment pc
-		register_pc += 2;
+		m->register_pc += 2;
+	} else {
+		// longmem
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "ADC A,%04x\n", long_address);
 		
-		break;
-
-	case OR_REG_IND_OFF_LONG:
-		if(precode_90) {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "OR A,(%04x,Y)\n", long_address);
-			register_a |= get_data_memory_byte(long_address+register_y);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(6);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "OR A,([%02x.w],Y)\n", indirect_address);
-			register_a |= get_data_memory_byte(long_address+register_y);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "OR A,([%02x.w],X)\n", indirect_address);
-			register_a |= get_data_memory_byte(long_address+register_x);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_92 = 0;
+		adc(m, get_data_memory_byte(m, long_address));
+		// increment pc
+		m->register_pc += 3;
+	}
+}
 
-		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "OR A,(%04x, X)\n", long_address);
-			register_a |= get_data_memory_byte(long_address+register_x);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(5);
+template<unsigned int PRECODE_SPACE> void op_adc_reg_ind(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "ADC A,(Y)\n");
+		adc(m, get_data_memory_byte(m, m->register_y));
+	} else {
+		disasm(m, "ADC A,(X)\n");
+		adc(m, get_data_memory_byte(m, m->register_x));
+	}
+	// increment pc
+	m->register_pc++;
+}
 
-		}
-		set_flags(register_a);
-		
-		break;
+template<unsigned int PRECODE_SPACE> void op_adc_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		// shortoff,y
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "ADC A,(%02x,Y)\n", short_address);
+		adc(m, get_data_memory_byte(m, short_address+m->register_y));
+
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		// [shortptr.w],y
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "ADC A,([%02x],Y)\n", indirect_address);
+		adc(m, get_data_memory_byte(m, short_address+m->register_y));
+
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		// [shortptr.w],x
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "ADC A,([%02x],X)\n", indirect_address);
+		adc(m, get_data_memory_byte(m, short_address+m->register_x));
 
-	// XOR A,x
-	case XOR_IMMED:
-		sprintf((char *)print_buffer, "XOR A,#%02x\n", get_data_memory_byte(register_pc+1));
-		register_a ^= get_data_memory_byte(register_pc+1);
-		set_flags(register_a);
+	} else {
+		// shortoff,X
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "ADC A,(%02x,X)\n", short_address);
+		adc(m, get_data_memory_byte(m, short_address+m->register_x));
+		m->register_a += get_data_memory_byte(m, short_address+m->register_x);
+	}
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_adc_reg_ind_off_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		// longoff,y
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "ADC A,(%04x,Y)\n", long_address);
+		adc(m, get_data_memory_byte(m, long_address+m->register_y));
+		// increment pc
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		// [shortptr.w],y
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "ADC A,([%02x.w],Y)\n", indirect_address);
+		adc(m, get_data_memory_byte(m, long_address+m->register_y));
+		// increment pc
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		//[shortptr.w],x
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "ADC A,([%02x.w],X)\n", indirect_address);
+		adc(m, get_data_memory_byte(m, long_address+m->register_x));
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		// longoff,X
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "ADC A,(%04x, X)\n", long_address);
+		adc(m, get_data_memory_byte(m, long_address+m->register_x));
 		// increment pc
-		register_pc += 2;
-		inc_sim_time(2);
-		
-		break;
+		m->register_pc += 3;
+	}
+}
 
-	case XOR_SHORT:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "XOR A,[%02x]\n", indirect_address);
-			inc_sim_time(5);
-			precode_92 = 0;
+// ADD A,x
+template<unsigned int PRECODE_SPACE> void op_add_immed(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "XOR A,%02x\n", short_address);
-			inc_sim_time(3);
+	temp = OPERAND(m->register_pc+1);
+	disasm(m, "ADD A,#%02x\n", temp);
+	add(m, temp);
+	// increment pc
+	m->register_pc += 2;
+}
 
-		}
-		register_a ^= get_data_memory_byte(short_address);
-		set_flags(register_a);
-		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case XOR_LONG:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "XOR A,[%02x.w]\n", indirect_address);
-			register_a ^= get_data_memory_byte(long_address);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_92 = 0;
+template<unsigned int PRECODE_SPACE> void op_add_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
 
-		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "XOR A,%04x\n", long_address);
-			register_a ^= get_data_memory_byte(long_address);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(5);
+	if(PRECODE_SPACE == PRECODE_92) {
+		// [short]
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "ADD A,[%02x]\n", indirect_address);
+	} else {
+		// short
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "ADD A,%02x\n", short_address);
+	}
+	add(m, get_data_memory_byte(m, short_address));
+	// increment pc
+	m->register_pc += 2;
+}
 
-		}
-		set_flags(register_a);
-		
-		break;
+template<unsigned int PRECODE_SPACE> void op_add_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		// [shortptr.w]
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "ADD A,[%02x.w]\n", indirect_address);
+		add(m, get_data_memory_byte(m, long_address));
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		// longmem
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "ADD A,%04x\n", long_address);
+		add(m, get_data_memory_byte(m, long_address));
+		// increment pc
+		m->register_pc += 3;
+	}
+}
 
-	case XOR_REG_IND:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "XOR A,(Y)\n");
-			register_a ^= get_data_memory_byte(register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
+template<unsigned int PRECODE_SPACE> void op_add_reg_ind(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		// (Y)
+		disasm(m, "ADD A,(Y)\n");
+		add(m, get_data_memory_byte(m, m->register_y));
+	} else {
+		// (X)
+		disasm(m, "ADD A,(X)\n");
+		add(m, get_data_memory_byte(m, m->register_x));
+	}
+	// increment pc
+	m->register_pc++;
+}
 
-		} else {
-			sprintf((char *)print_buffer, "XOR A,(X)\n");
-			register_a ^= get_data_memory_byte(register_x);
-			inc_sim_time(3);
+template<unsigned int PRECODE_SPACE> void op_add_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		// (shortoff,Y)
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "ADD A,(%02x,Y)\n", short_address);
+		add(m, get_data_memory_byte(m, short_address+m->register_y));
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		// ([short],Y) - Present in ST7, but not ST8
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "ADD A,([%02x],Y)\n", indirect_address);
+		add(m, get_data_memory_byte(m, short_address+m->register_y));
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		// ([short],X) - Present in ST7, but not ST8
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "ADD A,([%02x],X)\n", indirect_address);
+		add(m, get_data_memory_byte(m, short_address+m->register_x));
+	} else {
+		// (shortoff,X)
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "ADD A,(%02x,X)\n", short_address);
+		add(m, get_data_memory_byte(m, short_address+m->register_x));
+	}
+	// increment pc
+	m->register_pc += 2;
+}
 
-		}
-		set_flags(register_a);
+template<unsigned int PRECODE_SPACE> void op_add_reg_ind_off_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		// (longoff,Y)
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "ADD A,(%04x,Y)\n", long_address);
+		add(m, get_data_memory_byte(m, long_address+m->register_y));
+		// increment pc
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		// ([shortptr.w],Y)
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "ADD A,([%02x.w],Y)\n", indirect_address);
+		add(m, get_data_memory_byte(m, long_address+m->register_y));
+		// increment pc
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		// ([shortptr.w],X)
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "ADD A,([%02x.w],X)\n", indirect_address);
+		add(m, get_data_memory_byte(m, long_address+m->register_x));
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		// (longoff,X)
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "ADD A,(%04x, X)\n", long_address);
+		add(m, get_data_memory_byte(m, long_address+m->register_x));
 		// increment pc
-		register_pc++;
-		
-		break;
-
-	case XOR_REG_IND_OFF_SHORT:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "XOR A,(%02x,Y)\n", short_address);
-			register_a ^= get_data_memory_byte(short_address+register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "XOR A,([%02x],Y)\n", indirect_address);
-			register_a ^= get_data_memory_byte(short_address+register_y);
-			inc_sim_time(4);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "XOR A,([%02x],X)\n", indirect_address);
-			register_a ^= get_data_memory_byte(short_address+register_x);
-			inc_sim_time(4);
-			precode_92 = 0;
+		m->register_pc += 3;
+	}
+}
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "XOR A,(%02x,X)\n", short_address);
-			register_a ^= get_data_memory_byte(short_address+register_x);
-			inc_sim_time(4);
+// AND A,x
+template<unsigned int PRECODE_SPACE> void op_and_immed(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
+
+	temp = OPERAND(m->register_pc+1);
+	disasm(m, "AND A,#%02x\n", temp);
+	m->register_a &= temp;
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 2;
+}
 
-		}
-		set_flags(register_a);
+template<unsigned int PRECODE_SPACE> void op_and_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		// [short] - Present in ST7, but not ST8
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "AND A,[%02x]\n", indirect_address);
+	} else {
+		// shortmem
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "AND A,%02x\n", short_address);
+	}
+	m->register_a &= get_data_memory_byte(m, short_address);
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_and_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		// [shortptr.w]
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "AND A,[%02x.w]\n", indirect_address);
+		m->register_a &= get_data_memory_byte(m, long_address);
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		// longmem
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "AND A,%04x\n", long_address);
+		m->register_a &= get_data_memory_byte(m, long_address);
 		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case XOR_REG_IND_OFF_LONG:
-		if(precode_90) {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "XOR A,(%04x,Y)\n", long_address);
-			register_a ^= get_data_memory_byte(long_address+register_y);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(7);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "XOR A,([%02x.w],Y)\n", indirect_address);
-			register_a ^= get_data_memory_byte(long_address+register_y);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "XOR A,([%02x.w],X)\n", indirect_address);
-			register_a ^= get_data_memory_byte(long_address+register_x);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_92 = 0;
+		m->register_pc += 3;
+	}
+	set_flags(m, m->register_a);
+}
 
-		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "XOR A,(%04x, X)\n", long_address);
-			register_a ^= get_data_memory_byte(long_address+register_x);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(6);
+template<unsigned int PRECODE_SPACE> void op_and_reg_ind(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		// (Y)
+		disasm(m, "AND A,(Y)\n");
+		m->register_a &= get_data_memory_byte(m, m->register_y);
+	} else {
+		// (X)
+		disasm(m, "AND A,(X)\n");
+		m->register_a &= get_data_memory_byte(m, m->register_x);
+	}
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc++;
+}
 
-		}
-		set_flags(register_a);
-		
-		break;
+template<unsigned int PRECODE_SPACE> void op_and_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		// (shortoff,Y)
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "AND A,(%02x,Y)\n", short_address);
+		m->register_a &= get_data_memory_byte(m, short_address+m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		// ([short],Y) - Present in ST7 but not st8
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "AND A,([%02x],Y)\n", indirect_address);
+		m->register_a &= get_data_memory_byte(m, short_address+m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		// ([short],X) - - Present in ST7 but not st8
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "AND A,([%02x],X)\n", indirect_address);
+		m->register_a &= get_data_memory_byte(m, short_address+m->register_x);
+	} else {
+		// (shortoff,X)
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "AND A,(%02x,X)\n", short_address);
+		m->register_a &= get_data_memory_byte(m, short_address+m->register_x);
+	}
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 2;
+}
 
-	// SBC
-	case SBC_IMMED:
-		sprintf((char *)print_buffer, "SBC A,#%02x\n", get_data_memory_byte(register_pc+1));
-		sbc(get_data_memory_byte(register_pc+1));
+template<unsigned int PRECODE_SPACE> void op_and_reg_ind_off_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		// (longoff,Y)
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "AND A,(%04x,Y)\n", long_address);
+		m->register_a &= get_data_memory_byte(m, long_address+m->register_y);
+		// increment pc
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		// ([shortptr.w],Y)
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "AND A,([%02x.w],Y)\n", indirect_address);
+		m->register_a &= get_data_memory_byte(m, long_address+m->register_y);
+		// increment pc
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		// ([shortptr.w],X)
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "AND A,([%02x.w],X)\n", indirect_address);
+		m->register_a &= get_data_memory_byte(m, long_address+m->register_x);
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		// (longoff,X)
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "AND A,(%04x, X)\n", long_address);
+		m->register_a &= get_data_memory_byte(m, long_address+m->register_x);
 		// increment pc
-		register_pc += 2;
-		inc_sim_time(3);
-		
-		break;
+		m->register_pc += 3;
+	}
+	set_flags(m, m->register_a);
+}
 
-	case SBC_SHORT:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "SBC A,[%02x]\n", indirect_address);
-			inc_sim_time(5);
-			precode_92 = 0;
+// BCP A,x
+template<unsigned int PRECODE_SPACE> void op_bcp_immed(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp, bcp_temp;
+
+	temp = OPERAND(m->register_pc+1);
+	disasm(m, "BCP A,#%02x\n", temp);
+	bcp_temp = m->register_a;
+	bcp_temp &= temp;
+	set_flags(m, bcp_temp);
+	// increment pc
+	m->register_pc += 2;
+}
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "SBC A,%02x\n", short_address);
-			inc_sim_time(3);
+template<unsigned int PRECODE_SPACE> void op_bcp_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned char bcp_temp;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		// [short] - Present in ST7, but not ST8
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "BCP A,[%02x]\n", indirect_address);
+	} else {
+		// shortmem
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "BCP A,%02x\n", short_address);
+	}
+	bcp_temp = m->register_a;
+	bcp_temp &= get_data_memory_byte(m, short_address);
+	set_flags(m, bcp_temp);
+	// increment pc
+	m->register_pc += 2;
+}
 
+template<unsigned int PRECODE_SPACE> void op_bcp_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned char bcp_temp;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		// [shortptr.w]
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "BCP A,[%02x.w]\n", indirect_address);
+		bcp_temp = m->register_a;
+		bcp_temp &= get_data_memory_byte(m, long_address);
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		// longmem
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "BCP A,%04x\n", long_address);
+		bcp_temp = m->register_a;
+		bcp_temp &= get_data_memory_byte(m, long_address);
+		// increment pc
+		m->register_pc += 3;
+	}
+	set_flags(m, bcp_temp);
+}
+
+template<unsigned int PRECODE_SPACE> void op_bcp_reg_ind(struct machine *m, unsigned char instruction)
+{
+	unsigned char bcp_temp;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		// (Y)
+		disasm(m, "BCP A,(Y)\n");
+		bcp_temp = m->register_a;
+		bcp_temp &= get_data_memory_byte(m, m->register_y);
+	} else {
+		// (X)
+		disasm(m, "BCP A,(X)\n");
+		bcp_temp = m->register_a;
+		bcp_temp &= get_data_memory_byte(m, m->register_x);
+	}
+	set_flags(m, bcp_temp);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_bcp_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned char bcp_temp;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "BCP A,(%02x,Y)\n", short_address);
+		bcp_temp = m->register_a;
+		bcp_temp &= get_data_memory_byte(m, short_address+m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "BCP A,([%02x],Y)\n", indirect_address);
+		bcp_temp = m->register_a;
+		bcp_temp &= get_data_memory_byte(m, short_address+m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "BCP A,([%02x],X)\n", indirect_address);
+		bcp_temp = m->register_a;
+		bcp_temp &= get_data_memory_byte(m, short_address+m->register_x);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "BCP A,(%02x,X)\n", short_address);
+		bcp_temp = m->register_a;
+		bcp_temp &= get_data_memory_byte(m, short_address+m->register_x);
+	}		
+	set_flags(m, bcp_temp);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_bcp_reg_ind_off_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned char bcp_temp;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "BCP A,(%04x,Y)\n", long_address);
+		bcp_temp = m->register_a;
+		bcp_temp &= get_data_memory_byte(m, long_address+m->register_y);
+		// increment pc
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "BCP A,([%02x.w],Y)\n", indirect_address);
+		bcp_temp = m->register_a;
+		bcp_temp &= get_data_memory_byte(m, long_address+m->register_y);
+		// increment pc
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "BCP A,([%02x.w],X)\n", indirect_address);
+		bcp_temp = m->register_a;
+		bcp_temp &= get_data_memory_byte(m, long_address+m->register_x);
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "BCP A,(%04x, X)\n", long_address);
+		bcp_temp = m->register_a;
+		bcp_temp &= get_data_memory_byte(m, long_address+m->register_x);
+		// increment pc
+		m->register_pc += 3;
+	}
+	set_flags(m, bcp_temp);
+}
+
+// CP A,x
+template<unsigned int PRECODE_SPACE> void op_cp_immed(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp, bcp_temp;
+
+	temp = OPERAND(m->register_pc+1);
+	disasm(m, "CP A,#%02x\n", temp);
+	bcp_temp = temp;
+	if(bcp_temp > m->register_a) {
+		m->register_cc |= CARRY_BIT;
+	} else {
+		m->register_cc &= ~CARRY_BIT;
+	}
+	bcp_temp = m->register_a - bcp_temp;
+	set_flags(m, bcp_temp);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_cp_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned char bcp_temp;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "CP A,[%02x]\n", indirect_address);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "CP A,%02x\n", short_address);
+	}
+	bcp_temp = get_data_memory_byte(m, short_address);
+	if(bcp_temp > m->register_a) {
+		m->register_cc |= CARRY_BIT;
+	} else {
+		m->register_cc &= ~CARRY_BIT;
+	}
+	bcp_temp = m->register_a - bcp_temp;
+	set_flags(m, bcp_temp);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_cp_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned char temp, bcp_temp;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+
+		
+		temp = get_data_memory_byte(m, long_address);
+		bcp_temp = temp;
+		if(bcp_temp > m->register_a) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
 		}
-		sbc(get_data_memory_byte(short_address));
+		bcp_temp = m->register_a - bcp_temp;
+		disasm(m, "CP A,[%02x.w] []=%04x (%04x)=%02x {%02x-%02x=%02x}\n", indirect_address, long_address, long_address, temp, m->register_a, temp, bcp_temp);
+		
 		// increment pc
-		register_pc += 2;
+		m->register_pc += 2;
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
 		
-		break;
-
-	case SBC_LONG:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "SBC A,[%02x.w]\n", indirect_address);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(5);
-			precode_92 = 0;
-
+		temp = get_data_memory_byte(m, long_address);
+		bcp_temp = temp;
+		if(bcp_temp > m->register_a) {
+			m->register_cc |= CARRY_BIT;
 		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "SBC A,%04x\n", long_address);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(4);
-
+			m->register_cc &= ~CARRY_BIT;
 		}
-		sbc(get_data_memory_byte(long_address));
+		bcp_temp = m->register_a - bcp_temp;
+		disasm(m, "CP A,%04x {%02x-%02x=%02x}\n", long_address, m->register_a, temp, bcp_temp);
 		
-		break;
+		// increment pc
+		m->register_pc += 3;
+	}
+	set_flags(m, bcp_temp);
+}
 
-	case SBC_REG_IND:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "SBC A,(Y)\n");
-			sbc(get_data_memory_byte(register_y));
-			inc_sim_time(4);
-			precode_90 = 0;
+template<unsigned int PRECODE_SPACE> void op_cp_reg_ind(struct machine *m, unsigned char instruction)
+{
+	unsigned char bcp_temp;
 
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "CP A,(Y)\n");
+		bcp_temp = get_data_memory_byte(m, m->register_y);
+		if(bcp_temp > m->register_a) {
+			m->register_cc |= CARRY_BIT;
 		} else {
-			sprintf((char *)print_buffer, "SBC A,(X)\n");
-			sbc(get_data_memory_byte(register_x));
-			inc_sim_time(3);
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_a - bcp_temp;
+	} else {
+		disasm(m, "CP A,(X)\n");
+		bcp_temp = get_data_memory_byte(m, m->register_x);
+		if(bcp_temp > m->register_a) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_a - bcp_temp;
+	}
+	set_flags(m, bcp_temp);
+	// increment pc
+	m->register_pc++;
+}
 
+template<unsigned int PRECODE_SPACE> void op_cp_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned char bcp_temp;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "CP A,(%02x,Y)\n", short_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_y);
+		if(bcp_temp > m->register_a) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_a - bcp_temp;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "CP A,([%02x],Y)\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_y);
+		if(bcp_temp > m->register_a) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_a - bcp_temp;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "CP A,([%02x],X)\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_x);
+		if(bcp_temp > m->register_a) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_a - bcp_temp;
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "CP A,(%02x,X)\n", short_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_x);
+		if(bcp_temp > m->register_a) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
 		}
-		// increment pc
-		register_pc++;
-		
-		break;
-
-	case SBC_REG_IND_OFF_SHORT:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "SBC A,(%02x,Y)\n", short_address);
-			sbc(get_data_memory_byte(short_address+register_y));
-			inc_sim_time(5);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "SBC A,([%02x],Y)\n", indirect_address);
-			sbc(get_data_memory_byte(short_address+register_y));
-			inc_sim_time(6);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "SBC A,([%02x],X)\n", indirect_address);
-			sbc(get_data_memory_byte(short_address+register_x));
-			inc_sim_time(6);
-			precode_92 = 0;
+		bcp_temp = m->register_a - bcp_temp;
+	}
+	set_flags(m, bcp_temp);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_cp_reg_ind_off_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned char bcp_temp;
+	unsigned int long_address;
+	unsigned short short_indirect_address;
 
+	if(PRECODE_SPACE == PRECODE_72) {
+
+		short_indirect_address = (OPERAND(m->register_pc+1) << 8);
+		short_indirect_address |= OPERAND(m->register_pc+2);
+
+		long_address = get_data_memory_byte(m, short_indirect_address) << 8;
+		long_address |= get_data_memory_byte(m, short_indirect_address+1);
+		disasm(m, "CP A,([%04x],X) (LA=%08x, EA=%08x)\n", short_indirect_address, long_address, long_address+m->register_x);
+		bcp_temp = get_data_memory_byte(m, long_address+m->register_x);
+		if(bcp_temp > m->register_a) {
+			m->register_cc |= CARRY_BIT;
 		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "SBC A,(%02x,X)\n", short_address);
-			sbc(get_data_memory_byte(short_address+register_x));
-			inc_sim_time(4);
+			m->register_cc &= ~CARRY_BIT;
 		}
+		bcp_temp = m->register_a - bcp_temp;
 		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case SBC_REG_IND_OFF_LONG:
-		if(precode_90) {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "SBC A,(%04x,Y)\n", long_address);
-			sbc(get_data_memory_byte(long_address+register_y));
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(6);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "SBC A,([%02x.w],Y)\n", indirect_address);
-			sbc(get_data_memory_byte(long_address+register_y));
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "SBC A,([%02x.w],X)\n", indirect_address);
-			sbc(get_data_memory_byte(long_address+register_x));
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_92 = 0;
-
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_90) {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "CP A,(%04x,Y)\n", long_address);
+		bcp_temp = get_data_memory_byte(m, long_address+m->register_y);
+		if(bcp_temp > m->register_a) {
+			m->register_cc |= CARRY_BIT;
 		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "SBC A,(%04x, X)\n", long_address);
-			sbc(get_data_memory_byte(long_address+register_x));
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(5);
-
+			m->register_cc &= ~CARRY_BIT;
 		}
-		register_a -= register_cc & CARRY_BIT;
-		set_flags(register_a);
-		
-		break;
-
-	// SUB
-	case SUB_IMMED:
-		sprintf((char *)print_buffer, "SUB A,#%02x\n", get_data_memory_byte(register_pc+1));
-		bcp_temp = get_data_memory_byte(register_pc+1);
-		if(bcp_temp > register_a) {
-			register_cc |= CARRY_BIT;
+		bcp_temp = m->register_a - bcp_temp;
+		// increment pc
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "CP A,([%02x.w],Y)\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, long_address+m->register_y);
+		if(bcp_temp > m->register_a) {
+			m->register_cc |= CARRY_BIT;
 		} else {
-			register_cc &= ~CARRY_BIT;
+			m->register_cc &= ~CARRY_BIT;
 		}
-		register_a -= bcp_temp;
-		set_flags(register_a);
+		bcp_temp = m->register_a - bcp_temp;
 		// increment pc
-		register_pc += 2;
-		inc_sim_time(2);
-		
-		break;
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "CP A,([%02x.w],X)\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, long_address+m->register_x);
+		if(bcp_temp > m->register_a) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_a - bcp_temp;
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "CP A,(%04x, X)\n", long_address);
+		bcp_temp = get_data_memory_byte(m, long_address+m->register_x);
+		if(bcp_temp > m->register_a) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_a - bcp_temp;
+		// increment pc
+		m->register_pc += 3;
+	}
+	set_flags(m, bcp_temp);
+	if(bcp_temp > m->register_a) {
+		m->register_cc |= CARRY_BIT;
+	} else {
+		m->register_cc &= ~CARRY_BIT;
+	}
+}
 
-	case SUB_SHORT:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "SUB A,[%02x]\n", indirect_address);
-			inc_sim_time(5);
-			precode_92 = 0;
+// CP X,x
+template<unsigned int PRECODE_SPACE> void op_cp_x_immed(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp, bcp_temp;
 
+	if(PRECODE_SPACE == PRECODE_90) {
+		temp = OPERAND(m->register_pc+1);
+		disasm(m, "CP Y,#%02x\n", temp);
+		bcp_temp = temp;
+		if(bcp_temp > m->register_y) {
+			m->register_cc |= CARRY_BIT;
 		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "SUB A,%02x\n", short_address);
-			inc_sim_time(3);
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_y - bcp_temp;
+		set_flags(m, bcp_temp);
+	} else {
+		temp = OPERAND(m->register_pc+1);
+		disasm(m, "CP X,#%02x\n", temp);
+		bcp_temp = temp;
+		if(bcp_temp > m->register_x) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_x - bcp_temp;
+		set_flags(m, bcp_temp);
+	}
+	// increment pc
+	m->register_pc += 2;
+}
 
+template<unsigned int PRECODE_SPACE> void op_cp_x_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned char bcp_temp;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "CP Y,%02x\n", short_address);
+		bcp_temp = get_data_memory_byte(m, short_address);
+		if(bcp_temp > m->register_y) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_y - bcp_temp;
+		set_flags(m, bcp_temp);
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "CP Y,[%02x]\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, short_address);
+		if(bcp_temp > m->register_y) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_y - bcp_temp;
+		set_flags(m, bcp_temp);
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "CP X,[%02x]\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, short_address);
+		if(bcp_temp > m->register_x) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_x - bcp_temp;
+		set_flags(m, bcp_temp);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "CP X,%02x\n", short_address);
+		bcp_temp = get_data_memory_byte(m, short_address);
+		if(bcp_temp > m->register_x) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
 		}
-		bcp_temp = get_data_memory_byte(short_address);
-		if(bcp_temp > register_a) {
-			register_cc |= CARRY_BIT;
+		bcp_temp = m->register_x - bcp_temp;
+		set_flags(m, bcp_temp);
+	}
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_cp_x_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned char bcp_temp;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "CP Y,%04x\n", long_address);
+		bcp_temp = get_data_memory_byte(m, long_address);
+		if(bcp_temp > m->register_y) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_y - bcp_temp;
+		set_flags(m, bcp_temp);
+		// increment pc
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "CP Y,[%02x.w]\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, long_address);
+		if(bcp_temp > m->register_a) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_y - bcp_temp;
+		set_flags(m, bcp_temp);
+		// increment pc
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "CP X,[%02x.w]\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, long_address);
+		if(bcp_temp > m->register_x) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_x - bcp_temp;
+		set_flags(m, bcp_temp);
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "CP X,%04x\n", long_address);
+		bcp_temp = get_data_memory_byte(m, long_address);
+		if(bcp_temp > m->register_x) {
+			m->register_cc |= CARRY_BIT;
 		} else {
-			register_cc &= ~CARRY_BIT;
+			m->register_cc &= ~CARRY_BIT;
 		}
-		register_a -= bcp_temp;
-		set_flags(register_a);
+		bcp_temp = m->register_x - bcp_temp;
+		set_flags(m, bcp_temp);
 		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case SUB_LONG:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "SUB A,[%02x.w]\n", indirect_address);
-			bcp_temp = get_data_memory_byte(long_address);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_92 = 0;
+		m->register_pc += 3;
+	}
+}
+
+template<unsigned int PRECODE_SPACE> void op_cp_x_reg_ind(struct machine *m, unsigned char instruction)
+{
+	unsigned char bcp_temp;
 
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "CP Y,(Y)\n");
+		bcp_temp = get_data_memory_byte(m, m->register_y);
+		if(bcp_temp > m->register_y) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_y - bcp_temp;
+		set_flags(m, bcp_temp);
+	} else {
+		disasm(m, "CP X,(X)\n");
+		bcp_temp = get_data_memory_byte(m, m->register_x);
+		if(bcp_temp > m->register_x) {
+			m->register_cc |= CARRY_BIT;
 		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "SUB A,%04x\n", long_address);
-			bcp_temp = get_data_memory_byte(long_address);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(5);
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_x - bcp_temp;
+		set_flags(m, bcp_temp);
+	}
+	// increment pc
+	m->register_pc++;
+}
 
+template<unsigned int PRECODE_SPACE> void op_cp_x_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned char bcp_temp;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "CP Y,(%02x,Y)\n", short_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_y);
+		if(bcp_temp > m->register_y) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_y - bcp_temp;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "CP Y,([%02x],Y)\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_y);
+		if(bcp_temp > m->register_y) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_y - bcp_temp;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "CP X,([%02x],X)\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_x);
+		if(bcp_temp > m->register_x) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_x - bcp_temp;
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "CP X,(%02x,X)\n", short_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_x);
+		if(bcp_temp > m->register_x) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
 		}
-		if(bcp_temp > register_a) {
-			register_cc |= CARRY_BIT;
+		bcp_temp = m->register_x - bcp_temp;
+	}
+	set_flags(m, bcp_temp);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_cp_x_reg_ind_off_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned char bcp_temp;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "CP Y,(%04x,Y)\n", long_address);
+		bcp_temp = get_data_memory_byte(m, long_address+m->register_y);
+		if(bcp_temp > m->register_y) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_y - bcp_temp;
+		// increment pc
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "CP Y,([%02x.w],Y)\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, long_address+m->register_y);
+		if(bcp_temp > m->register_y) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_y - bcp_temp;
+		// increment pc
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "CP X,([%02x.w],X)\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, long_address+m->register_x);
+		if(bcp_temp > m->register_x) {
+			m->register_cc |= CARRY_BIT;
+		} else {
+			m->register_cc &= ~CARRY_BIT;
+		}
+		bcp_temp = m->register_x - bcp_temp;
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "CP X,(%04x, X)\n", long_address);
+		bcp_temp = get_data_memory_byte(m, long_address+m->register_x);
+		if(bcp_temp > m->register_x) {
+			m->register_cc |= CARRY_BIT;
 		} else {
-			register_cc &= ~CARRY_BIT;
+			m->register_cc &= ~CARRY_BIT;
 		}
-		register_a -= bcp_temp;
-		set_flags(register_a);
-		
-		break;
+		bcp_temp = m->register_x - bcp_temp;
+		// increment pc
+		m->register_pc += 3;
+	}
+	set_flags(m, bcp_temp);
+}
+
+// OR A,x
+template<unsigned int PRECODE_SPACE> void op_or_immed(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
+
+	temp = OPERAND(m->register_pc+1);
+	disasm(m, "OR A,#%02x\n", temp);
+	m->register_a |= temp;
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_or_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "OR A,[%02x]\n", indirect_address);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "OR A,%02x\n", short_address);
+	}
+	m->register_a |= get_data_memory_byte(m, short_address);
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_or_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "OR A,[%02x.w]\n", indirect_address);
+		m->register_a |= get_data_memory_byte(m, long_address);
+
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "OR A,%04x\n", long_address);
+		m->register_a |= get_data_memory_byte(m, long_address);
+		// increment pc
+		m->register_pc += 3;
+	}
+	set_flags(m, m->register_a);
+}
+
+template<unsigned int PRECODE_SPACE> void op_or_reg_ind(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "OR A,(Y)\n");
+		m->register_a |= get_data_memory_byte(m, m->register_y);
+	} else {
+		disasm(m, "OR A,(X)\n");
+		m->register_a |= get_data_memory_byte(m, m->register_x);
+	}
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_or_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "OR A,(%02x,Y)\n", short_address);
+		m->register_a |= get_data_memory_byte(m, short_address+m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "OR A,([%02x],Y)\n", indirect_address);
+		m->register_a |= get_data_memory_byte(m, short_address+m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "OR A,([%02x],X)\n", indirect_address);
+		m->register_a |= get_data_memory_byte(m, short_address+m->register_x);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "OR A,(%02x,X)\n", short_address);
+		m->register_a |= get_data_memory_byte(m, short_address+m->register_x);
+	}
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_or_reg_ind_off_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "OR A,(%04x,Y)\n", long_address);
+		m->register_a |= get_data_memory_byte(m, long_address+m->register_y);
+		// increment pc
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "OR A,([%02x.w],Y)\n", indirect_address);
+		m->register_a |= get_data_memory_byte(m, long_address+m->register_y);
+		// increment pc
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "OR A,([%02x.w],X)\n", indirect_address);
+		m->register_a |= get_data_memory_byte(m, long_address+m->register_x);
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "OR A,(%04x, X)\n", long_address);
+		m->register_a |= get_data_memory_byte(m, long_address+m->register_x);
+		// increment pc
+		m->register_pc += 3;
+	}
+	set_flags(m, m->register_a);
+}
+
+// XOR A,x
+template<unsigned int PRECODE_SPACE> void op_xor_immed(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
+
+	temp = OPERAND(m->register_pc+1);
+	disasm(m, "XOR A,#%02x\n", temp);
+	m->register_a ^= temp;
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_xor_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "XOR A,[%02x]\n", indirect_address);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "XOR A,%02x\n", short_address);
+	}
+	m->register_a ^= get_data_memory_byte(m, short_address);
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_xor_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "XOR A,[%02x.w]\n", indirect_address);
+		m->register_a ^= get_data_memory_byte(m, long_address);
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "XOR A,%04x\n", long_address);
+		m->register_a ^= get_data_memory_byte(m, long_address);
+		// increment pc
+		m->register_pc += 3;
+	}
+	set_flags(m, m->register_a);
+}
+
+template<unsigned int PRECODE_SPACE> void op_xor_reg_ind(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "XOR A,(Y)\n");
+		m->register_a ^= get_data_memory_byte(m, m->register_y);
+	} else {
+		disasm(m, "XOR A,(X)\n");
+		m->register_a ^= get_data_memory_byte(m, m->register_x);
+	}
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_xor_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "XOR A,(%02x,Y)\n", short_address);
+		m->register_a ^= get_data_memory_byte(m, short_address+m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "XOR A,([%02x],Y)\n", indirect_address);
+		m->register_a ^= get_data_memory_byte(m, short_address+m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "XOR A,([%02x],X)\n", indirect_address);
+		m->register_a ^= get_data_memory_byte(m, short_address+m->register_x);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "XOR A,(%02x,X)\n", short_address);
+		m->register_a ^= get_data_memory_byte(m, short_address+m->register_x);
+	}
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_xor_reg_ind_off_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "XOR A,(%04x,Y)\n", long_address);
+		m->register_a ^= get_data_memory_byte(m, long_address+m->register_y);
+		// increment pc
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "XOR A,([%02x.w],Y)\n", indirect_address);
+		m->register_a ^= get_data_memory_byte(m, long_address+m->register_y);
+		// increment pc
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "XOR A,([%02x.w],X)\n", indirect_address);
+		m->register_a ^= get_data_memory_byte(m, long_address+m->register_x);
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "XOR A,(%04x, X)\n", long_address);
+		m->register_a ^= get_data_memory_byte(m, long_address+m->register_x);
+		// increment pc
+		m->register_pc += 3;
+	}
+	set_flags(m, m->register_a);
+}
+
+// SBC
+template<unsigned int PRECODE_SPACE> void op_sbc_immed(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
+
+	temp = OPERAND(m->register_pc+1);
+	disasm(m, "SBC A,#%02x\n", temp);
+	sbc(m, temp);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_sbc_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "SBC A,[%02x]\n", indirect_address);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "SBC A,%02x\n", short_address);
+	}
+	sbc(m, get_data_memory_byte(m, short_address));
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_sbc_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "SBC A,[%02x.w]\n", indirect_address);
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "SBC A,%04x\n", long_address);
+		// increment pc
+		m->register_pc += 3;
+	}
+	sbc(m, get_data_memory_byte(m, long_address));
+}
+
+template<unsigned int PRECODE_SPACE> void op_sbc_reg_ind(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "SBC A,(Y)\n");
+		sbc(m, get_data_memory_byte(m, m->register_y));
+	} else {
+		disasm(m, "SBC A,(X)\n");
+		sbc(m, get_data_memory_byte(m, m->register_x));
+	}
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_sbc_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "SBC A,(%02x,Y)\n", short_address);
+		sbc(m, get_data_memory_byte(m, short_address+m->register_y));
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "SBC A,([%02x],Y)\n", indirect_address);
+		sbc(m, get_data_memory_byte(m, short_address+m->register_y));
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "SBC A,([%02x],X)\n", indirect_address);
+		sbc(m, get_data_memory_byte(m, short_address+m->register_x));
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "SBC A,(%02x,X)\n", short_address);
+		sbc(m, get_data_memory_byte(m, short_address+m->register_x));
+	}
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_sbc_reg_ind_off_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "SBC A,(%04x,Y)\n", long_address);
+		sbc(m, get_data_memory_byte(m, long_address+m->register_y));
+		// increment pc
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "SBC A,([%02x.w],Y)\n", indirect_address);
+		sbc(m, get_data_memory_byte(m, long_address+m->register_y));
+		// increment pc
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "SBC A,([%02x.w],X)\n", indirect_address);
+		sbc(m, get_data_memory_byte(m, long_address+m->register_x));
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "SBC A,(%04x, X)\n", long_address);
+		sbc(m, get_data_memory_byte(m, long_address+m->register_x));
+		// increment pc
+		m->register_pc += 3;
+	}
+	m->register_a -= m->register_cc & CARRY_BIT;
+	set_flags(m, m->register_a);
+}
+
+// SUB
+template<unsigned int PRECODE_SPACE> void op_sub_immed(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp, bcp_temp;
+
+	temp = OPERAND(m->register_pc+1);
+	disasm(m, "SUB A,#%02x\n", temp);
+	bcp_temp = temp;
+	if(bcp_temp > m->register_a) {
+		m->register_cc |= CARRY_BIT;
+	} else {
+		m->register_cc &= ~CARRY_BIT;
+	}
+	m->register_a -= bcp_temp;
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_sub_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned char bcp_temp;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "SUB A,[%02x]\n", indirect_address);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "SUB A,%02x\n", short_address);
+	}
+	bcp_temp = get_data_memory_byte(m, short_address);
+	if(bcp_temp > m->register_a) {
+		m->register_cc |= CARRY_BIT;
+	} else {
+		m->register_cc &= ~CARRY_BIT;
+	}
+	m->register_a -= bcp_temp;
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_sub_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned char bcp_temp;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "SUB A,[%02x.w]\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, long_address);
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "SUB A,%04x\n", long_address);
+		bcp_temp = get_data_memory_byte(m, long_address);
+		// increment pc
+		m->register_pc += 3;
+	}
+	if(bcp_temp > m->register_a) {
+		m->register_cc |= CARRY_BIT;
+	} else {
+		m->register_cc &= ~CARRY_BIT;
+	}
+	m->register_a -= bcp_temp;
+	set_flags(m, m->register_a);
+}
+
+template<unsigned int PRECODE_SPACE> void op_sub_reg_ind(struct machine *m, unsigned char instruction)
+{
+	unsigned char bcp_temp;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "SUB A,(Y)\n");
+		bcp_temp = get_data_memory_byte(m, m->register_y);
+	} else {
+		disasm(m, "SUB A,(X)\n");
+		bcp_temp = get_data_memory_byte(m, m->register_x);
+	}
+	if(bcp_temp > m->register_a) {
+		m->register_cc |= CARRY_BIT;
+	} else {
+		m->register_cc &= ~CARRY_BIT;
+	}
+	m->register_a -= bcp_temp;
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_sub_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned char bcp_temp;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "SUB A,(%02x,Y)\n", short_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "SUB A,([%02x],Y)\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "SUB A,([%02x],X)\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_x);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "SUB A,(%02x,X)\n", short_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_x);
+	}
+	if(bcp_temp > m->register_a) {
+		m->register_cc |= CARRY_BIT;
+	} else {
+		m->register_cc &= ~CARRY_BIT;
+	}
+	m->register_a -= bcp_temp;
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_sub_reg_ind_off_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned char bcp_temp;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "SUB A,(%04x,Y)\n", long_address);
+		bcp_temp = get_data_memory_byte(m, long_address+m->register_y);
+		// increment pc
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "SUB A,([%02x.w],Y)\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, long_address+m->register_y);
+		// increment pc
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "SUB A,([%02x.w],X)\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, long_address+m->register_x);
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "SUB A,(%04x, X)\n", long_address);
+		bcp_temp = get_data_memory_byte(m, long_address+m->register_x);
+		// increment pc
+		m->register_pc += 3;
+	}
+	if(bcp_temp > m->register_a) {
+		m->register_cc |= CARRY_BIT;
+	} else {
+		m->register_cc &= ~CARRY_BIT;
+	}
+	m->register_a -= bcp_temp;
+	set_flags(m, m->register_a);
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_a_x(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "LD A,Y\n");
+		m->register_a = m->register_y;
+
+	} else {
+		disasm(m, "LD A,X\n");
+		m->register_a = m->register_x;
+	}
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_x_a(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "LD Y,A\n");
+		m->register_y = m->register_a;
+
+	} else {
+		disasm(m, "LD X,A\n");
+		m->register_x = m->register_a;
+	}
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_x_y(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "LD Y,X\n");
+		m->register_y = m->register_x;
+
+	} else {
+		disasm(m, "LD X,Y\n");
+		m->register_x = m->register_y;
+	}
+	set_flags(m, m->register_x);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_a_s(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "LD A,S\n");
+	m->register_a = m->register_sp & 0xff;
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_s_a(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "LD S,A\n");
+	m->register_sp &= 0xff00;
+	m->register_sp |= m->register_a;
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_x_s(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "LD X,S\n");
+	m->register_x = m->register_sp & 0xff;
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_s_x(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "LD S,X\n");
+	m->register_sp &= 0xff00;
+	m->register_sp |= m->register_x;
+	set_flags(m, m->register_x);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_a_immed(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
+
+	temp = OPERAND(m->register_pc+1);
+	disasm(m, "LD A,#%02x\n", temp);
+	m->register_a = temp;
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_a_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		disasm(m, "LD A,[%02x]\n", indirect_address);
+		short_address = get_data_memory_byte(m, indirect_address);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "LD A,%02x\n", short_address);
+	}
+	m->register_a = get_data_memory_byte(m, short_address);
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_a_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_72) {
+
+		disasm(m, "LD A,[xxxx.w] (st8) goes here\n");
+
+		// unhandled precode handler will catch this
+
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		// [long.w]
+		indirect_address = OPERAND(m->register_pc+1);
+		disasm(m, "LD A,[%02x.w]\n", indirect_address);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		// long
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "LD A,%04x\n", long_address);
+		// increment pc
+		m->register_pc += 3;
+	}
+	m->register_a = get_data_memory_byte(m, long_address);
+	set_flags(m, m->register_a);
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_a_reg_ind(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "LD A,(Y)\n");
+		m->register_a = get_data_memory_byte(m, m->register_y);
+	} else {
+		disasm(m, "LD A,(X)\n");
+		m->register_a = get_data_memory_byte(m, m->register_x);
+	}
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_a_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+
+		disasm(m, "LD A,(%02x,Y)\n", short_address);
+		m->register_a = get_data_memory_byte(m, short_address+m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1); 
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "LD A,([%02x],Y)\n", indirect_address);
+		m->register_a = get_data_memory_byte(m, short_address+m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1); 
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "LD A,([%02x],X)\n", indirect_address);
+		m->register_a = get_data_memory_byte(m, short_address+m->register_x);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "LD A,(%02x,X)\n", short_address);
+		m->register_a = get_data_memory_byte(m, short_address+m->register_x);
+	}
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_a_reg_ind_off_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "LD A,(%04x,Y)\n", long_address);
+		m->register_a = get_data_memory_byte(m, long_address+m->register_y);
+		// increment pc
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "LD A,([%02x.w],Y) []=%02x LA=%04x Y=%02x EA=%08x\n", indirect_address, indirect_address, long_address, m->register_y, long_address+m->register_y);
+		m->register_a = get_data_memory_byte(m, long_address+m->register_y);
+		// increment pc
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "LD A,([%02x.w],X)\n", indirect_address);
+		m->register_a = get_data_memory_byte(m, long_address+m->register_x);
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "LD A,(%04x,X)\n", long_address);
+		m->register_a = get_data_memory_byte(m, long_address+m->register_x);
+		// increment pc
+		m->register_pc += 3;
+	}
+	set_flags(m, m->register_a);
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_a_sp_ind(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address;
+
+	short_address = OPERAND(m->register_pc+1);
+		disasm(m, "LD A,(%02x,SP)\n", short_address);
+	m->register_a = get_data_memory_byte(m, short_address+m->register_sp);
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 2;
+}
+
+// LD x,A
+template<unsigned int PRECODE_SPACE> void op_ld_short_a(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "LD [%02x],A\n", indirect_address);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "LD %02x,A\n", short_address);
+	}
+	put_data_memory_byte(m, short_address, m->register_a);
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_long_a(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "LD [%02x.w],A\n", indirect_address);
+		put_data_memory_byte(m, long_address, m->register_a);
+		set_flags(m, m->register_a);
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "LD %04x,A\n", long_address);
+		put_data_memory_byte(m, long_address, m->register_a);
+		set_flags(m, m->register_a);			
+		// increment pc
+		m->register_pc += 3;
+	}
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_reg_ind_a(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "LD (Y),A\n");
+		put_data_memory_byte(m, m->register_y, m->register_a);
+	} else {
+		disasm(m, "LD (X),A\n");
+		put_data_memory_byte(m, m->register_x, m->register_a);
+	}
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_reg_ind_off_short_a(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "LD (%02x,Y),A\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_y, m->register_a);
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "LD ([%02x],Y),A\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_y, m->register_a);
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "LD ([%02x],X),A\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_x, m->register_a);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "LD (%02x,X),A\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_x, m->register_a);
+	}
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_reg_ind_off_long_a(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
+	unsigned short short_indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_72) {
+		short_indirect_address = (OPERAND(m->register_pc+1) << 8);
+		short_indirect_address |= OPERAND(m->register_pc+2);
+		long_address = get_data_memory_byte(m, short_indirect_address) << 8;
+		long_address |= get_data_memory_byte(m, short_indirect_address+1);
+		disasm(m, "LD ([%04x],X),A (LA=%08x, EA=%08x)\n", short_indirect_address, long_address, long_address+m->register_x);
+		put_data_memory_byte(m, long_address+m->register_x, m->register_a);
+		// increment pc
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_90) {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "LD (%04x,Y),A\n", long_address);
+		put_data_memory_byte(m, long_address+m->register_y, m->register_a);
+		// increment pc
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "LD ([%02x.w],Y),A\n", indirect_address);
+		put_data_memory_byte(m, long_address+m->register_y, m->register_a);
+		// increment pc
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "LD ([%02x.w],X),A\n", indirect_address);
+		put_data_memory_byte(m, long_address+m->register_x, m->register_a);
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "LD (%04x,X),A\n", long_address);
+		put_data_memory_byte(m, long_address+m->register_x, m->register_a);
+		// increment pc
+		m->register_pc += 3;
+	}
+	set_flags(m, m->register_a);
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_sp_ind_a(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address;
+
+	// st8
+	short_address = OPERAND(m->register_pc+1);
+	disasm(m, "LD (%02x,SP),A\n", short_address);
+	put_data_memory_byte(m, short_address+m->register_sp, m->register_a);
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc += 2;
+}
+
+// LD X, x	// 0xae
+template<unsigned int PRECODE_SPACE> void op_ld_x_immed(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		temp = OPERAND(m->register_pc+1);
+		disasm(m, "LD Y,#%02x\n", temp);
+		m->register_y = temp;
+		set_flags(m, m->register_y);
+	} else {
+		temp = OPERAND(m->register_pc+1);
+		disasm(m, "LD X,#%02x\n", temp);
+		m->register_x = temp;
+		set_flags(m, m->register_x);
+	}
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_x_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "LD Y,%02x\n", short_address);
+		m->register_y = get_data_memory_byte(m, short_address);
+		set_flags(m, m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "LD Y,[%02x]\n", indirect_address);
+		m->register_y = get_data_memory_byte(m, short_address);
+		set_flags(m, m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "LD X,[%02x]\n", indirect_address);
+		m->register_x = get_data_memory_byte(m, short_address);
+		set_flags(m, m->register_x);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "LD X,%02x\n", short_address);
+		m->register_x = get_data_memory_byte(m, short_address);
+		set_flags(m, m->register_x);
+	}
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_x_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "LD Y,%04x\n", long_address);
+		m->register_y = get_data_memory_byte(m, long_address);
+		set_flags(m, m->register_y);
+		// increment pc
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "LD Y,[%02x.w]\n", indirect_address);
+		m->register_y = get_data_memory_byte(m, long_address);
+		set_flags(m, m->register_y);
+		// increment pc
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "LD X,[%02x.w]\n", indirect_address);
+		m->register_x = get_data_memory_byte(m, long_address);
+		set_flags(m, m->register_x);
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "LD X,%04x\n", long_address);
+		m->register_x = get_data_memory_byte(m, long_address);
+		set_flags(m, m->register_x);
+		// increment pc
+		m->register_pc += 3;
+	}
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_x_reg_ind(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "LD Y,(Y)\n");
+		m->register_y = get_data_memory_byte(m, m->register_y);
+		set_flags(m, m->register_y);
+	} else {
+		disasm(m, "LD X,(X)\n");
+		m->register_x = get_data_memory_byte(m, m->register_x);
+		set_flags(m, m->register_x);
+	}
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_x_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "LD Y,(%02x,Y)\n", short_address);
+		m->register_y = get_data_memory_byte(m, short_address+m->register_y);
+		set_flags(m, m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "LD Y,([%02x],Y)\n", indirect_address);
+		m->register_y = get_data_memory_byte(m, short_address+m->register_y);
+		set_flags(m, m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "LD X,([%02x],X)\n", indirect_address);
+		m->register_x = get_data_memory_byte(m, short_address+m->register_x);
+		set_flags(m, m->register_x);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "LD X,(%02x,X)\n", short_address);
+		m->register_x = get_data_memory_byte(m, short_address+m->register_x);
+		set_flags(m, m->register_x);
+	}
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_x_reg_ind_off_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "LD Y,(%04x,Y)\n", long_address);
+		m->register_y = get_data_memory_byte(m, long_address+m->register_y);
+		set_flags(m, m->register_y);
+		// increment pc
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "LD Y,([%02x.w],Y)\n", indirect_address);
+		m->register_y = get_data_memory_byte(m, long_address+m->register_y);
+		set_flags(m, m->register_y);
+		// increment pc
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "LD X,([%02x.w],X)\n", indirect_address);
+		m->register_x = get_data_memory_byte(m, long_address+m->register_x);
+		set_flags(m, m->register_x);
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "LD X,(%04x,X)\n", long_address);
+		m->register_x = get_data_memory_byte(m, long_address+m->register_x);
+		set_flags(m, m->register_x);
+		// increment pc
+		m->register_pc += 3;
+	}
+}
+
+// LD x,X
+template<unsigned int PRECODE_SPACE> void op_ld_short_x(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "LD %02x,Y\n", short_address);
+		put_data_memory_byte(m, short_address, m->register_y);
+		set_flags(m, m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "LD [%02x],Y\n", indirect_address);
+		put_data_memory_byte(m, short_address, m->register_y);
+		set_flags(m, m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "LD [%02x],X\n", indirect_address);
+		put_data_memory_byte(m, short_address, m->register_x);
+		set_flags(m, m->register_x);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "LD %02x,X\n", short_address);
+		put_data_memory_byte(m, short_address, m->register_x);
+		set_flags(m, m->register_x);
+	}
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_long_x(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "LD %04x,Y\n", long_address);
+		put_data_memory_byte(m, long_address, m->register_y);
+		set_flags(m, m->register_y);
+		// increment pc
+		m->register_pc += 3;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "LD [%02x.w],Y\n", indirect_address);
+		put_data_memory_byte(m, long_address, m->register_y);
+		set_flags(m, m->register_y);
+		// increment pc
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "LD [%02x.w],X\n", indirect_address);
+		put_data_memory_byte(m, long_address, m->register_x);
+		set_flags(m, m->register_x);
+		// increment pc
+		m->register_pc += 2;
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "LD %04x,X\n", long_address);
+		put_data_memory_byte(m, long_address, m->register_x);
+		set_flags(m, m->register_x);
+		// increment pc
+		m->register_pc += 3;
+	}
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_reg_ind_x(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "LD (Y),Y\n");
+		put_data_memory_byte(m, m->register_y, m->register_y);
+		set_flags(m, m->register_y);
+
+	} else {
+		disasm(m, "LD (X),X\n");
+		put_data_memory_byte(m, m->register_x, m->register_x);
+		set_flags(m, m->register_x);
+	}
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_reg_ind_off_short_x(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "LD (%02x,Y),Y\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_y, m->register_y);
+		set_flags(m, m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "LD ([%02x],Y),Y\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_y, m->register_y);
+		set_flags(m, m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "LD ([%02x],X),Y\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_x, m->register_x);
+		set_flags(m, m->register_x);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "LD (%02x,X),X\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_x, m->register_x);
+		set_flags(m, m->register_x);
+	}
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_ld_reg_ind_off_long_x(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "LD (%04x,Y),Y\n", long_address);
+		put_data_memory_byte(m, long_address+m->register_y, m->register_y);
+		set_flags(m, m->register_y);
+		// increment pc
+		m->register_pc += 3;
+
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "LD ([%02x],Y),Y\n", indirect_address);
+		put_data_memory_byte(m, long_address+m->register_y, m->register_y);
+		set_flags(m, m->register_y);
+		// increment pc
+		m->register_pc += 2;
+
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = (get_data_memory_byte(m, indirect_address) << 8);
+		long_address |= get_data_memory_byte(m, indirect_address+1);
+		disasm(m, "LD ([%02x],X),X\n", indirect_address);
+		put_data_memory_byte(m, long_address+m->register_x, m->register_x);
+		set_flags(m, m->register_x);
+		// increment pc
+		m->register_pc += 2;
+
+	} else {
+		long_address = (OPERAND(m->register_pc+1) << 8);
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "LD (%04x,X),X\n", long_address);
+		put_data_memory_byte(m, long_address+m->register_x, m->register_x);
+		set_flags(m, m->register_x);
+		// increment pc
+		m->register_pc += 3;
+	}
+	set_flags(m, m->register_a);
+}
+
+// CLR
+template<unsigned int PRECODE_SPACE> void op_clr_a(struct machine *m, unsigned char instruction)
+{
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_72) {
+		// st8 has
+		long_address = OPERAND(m->register_pc+1) << 8;
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "CLR (%08x,x)\n", long_address);
+		put_data_memory_byte(m, long_address+m->register_x, 0);
+		// increment pc
+		m->register_pc += 3;
+		set_flags(m, 0);
+
+	} else  {
+		disasm(m, "CLR A\n");
+		m->register_a = 0;
+		set_flags(m, m->register_a);
+		// increment pc
+		m->register_pc++;
+	}
+}
+
+template<unsigned int PRECODE_SPACE> void op_clr_x(struct machine *m, unsigned char instruction)
+{
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_72) {
+		long_address = OPERAND(m->register_pc+1) << 8;
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "CLR [%08x]\n", long_address);
+		put_data_memory_byte(m, long_address, 0);
+		// ncrement pc
+		m->register_pc += 3;
+
+	} else if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "CLR Y\n");
+		m->register_y = 0;
+		// increment pc
+		m->register_pc++;
+
+	} else {
+		disasm(m, "CLR X\n");
+		m->register_x = 0;
+		// increment pc
+		m->register_pc++;
+	}
+	m->register_cc &= ~NEGATIVE_BIT;
+	m->register_cc |= ZERO_BIT;
+}
+
+template<unsigned int PRECODE_SPACE> void op_clr_reg_ind(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "CLR (Y)\n");
+		put_data_memory_byte(m, m->register_y, 0);
+	} else {
+		disasm(m, "CLR (X)\n");
+		put_data_memory_byte(m, m->register_x, 0);
+	}
+	m->register_cc &= ~NEGATIVE_BIT;
+	m->register_cc |= ZERO_BIT;
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_clr_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned short short_indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_72) {
+		// added 09/06/2017);
+		short_indirect_address = OPERAND(m->register_pc+1) << 8;
+		short_indirect_address |= OPERAND(m->register_pc+2);
+		short_address = get_data_memory_byte(m, short_indirect_address);
+		disasm(m, "CLR [%04x]\n", short_indirect_address);
+		m->register_pc++;
+
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "CLR [%02x]\n", indirect_address);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "CLR %02x\n", short_address);
+	}
+	put_data_memory_byte(m, short_address, 0);
+	m->register_cc &= ~NEGATIVE_BIT;
+	m->register_cc |= ZERO_BIT;
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_clr_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "CLR (%02x,Y)\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_y, 0);
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "CLR ([%02x],Y)\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_y, 0);
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "CLR ([%02x],X)\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_x, 0);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "CLR (%02x,X)\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_x, 0);
+	}
+	m->register_cc &= ~NEGATIVE_BIT;
+	m->register_cc |= ZERO_BIT;
+	// increment pc
+	m->register_pc += 2;
+}
+
+// RLC
+template<unsigned int PRECODE_SPACE> void op_rlc_a(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "RLC A\n");
+	m->register_a = rlc(m, m->register_a);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_rlc_x(struct machine *m, unsigned char instruction)
+{
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_72) {
+		// added 8/25/17 - st8
+		// long
+		long_address = OPERAND(m->register_pc+1) << 8;
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "RLC (%04x)\n", long_address);
+		put_data_memory_byte(m, long_address, rlc(m, get_data_memory_byte(m, long_address)));
+		// increment pc
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_90) {
+		// Y
+		disasm(m, "RLC Y\n");
+		m->register_y = rlc(m, m->register_y);
+	} else {
+		// X
+		disasm(m, "RLC X\n");
+		m->register_x = rlc(m, m->register_x);
+	}
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_rlc_reg_ind(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "RLC (Y)\n");
+		put_data_memory_byte(m, m->register_y, rlc(m, get_data_memory_byte(m, m->register_y)));
+	} else {
+		disasm(m, "RLC (X)\n");
+		put_data_memory_byte(m, m->register_x, rlc(m, get_data_memory_byte(m, m->register_x)));
+	}
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_rlc_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "RLC [%02x]\n", indirect_address);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "RLC %02x\n", short_address);
+	}
+	put_data_memory_byte(m, short_address, rlc(m, get_data_memory_byte(m, short_address)));
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_rlc_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "RLC (%02x,Y)\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_y, rlc(m, get_data_memory_byte(m, short_address+m->register_y)));
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "RLC ([%02x],Y)\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_y, rlc(m, get_data_memory_byte(m, short_address+m->register_y)));
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "RLC ([%02x],X)\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_x, rlc(m, get_data_memory_byte(m, short_address+m->register_x)));
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "RLC (%02x,X)\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_x, rlc(m, get_data_memory_byte(m, short_address+m->register_x)));
+	}
+	// increment pc
+	m->register_pc += 2;
+}
+
+// RRC
+template<unsigned int PRECODE_SPACE> void op_rrc_a(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "RRC A\n");
+	m->register_a = rrc(m, m->register_a);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_rrc_x(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "RRC Y\n");
+		m->register_y = rrc(m, m->register_y);
+	} else {
+		disasm(m, "RRC X\n");
+		m->register_x = rrc(m, m->register_x);
+	}
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_rrc_reg_ind(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "RRC (Y)\n");
+		put_data_memory_byte(m, m->register_y, rrc(m, get_data_memory_byte(m, m->register_y)));
+	} else {
+		disasm(m, "RRC (X)\n");
+		put_data_memory_byte(m, m->register_x, rrc(m, get_data_memory_byte(m, m->register_x)));
+	}
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_rrc_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "RRC [%02x]\n", indirect_address);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "RRC %02x\n", short_address);
+	}
+	put_data_memory_byte(m, short_address, rrc(m, get_data_memory_byte(m, short_address)));
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_rrc_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "RRC (%02x,Y)\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_y, rrc(m, get_data_memory_byte(m, short_address+m->register_y)));
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "RRC ([%02x],Y)\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_y, rrc(m, get_data_memory_byte(m, short_address+m->register_y)));
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "RRC ([%02x],X)\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_x, rrc(m, get_data_memory_byte(m, short_address+m->register_x)));
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "RRC (%02x,X)\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_x, rrc(m, get_data_memory_byte(m, short_address+m->register_x)));
+	}
+	m->register_cc &= ~NEGATIVE_BIT;
+	m->register_cc |= ZERO_BIT;
+	// increment pc
+	m->register_pc += 2;
+}
+
+// SLA
+template<unsigned int PRECODE_SPACE> void op_sla_a(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "SLA A\n");
+	m->register_a = sla(m, m->register_a);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_sla_x(struct machine *m, unsigned char instruction)
+{
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_72) {
+		// added 8/25/17 st8
+		// long
+		long_address = OPERAND(m->register_pc+1) << 8;
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "SLA (%04x)\n", long_address);
+		put_data_memory_byte(m, long_address, sla(m, get_data_memory_byte(m, long_address)));
+		// increment pc
+		m->register_pc += 2;
+	} else if(PRECODE_SPACE == PRECODE_90) {
+		// Y
+		disasm(m, "SLA Y\n");
+		m->register_y = sla(m, m->register_y);
+	} else {
+		// X
+		disasm(m, "SLA X\n");
+		m->register_x = sla(m, m->register_x);
+	}
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_sla_reg_ind(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "SLA (Y)\n");
+		put_data_memory_byte(m, m->register_y, sla(m, get_data_memory_byte(m, m->register_y)));
+	} else {
+		disasm(m, "SLA (X)\n");
+		put_data_memory_byte(m, m->register_x, sla(m, get_data_memory_byte(m, m->register_x)));
+	}
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_sla_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "SLA [%02x]\n", indirect_address);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "SLA %02x\n", short_address);
+	}
+	put_data_memory_byte(m, short_address, sla(m, get_data_memory_byte(m, short_address)));
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_sla_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "SLA (%02x,Y)\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_y, sla(m, get_data_memory_byte(m, short_address+m->register_y)));
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "SLA ([%02x],Y)\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_y, sla(m, get_data_memory_byte(m, short_address+m->register_y)));
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "SLA ([%02x],X)\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_x, sla(m, get_data_memory_byte(m, short_address+m->register_x)));
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "SLA (%02x,X)\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_x, sla(m, get_data_memory_byte(m, short_address+m->register_x)));
+	}
+	// increment pc
+	m->register_pc += 2;
+}
+
+// SRA
+template<unsigned int PRECODE_SPACE> void op_sra_a(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "SRA A\n");
+	m->register_a = sra(m, m->register_a);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_sra_x(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "SRA Y\n");
+		m->register_y = sra(m, m->register_y);
+	} else {
+		disasm(m, "SRA X\n");
+		m->register_x = sra(m, m->register_x);
+	}
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_sra_reg_ind(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "SRA (Y)\n");
+		put_data_memory_byte(m, m->register_y, sra(m, get_data_memory_byte(m, m->register_y)));
+	} else {
+		disasm(m, "SRA (X)\n");
+		put_data_memory_byte(m, m->register_x, sra(m, get_data_memory_byte(m, m->register_x)));
+	}
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_sra_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "SRA [%02x]\n", indirect_address);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "SRA %02x\n", short_address);
+	}
+	put_data_memory_byte(m, short_address, sra(m, get_data_memory_byte(m, short_address)));
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_sra_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "SRA (%02x,Y)\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_y, sra(m, get_data_memory_byte(m, short_address+m->register_y)));
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "SRA ([%02x],Y)\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_y, sra(m, get_data_memory_byte(m, short_address+m->register_y)));
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "SRA ([%02x],X)\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_x, sra(m, get_data_memory_byte(m, short_address+m->register_x)));
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "SRA (%02x,X)\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_x, sra(m, get_data_memory_byte(m, short_address+m->register_x)));
+	}
+	// increment pc
+	m->register_pc += 2;
+}
+
+// SRL
+template<unsigned int PRECODE_SPACE> void op_srl_a(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "SRL A\n");
+	m->register_a = srl(m, m->register_a);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_srl_x(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "SRL Y\n");
+		m->register_y = srl(m, m->register_y);
+	} else {
+		disasm(m, "SRL X\n");
+		m->register_x = srl(m, m->register_x);
+	}
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_srl_reg_ind(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "SRL (Y)\n");
+		put_data_memory_byte(m, m->register_y, srl(m, get_data_memory_byte(m, m->register_y)));
+	} else {
+		disasm(m, "SRL (X)\n");
+		put_data_memory_byte(m, m->register_x, srl(m, get_data_memory_byte(m, m->register_x)));
+	}
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_srl_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "SRL [%02x]\n", indirect_address);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "SRL %02x\n", short_address);
+	}
+	put_data_memory_byte(m, short_address, srl(m, get_data_memory_byte(m, short_address)));
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_srl_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "SRL (%02x,Y)\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_y, srl(m, get_data_memory_byte(m, short_address+m->register_y)));
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "SRL ([%02x],Y)\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_y, srl(m, get_data_memory_byte(m, short_address+m->register_y)));
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "SRL ([%02x],X)\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_x, srl(m, get_data_memory_byte(m, short_address+m->register_x)));
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "SRL (%02x,X)\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_x, srl(m, get_data_memory_byte(m, short_address+m->register_x)));
+	}
+	// increment pc
+	m->register_pc += 2;
+}
+
+// SWAP
+template<unsigned int PRECODE_SPACE> void op_swap_a(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
+
+	disasm(m, "SWAP A\n");
+	temp = m->register_a;
+	m->register_a = (temp >> 4);
+	m->register_a |= (temp << 4);
+	set_flags(m, m->register_a);
+
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_swap_x(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "SWAP Y\n");
+		temp = m->register_y;
+		m->register_y = (temp >> 4);
+		m->register_y |= (temp << 4);
+		set_flags(m, m->register_y);
+	} else {
+		disasm(m, "SWAP X\n");
+		temp = m->register_x;
+		m->register_x = (temp >> 4);
+		m->register_x |= (temp << 4);
+		set_flags(m, m->register_x);
+	}
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_swap_reg_ind(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "SWAP (Y)\n");
+		temp = get_data_memory_byte(m, m->register_y);
+		put_data_memory_byte(m, m->register_y, ((temp >> 4) | (temp << 4)));
+		set_flags(m, get_memory_byte(m->prog_memory, m->register_y));
+	} else {
+		disasm(m, "SWAP (X)\n");
+		temp = get_data_memory_byte(m, m->register_x);
+		put_data_memory_byte(m, m->register_x, ((temp >> 4) | (temp << 4)));
+		set_flags(m, get_memory_byte(m->prog_memory, m->register_x));
+	}
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_swap_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned char temp;
+
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "SWAP [%02x]\n", indirect_address);
+		temp = get_data_memory_byte(m, short_address);
+		put_data_memory_byte(m, short_address, ((temp >> 4) | (temp << 4)));
+		set_flags(m, get_memory_byte(m->prog_memory, short_address));
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "SWAP %02x\n", short_address);
+		temp = get_data_memory_byte(m, short_address);
+		put_data_memory_byte(m, short_address, ((temp >> 4) | (temp << 4)));
+		set_flags(m, get_memory_byte(m->prog_memory, short_address));
+	}
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_swap_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned char temp;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "SWAP (%02x,Y)\n", short_address);
+		temp = get_data_memory_byte(m, short_address+m->register_y);
+		put_data_memory_byte(m, short_address+m->register_y, ((temp >> 4) | (temp << 4)));
+		set_flags(m, get_memory_byte(m->prog_memory, short_address+m->register_y));
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "SWAP ([%02x],Y)\n", indirect_address);
+		temp = get_data_memory_byte(m, short_address+m->register_y);
+		put_data_memory_byte(m, short_address+m->register_y, ((temp >> 4) | (temp << 4)));
+		set_flags(m, get_memory_byte(m->prog_memory, short_address+m->register_y));
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "SWAP ([%02x],X)\n", indirect_address);
+		temp = get_data_memory_byte(m, short_address+m->register_x);
+		put_data_memory_byte(m, short_address+m->register_x, ((temp >> 4) | (temp << 4)));
+		set_flags(m, get_memory_byte(m->prog_memory, short_address+m->register_x));
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "SWAP (%02x,X)\n", short_address);
+		temp = get_data_memory_byte(m, short_address+m->register_x);
+		put_data_memory_byte(m, short_address+m->register_x, ((temp >> 4) | (temp << 4)));
+		set_flags(m, get_memory_byte(m->prog_memory, short_address+m->register_x));
+	}
+	// increment pc
+	m->register_pc += 2;
+}
+
+// INC
+template<unsigned int PRECODE_SPACE> void op_inc_a(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "INC A\n");
+	m->register_a++;
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_inc_x(struct machine *m, unsigned char instruction)
+{
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_72) {
+		long_address = OPERAND(m->register_pc+1) << 8;
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "INC %08x\n", long_address);
+		put_data_memory_byte(m, long_address, (get_data_memory_byte(m, long_address) + 1));
+		set_flags(m, get_memory_byte(m->prog_memory, long_address));
+		// increment pc
+		m->register_pc += 3;
+
+	} else if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "INC Y\n");
+		m->register_y++;
+		set_flags(m, m->register_y);
+		// increment pc
+		m->register_pc++;
+
+	} else {
+		disasm(m, "INC X\n");
+		m->register_x++;
+		set_flags(m, m->register_x);
+		// increment pc
+		m->register_pc++;
+	}
+}
+
+template<unsigned int PRECODE_SPACE> void op_inc_reg_ind(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "INC (Y)\n");
+		put_data_memory_byte(m, m->register_y, (get_data_memory_byte(m, m->register_y) + 1));
+		set_flags(m, get_memory_byte(m->prog_memory, m->register_y));
+	} else {
+		disasm(m, "INC (X)\n");
+		put_data_memory_byte(m, m->register_x, (get_data_memory_byte(m, m->register_x) + 1));
+		set_flags(m, get_memory_byte(m->prog_memory, m->register_x));
+	}
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_inc_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned short short_indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_72) {
+		// added 09/06/2107 st8
+		// [longptr.w]
+		short_indirect_address = OPERAND(m->register_pc+1) << 8;
+		short_indirect_address |= OPERAND(m->register_pc+2);
+
+		short_address = get_data_memory_byte(m, short_indirect_address);
+
+		disasm(m, "INC [%04x]\n", short_indirect_address);
+		m->register_pc++;
+
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		// [short]
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "INC [%02x]\n", indirect_address);
+	} else {
+		// short
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "INC %02x\n", short_address);
+	}
+	put_data_memory_byte(m, short_address, (get_data_memory_byte(m, short_address) + 1));
+	set_flags(m, get_memory_byte(m->prog_memory, short_address));
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_inc_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "INC (%02x,Y)\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_y, (get_data_memory_byte(m, short_address+m->register_y) + 1));
+		set_flags(m, get_memory_byte(m->prog_memory, short_address+m->register_y));
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "INC ([%02x],Y)\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_y, (get_data_memory_byte(m, short_address+m->register_y) + 1));
+		set_flags(m, get_memory_byte(m->prog_memory, short_address+m->register_y));
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "INC ([%02x],X)\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_x, (get_data_memory_byte(m, short_address+m->register_x) + 1));
+		set_flags(m, get_memory_byte(m->prog_memory, short_address+m->register_x));
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "INC (%02x,X)\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_x, (get_data_memory_byte(m, short_address+m->register_x) + 1));
+		set_flags(m, get_memory_byte(m->prog_memory, short_address+m->register_x));
+	}
+	// increment pc
+	m->register_pc += 2;
+}
+
+// DEC
+template<unsigned int PRECODE_SPACE> void op_dec_a(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "DEC A\n");
+	m->register_a--;
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_dec_x(struct machine *m, unsigned char instruction)
+{
+	unsigned int long_address;
+
+	if(PRECODE_SPACE == PRECODE_72) {
+		long_address = OPERAND(m->register_pc+1) << 8;
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "DEC %08x\n", long_address);
+		put_data_memory_byte(m, long_address, (get_data_memory_byte(m, long_address) - 1));
+		set_flags(m, get_memory_byte(m->prog_memory, long_address));
+		// increment pc
+		m->register_pc += 3;
+
+	} else if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "DEC Y\n");
+		m->register_y--;
+		set_flags(m, m->register_y);
+		// increment pc
+		m->register_pc++;
+
+	} else {
+		disasm(m, "DEC X\n");
+		m->register_x--;
+		set_flags(m, m->register_x);
+		// increment pc
+		m->register_pc++;
+	}
+}
+
+template<unsigned int PRECODE_SPACE> void op_dec_reg_ind(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "DEC (Y)\n");
+		put_data_memory_byte(m, m->register_y, (get_data_memory_byte(m, m->register_y) - 1));
+	} else {
+		disasm(m, "DEC (X)\n");
+		put_data_memory_byte(m, m->register_x, (get_data_memory_byte(m, m->register_x) - 1));
+	}
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_dec_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned short short_indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_72) {
+		//	added 09/06/2017; st8
+		short_indirect_address = OPERAND(m->register_pc+1) << 8;
+		short_indirect_address |= OPERAND(m->register_pc+2);
+		short_address = get_data_memory_byte(m, short_indirect_address);
+		disasm(m, "DEC [%04x]\n", short_indirect_address);
+		m->register_pc++;
+
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "DEC [%02x]\n", indirect_address);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "DEC %02x\n", short_address);
+	}
+	put_data_memory_byte(m, short_address, (get_data_memory_byte(m, short_address) - 1));
+	set_flags(m, get_memory_byte(m->prog_memory, short_address));
+	// increment pc
+	m->register_pc += 2;
+}
+
+template<unsigned int PRECODE_SPACE> void op_dec_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "DEC (%02x,Y)\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_y, (get_data_memory_byte(m, short_address+m->register_y) - 1));
+		set_flags(m, get_memory_byte(m->prog_memory, short_address+m->register_y));
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "DEC ([%02x],Y)\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_y, (get_data_memory_byte(m, short_address+m->register_y) - 1));
+		set_flags(m, get_memory_byte(m->prog_memory, short_address+m->register_y));
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "DEC ([%02x],X)\n", indirect_address);
+		put_data_memory_byte(m, short_address+m->register_x, (get_data_memory_byte(m, short_address+m->register_x) - 1));
+		set_flags(m, get_memory_byte(m->prog_memory, short_address+m->register_x));
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "DEC (%02x,X)\n", short_address);
+		put_data_memory_byte(m, short_address+m->register_x, (get_data_memory_byte(m, short_address+m->register_x) - 1));
+		set_flags(m, get_memory_byte(m->prog_memory, short_address+m->register_x));
+	}
+	// increment pc
+	m->register_pc += 2;
+}
+
+// NEG
+template<unsigned int PRECODE_SPACE> void op_neg_a(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "NEG A\n");
+	m->register_a = 0 - m->register_a;
+	set_flags(m, m->register_a);
+	if(!m->register_a) {
+		m->register_cc &= ~CARRY_BIT;
+	}
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_neg_x(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "NEG Y\n");
+		m->register_y = 0 - m->register_y;
+		set_flags(m, m->register_y);
+		if(!m->register_y) {
+			m->register_cc &= ~CARRY_BIT;
+		}
+	} else {
+		disasm(m, "NEG X\n");
+		m->register_x = 0 - m->register_x;
+		set_flags(m, m->register_x);
+		if(!m->register_x) {
+			m->register_cc &= ~CARRY_BIT;
+		}
+	}
+	// increment pc
+	m->register_pc++;
+}
+
+template<unsigned int PRECODE_SPACE> void op_neg_reg_ind(struct machine *m, unsigned char instruction)
+{
+	unsigned char bcp_temp;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "NEG (Y)\n");
+		bcp_temp = get_data_memory_byte(m, m->register_y);
+		bcp_temp = 0 - bcp_temp;
+		put_data_memory_byte(m, m->register_y, bcp_temp);
+		set_flags(m, bcp_temp);
+		if(!bcp_temp) {
+			m->register_cc &= ~CARRY_BIT;
+		}
+	} else {
+		disasm(m, "NEG (X)\n");
+		bcp_temp = get_data_memory_byte(m, m->register_x);
+		bcp_temp = 0 - bcp_temp;
+		put_data_memory_byte(m, m->register_x, bcp_temp);
+		set_flags(m, bcp_temp);
+		if(!bcp_temp) {
+			m->register_cc &= ~CARRY_BIT;
+		}
+	}
+	// increment pc
+	m->register_pc++;
+}
 
-	case SUB_REG_IND:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "SUB A,(Y)\n");
-			bcp_temp = get_data_memory_byte(register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
+template<unsigned int PRECODE_SPACE> void op_neg_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned char bcp_temp;
 
-		} else {
-			sprintf((char *)print_buffer, "SUB A,(X)\n");
-			bcp_temp = get_data_memory_byte(register_x);
-			inc_sim_time(3);
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "NEG [%02x]\n", indirect_address);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "NEG %02x\n", short_address);
+	}
+	bcp_temp = get_data_memory_byte(m, short_address);
+	bcp_temp = 0 - bcp_temp;
+	put_data_memory_byte(m, short_address, bcp_temp);
+	set_flags(m, bcp_temp);
+	if(!bcp_temp) {
+		m->register_cc &= ~CARRY_BIT;
+	}
+	// increment pc
+	m->register_pc += 2;
+}
 
+template<unsigned int PRECODE_SPACE> void op_neg_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned char bcp_temp;
+
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "NEG (%02x,Y)\n", short_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_y);
+		bcp_temp = 0 - bcp_temp;
+		put_data_memory_byte(m, short_address+m->register_y, bcp_temp);
+		set_flags(m, bcp_temp);
+		if(!bcp_temp) {
+			m->register_cc &= ~CARRY_BIT;
 		}
-		if(bcp_temp > register_a) {
-			register_cc |= CARRY_BIT;
-		} else {
-			register_cc &= ~CARRY_BIT;
-		}
-		register_a -= bcp_temp;
-		set_flags(register_a);
-		// increment pc
-		register_pc++;
-		
-		break;
-
-	case SUB_REG_IND_OFF_SHORT:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "SUB A,(%02x,Y)\n", short_address);
-			bcp_temp = get_data_memory_byte(short_address+register_y);
-			inc_sim_time(6);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "SUB A,([%02x],Y)\n", indirect_address);
-			bcp_temp = get_data_memory_byte(short_address+register_y);
-			inc_sim_time(7);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "SUB A,([%02x],X)\n", indirect_address);
-			bcp_temp = get_data_memory_byte(short_address+register_x);
-			inc_sim_time(7);
-			precode_92 = 0;
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "NEG ([%02x],Y)\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_y);
+		bcp_temp = 0 - bcp_temp;
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "SUB A,(%02x,X)\n", short_address);
-			bcp_temp = get_data_memory_byte(short_address+register_x);
-			inc_sim_time(5);
+		put_data_memory_byte(m, short_address+m->register_y, bcp_temp);
+		set_flags(m, bcp_temp);
+		if(!bcp_temp) {
+			m->register_cc &= ~CARRY_BIT;
+		}
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "NEG ([%02x],X)\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_x);
+		bcp_temp = 0 - bcp_temp;
 
+		put_data_memory_byte(m, short_address+m->register_x, bcp_temp);
+		set_flags(m, bcp_temp);
+		if(!bcp_temp) {
+			m->register_cc &= ~CARRY_BIT;
 		}
-		if(bcp_temp > register_a) {
-			register_cc |= CARRY_BIT;
-		} else {
-			register_cc &= ~CARRY_BIT;
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "NEG (%02x,X)\n", short_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_x);
+		bcp_temp = 0 - bcp_temp;
+		put_data_memory_byte(m, short_address+m->register_x, bcp_temp);
+		set_flags(m, bcp_temp);
+		if(!bcp_temp) {
+			m->register_cc &= ~CARRY_BIT;
 		}
-		register_a -= bcp_temp;
-		set_flags(register_a);
-		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case SUB_REG_IND_OFF_LONG:
-		if(precode_90) {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "SUB A,(%04x,Y)\n", long_address);
-			bcp_temp = get_data_memory_byte(long_address+register_y);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(7);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "SUB A,([%02x.w],Y)\n", indirect_address);
-			bcp_temp = get_data_memory_byte(long_address+register_y);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(8);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "SUB A,([%02x.w],X)\n", indirect_address);
-			bcp_temp = get_data_memory_byte(long_address+register_x);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(8);
-			precode_92 = 0;
+	}
+	// increment pc
+	m->register_pc += 2;
+}
 
-		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "SUB A,(%04x, X)\n", long_address);
-			bcp_temp = get_data_memory_byte(long_address+register_x);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(6);
+// CPL
+template<unsigned int PRECODE_SPACE> void op_cpl_a(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "CPL A\n");
+	m->register_a = (0xff - m->register_a);
+	set_flags(m, m->register_a);
+	m->register_cc |= CARRY_BIT;
+	// increment pc
+	m->register_pc++;
+}
 
-		}
-		if(bcp_temp > register_a) {
-			register_cc |= CARRY_BIT;
-		} else {
-			register_cc &= ~CARRY_BIT;
-		}
-		register_a -= bcp_temp;
-		set_flags(register_a);
-		
-		break;
+template<unsigned int PRECODE_SPACE> void op_cpl_x(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "CPL Y\n");
+		m->register_y = (0xff - m->register_y);
+		set_flags(m, m->register_y);	
+	} else {
+		disasm(m, "CPL X\n");
+		m->register_x = (0xff - m->register_x);
+		set_flags(m, m->register_x);
+	}
+	m->register_cc |= CARRY_BIT;
+	// increment pc
+	m->register_pc++;
+}
 
-	case LD_A_X:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "LD A,Y\n");
-			register_a = register_y;
-			precode_90 = 0;
+template<unsigned int PRECODE_SPACE> void op_cpl_reg_ind(struct machine *m, unsigned char instruction)
+{
+	unsigned char bcp_temp;
 
-		} else {
-			sprintf((char *)print_buffer, "LD A,X\n");
-			register_a = register_x;
-		}
-		set_flags(register_a);
-		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		
-		break;
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "CPL (Y)\n");
+		bcp_temp = get_data_memory_byte(m, m->register_y);
+		bcp_temp = (0xff - bcp_temp);
+		put_data_memory_byte(m, m->register_y, bcp_temp);
+		set_flags(m, bcp_temp);
+	} else {
+		disasm(m, "CPL (X)\n");
+		bcp_temp = get_data_memory_byte(m, m->register_x);
+		bcp_temp = (0xff - bcp_temp);
+		put_data_memory_byte(m, m->register_x, bcp_temp);
+		set_flags(m, bcp_temp);
+	}
+	m->register_cc |= CARRY_BIT;
+	// increment pc
+	m->register_pc++;
+}
 
-	case LD_X_A:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "LD Y,A\n");
-			register_y = register_a;
-			precode_90 = 0;
+template<unsigned int PRECODE_SPACE> void op_cpl_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned char bcp_temp;
 
-		} else {
-			sprintf((char *)print_buffer, "LD X,A\n");
-			register_x = register_a;
-		}
-		set_flags(register_a);
-		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		
-		break;
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "CPL [%02x]\n", indirect_address);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "CPL %02x\n", short_address);
+	}
+	bcp_temp = get_data_memory_byte(m, short_address);
+	bcp_temp = (0xff - bcp_temp);
+	put_data_memory_byte(m, short_address, bcp_temp);
+	set_flags(m, bcp_temp);
+	m->register_cc |= CARRY_BIT;
+	// increment pc
+	m->register_pc += 2;
+}
 
-	case LD_X_Y:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "LD Y,X\n");
-			register_y = register_x;
-			precode_90 = 0;
+template<unsigned int PRECODE_SPACE> void op_cpl_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned char bcp_temp;
 
-		} else {
-			sprintf((char *)print_buffer, "LD X,Y\n");
-			register_x = register_y;
-		}
-		set_flags(register_x);
-		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		
-		break;
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "CPL (%02x,Y)\n", short_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_y);
+		bcp_temp = (0xff - bcp_temp);
+		put_data_memory_byte(m, short_address+m->register_y, bcp_temp);
+		set_flags(m, bcp_temp);			
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "CPL ([%02x],Y)\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_y);
+		bcp_temp = (0xff - bcp_temp);
+		put_data_memory_byte(m, short_address+m->register_y, bcp_temp);
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "CPL ([%02x],X)\n", indirect_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_x);
+		bcp_temp = (0xff - bcp_temp);
+		put_data_memory_byte(m, short_address+m->register_x, bcp_temp);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "CPL (%02x,X)\n", short_address);
+		bcp_temp = get_data_memory_byte(m, short_address+m->register_x);
+		bcp_temp = (0xff - bcp_temp);
+		put_data_memory_byte(m, short_address+m->register_x, bcp_temp);
+	}
+	m->register_cc |= CARRY_BIT;
+	// increment pc
+	m->register_pc += 2;
+}
 
-	case LD_A_S:
-		sprintf((char *)print_buffer, "LD A,S\n");
-		register_a = register_sp & 0xff;
-		set_flags(register_a);
-		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		
-		break;
+// TNZ
+template<unsigned int PRECODE_SPACE> void op_tnz_a(struct machine *m, unsigned char instruction)
+{
+	// standard st8 has precode 72 - tnz #xxxx
+	// standard st8 has precode 90 - (tnz #xxxx,Y)
+	disasm(m, "TNZ A\n");
+	set_flags(m, m->register_a);
+	// increment pc
+	m->register_pc++;
+}
 
-	case LD_S_A:
-		sprintf((char *)print_buffer, "LD S,A\n");
-		register_sp &= 0xff00;
-		register_sp |= register_a;
-		set_flags(register_a);
-		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		
-		break;
+template<unsigned int PRECODE_SPACE> void op_tnz_x(struct machine *m, unsigned char instruction)
+{
+	unsigned int long_address;
 
-	case LD_X_S:
-		sprintf((char *)print_buffer, "LD X,S\n");
-		register_x = register_sp & 0xff;
-		set_flags(register_a);
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "TNZ Y\n");
+		set_flags(m, m->register_y);
 		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		
-		break;
-
-	case LD_S_X:
-		sprintf((char *)print_buffer, "LD S,X\n");
-		register_sp &= 0xff00;
-		register_sp |= register_x;
-		set_flags(register_x);
+		m->register_pc++;
+	} else if(PRECODE_SPACE == PRECODE_72) {
+		long_address = OPERAND(m->register_pc+1) << 8;
+		long_address |= OPERAND(m->register_pc+2);
+		disasm(m, "TNZ %04x\n", long_address);
+		set_flags(m, get_data_memory_byte(m, long_address));
 		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-		
-		break;
-
-	case LD_A_IMMED:
-		sprintf((char *)print_buffer, "LD A,#%02x\n", get_data_memory_byte(register_pc+1));
-		register_a = get_data_memory_byte(register_pc+1);
-		set_flags(register_a);
+		m->register_pc += 3;
+	} else {
+		disasm(m, "TNZ X\n");
+		set_flags(m, m->register_x);
 		// increment pc
-		register_pc += 2;
-		inc_sim_time(2);
-		
-		break;
-
-	case LD_A_SHORT:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "LD A,[%02x]\n", indirect_address);
-			short_address = get_data_memory_byte(indirect_address);
-			inc_sim_time(6);
-			precode_92 = 0;
+		m->register_pc++;
+	}
+}
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "LD A,%02x\n", short_address);
-			inc_sim_time(6);
+template<unsigned int PRECODE_SPACE> void op_tnz_reg_ind(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "TNZ (Y)\n");
+		set_flags(m, get_data_memory_byte(m, m->register_y));
+	} else {
+		disasm(m, "TNZ (X)\n");
+		set_flags(m, get_data_memory_byte(m, m->register_x));
+	}
+	// increment pc
+	m->register_pc++;
+}
 
-		}
-		register_a = get_data_memory_byte(short_address);
-		set_flags(register_a);
-		// increment pc
-		register_pc += 2;
-		
-		break;
+template<unsigned int PRECODE_SPACE> void op_tnz_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
 
-	case LD_A_LONG:			// 0xc6
-		if(precode_72) {
+	// standard st8 has precode 0x72 TNZ [xxxx].w
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "TNZ [%02x]\n", indirect_address);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "TNZ %02x\n", short_address);
+	}
+	set_flags(m, get_data_memory_byte(m, short_address));
+	// increment pc
+	m->register_pc += 2;
+}
 
-			sprintf((char *)print_buffer, "LD A,[xxxx.w] (st8) goes here\n");
+template<unsigned int PRECODE_SPACE> void op_tnz_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned char temp;
+
+	// standard st8 has precode 0x72 - TNZ([#xxxx.w],X)
+	if(PRECODE_SPACE == PRECODE_90) {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "TNZ (%02x,Y)\n", short_address);
+		temp = get_data_memory_byte(m, short_address+m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "TNZ ([%02x],Y)\n", indirect_address);
+		temp = get_data_memory_byte(m, short_address+m->register_y);
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
+		disasm(m, "TNZ ([%02x],X)\n", indirect_address);
+		temp = get_data_memory_byte(m, short_address+m->register_x);
+	} else {
+		short_address = OPERAND(m->register_pc+1);
+		disasm(m, "TNZ (%02x,X)\n", short_address);
+		temp = get_data_memory_byte(m, short_address+m->register_x);
+	}
+	set_flags(m, temp);
+	// increment pc
+	m->register_pc += 2;
+}
 
-			// unhandled precode handler will catch this
+// PUSH
+template<unsigned int PRECODE_SPACE> void op_push_a(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "PUSH A\n");
+	put_memory_byte(m->prog_memory, m->register_sp--, m->register_a);	// push a onto the stack
+	// increment pc
+	m->register_pc++;
+}
 
-		} else if(precode_92) {
-			// [long.w]
-			indirect_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "LD A,[%02x.w]\n", indirect_address);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_92 = 0;
+template<unsigned int PRECODE_SPACE> void op_push_x(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "PUSH Y\n");
+		put_memory_byte(m->prog_memory, m->register_sp--, m->register_y);	// push y onto the stack
+	} else {
+		disasm(m, "PUSH X\n");
+		put_memory_byte(m->prog_memory, m->register_sp--, m->register_x);	// push x onto the stack
+	}
+	// increment pc
+	m->register_pc++;
+}
 
-		} else {
-			// long
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "LD A,%04x\n", long_address);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(6);
+template<unsigned int PRECODE_SPACE> void op_push_cc(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "PUSH CC\n");
+	put_memory_byte(m->prog_memory, m->register_sp--, m->register_cc);	// push cc onto the stack
+	// increment pc
+	m->register_pc++;
+}
 
-		}
-		register_a = get_data_memory_byte(long_address);
-		set_flags(register_a);
-		
-		break;
+template<unsigned int PRECODE_SPACE> void op_push_long(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
+	unsigned int long_address;
+
+	long_address = OPERAND(m->register_pc+1) << 8;
+	long_address |= OPERAND(m->register_pc+2);
+	disasm(m, "PUSH %08x\n", long_address);
+	temp = get_data_memory_byte(m, long_address);
+	put_memory_byte(m->prog_memory, m->register_sp--, temp);	// push onto the stack
+	// increment pc
+	m->register_pc += 3;
+}
 
-	case LD_A_REG_IND:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "LD A,(Y)\n");
-			register_a = get_data_memory_byte(register_y);
-			inc_sim_time(7);
-			precode_90 = 0;
+template<unsigned int PRECODE_SPACE> void op_push_immed(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
 
-		} else {
-			sprintf((char *)print_buffer, "LD A,(X)\n");
-			register_a = get_data_memory_byte(register_x);
-			inc_sim_time(5);
+	temp = OPERAND(m->register_pc+1);
+	disasm(m, "PUSH #%02x\n", temp);
+	put_memory_byte(m->prog_memory, m->register_sp--, temp);	// push onto the stack
+	// increment pc
+	m->register_pc += 2;
+}
 
-		}
-		set_flags(register_a);
-		// increment pc
-		register_pc++;
-		
-		break;
-
-	case LD_A_REG_IND_OFF_SHORT:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-
-			sprintf((char *)print_buffer, "LD A,(%02x,Y)\n", short_address);
-			register_a = get_data_memory_byte(short_address+register_y);
-			inc_sim_time(6);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1); 
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "LD A,([%02x],Y)\n", indirect_address);
-			register_a = get_data_memory_byte(short_address+register_y);
-			inc_sim_time(7);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1); 
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "LD A,([%02x],X)\n", indirect_address);
-			register_a = get_data_memory_byte(short_address+register_x);
-			inc_sim_time(7);
-			precode_92 = 0;
-	
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "LD A,(%02x,X)\n", short_address);
-			register_a = get_data_memory_byte(short_address+register_x);
-			inc_sim_time(5);
-		}
-		set_flags(register_a);
-		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case LD_A_REG_IND_OFF_LONG:
-		if(precode_90) {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "LD A,(%04x,Y)\n", long_address);
-			register_a = get_data_memory_byte(long_address+register_y);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(8);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "LD A,([%02x.w],Y) []=%02x LA=%04x Y=%02x EA=%08x\n", indirect_address, indirect_address, long_address, register_y, long_address+register_y);
-			register_a = get_data_memory_byte(long_address+register_y);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(8);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "LD A,([%02x.w],X)\n", indirect_address);
-			register_a = get_data_memory_byte(long_address+register_x);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_92 = 0;
+// POP
+template<unsigned int PRECODE_SPACE> void op_pop_a(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "POP A\n");
+	m->register_a = get_data_memory_byte(m, ++m->register_sp);	// push from the stack into a
+//		set_flags(register_a);
+	// increment pc
+	m->register_pc++;
+}
 
-		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "LD A,(%04x,X)\n", long_address);
-			register_a = get_data_memory_byte(long_address+register_x);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(5);
+template<unsigned int PRECODE_SPACE> void op_pop_x(struct machine *m, unsigned char instruction)
+{
+	if(PRECODE_SPACE == PRECODE_90) {
+		disasm(m, "POP Y\n");
+		m->register_y = get_data_memory_byte(m, ++m->register_sp);	// push from the stack into y
+//			set_flags(register_y);
+	} else {
+		disasm(m, "POP X\n");
+		m->register_x = get_data_memory_byte(m, ++m->register_sp);	// push from the stack into x
+//			set_flags(register_x);
+	}
+	// increment pc
+	m->register_pc++;
+}
 
-		}
-		set_flags(register_a);
-		
-		break;
-
-	case LD_A_SP_IND:	//				0x7b
-		short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "LD A,(%02x,SP)\n", short_address);
-		register_a = get_data_memory_byte(short_address+register_sp);
-		inc_sim_time(5);
-		set_flags(register_a);
-		// increment pc
-		register_pc += 2;
-		
-		break;
+template<unsigned int PRECODE_SPACE> void op_pop_cc(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "POP CC\n");
+	m->register_cc = get_data_memory_byte(m, ++m->register_sp);	// push from the stack into cc
+	// increment pc
+	m->register_pc++;
+}
 
-	// LD x,A
-	case LD_SHORT_A:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "LD [%02x],A\n", indirect_address);
-			inc_sim_time(5);
-			precode_92 = 0;
+template<unsigned int PRECODE_SPACE> void op_pop_long(struct machine *m, unsigned char instruction)
+{
+	unsigned char temp;
+	unsigned int long_address;
+
+	long_address = OPERAND(m->register_pc+1) << 8;
+	long_address |= OPERAND(m->register_pc+2);
+	disasm(m, "POP %08x\n", long_address);
+	temp = get_data_memory_byte(m, ++m->register_sp);	// push from the stack
+	put_data_memory_byte(m, long_address, temp);
+	// increment pc
+	m->register_pc += 3;
+}
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "LD %02x,A\n", short_address);
-			inc_sim_time(4);
+// CALL
+template<unsigned int PRECODE_SPACE> void op_call_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned int dest;
 
-		}
-		put_data_memory_byte(short_address, register_a);
-		set_flags(register_a);
-		// increment pc
-		register_pc += 2;
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		dest = get_data_memory_byte(m, indirect_address) << 8;
+		dest |= get_data_memory_byte(m, indirect_address+1);
 		
-		break;
-
-	case LD_LONG_A:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "LD [%02x.w],A\n", indirect_address);
-			put_data_memory_byte(long_address, register_a);
-			set_flags(register_a);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_92 = 0;
+		m->register_pc += 2;	// adjust so return address is correct
 
-		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "LD %04x,A\n", long_address);
-			put_data_memory_byte(long_address, register_a);
-			set_flags(register_a);			
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(5);
-		}
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)(m->register_pc & 0xff));	// push return address on stack
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)((m->register_pc >> 8) & 0xff));
+		m->register_pc &= 0xffff0000;
+		m->register_pc |= dest;			
+
+		disasm(m, "CALL [%02x.w]=%04x EA=%04x : pc=%08x\n", indirect_address, dest, dest, m->register_pc);
+	} else {
+		dest = OPERAND(m->register_pc+1) << 8;
+		dest |= OPERAND(m->register_pc+2);
 		
-		break;
+		m->register_pc += 3;	// adjust so return address is correct
 
-	case LD_REG_IND_A:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "LD (Y),A\n");
-			put_data_memory_byte(register_y, register_a);
-			inc_sim_time(7);
-			precode_90 = 0;
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)(m->register_pc & 0xff));// push return address on stack
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)((m->register_pc >> 8) & 0xff));
+		m->register_pc &= 0xffff0000;
+		m->register_pc |= dest;
 
-		} else {
-			sprintf((char *)print_buffer, "LD (X),A\n");
-			put_data_memory_byte(register_x, register_a);
-			inc_sim_time(5);
+		disasm(m, "CALL %04x : pc=%08x\n", dest, m->register_pc);
+	}
+	m->executed_call_instruction = 1;
+	call_event(m, CALL_EVENT_CALL);
+}
 
-		}
-		set_flags(register_a);
-		// increment pc
-		register_pc++;
-		
-		break;
-
-	case LD_REG_IND_OFF_SHORT_A:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "LD (%02x,Y),A\n", short_address);
-			put_data_memory_byte(short_address+register_y, register_a);
-			inc_sim_time(6);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "LD ([%02x],Y),A\n", indirect_address);
-			put_data_memory_byte(short_address+register_y, register_a);
-			inc_sim_time(7);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "LD ([%02x],X),A\n", indirect_address);
-			put_data_memory_byte(short_address+register_x, register_a);
-			inc_sim_time(7);
-			precode_92 = 0;
+template<unsigned int PRECODE_SPACE> void op_call_reg_ind(struct machine *m, unsigned char instruction)
+{
+	unsigned int dest;
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "LD (%02x,X),A\n", short_address);
-			put_data_memory_byte(short_address+register_x, register_a);
-			inc_sim_time(5);
+	if(PRECODE_SPACE == PRECODE_90) {
+		dest = m->register_y;
 
-		}
-		set_flags(register_a);
-		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case LD_REG_IND_OFF_LONG_A:
-		if(precode_72) {
-			short_indirect_address = (get_data_memory_byte(register_pc+1) << 8);
-			short_indirect_address |= get_data_memory_byte(register_pc+2);
-			long_address = get_data_memory_byte(short_indirect_address) << 8;
-			long_address |= get_data_memory_byte(short_indirect_address+1);
-			sprintf((char *)print_buffer, "LD ([%04x],X),A (LA=%08x, EA=%08x)\n", short_indirect_address, long_address, long_address+register_x);
-			put_data_memory_byte(long_address+register_x, register_a);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(8);
-			precode_72 = 0;
-
-		} else if(precode_90) {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "LD (%04x,Y),A\n", long_address);
-			put_data_memory_byte(long_address+register_y, register_a);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(8);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "LD ([%02x.w],Y),A\n", indirect_address);
-			put_data_memory_byte(long_address+register_y, register_a);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(8);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "LD ([%02x.w],X),A\n", indirect_address);
-			put_data_memory_byte(long_address+register_x, register_a);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_92 = 0;
+		m->register_pc++;	// adjust so return address is correct
 
-		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "LD (%04x,X),A\n", long_address);
-			put_data_memory_byte(long_address+register_x, register_a);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(7);
-		}
-		set_flags(register_a);
-		
-		break;
-
-	case LD_SP_IND_A:	//				0x6b
-		// st8
-		short_address = get_data_memory_byte(register_pc+1);
-		sprintf((char *)print_buffer, "LD (%02x,SP),A\n", short_address);
-		put_data_memory_byte(short_address+register_sp, register_a);
-		inc_sim_time(5);
-		set_flags(register_a);
-		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	// LD X, x	// 0xae
-	case LD_X_IMMED:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "LD Y,#%02x\n", get_data_memory_byte(register_pc+1));
-			register_y = get_data_memory_byte(register_pc+1);
-			set_flags(register_y);
-			inc_sim_time(3);
-			precode_90 = 0;
-		} else {
-			sprintf((char *)print_buffer, "LD X,#%02x\n", get_data_memory_byte(register_pc+1));
-			register_x = get_data_memory_byte(register_pc+1);
-			set_flags(register_x);
-			inc_sim_time(2);
-		}
-		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case LD_X_SHORT:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "LD Y,%02x\n", short_address);
-			register_y = get_data_memory_byte(short_address);
-			set_flags(register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "LD Y,[%02x]\n", indirect_address);
-			register_y = get_data_memory_byte(short_address);
-			set_flags(register_y);
-			inc_sim_time(5);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "LD X,[%02x]\n", indirect_address);
-			register_x = get_data_memory_byte(short_address);
-			set_flags(register_x);
-			inc_sim_time(5);
-			precode_92 = 0;
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)(m->register_pc & 0xff));
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)((m->register_pc >> 8) & 0xff));
+		m->register_pc = dest;
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "LD X,%02x\n", short_address);
-			register_x = get_data_memory_byte(short_address);
-			set_flags(register_x);
-			inc_sim_time(3);
+		disasm(m, "CALL (Y) : pc=%08x\n", dest);
+	} else {
+		dest = m->register_x;
 
-		}
-		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case LD_X_LONG:
-		if(precode_90) {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "LD Y,%04x\n", long_address);
-			register_y = get_data_memory_byte(long_address);
-			set_flags(register_y);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(5);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "LD Y,[%02x.w]\n", indirect_address);
-			register_y = get_data_memory_byte(long_address);
-			set_flags(register_y);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(5);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "LD X,[%02x.w]\n", indirect_address);
-			register_x = get_data_memory_byte(long_address);
-			set_flags(register_x);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(5);
-			precode_92 = 0;
+		m->register_pc++;	// adjust so return address is correct
 
-		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "LD X,%04x\n", long_address);
-			register_x = get_data_memory_byte(long_address);
-			set_flags(register_x);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(4);
-		}
-		
-		break;
-
-	case LD_X_REG_IND:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "LD Y,(Y)\n");
-			register_y = get_data_memory_byte(register_y);
-			set_flags(register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
-		} else {
-			sprintf((char *)print_buffer, "LD X,(X)\n");
-			register_x = get_data_memory_byte(register_x);
-			set_flags(register_x);
-			inc_sim_time(3);
-		}
-		// increment pc
-		register_pc++;
-		
-		break;
-
-	case LD_X_REG_IND_OFF_SHORT:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "LD Y,(%02x,Y)\n", short_address);
-			register_y = get_data_memory_byte(short_address+register_y);
-			set_flags(register_y);
-			inc_sim_time(6);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "LD Y,([%02x],Y)\n", indirect_address);
-			register_y = get_data_memory_byte(short_address+register_y);
-			set_flags(register_y);
-			inc_sim_time(7);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "LD X,([%02x],X)\n", indirect_address);
-			register_x = get_data_memory_byte(short_address+register_x);
-			set_flags(register_x);
-			inc_sim_time(5);
-			precode_92 = 0;
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)(m->register_pc & 0xff));
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)((m->register_pc >> 8) & 0xff));
+		m->register_pc = dest;
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "LD X,(%02x,X)\n", short_address);
-			register_x = get_data_memory_byte(short_address+register_x);
-			set_flags(register_x);
-			inc_sim_time(4);
+		disasm(m, "CALL (X) : pc=%08x\n", dest);
+	}
+	m->executed_call_instruction = 1;
+	call_event(m, CALL_EVENT_CALL);
+}
 
-		}
-		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case LD_X_REG_IND_OFF_LONG:
-		if(precode_90) {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "LD Y,(%04x,Y)\n", long_address);
-			register_y = get_data_memory_byte(long_address+register_y);
-			set_flags(register_y);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(6);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "LD Y,([%02x.w],Y)\n", indirect_address);
-			register_y = get_data_memory_byte(long_address+register_y);
-			set_flags(register_y);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "LD X,([%02x.w],X)\n", indirect_address);
-			register_x = get_data_memory_byte(long_address+register_x);
-			set_flags(register_x);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_92 = 0;
+template<unsigned int PRECODE_SPACE> void op_call_reg_ind_off_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char short_address, indirect_address;
+	unsigned char temp;
+	unsigned int dest;
 
-		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "LD X,(%04x,X)\n", long_address);
-			register_x = get_data_memory_byte(long_address+register_x);
-			set_flags(register_x);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(5);
-		}
+	m->register_pc += 2;
+	if(PRECODE_SPACE == PRECODE_90) {
+		// (short,Y)
+		short_address = OPERAND(m->register_pc+1);
 		
-		break;
-
-	// LD x,X
-	case LD_SHORT_X:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "LD %02x,Y\n", short_address);
-			put_data_memory_byte(short_address, register_y);
-			set_flags(register_y);
-			inc_sim_time(5);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "LD [%02x],Y\n", indirect_address);
-			put_data_memory_byte(short_address, register_y);
-			set_flags(register_y);
-			inc_sim_time(7);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "LD [%02x],X\n", indirect_address);
-			put_data_memory_byte(short_address, register_x);
-			set_flags(register_x);
-			inc_sim_time(6);
-			precode_92 = 0;
+		temp = m->register_y;
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "LD %02x,X\n", short_address);
-			put_data_memory_byte(short_address, register_x);
-			set_flags(register_x);
-			inc_sim_time(4);
-		}
-		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case LD_LONG_X:
-		if(precode_90) {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "LD %04x,Y\n", long_address);
-			put_data_memory_byte(long_address, register_y);
-			set_flags(register_y);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(6);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "LD [%02x.w],Y\n", indirect_address);
-			put_data_memory_byte(long_address, register_y);
-			set_flags(register_y);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(7);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "LD [%02x.w],X\n", indirect_address);
-			put_data_memory_byte(long_address, register_x);
-			set_flags(register_x);
-			// increment pc
-			register_pc += 2;
-			inc_sim_time(6);
-			precode_92 = 0;
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)(m->register_pc & 0xff)); // save return address on stack
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)((m->register_pc >> 8) & 0xff));
 
-		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "LD %04x,X\n", long_address);
-			put_data_memory_byte(long_address, register_x);
-			set_flags(register_x);
-			// increment pc
-			register_pc += 3;
-			inc_sim_time(5);
+		dest = short_address;
+		dest += temp;
+		m->register_pc = dest;
 
-		}
+		disasm(m, "CALL (%02x,Y) : pc=%08x\n", short_address, m->register_pc);
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		// ([short],X)
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
 		
-		break;
+		temp = m->register_x;
 
-	case LD_REG_IND_X:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "LD (Y),Y\n");
-			put_data_memory_byte(register_y, register_y);
-			set_flags(register_y);
-			precode_90 = 0;
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)(m->register_pc & 0xff)); // save return address on stack
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)((m->register_pc >> 8) & 0xff));
 
-		} else {
-			sprintf((char *)print_buffer, "LD (X),X\n");
-			put_data_memory_byte(register_x, register_x);
-			set_flags(register_x);
-		}
-		// increment pc
-		register_pc++;
-		inc_sim_time(4);
-		
-		break;
-
-	case LD_REG_IND_OFF_SHORT_X:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "LD (%02x,Y),Y\n", short_address);
-			put_data_memory_byte(short_address+register_y, register_y);
-			set_flags(register_y);
-			inc_sim_time(5);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "LD ([%02x],Y),Y\n", indirect_address);
-			put_data_memory_byte(short_address+register_y, register_y);
-			set_flags(register_y);
-			inc_sim_time(7);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "LD ([%02x],X),Y\n", indirect_address);
-			put_data_memory_byte(short_address+register_x, register_x);
-			set_flags(register_x);
-			inc_sim_time(6);
-			precode_92 = 0;
+		dest = short_address;
+		dest += temp;
+		m->register_pc = dest;
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "LD (%02x,X),X\n", short_address);
-			put_data_memory_byte(short_address+register_x, register_x);
-			set_flags(register_x);
-			inc_sim_time(4);
-
-		}
-		// increment pc
-		register_pc += 2;
+		disasm(m, "CALL ([%02x],X) : pc=%08x\n", indirect_address, m->register_pc);
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		// ([short],Y)
+		indirect_address = OPERAND(m->register_pc+1);
+		short_address = get_data_memory_byte(m, indirect_address);
 		
-		break;
-
-	case LD_REG_IND_OFF_LONG_X:
-		if(precode_90) {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "LD (%04x,Y),Y\n", long_address);
-			put_data_memory_byte(long_address+register_y, register_y);
-			set_flags(register_y);
-			// increment pc
-			register_pc += 3;
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "LD ([%02x],Y),Y\n", indirect_address);
-			put_data_memory_byte(long_address+register_y, register_y);
-			set_flags(register_y);
-			// increment pc
-			register_pc += 2;
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = (get_data_memory_byte(indirect_address) << 8);
-			long_address |= get_data_memory_byte(indirect_address+1);
-			sprintf((char *)print_buffer, "LD ([%02x],X),X\n", indirect_address);
-			put_data_memory_byte(long_address+register_x, register_x);
-			set_flags(register_x);
-			// increment pc
-			register_pc += 2;
-			precode_92 = 0;
+		temp = m->register_y;
 
-		} else {
-			long_address = (get_data_memory_byte(register_pc+1) << 8);
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "LD (%04x,X),X\n", long_address);
-			put_data_memory_byte(long_address+register_x, register_x);
-			set_flags(register_x);
-			// increment pc
-			register_pc += 3;
-		}
-		set_flags(register_a);
-		inc_sim_time(8);
-		
-		break;
-
-	// CLR
-	case CLR_A:
-		if(precode_72) {
-			// st8 has
-			long_address = get_data_memory_byte(register_pc+1) << 8;
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "CLR (%08x,x)\n", long_address);
-			put_data_memory_byte(long_address+register_x, 0);
-			inc_sim_time(4);
-			precode_72 = 0;
-			// increment pc
-			register_pc += 3;
-			set_flags(0);
-
-		} else  {
-			sprintf((char *)print_buffer, "CLR A\n");
-			register_a = 0;
-			set_flags(register_a);
-			// increment pc
-			register_pc++;
-			inc_sim_time(2);
-		}
-		
-		break;
-
-	case CLR_X:
-		if(precode_72) {
-			long_address = get_data_memory_byte(register_pc+1) << 8;
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "CLR [%08x]\n", long_address);
-			put_data_memory_byte(long_address, 0);
-			inc_sim_time(4);
-			precode_72 = 0;
-			// ncrement pc
-			register_pc += 3;
-
-		} else if(precode_90) {
-			sprintf((char *)print_buffer, "CLR Y\n");
-			register_y = 0;
-			inc_sim_time(4);
-			precode_90 = 0;
-			// increment pc
-			register_pc++;
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)(m->register_pc & 0xff)); // save return address on stack
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)((m->register_pc >> 8) & 0xff));
 
-		} else {
-			sprintf((char *)print_buffer, "CLR X\n");
-			register_x = 0;
-			inc_sim_time(3);
-			// increment pc
-			register_pc++;
-		}
-		register_cc &= ~NEGATIVE_BIT;
-		register_cc |= ZERO_BIT;
+		dest = short_address;
+		dest += temp;
+		m->register_pc = dest;
+
+		disasm(m, "CALL ([%02x],Y) : pc=%08x\n", indirect_address, m->register_pc);
+	} else {
+		// (short,X)
+		short_address = OPERAND(m->register_pc+1);
 		
-		break;
+		temp = m->register_x;
 
-	case CLR_REG_IND:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "CLR (Y)\n");
-			put_data_memory_byte(register_y, 0);
-			inc_sim_time(6);
-			precode_90 = 0;
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)(m->register_pc & 0xff)); // save return address on stack
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)((m->register_pc >> 8) & 0xff));
 
-		} else {
-			sprintf((char *)print_buffer, "CLR (X)\n");
-			put_data_memory_byte(register_x, 0);
-			inc_sim_time(5);
+		dest = short_address;
+		dest += temp;
+		m->register_pc = dest;
 
-		}
-		register_cc &= ~NEGATIVE_BIT;
-		register_cc |= ZERO_BIT;
-		// increment pc
-		register_pc++;
-		
-		break;
-
-	case CLR_SHORT:		// 0x3f
-		if(precode_72) {
-			// added 09/06/2017);
-			short_indirect_address = get_data_memory_byte(register_pc+1) << 8;
-			short_indirect_address |= get_data_memory_byte(register_pc+2);
-			short_address = get_data_memory_byte(short_indirect_address);
-			sprintf((char *)print_buffer, "CLR [%04x]\n", short_indirect_address);
-			inc_sim_time(9);
-			precode_72 = 0;
-			register_pc++;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "CLR [%02x]\n", indirect_address);
-			inc_sim_time(7);
-			precode_92 = 0;
+		disasm(m, "CALL (%02x,X) : pc=%08x\n", short_address, m->register_pc);
+	}
+	m->executed_call_instruction = 1;
+	call_event(m, CALL_EVENT_CALL);
+}
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "CLR %02x\n", short_address);
-			inc_sim_time(5);
+template<unsigned int PRECODE_SPACE> void op_call_reg_ind_off_long(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	unsigned char temp;
+	unsigned int long_address;
+	unsigned int dest;
 
-		}
-		put_data_memory_byte(short_address, 0);
-		register_cc &= ~NEGATIVE_BIT;
-		register_cc |= ZERO_BIT;
-		// increment pc
-		register_pc += 2;
+	if(PRECODE_SPACE == PRECODE_90) {
+		// (long,Y)
+		long_address = OPERAND(m->register_pc+1) << 8;
+		long_address |= OPERAND(m->register_pc+2);
 		
-		break;
-
-	case CLR_REG_IND_OFF_SHORT:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "CLR (%02x,Y)\n", short_address);
-			put_data_memory_byte(short_address+register_y, 0);
-			inc_sim_time(7);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "CLR ([%02x],Y)\n", indirect_address);
-			put_data_memory_byte(short_address+register_y, 0);
-			inc_sim_time(8);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "CLR ([%02x],X)\n", indirect_address);
-			put_data_memory_byte(short_address+register_x, 0);
-			inc_sim_time(8);
-			precode_92 = 0;
-
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "CLR (%02x,X)\n", short_address);
-			put_data_memory_byte(short_address+register_x, 0);
-			inc_sim_time(6);
+		temp = m->register_y;
 
-		}
-		register_cc &= ~NEGATIVE_BIT;
-		register_cc |= ZERO_BIT;
-		// increment pc
-		register_pc += 2;
-		
-		break;
+		m->register_pc += 3;	// adjust so return address is correct
 
-	// RLC
-	case RLC_A:	// 0x49
-		sprintf((char *)print_buffer, "RLC A\n");
-		register_a = rlc(register_a);
-		// increment pc
-		register_pc++;
-		inc_sim_time(3);
-		
-		break;
-
-	case RLC_X:	// 0x59
-		if(precode_72) {
-			// added 8/25/17 - st8
-			// long
-			long_address = get_data_memory_byte(register_pc+1) << 8;
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "RLC (%04x)\n", long_address);
-			inc_sim_time(5);
-			put_data_memory_byte(long_address, rlc(get_data_memory_byte(long_address)));
-			precode_72 = 0;
-			// increment pc
-			register_pc += 2;
-		} else if(precode_90) {
-			// Y
-			sprintf((char *)print_buffer, "RLC Y\n");
-			register_y = rlc(register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)(m->register_pc & 0xff));	// save returnj address on stack
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)((m->register_pc >> 8) & 0xff));
 
-		} else {
-			// X
-			sprintf((char *)print_buffer, "RLC X\n");
-			register_x = rlc(register_x);
-			inc_sim_time(3);
+		dest = long_address;
+		dest += temp;
+		m->register_pc = dest;
 
-		}
-		// increment pc
-		register_pc++;
+		disasm(m, "CALL (%04x,Y) : pc=%08x\n", long_address, m->register_pc);
+	} else if(PRECODE_SPACE == PRECODE_92) {
+		// ([long],X)
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = get_data_memory_byte(m, indirect_address) << 8;
+		long_address |= get_data_memory_byte(m, indirect_address);
 		
-		break;
+		temp = m->register_x;
 
-	case RLC_REG_IND:	// 0x79
-		if(precode_90) {
-			sprintf((char *)print_buffer, "RLC (Y)\n");
-			put_data_memory_byte(register_y, rlc(get_data_memory_byte(register_y)));
-			precode_90 = 0;
-			inc_sim_time(6);
+		m->register_pc += 2;// adjust so return address is correct
 
-		} else {
-			sprintf((char *)print_buffer, "RLC (X)\n");
-			put_data_memory_byte(register_x, rlc(get_data_memory_byte(register_x)));
-			inc_sim_time(5);
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)(m->register_pc & 0xff));	// save returnj address on stack
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)((m->register_pc >> 8) & 0xff));
 
-		}
-		// increment pc
-		register_pc++;
+		dest = long_address;
+		dest += temp;
+		m->register_pc = dest;
+
+		disasm(m, "CALL ([%02x.w],X) : pc=%08x\n", indirect_address, m->register_pc);
+	} else if(PRECODE_SPACE == PRECODE_91) {
+		// ([long],Y)
+		indirect_address = OPERAND(m->register_pc+1);
+		long_address = get_data_memory_byte(m, indirect_address) << 8;
+		long_address = get_data_memory_byte(m, indirect_address) << 8;
 		
-		break;
+		temp = m->register_y;
 
-	case RLC_SHORT:	// 0x39
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "RLC [%02x]\n", indirect_address);
-			inc_sim_time(7);
-			precode_92 = 0;
+		m->register_pc += 2;	// adjust so return address is correct
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "RLC %02x\n", short_address);
-			inc_sim_time(5);
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)(m->register_pc & 0xff));	// save returnj address on stack
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)((m->register_pc >> 8) & 0xff));
 
-		}
-		put_data_memory_byte(short_address, rlc(get_data_memory_byte(short_address)));
-		// increment pc
-		register_pc += 2;
+		dest = long_address;
+		dest += temp;
+		m->register_pc = dest;
+
+		disasm(m, "CALL ([%02x.w],Y) : pc=%08x\n", indirect_address, m->register_pc);
+	} else {
+		// (long,X)
+		long_address = OPERAND(m->register_pc+1) << 8;
+		long_address |= OPERAND(m->register_pc+2);
 		
-		break;
-
-	case RLC_REG_IND_OFF_SHORT:	// 0x69
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "RLC (%02x,Y)\n", short_address);
-			put_data_memory_byte(short_address+register_y, rlc(get_data_memory_byte(short_address+register_y)));
-			inc_sim_time(8);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "RLC ([%02x],Y)\n", indirect_address);
-			put_data_memory_byte(short_address+register_y, rlc(get_data_memory_byte(short_address+register_y)));
-			inc_sim_time(8);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "RLC ([%02x],X)\n", indirect_address);
-			put_data_memory_byte(short_address+register_x, rlc(get_data_memory_byte(short_address+register_x)));
-			inc_sim_time(7);
-			precode_92 = 0;
+		temp = m->register_x;
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "RLC (%02x,X)\n", short_address);
-			put_data_memory_byte(short_address+register_x, rlc(get_data_memory_byte(short_address+register_x)));
-			inc_sim_time(7);
+		m->register_pc += 3;	// adjust so return address is correct
 
-		}
-		// increment pc
-		register_pc += 2;
-		
-		break;
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)(m->register_pc & 0xff));	// save returnj address on stack
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)((m->register_pc >> 8) & 0xff));
 
-	// RRC
-	case RRC_A:
-		sprintf((char *)print_buffer, "RRC A\n");
-		register_a = rrc(register_a);
-		// increment pc
-		register_pc++;
-		inc_sim_time(3);
-		
-		break;
+		dest = long_address;
+		dest += temp;
+		m->register_pc = dest;
 
-	case RRC_X:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "RRC Y\n");
-			register_y = rrc(register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
+		disasm(m, "CALL (%04x,X) : pc=%08x\n", long_address, m->register_pc);
+	}
+	m->executed_call_instruction = 1;
+	call_event(m, CALL_EVENT_CALL);
+}
 
-		} else {
-			sprintf((char *)print_buffer, "RRC X\n");
-			register_x = rrc(register_x);
-			inc_sim_time(3);
+template<unsigned int PRECODE_SPACE> void op_callr_short(struct machine *m, unsigned char instruction)
+{
+	register unsigned char indirect_address;
+	short displacement;
 
-		}
-		// increment pc
-		register_pc++;
-		
-		break;
+	if(PRECODE_SPACE == PRECODE_92) {
+		indirect_address = OPERAND(m->register_pc+1);
+		displacement = get_data_memory_byte(m, indirect_address);
 
-	case RRC_REG_IND:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "RRC (Y)\n");
-			put_data_memory_byte(register_y, rrc(get_data_memory_byte(register_y)));
-			inc_sim_time(6);
-			precode_90 = 0;
+		m->register_pc += 2;	// adjust so return address is correct
 
-		} else {
-			sprintf((char *)print_buffer, "RRC (X)\n");
-			put_data_memory_byte(register_x, rrc(get_data_memory_byte(register_x)));
-			inc_sim_time(5);
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)(m->register_pc & 0xff));	// save returnj address on stack
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)((m->register_pc >> 8) & 0xff));
 
+		if(displacement & 0x0080) {
+			displacement |= 0xff00;
 		}
-		// increment pc
-		register_pc++;
+		m->register_pc += displacement;
 		
-		break;
-
-	case RRC_SHORT:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "RRC [%02x]\n", indirect_address);
-			inc_sim_time(7);
-			precode_92 = 0;
-	
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "RRC %02x\n", short_address);
-			inc_sim_time(5);
+		disasm(m, "CALLR [%02x]=%d : pc=%08x\n", indirect_address, displacement, m->register_pc);
+	} else {
+		displacement = OPERAND(m->register_pc+1);
 
-		}
-		put_data_memory_byte(short_address, rrc(get_data_memory_byte(short_address)));
-		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case RRC_REG_IND_OFF_SHORT:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "RRC (%02x,Y)\n", short_address);
-			put_data_memory_byte(short_address+register_y, rrc(get_data_memory_byte(short_address+register_y)));
-			inc_sim_time(8);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "RRC ([%02x],Y)\n", indirect_address);
-			put_data_memory_byte(short_address+register_y, rrc(get_data_memory_byte(short_address+register_y)));
-			inc_sim_time(8);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "RRC ([%02x],X)\n", indirect_address);
-			put_data_memory_byte(short_address+register_x, rrc(get_data_memory_byte(short_address+register_x)));
-			inc_sim_time(7);
-			precode_92 = 0;
+		m->register_pc += 2;	// adjust so return address is correct
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "RRC (%02x,X)\n", short_address);
-			put_data_memory_byte(short_address+register_x, rrc(get_data_memory_byte(short_address+register_x)));
-			inc_sim_time(6);
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)(m->register_pc & 0xff));	// save returnj address on stack
+		put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)((m->register_pc >> 8) & 0xff));
 
+		if(displacement & 0x0080) {
+				displacement |= 0xff00;
 		}
-		register_cc &= ~NEGATIVE_BIT;
-		register_cc |= ZERO_BIT;
-		// increment pc
-		register_pc += 2;
-		
-		break;
+		m->register_pc += displacement;	
 
-	// SLA
-	case SLA_A:	// 0x48
-		sprintf((char *)print_buffer, "SLA A\n");
-		register_a = sla(register_a);
-		// increment pc
-		register_pc++;
-		inc_sim_time(3);
-		
-		break;
-
-	case SLA_X:	// 0x58
-		if(precode_72) {
-			// added 8/25/17 st8
-			// long
-			long_address = get_data_memory_byte(register_pc+1) << 8;
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "SLA (%04x)\n", long_address);
-			inc_sim_time(5);
-			put_data_memory_byte(long_address, sla(get_data_memory_byte(long_address)));
-			precode_72 = 0;
-			// increment pc
-			register_pc += 2;
-		} else if(precode_90) {
-			// Y
-			sprintf((char *)print_buffer, "SLA Y\n");
-			register_y = sla(register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
+		disasm(m, "CALLR %d : pc=%08x\n", displacement, m->register_pc);
+	}
+	m->executed_call_instruction = 1;
+	call_event(m, CALL_EVENT_CALL);
+}
 
-		} else {
-			// X
-			sprintf((char *)print_buffer, "SLA X\n");
-			register_x = sla(register_x);
-			inc_sim_time(3);
+template<unsigned int PRECODE_SPACE> void op_call_far(struct machine *m, unsigned char instruction)
+{
+	unsigned int dword_address;
 
-		}
-		// increment pc
-		register_pc++;
-		
-		break;
+	dword_address = OPERAND(m->register_pc+1) << 16;
+	dword_address |= OPERAND(m->register_pc+2) << 8;
+	dword_address |= OPERAND(m->register_pc+3);
 
-	case SLA_REG_IND:	// 0x78
-		if(precode_90) {
-			sprintf((char *)print_buffer, "SLA (Y)\n");
-			put_data_memory_byte(register_y, sla(get_data_memory_byte(register_y)));
-			inc_sim_time(6);
-			precode_90 = 0;
+	m->register_pc += 4;	// adjust so return address is correct
 
-		} else {
-			sprintf((char *)print_buffer, "SLA (X)\n");
-			put_data_memory_byte(register_x, sla(get_data_memory_byte(register_x)));
-			inc_sim_time(5);
+	put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)(m->register_pc & 0xff));	// save returnj address on stack (long format)
+	put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)((m->register_pc >> 8) & 0xff));
+	put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)((m->register_pc >> 16) & 0xff));
 
-		}
-		// increment pc
-		register_pc++;
-		
-		break;
+	if(dword_address & 0xffff0000) {
+//			disasm("*INTER-SEGMENT CALL to %08x", dword_address);
+	}
+	m->register_pc = dword_address;
 
-	case SLA_SHORT:	// 0x38
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "SLA [%02x]\n", indirect_address);
-			inc_sim_time(7);
-			precode_92 = 0;
+	disasm(m, "CALLF %08x : pc=%08x\n", dword_address, m->register_pc);
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "SLA %02x\n", short_address);
-			inc_sim_time(5);
+	m->executed_call_instruction = 1;
+	call_event(m, CALL_EVENT_CALL);
+}
 
-		}
-		put_data_memory_byte(short_address, sla(get_data_memory_byte(short_address)));
-		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case SLA_REG_IND_OFF_SHORT:	// 0x68
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "SLA (%02x,Y)\n", short_address);
-			put_data_memory_byte(short_address+register_y, sla(get_data_memory_byte(short_address+register_y)));
-			inc_sim_time(7);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "SLA ([%02x],Y)\n", indirect_address);
-			put_data_memory_byte(short_address+register_y, sla(get_data_memory_byte(short_address+register_y)));
-			inc_sim_time(8);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "SLA ([%02x],X)\n", indirect_address);
-			put_data_memory_byte(short_address+register_x, sla(get_data_memory_byte(short_address+register_x)));
-			inc_sim_time(8);
-			precode_92 = 0;
+template<unsigned int PRECODE_SPACE> void op_ret(struct machine *m, unsigned char instruction)
+{
+	unsigned int dest;
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "SLA (%02x,X)\n", short_address);
-			put_data_memory_byte(short_address+register_x, sla(get_data_memory_byte(short_address+register_x)));
-			inc_sim_time(6);
+	// protection for stack underflow
+/*		if(register_sp >= 0x1000) {
+		disasm("*** STACK UNDERFLOW @ %08x\n", register_pc);
+		running = 0;
+	} else {
+*/
+		dest = get_data_memory_byte(m, ++m->register_sp) << 8;	// get return address from stack
+		dest |= get_data_memory_byte(m, ++m->register_sp);
 
-		}
-		// increment pc
-		register_pc += 2;
-		
-		break;
+		disasm(m, "RET (%04x)\n", dest);
 
-	// SRA
-	case SRA_A:	// 0x47
-		sprintf((char *)print_buffer, "SRA A\n");
-		register_a = sra(register_a);
-		// increment pc
-		register_pc++;
-		inc_sim_time(3);
-		
-		break;
+	if(((dest & 0x0000ffff) >= XIO_START) && ((dest & 0x0000ffff) <= XIO_END)) {
+		disasm(m, "\n*** FETCHING FROM IO REGION: pc=%08x, address=%08x previous_pc=%08x\n", m->register_pc, dest, m->previous_register_pc);
+		m->running = 0;
+		m->aabnormal_termination = 1;
+		return;
+	}
 
-	case SRA_X:	// 0x57
-		if(precode_90) {
-			sprintf((char *)print_buffer, "SRA Y\n");
-			register_y = sra(register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
+	if(((dest & 0x0000ffff) >= IO_START) && ((dest & 0x0000ffff) <= IO_END)) {
+		disasm(m, "\n*** FETCHING FROM IO REGION: pc=%08x, address=%08x previous_pc=%08x\n", m->register_pc, dest, m->previous_register_pc);
+		m->aabnormal_termination = 1;
+		m->running = 0;
+		return;
+	}
 
-		} else {
-			sprintf((char *)print_buffer, "SRA X\n");
-			register_x = sra(register_x);
-			inc_sim_time(3);
+	if(((dest & 0x0000ffff) >= RAM_START) && ((dest & 0x0000ffff) <= RAM_END)) {
+		disasm(m, "\n*** FETCHING FROM RAM REGION: pc=%08x, address=%08x previous_pc=%08x\n", m->register_pc, dest, m->previous_register_pc);
+		m->aabnormal_termination = 1;
+		m->running = 0;
+		return;
+	}
+	m->register_pc &= 0xffff0000;
+	m->register_pc |= dest;
+//		}
+	m->executed_return_instruction = 1;
+	call_event(m, CALL_EVENT_RETURN);
+}
 
-		}
-		// increment pc
-		register_pc++;
-		
-		break;
+template<unsigned int PRECODE_SPACE> void op_retf(struct machine *m, unsigned char instruction)
+{
+	unsigned int dword_address;
 
-	case SRA_REG_IND:	// 0x77
-		if(precode_90) {
-			sprintf((char *)print_buffer, "SRA (Y)\n");
-			put_data_memory_byte(register_y, sra(get_data_memory_byte(register_y)));
-			inc_sim_time(6);
-			precode_90 = 0;
+	// protection for stack underflow
+/*		if(register_sp >= 0x1000) {
+		disasm("*** STACK UNDERFLOW @ %08x\n", register_pc);
+		running = 0;
+	} else {
+*/
+		dword_address = get_data_memory_byte(m, ++m->register_sp) << 16;	// save returnj address on stack (long format)
+		dword_address |= get_data_memory_byte(m, ++m->register_sp) << 8;
+		dword_address |= get_data_memory_byte(m, ++m->register_sp);
 
-		} else {
-			sprintf((char *)print_buffer, "SRA (X)\n");
-			put_data_memory_byte(register_x, sra(get_data_memory_byte(register_x)));
-			inc_sim_time(5);
-		}
-		// increment pc
-		register_pc++;
-		
-		break;
+		disasm(m, "RETF (%08x)\n", dword_address);
 
-	case SRA_SHORT:	// 0x37
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "SRA [%02x]\n", indirect_address);
-			inc_sim_time(7);
-			precode_92 = 0;
+	if(((dword_address & 0x0000ffff) >= XIO_START) && ((dword_address & 0x0000ffff) <= XIO_END)) {
+		disasm(m, "\n*** FETCHING FROM IO REGION: pc=%08x, address=%08x previous_pc=%08x\n", m->register_pc, dword_address, m->previous_register_pc);
+		m->running = 0;
+		m->aabnormal_termination = 1;
+		return;
+	}
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "SRA %02x\n", short_address);
-			inc_sim_time(5);
+	if(((dword_address & 0x0000ffff) >= IO_START) && ((dword_address & 0x0000ffff) <= IO_END)) {
+		disasm(m, "\n*** FETCHING FROM IO REGION: pc=%08x, address=%08x previous_pc=%08x\n", m->register_pc, dword_address, m->previous_register_pc);
+		m->aabnormal_termination = 1;
+		m->running = 0;
+		return;
+	}
 
-		}
-		put_data_memory_byte(short_address, sra(get_data_memory_byte(short_address)));
-		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case SRA_REG_IND_OFF_SHORT:	// 0x67
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "SRA (%02x,Y)\n", short_address);
-			put_data_memory_byte(short_address+register_y, sra(get_data_memory_byte(short_address+register_y)));
-			inc_sim_time(7);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "SRA ([%02x],Y)\n", indirect_address);
-			put_data_memory_byte(short_address+register_y, sra(get_data_memory_byte(short_address+register_y)));
-			inc_sim_time(8);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "SRA ([%02x],X)\n", indirect_address);
-			put_data_memory_byte(short_address+register_x, sra(get_data_memory_byte(short_address+register_x)));
-			inc_sim_time(8);
-			precode_92 = 0;
+	if(((dword_address & 0x0000ffff) >= RAM_START) && ((dword_address & 0x0000ffff) <= RAM_END)) {
+		disasm(m, "\n*** FETCHING FROM RAM REGION: pc=%08x, address=%08x previous_pc=%08x\n", m->register_pc, dword_address, m->previous_register_pc);
+		m->aabnormal_termination = 1;
+		m->running = 0;
+		return;
+	}
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "SRA (%02x,X)\n", short_address);
-			put_data_memory_byte(short_address+register_x, sra(get_data_memory_byte(short_address+register_x)));
-			inc_sim_time(6);
+	m->register_pc = dword_address;
+//		}
+	m->executed_return_instruction = 1;
+	call_event(m, CALL_EVENT_RETURN);
+}
 
-		}
-		// increment pc
-		register_pc += 2;
-		break;
+template<unsigned int PRECODE_SPACE> void op_trap(struct machine *m, unsigned char instruction)
+{
+	unsigned int dest;
 
-	// SRL
-	case SRL_A:	// 0x44
-		sprintf((char *)print_buffer, "SRL A\n");
-		register_a = srl(register_a);
-		// increment pc
-		register_pc++;
-		inc_sim_time(3);
-		break;
+	m->register_pc++;
 
-	case SRL_X:	// 0x54
-		if(precode_90) {
-			sprintf((char *)print_buffer, "SRL Y\n");
-			register_y = srl(register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
+	put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)(m->register_pc & 0xff));	// save registers to stack
+	put_memory_byte(m->prog_memory, m->register_sp--, (unsigned char)((m->register_pc >> 8) & 0xff));
+	put_memory_byte(m->prog_memory, m->register_sp--, m->register_x);
+	put_memory_byte(m->prog_memory, m->register_sp--, m->register_a);
+	put_memory_byte(m->prog_memory, m->register_sp--, m->register_cc);
 
-		} else {
-			sprintf((char *)print_buffer, "SRL X\n");
-			register_x = srl(register_x);
-			inc_sim_time(3);
+	m->register_cc |= (INTERRUPT_MASK_L0_BIT|INTERRUPT_MASK_L1_BIT);
 
-		}
-		// increment pc
-		register_pc++;
-		break;
+	dest = get_data_memory_byte(m, SWI) << 8;
+	dest |= get_data_memory_byte(m, SWI+1);
+	m->register_pc = dest;
+	disasm(m, "TRAP %04x\n", dest);
 
-	case SRL_REG_IND:	// 0x74
-		if(precode_90) {
-			sprintf((char *)print_buffer, "SRL (Y)\n");
-			put_data_memory_byte(register_y, srl(get_data_memory_byte(register_y)));
-			inc_sim_time(7);
-			precode_90 = 0;
+	call_event(m, CALL_EVENT_TRAP);
+}
 
-		} else {
-			sprintf((char *)print_buffer, "SRL (X)\n");
-			put_data_memory_byte(register_x, srl(get_data_memory_byte(register_x)));
-			inc_sim_time(5);
+template<unsigned int PRECODE_SPACE> void op_iret(struct machine *m, unsigned char instruction)
+{
+	unsigned int dest;
 
-		}
-		// increment pc
-		register_pc++;
-		break;
+	m->register_cc = get_data_memory_byte(m, ++m->register_sp);	// restore registers from stack
+	m->register_a = get_data_memory_byte(m, ++m->register_sp);
+	m->register_x = get_data_memory_byte(m, ++m->register_sp);
 
-	case SRL_SHORT:	// 0x34
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "SRL [%02x]\n", indirect_address);
-			inc_sim_time(7);
-			precode_92 = 0;
+	dest = get_data_memory_byte(m, ++m->register_sp) << 8;
+	dest |= get_data_memory_byte(m, ++m->register_sp);
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "SRL %02x\n", short_address);
-			inc_sim_time(5);
+	disasm(m, "IRET (%04x)\n", dest);
+	
 
-		}
-		put_data_memory_byte(short_address, srl(get_data_memory_byte(short_address)));
-		// increment pc
-		register_pc += 2;
-		break;
-
-	case SRL_REG_IND_OFF_SHORT:	// 0x64
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "SRL (%02x,Y)\n", short_address);
-			put_data_memory_byte(short_address+register_y, srl(get_data_memory_byte(short_address+register_y)));
-			inc_sim_time(7);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "SRL ([%02x],Y)\n", indirect_address);
-			put_data_memory_byte(short_address+register_y, srl(get_data_memory_byte(short_address+register_y)));
-			inc_sim_time(8);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "SRL ([%02x],X)\n", indirect_address);
-			put_data_memory_byte(short_address+register_x, srl(get_data_memory_byte(short_address+register_x)));
-			inc_sim_time(8);
-			precode_92 = 0;
+	m->register_pc = dest;
+	call_event(m, CALL_EVENT_IRET);
+}
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "SRL (%02x,X)\n", short_address);
-			put_data_memory_byte(short_address+register_x, srl(get_data_memory_byte(short_address+register_x)));
-			inc_sim_time(6);
+template<unsigned int PRECODE_SPACE> void op_wfi(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "WFI\n");
+	
+	m->register_cc &= ~(INTERRUPT_MASK_L0_BIT|INTERRUPT_MASK_L1_BIT);
+	m->running = 0;
+//		while(1)
+//			;
+}
 
-		}
-		// increment pc
-		register_pc += 2;
-		break;
+//
+// nothing at this opcode in the primary space
+//
+void op_unknown(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "*** Unknown instruction (%02x) @ pc=%08x\n", instruction, m->register_pc);
+	m->aabnormal_termination = 1;
+	m->running = 0;
+}
 
-	// SWAP
-	case SWAP_A:
-		sprintf((char *)print_buffer, "SWAP A\n");
-		temp = register_a;
-		register_a = (temp >> 4);
-		register_a |= (temp << 4);
-		set_flags(register_a);
+//
+// opcode doesn't exist in the space selected by the precode
+//
+void op_unhandled_precode(struct machine *m, unsigned char instruction)
+{
+	disasm(m, "*** Unhandled precode_%02x @ pc=%08x\n", m->decode_record.precode, m->register_pc);
+	m->aabnormal_termination = 1;
+	m->running = 0;
+}
 
-		// increment pc
-		register_pc++;
-		inc_sim_time(3);
-		break;
-
-	case SWAP_X:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "SWAP Y\n");
-			temp = register_y;
-			register_y = (temp >> 4);
-			register_y |= (temp << 4);
-			set_flags(register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
+//
+//----------------------------------------------
+// Opcode dispatch
+//----------------------------------------------
+//
+// The five opcode tables are built from the instruction spec in st7xisa.h.
+// Only the spaces an instruction is listed in get instantiated,
+// every other slot falls back to op_unknown / op_unhandled_precode.
+//
 
-		} else {
-			sprintf((char *)print_buffer, "SWAP X\n");
-			temp = register_x;
-			register_x = (temp >> 4);
-			register_x |= (temp << 4);
-			set_flags(register_x);
-			inc_sim_time(3);
+// handler for one space if the spec lists it there, else NULL
+#define SPACE_HANDLER(name, spaces, space, precode)	(((spaces) & (1 << (space))) ? op_##name<((spaces) & (1 << (space))) ? (precode) : 0> : NULL)
+
+struct insn_spec {
+	unsigned char opcode;
+	unsigned char length;		// primary space, without a precode
+	unsigned char flags;
+	const char *name;
+	opcode_handler handler[NUM_OPCODE_SPACES];
+	unsigned char cycles[NUM_OPCODE_SPACES];
+	unsigned char taken;		// on top of cycles when a conditional branch goes
+};
+
+#define INSN(opcode, name, spaces, length, flags, cycles, taken)	{ opcode, length, flags, #name, {				\
+										SPACE_HANDLER(name, spaces, SPACE_PRIMARY, 0),								\
+										SPACE_HANDLER(name, spaces, SPACE_90, PRECODE_90),							\
+										SPACE_HANDLER(name, spaces, SPACE_91, PRECODE_91),							\
+										SPACE_HANDLER(name, spaces, SPACE_92, PRECODE_92),							\
+										SPACE_HANDLER(name, spaces, SPACE_72, PRECODE_72) }, cycles, taken },
+
+#define CYCLES(primary, space_90, space_91, space_92, space_72)	{ primary, space_90, space_91, space_92, space_72 }
+
+struct insn_spec insn_specs[] = {
+#include "st7xisa.h"
+};
+
+#undef CYCLES
+#undef INSN
+
+// [space][opcode]
+opcode_handler opcode_spaces[NUM_OPCODE_SPACES][256];
+unsigned char opcode_flags[NUM_OPCODE_SPACES][256];
+unsigned char opcode_lengths[NUM_OPCODE_SPACES][256];	// bytes, precode included, 0 if unknown
+const char *opcode_names[NUM_OPCODE_SPACES][256];			// handler name, NULL if unknown
+unsigned char opcode_cycles[NUM_OPCODE_SPACES][256];		// precode included, 0 if unknown
+unsigned char opcode_taken_cycles[NUM_OPCODE_SPACES][256];	// extra for a taken branch
 
-		}
-		// increment pc
-		register_pc++;
-		
-		break;
+//
+// Fill in the opcode tables from the spec
+//
+void build_opcode_spaces(void)
+{
+	static int built;
+	unsigned int x, space, length;
 
-	case SWAP_REG_IND:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "SWAP (Y)\n");
-			temp = get_data_memory_byte(register_y);
-			put_data_memory_byte(register_y, ((temp >> 4) | (temp << 4)));
-			set_flags(prog_memory[register_y]);
-			inc_sim_time(6);
-			precode_90 = 0;
+	// the tables are the same for every machine
+	if(built) {
+		return;
+	}
+	built = 1;
 
-		} else {
-			sprintf((char *)print_buffer, "SWAP (X)\n");
-			temp = get_data_memory_byte(register_x);
-			put_data_memory_byte(register_x, ((temp >> 4) | (temp << 4)));
-			set_flags(prog_memory[register_x]);
-			inc_sim_time(5);
+	for(x = 0; x != 256; x++) {
+		opcode_spaces[SPACE_PRIMARY][x] = op_unknown;
+		for(space = SPACE_PRIMARY + 1; space != NUM_OPCODE_SPACES; space++) {
+			opcode_spaces[space][x] = op_unhandled_precode;
+		}
+	}
+	memset(opcode_flags, 0, sizeof(opcode_flags));
+	memset(opcode_lengths, 0, sizeof(opcode_lengths));
+	memset(opcode_names, 0, sizeof(opcode_names));
+	memset(opcode_cycles, 0, sizeof(opcode_cycles));
+	memset(opcode_taken_cycles, 0, sizeof(opcode_taken_cycles));
+
+	for(x = 0; x != sizeof(insn_specs) / sizeof(insn_specs[0]); x++) {
+		for(space = 0; space != NUM_OPCODE_SPACES; space++) {
+			if(insn_specs[x].handler[space]) {
+				opcode_spaces[space][insn_specs[x].opcode] = insn_specs[x].handler[space];
+				opcode_flags[space][insn_specs[x].opcode] = insn_specs[x].flags;
+				opcode_names[space][insn_specs[x].opcode] = insn_specs[x].name;
+				opcode_cycles[space][insn_specs[x].opcode] = insn_specs[x].cycles[space];
+				opcode_taken_cycles[space][insn_specs[x].opcode] = insn_specs[x].taken;
+
+				// every instruction takes some time
+				if(!insn_specs[x].cycles[space]) {
+					fprintf(stderr, "ERROR: %s has no cycle count in opcode space %d\n", insn_specs[x].name, space);
+				}
 
+				// the spec has the primary size, the precoded forms follow from the addressing mode
+				switch(space) {
+				case SPACE_PRIMARY:
+					length = insn_specs[x].length;
+					break;
+				case SPACE_90:
+					length = 1 + insn_specs[x].length;
+					break;
+				case SPACE_91:
+				case SPACE_92:
+					length = 1 + 2;
+					break;
+				default:
+					// SPACE_72, BTJx is the only jump in there
+					length = 1 + ((insn_specs[x].flags & INSN_JUMP) ? 4 : 3);
+					break;
+				}
+				opcode_lengths[space][insn_specs[x].opcode] = (unsigned char)length;
+			}
 		}
-		// increment pc
-		register_pc++;
-		
-		break;
-
-	case SWAP_SHORT:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "SWAP [%02x]\n", indirect_address);
-			temp = get_data_memory_byte(short_address);
-			put_data_memory_byte(short_address, ((temp >> 4) | (temp << 4)));
-			set_flags(prog_memory[short_address]);
-			inc_sim_time(7);
-			precode_92 = 0;
+	}
+}
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "SWAP %02x\n", short_address);
-			temp = get_data_memory_byte(short_address);
-			put_data_memory_byte(short_address, ((temp >> 4) | (temp << 4)));
-			set_flags(prog_memory[short_address]);
-			inc_sim_time(5);
+//
+// what the decoder makes of the instruction at address, for the recompiler
+//
+// returns 0 if the address isn't cached or nothing handles the opcode there
+//
+int describe_instruction(struct machine *m, unsigned int address, struct insn_description *insn)
+{
+	struct decode_entry *entry;
 
-		}
-		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case SWAP_REG_IND_OFF_SHORT:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "SWAP (%02x,Y)\n", short_address);
-			temp = get_data_memory_byte(short_address+register_y);
-			put_data_memory_byte(short_address+register_y, ((temp >> 4) | (temp << 4)));
-			set_flags(prog_memory[short_address+register_y]);
-			inc_sim_time(7);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "SWAP ([%02x],Y)\n", indirect_address);
-			temp = get_data_memory_byte(short_address+register_y);
-			put_data_memory_byte(short_address+register_y, ((temp >> 4) | (temp << 4)));
-			set_flags(prog_memory[short_address+register_y]);
-			inc_sim_time(8);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "SWAP ([%02x],X)\n", indirect_address);
-			temp = get_data_memory_byte(short_address+register_x);
-			put_data_memory_byte(short_address+register_x, ((temp >> 4) | (temp << 4)));
-			set_flags(prog_memory[short_address+register_x]);
-			inc_sim_time(8);
-			precode_92 = 0;
+	entry = lookup_decode_cache(m, address);
+	if(!entry || !opcode_names[entry->space][entry->opcode]) {
+		return(0);
+	}
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "SWAP (%02x,X)\n", short_address);
-			temp = get_data_memory_byte(short_address+register_x);
-			put_data_memory_byte(short_address+register_x, ((temp >> 4) | (temp << 4)));
-			set_flags(prog_memory[short_address+register_x]);
-			inc_sim_time(6);
+	insn->space = entry->space;
+	insn->precode = entry->precode;
+	insn->opcode = entry->opcode;
+	memcpy(insn->operand, entry->operand, sizeof(insn->operand));
+	insn->name = opcode_names[entry->space][entry->opcode];
+	insn->length = opcode_lengths[entry->space][entry->opcode];
+	insn->flags = opcode_flags[entry->space][entry->opcode];
 
-		}
-		// increment pc
-		register_pc += 2;
-		
-		break;
+	return(1);
+}
 
-	// INC
-	case INC_A:
-		sprintf((char *)print_buffer, "INC A\n");
-		register_a++;
-		set_flags(register_a);
-		// increment pc
-		register_pc++;
-		inc_sim_time(3);
-		
-		break;
-
-	case INC_X:
-		if(precode_72) {
-			long_address = get_data_memory_byte(register_pc+1) << 8;
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "INC %08x\n", long_address);
-			put_data_memory_byte(long_address, (get_data_memory_byte(long_address) + 1));
-			set_flags(prog_memory[long_address]);
-			inc_sim_time(6);
-			precode_72 = 0;
-			// increment pc
-			register_pc += 3;
-
-		} else if(precode_90) {
-			sprintf((char *)print_buffer, "INC Y\n");
-			register_y++;
-			set_flags(register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
-			// increment pc
-			register_pc++;
+//
+// Execute an instruction
+// This os the heart of the simulator
+// can set global abnormal termination flag
+//
+// fetch, pick the opcode space from the precode and call the handler out of its table
+//
+void execute(struct machine *m)
+{
+	unsigned char instruction;
+	unsigned int precode, space;
 
-		} else {
-			sprintf((char *)print_buffer, "INC X\n");
-			register_x++;
-			set_flags(register_x);
-			inc_sim_time(3);
-			// increment pc
-			register_pc++;
-		}
-		
-		break;
+	// start a fresh decode record, nothing gets formatted unless someone is tracing
+	m->decode_record.pc = m->register_pc;
+	m->decode_record.branch = DECODE_NOT_A_BRANCH;
+	m->decode_record.format = NULL;
 
-	case INC_REG_IND:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "INC (Y)\n");
-			put_data_memory_byte(register_y, (get_data_memory_byte(register_y) + 1));
-			set_flags(prog_memory[register_y]);
-			inc_sim_time(6);
-			precode_90 = 0;
+	m->executed_call_instruction = 0;
+	m->executed_return_instruction = 0;
+	m->aabnormal_termination = 0;
 
-		} else {
-			sprintf((char *)print_buffer, "INC (X)\n");
-			put_data_memory_byte(register_x, (get_data_memory_byte(register_x) + 1));
-			set_flags(prog_memory[register_x]);
-			inc_sim_time(5);
+	// Save pc to previous_pc
+	m->previous_register_pc = m->register_pc;
+
+	// Save pc to previous_sp
+	m->previous_register_sp = m->register_sp;
 
+	// Fetch next instruction, firmware comes out of the decode cache
+	m->decoded = lookup_decode_cache(m, m->register_pc);
+	if(m->decoded == NULL) {
+		// anything else is fetched every time
+		if(!fetch_instruction(m, m->register_pc, &m->caches->fetched)) {
+			return;		// abnormal termination, the simulator stops
 		}
-		// increment pc
-		register_pc++;
-		
-		break;
-
-	case INC_SHORT:		// 0x3c
-		if(precode_72) {
-			// added 09/06/2107 st8
-			// [longptr.w]
-			short_indirect_address = get_data_memory_byte(register_pc+1) << 8;
-			short_indirect_address |= get_data_memory_byte(register_pc+2);
-	
-			short_address = get_data_memory_byte(short_indirect_address);
+		m->decoded = &m->caches->fetched;
+	}
+	space = m->decoded->space;
+	precode = m->decoded->precode;
+	instruction = m->decoded->opcode;
 
-			sprintf((char *)print_buffer, "INC [%04x]\n", short_indirect_address);
-			inc_sim_time(9);
-			precode_72 = 0;
-			register_pc++;
-	
-		} else if(precode_92) {
-			// [short]
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "INC [%02x]\n", indirect_address);
-			inc_sim_time(7);
-			precode_92 = 0;
+	m->decode_record.precode = precode;
+	m->decode_record.opcode = instruction;
 
-		} else {
-			// short
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "INC %02x\n", short_address);
-			inc_sim_time(5);
+	// step over the precode
+	if(precode) {
+		disasm(m, "PRECODE_%02x ", precode);
+		simulator_output(m);
+		m->decode_record.format = NULL;
 
-		}
-		put_data_memory_byte(short_address, (get_data_memory_byte(short_address) + 1));
-		set_flags(prog_memory[short_address]);
 		// increment pc
-		register_pc += 2;
-		
-		break;
-
-	case INC_REG_IND_OFF_SHORT:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "INC (%02x,Y)\n", short_address);
-			put_data_memory_byte(short_address+register_y, (get_data_memory_byte(short_address+register_y) + 1));
-			set_flags(prog_memory[short_address+register_y]);
-			inc_sim_time(7);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "INC ([%02x],Y)\n", indirect_address);
-			put_data_memory_byte(short_address+register_y, (get_data_memory_byte(short_address+register_y) + 1));
-			set_flags(prog_memory[short_address+register_y]);
-			inc_sim_time(8);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "INC ([%02x],X)\n", indirect_address);
-			put_data_memory_byte(short_address+register_x, (get_data_memory_byte(short_address+register_x) + 1));
-			set_flags(prog_memory[short_address+register_x]);
-			inc_sim_time(8);
-			precode_92 = 0;
+		m->register_pc++;
+	}
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "INC (%02x,X)\n", short_address);
-			put_data_memory_byte(short_address+register_x, (get_data_memory_byte(short_address+register_x) + 1));
-			set_flags(prog_memory[short_address+register_x]);
-			inc_sim_time(6);
+	// operands follow the opcode
+	m->operand_pc = m->register_pc;
+	m->operand_count = 4;
 
-		}
-		// increment pc
-		register_pc += 2;
-		
-		break;
+	// charge the instruction, a taken branch adds to it
+	inc_sim_time(m, opcode_cycles[space][instruction]);
 
-	// DEC
-	case DEC_A:
-		sprintf((char *)print_buffer, "DEC A\n");
-		register_a--;
-		set_flags(register_a);
-		// increment pc
-		register_pc++;
-		inc_sim_time(2);
-
-		break;
-	case DEC_X:
-		if(precode_72) {
-			long_address = get_data_memory_byte(register_pc+1) << 8;
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "DEC %08x\n", long_address);
-			put_data_memory_byte(long_address, (get_data_memory_byte(long_address) - 1));
-			set_flags(prog_memory[long_address]);
-			inc_sim_time(6);
-			precode_72 = 0;
-			// increment pc
-			register_pc += 3;
-
-		} else if(precode_90) {
-			sprintf((char *)print_buffer, "DEC Y\n");
-			register_y--;
-			set_flags(register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
-			// increment pc
-			register_pc++;
+	// scoreboard the instruction and execute it
+	m->scoreboard[space][instruction].executions++;
+	m->scoreboard[space][instruction].cycles += opcode_cycles[space][instruction];
+	opcode_spaces[space][instruction](m, instruction);
 
-		} else {
-			sprintf((char *)print_buffer, "DEC X\n");
-			register_x--;
-			set_flags(register_x);
-			inc_sim_time(3);
-			// increment pc
-			register_pc++;
-		}
-		
-		break;
+	// produce output
+	simulator_output(m);
+}
 
-	case DEC_REG_IND:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "DEC (Y)\n");
-			put_data_memory_byte(register_y, (get_data_memory_byte(register_y) - 1));
-			inc_sim_time(7);
-			precode_90 = 0;
+//
+//----------------------------------------------
+// Basic block cache
+//----------------------------------------------
+//
+// For long runs with nothing to look at (no trace, no register display, no
+// step over) the firmware is run a basic block at a time. A block is a straight
+// run of cached instructions ending at a jump, call or return, kept as a list
+// of handlers already bound to their decode entries, and each block remembers
+// where it went last so the next one is found without a lookup.
+//
+// Blocks are recorded the first time through by execute(), so they are exactly
+// what the slow path would have done. With block_check set every block
+// instruction is compared against a fresh decode from memory before it runs,
+// and the block is run again in lockstep through execute() on a fork of the
+// machine, the registers and sim time have to match after every instruction
+// and the memory after the block.
+//
+// The run loop only gets to look at the pc between blocks, so a block never runs
+// over an address on the split list, an instruction breakpoint or a pc hook,
+// it ends in front of it instead and the next block starts there.
+//
 
-		} else {
-			sprintf((char *)print_buffer, "DEC (X)\n");
-			put_data_memory_byte(register_x, (get_data_memory_byte(register_x) - 1));
-			inc_sim_time(5);
+// blocks are kept in the machine's caches, see struct processor_caches
 
-		}
-		// increment pc
-		register_pc++;
-		
-		break;
-
-	case DEC_SHORT:		// 0x3a
-		if(precode_72) {
-			//	added 09/06/2017; st8
-			short_indirect_address = get_data_memory_byte(register_pc+1) << 8;
-			short_indirect_address |= get_data_memory_byte(register_pc+2);
-			short_address = get_data_memory_byte(short_indirect_address);
-			sprintf((char *)print_buffer, "DEC [%04x]\n", short_indirect_address);
-			inc_sim_time(9);
-			precode_72 = 0;
-			register_pc++;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "DEC [%02x]\n", indirect_address);
-			inc_sim_time(7);
-			precode_92 = 0;
+//
+// throw away all blocks
+//
+void flush_blocks(struct machine *m)
+{
+	m->caches->num_blocks = 0;
+	m->caches->num_block_insns = 0;
+	memset(m->caches->block_map, 0, sizeof(m->caches->block_map));
+	memset(m->caches->block_code, 0, sizeof(m->caches->block_code));
+	m->caches->blocks_flushed = 1;
+}
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "DEC %02x\n", short_address);
-			inc_sim_time(5);
+//
+// a byte at address changed, if any block instruction depends on it they all go
+//
+void invalidate_blocks_address(struct machine *m, unsigned int address)
+{
+	unsigned int offset, x;
 
-		}
-		put_data_memory_byte(short_address, (get_data_memory_byte(short_address) - 1));
-		set_flags(prog_memory[short_address]);
-		// increment pc
-		register_pc += 2;
-		break;
-
-	case DEC_REG_IND_OFF_SHORT:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "DEC (%02x,Y)\n", short_address);
-			put_data_memory_byte(short_address+register_y, (get_data_memory_byte(short_address+register_y) - 1));
-			set_flags(prog_memory[short_address+register_y]);
-			inc_sim_time(7);
-			precode_90 = 0;
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "DEC ([%02x],Y)\n", indirect_address);
-			put_data_memory_byte(short_address+register_y, (get_data_memory_byte(short_address+register_y) - 1));
-			set_flags(prog_memory[short_address+register_y]);
-			inc_sim_time(8);
-			precode_91 = 0;
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "DEC ([%02x],X)\n", indirect_address);
-			put_data_memory_byte(short_address+register_x, (get_data_memory_byte(short_address+register_x) - 1));
-			set_flags(prog_memory[short_address+register_x]);
-			inc_sim_time(8);
-			precode_92 = 0;
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "DEC (%02x,X)\n", short_address);
-			put_data_memory_byte(short_address+register_x, (get_data_memory_byte(short_address+register_x) - 1));
-			set_flags(prog_memory[short_address+register_x]);
-			inc_sim_time(6);
-		}
-		// increment pc
-		register_pc += 2;
-		break;
-
-	// NEG
-	case NEG_A:
-		sprintf((char *)print_buffer, "NEG A\n");
-		register_a = 0 - register_a;
-		set_flags(register_a);
-		if(!register_a) {
-			register_cc &= ~CARRY_BIT;
-		}
-		// increment pc
-		register_pc++;
-		inc_sim_time(3);
-		break;
-
-	case NEG_X:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "NEG Y\n");
-			register_y = 0 - register_y;
-			set_flags(register_y);
-			if(!register_y) {
-				register_cc &= ~CARRY_BIT;
-			}
-			inc_sim_time(4);
-			precode_90 = 0;
-		} else {
-			sprintf((char *)print_buffer, "NEG X\n");
-			register_x = 0 - register_x;
-			set_flags(register_x);
-			if(!register_x) {
-				register_cc &= ~CARRY_BIT;
-			}
-			inc_sim_time(3);
-		}
-		// increment pc
-		register_pc++;
-		break;
-
-	case NEG_REG_IND:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "NEG (Y)\n");
-			bcp_temp = get_data_memory_byte(register_y);
-			bcp_temp = 0 - bcp_temp;
-			put_data_memory_byte(register_y, bcp_temp);
-			set_flags(bcp_temp);
-			if(!bcp_temp) {
-				register_cc &= ~CARRY_BIT;
-			}
-			inc_sim_time(7);
-			precode_90 = 0;
-		} else {
-			sprintf((char *)print_buffer, "NEG (X)\n");
-			bcp_temp = get_data_memory_byte(register_x);
-			bcp_temp = 0 - bcp_temp;
-			put_data_memory_byte(register_x, bcp_temp);
-			set_flags(bcp_temp);
-			if(!bcp_temp) {
-				register_cc &= ~CARRY_BIT;
-			}
-			inc_sim_time(5);
-		}
-		// increment pc
-		register_pc++;
-		break;
-
-	case NEG_SHORT:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "NEG [%02x]\n", indirect_address);
-			inc_sim_time(7);
-			precode_92 = 0;
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "NEG %02x\n", short_address);
-			inc_sim_time(5);
-		}
-		bcp_temp = get_data_memory_byte(short_address);
-		bcp_temp = 0 - bcp_temp;
-		put_data_memory_byte(short_address, bcp_temp);
-		set_flags(bcp_temp);
-		if(!bcp_temp) {
-			register_cc &= ~CARRY_BIT;
-		}
-		// increment pc
-		register_pc += 2;
-		break;
-
-	case NEG_REG_IND_OFF_SHORT:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "NEG (%02x,Y)\n", short_address);
-			bcp_temp = get_data_memory_byte(short_address+register_y);
-			bcp_temp = 0 - bcp_temp;
-			put_data_memory_byte(short_address+register_y, bcp_temp);
-			set_flags(bcp_temp);
-			if(!bcp_temp) {
-				register_cc &= ~CARRY_BIT;
-			}
-			inc_sim_time(7);
-			precode_90 = 0;
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "NEG ([%02x],Y)\n", indirect_address);
-			bcp_temp = get_data_memory_byte(short_address+register_y);
-			bcp_temp = 0 - bcp_temp;
-
-			put_data_memory_byte(short_address+register_y, bcp_temp);
-			set_flags(bcp_temp);
-			if(!bcp_temp) {
-				register_cc &= ~CARRY_BIT;
-			}
-			inc_sim_time(8);
-			precode_91 = 0;
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "NEG ([%02x],X)\n", indirect_address);
-			bcp_temp = get_data_memory_byte(short_address+register_x);
-			bcp_temp = 0 - bcp_temp;
-
-			put_data_memory_byte(short_address+register_x, bcp_temp);
-			set_flags(bcp_temp);
-			if(!bcp_temp) {
-				register_cc &= ~CARRY_BIT;
-			}
-			inc_sim_time(8);
-			precode_92 = 0;
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "NEG (%02x,X)\n", short_address);
-			bcp_temp = get_data_memory_byte(short_address+register_x);
-			bcp_temp = 0 - bcp_temp;
-			put_data_memory_byte(short_address+register_x, bcp_temp);
-			set_flags(bcp_temp);
-			if(!bcp_temp) {
-				register_cc &= ~CARRY_BIT;
+	offset = address & 0x0000ffff;
+
+	for(x = 0; x != DECODE_WINDOW; x++) {
+		if((offset >= (ROM_START + x)) && ((offset - x) <= DECODE_CACHE_END)) {
+			if(m->caches->block_code[0][offset - x - ROM_START] | m->caches->block_code[1][offset - x - ROM_START]) {
+				flush_blocks(m);
+				return;
 			}
-			inc_sim_time(6);
-		}
-		// increment pc
-		register_pc += 2;
-		break;
-
-	// CPL
-	case CPL_A:
-		sprintf((char *)print_buffer, "CPL A\n");
-		register_a = (0xff - register_a);
-		set_flags(register_a);
-		register_cc |= CARRY_BIT;
-		// increment pc
-		register_pc++;
-		inc_sim_time(3);
-		break;
-
-	case CPL_X:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "CPL Y\n");
-			register_y = (0xff - register_y);
-			set_flags(register_y);	
-			inc_sim_time(4);
-			precode_90 = 0;
-		} else {
-			sprintf((char *)print_buffer, "CPL X\n");
-			register_x = (0xff - register_x);
-			set_flags(register_x);
-			inc_sim_time(3);
-		}
-		register_cc |= CARRY_BIT;
-		// increment pc
-		register_pc++;
-		break;
-
-	case CPL_REG_IND:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "CPL (Y)\n");
-			bcp_temp = get_data_memory_byte(register_y);
-			bcp_temp = (0xff - bcp_temp);
-			put_data_memory_byte(register_y, bcp_temp);
-			set_flags(bcp_temp);
-			inc_sim_time(7);
-			precode_90 = 0;
-		} else {
-			sprintf((char *)print_buffer, "CPL (X)\n");
-			bcp_temp = get_data_memory_byte(register_x);
-			bcp_temp = (0xff - bcp_temp);
-			put_data_memory_byte(register_x, bcp_temp);
-			set_flags(bcp_temp);
-			inc_sim_time(5);
-		}
-		register_cc |= CARRY_BIT;
-		// increment pc
-		register_pc++;
-		break;
-
-	case CPL_SHORT:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "CPL [%02x]\n", indirect_address);
-			inc_sim_time(7);
-			precode_92 = 0;
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "CPL %02x\n", short_address);
-			inc_sim_time(5);
-		}
-		bcp_temp = get_data_memory_byte(short_address);
-		bcp_temp = (0xff - bcp_temp);
-		put_data_memory_byte(short_address, bcp_temp);
-		set_flags(bcp_temp);
-		register_cc |= CARRY_BIT;
-		// increment pc
-		register_pc += 2;
-		break;
-
-	case CPL_REG_IND_OFF_SHORT:
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "CPL (%02x,Y)\n", short_address);
-			bcp_temp = get_data_memory_byte(short_address+register_y);
-			bcp_temp = (0xff - bcp_temp);
-			put_data_memory_byte(short_address+register_y, bcp_temp);
-			set_flags(bcp_temp);			
-			inc_sim_time(7);
-			precode_90 = 0;
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "CPL ([%02x],Y)\n", indirect_address);
-			bcp_temp = get_data_memory_byte(short_address+register_y);
-			bcp_temp = (0xff - bcp_temp);
-			put_data_memory_byte(short_address+register_y, bcp_temp);
-			inc_sim_time(8);
-			precode_91 = 0;
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "CPL ([%02x],X)\n", indirect_address);
-			bcp_temp = get_data_memory_byte(short_address+register_x);
-			bcp_temp = (0xff - bcp_temp);
-			put_data_memory_byte(short_address+register_x, bcp_temp);
-			precode_92 = 0;
-			inc_sim_time(8);
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "CPL (%02x,X)\n", short_address);
-			bcp_temp = get_data_memory_byte(short_address+register_x);
-			bcp_temp = (0xff - bcp_temp);
-			put_data_memory_byte(short_address+register_x, bcp_temp);
-			inc_sim_time(6);
-		}
-		register_cc |= CARRY_BIT;
-		// increment pc
-		register_pc += 2;
-		break;
-
-	// TNZ
-	case TNZ_A:	// 0x4d
-		// standard st8 has precode 72 - tnz #xxxx
-		// standard st8 has precode 90 - (tnz #xxxx,Y)
-		sprintf((char *)print_buffer, "TNZ A\n");
-		set_flags(register_a);
-		// increment pc
-		register_pc++;
-		inc_sim_time(3);
-		break;
-
-	case TNZ_X:	// 0x5d
-		if(precode_90) {
-			sprintf((char *)print_buffer, "TNZ Y\n");
-			set_flags(register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
-			// increment pc
-			register_pc++;
-		} else if(precode_72) {
-			long_address = get_data_memory_byte(register_pc+1) << 8;
-			long_address |= get_data_memory_byte(register_pc+2);
-			sprintf((char *)print_buffer, "TNZ %04x\n", long_address);
-			inc_sim_time(5);
-			set_flags(get_data_memory_byte(long_address));
-			precode_72 = 0;
-			// increment pc
-			register_pc += 3;
-		} else {
-			sprintf((char *)print_buffer, "TNZ X\n");
-			set_flags(register_x);
-			inc_sim_time(3);
-			// increment pc
-			register_pc++;
-		}
-		break;
-
-	case TNZ_REG_IND:	// 0x7d
-		if(precode_90) {
-			sprintf((char *)print_buffer, "TNZ (Y)\n");
-			set_flags(get_data_memory_byte(register_y));
-			inc_sim_time(7);
-			precode_90 = 0;
-		} else {
-			sprintf((char *)print_buffer, "TNZ (X)\n");
-			set_flags(get_data_memory_byte(register_x));
-			inc_sim_time(5);
 		}
-		// increment pc
-		register_pc++;
-		break;
-
-	case TNZ_SHORT: // 0x3d
-		// standard st8 has precode 0x72 TNZ [xxxx].w
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "TNZ [%02x]\n", indirect_address);
-			inc_sim_time(7);
-			precode_92 = 0;
+	}
+}
 
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "TNZ %02x\n", short_address);
-			inc_sim_time(5);
+//
+// mark the cached addresses on the split list, with an instruction breakpoint or a pc hook
+//
+void build_block_split_map(struct machine *m)
+{
+	unsigned int address;
+	int x;
 
+	memset(m->caches->block_split_map, 0, sizeof(m->caches->block_split_map));
+	for(x = 0; x != m->num_block_splits; x++) {
+		address = m->block_splits[x];
+		if(DECODE_CACHED(address)) {
+			m->caches->block_split_map[(address >> 20) & 1][(address & 0x0000ffff) - ROM_START] = 1;
 		}
-		set_flags(get_data_memory_byte(short_address));
-		// increment pc
-		register_pc += 2;
-		break;
-
-	case TNZ_REG_IND_OFF_SHORT:	// 0x6d
-		// standard st8 has precode 0x72 - TNZ([#xxxx.w],X)
-		if(precode_90) {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "TNZ (%02x,Y)\n", short_address);
-			temp = get_data_memory_byte(short_address+register_y);
-			inc_sim_time(7);
-			precode_90 = 0;
-
-		} else if(precode_91) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "TNZ ([%02x],Y)\n", indirect_address);
-			temp = get_data_memory_byte(short_address+register_y);
-			inc_sim_time(8);
-			precode_91 = 0;
-
-		} else if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			sprintf((char *)print_buffer, "TNZ ([%02x],X)\n", indirect_address);
-			temp = get_data_memory_byte(short_address+register_x);
-			inc_sim_time(8);
-			precode_92 = 0;
-
-		} else {
-			short_address = get_data_memory_byte(register_pc+1);
-			sprintf((char *)print_buffer, "TNZ (%02x,X)\n", short_address);
-			temp = get_data_memory_byte(short_address+register_x);
-			inc_sim_time(6);
+	}
 
+	if(m->num_ins_breakpoints) {
+		for(address = ROM_START; address <= DECODE_CACHE_END; address++) {
+			if(ins_breakpoint(m, address)) {
+				m->caches->block_split_map[0][address - ROM_START] = 1;
+			}
+			if(ins_breakpoint(m, address | 0x00100000)) {
+				m->caches->block_split_map[1][address - ROM_START] = 1;
+			}
 		}
-		set_flags(temp);
-		// increment pc
-		register_pc += 2;
-		break;
-
-	// PUSH
-	case PUSH_A:
-		sprintf((char *)print_buffer, "PUSH A\n");
-		prog_memory[register_sp--] = register_a;	// push a onto the stack
-		// increment pc
-		register_pc++;
-		inc_sim_time(3);
-		break;
-
-	case PUSH_X:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "PUSH Y\n");
-			prog_memory[register_sp--] = register_y;	// push y onto the stack
-			inc_sim_time(4);
-			precode_90 = 0;
+	}
 
-		} else {
-			sprintf((char *)print_buffer, "PUSH X\n");
-			prog_memory[register_sp--] = register_x;	// push x onto the stack
-			inc_sim_time(3);
+	for(address = next_pc_hook(ROM_START); address != NO_PC_HOOK; address = next_pc_hook(address + 1)) {
+		if(DECODE_CACHED(address)) {
+			m->caches->block_split_map[(address >> 20) & 1][(address & 0x0000ffff) - ROM_START] = 1;
 		}
-		// increment pc
-		register_pc++;
-		break;
+	}
+	m->caches->block_split_hooks = pc_hook_generation;
+}
 
-	case PUSH_CC:
-		sprintf((char *)print_buffer, "PUSH CC\n");
-		prog_memory[register_sp--] = register_cc;	// push cc onto the stack
-		// increment pc
-		register_pc++;
-		inc_sim_time(3);
-		break;
-
-	case PUSH_LONG:	// 3b
-		long_address = get_data_memory_byte(register_pc+1) << 8;
-		long_address |= get_data_memory_byte(register_pc+2);
-		sprintf((char *)print_buffer, "PUSH %08x\n", long_address);
-		temp = get_data_memory_byte(long_address);
-		prog_memory[register_sp--] = temp;	// push onto the stack
-		// increment pc
-		register_pc += 3;
-		inc_sim_time(3);
-		break;
-
-	case PUSH_IMMED:	//				0x4b
-		temp = get_data_memory_byte(register_pc+1);
-		sprintf((char *)print_buffer, "PUSH #%02x\n", temp);
-		prog_memory[register_sp--] = temp;	// push onto the stack
-		// increment pc
-		register_pc += 2;
-		inc_sim_time(3);
-		break;
-
-	// POP
-	case POP_A:
-		sprintf((char *)print_buffer, "POP A\n");
-		register_a = get_data_memory_byte(++register_sp);	// push from the stack into a
-//		set_flags(register_a);
-		// increment pc
-		register_pc++;
-		inc_sim_time(3);
-		break;
-
-	case POP_X:
-		if(precode_90) {
-			sprintf((char *)print_buffer, "POP Y\n");
-			register_y = get_data_memory_byte(++register_sp);	// push from the stack into y
-//			set_flags(register_y);
-			inc_sim_time(4);
-			precode_90 = 0;
+//
+// set the addresses a block must not run over, the blocks are rebuilt if they changed
+//
+void set_block_splits(struct machine *m, unsigned int *addresses, int count)
+{
+	if(count > MAX_BLOCK_SPLITS) {
+		printf("*** Too many block split addresses (%d), only %d used\n", count, MAX_BLOCK_SPLITS);
+		count = MAX_BLOCK_SPLITS;
+	}
 
-		} else {
-			sprintf((char *)print_buffer, "POP X\n");
-			register_x = get_data_memory_byte(++register_sp);	// push from the stack into x
-//			set_flags(register_x);
-			inc_sim_time(3);
-		}
-		// increment pc
-		register_pc++;
-		break;
+	if((count == m->num_block_splits) && !memcmp(m->block_splits, addresses, count * sizeof(unsigned int)) && (m->caches->block_split_hooks == pc_hook_generation)) {
+		return;
+	}
 
-	case POP_CC:
-		sprintf((char *)print_buffer, "POP CC\n");
-		register_cc = get_data_memory_byte(++register_sp);	// push from the stack into cc
-		// increment pc
-		register_pc++;
-		inc_sim_time(3);
-		break;
-
-	case POP_LONG:	//				0x32
-		long_address = get_data_memory_byte(register_pc+1) << 8;
-		long_address |= get_data_memory_byte(register_pc+2);
-		sprintf((char *)print_buffer, "POP %08x\n", long_address);
-		temp = get_data_memory_byte(++register_sp);	// push from the stack
-		put_data_memory_byte(long_address, temp);
-		// increment pc
-		register_pc += 3;
-		inc_sim_time(3);
-		break;
+	memcpy(m->block_splits, addresses, count * sizeof(unsigned int));
+	m->num_block_splits = count;
 
-// CALL
-	case CALL_LONG:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			dest = get_data_memory_byte(indirect_address) << 8;
-			dest |= get_data_memory_byte(indirect_address+1);
-			
-			register_pc += 2;	// adjust so return address is correct
-	
-			prog_memory[register_sp--] = (unsigned char)(register_pc & 0xff);	// push return address on stack
-			prog_memory[register_sp--] = (unsigned char)((register_pc >> 8) & 0xff);
-			register_pc &= 0xffff0000;
-			register_pc |= dest;			
+	build_block_split_map(m);
+	flush_blocks(m);
+}
 
-			sprintf((char *)print_buffer, "CALL [%02x.w]=%04x EA=%04x : pc=%08x\n", indirect_address, dest, dest, register_pc);
-			
-			inc_sim_time(8);
-			precode_92 = 0;
-		} else {
-			dest = get_data_memory_byte(register_pc+1) << 8;
-			dest |= get_data_memory_byte(register_pc+2);
-			
-			register_pc += 3;	// adjust so return address is correct
+//
+// the instruction breakpoints changed, the blocks are rebuilt around the new ones
+//
+void update_block_split_map(struct machine *m)
+{
+	build_block_split_map(m);
+	flush_blocks(m);
+}
+
+//
+// is address on the split list, an instruction breakpoint or a pc hook
+//
+int block_split(struct machine *m, unsigned int address)
+{
+	int x;
 
-			prog_memory[register_sp--] = (unsigned char)(register_pc & 0xff);// push return address on stack
-			prog_memory[register_sp--] = (unsigned char)((register_pc >> 8) & 0xff);
-			register_pc &= 0xffff0000;
-			register_pc |= dest;
+	if(DECODE_CACHED(address)) {
+		return(m->caches->block_split_map[(address >> 20) & 1][(address & 0x0000ffff) - ROM_START]);
+	}
 
-			sprintf((char *)print_buffer, "CALL %04x : pc=%08x\n", dest, register_pc);
+	if(ins_breakpoint(m, address) || pc_hooked(address)) {
+		return(1);
+	}
 
-			inc_sim_time(6);
+	for(x = 0; x != m->num_block_splits; x++) {
+		if(m->block_splits[x] == address) {
+			return(1);
 		}
-		executed_call_instruction = 1;
-		break;
+	}
+	return(0);
+}
 
-	case CALL_REG_IND:
-		if(precode_90) {
-			dest = register_y;
+//
+// block starting at address, NULL if there isn't one (yet)
+//
+inline struct block *lookup_block(struct machine *m, unsigned int address)
+{
+	if(!DECODE_CACHED(address)) {
+		return(NULL);
+	}
+	return(m->caches->block_map[(address >> 20) & 1][(address & 0x0000ffff) - ROM_START]);
+}
 
-			register_pc++;	// adjust so return address is correct
+//
+// run instructions through execute() starting at the pc and keep them as a block
+//
+// runs at most budget instructions, *executed says how many it did
+// returns NULL if nothing could be kept
+//
+struct block *record_block(struct machine *m, unsigned int budget, unsigned int *executed)
+{
+	struct block *block;
+	struct block_insn *insn;
+	unsigned int address, space;
 
-			prog_memory[register_sp--] = (unsigned char)(register_pc & 0xff);
-			prog_memory[register_sp--] = (unsigned char)((register_pc >> 8) & 0xff);
-			register_pc = dest;
+	*executed = 0;
 
-			sprintf((char *)print_buffer, "CALL (Y) : pc=%08x\n", dest);
+	// make room
+	if((m->caches->num_blocks == MAX_BLOCKS) || ((m->caches->num_block_insns + MAX_BLOCK_LENGTH) > MAX_BLOCK_INSNS)) {
+		flush_blocks(m);
+	}
 
-			inc_sim_time(6);
-			precode_90 = 0;
-		} else {
-			dest = register_x;
+	block = &m->caches->blocks[m->caches->num_blocks];
+	block->pc = m->register_pc;
+	block->count = 0;
+	block->split = block_split(m, m->register_pc);
+	block->insns = &m->caches->block_insns[m->caches->num_block_insns];
+	block->chain_pc[0] = block->chain_pc[1] = 0xffffffff;
+	block->chain[0] = block->chain[1] = NULL;
+	block->chain_next = 0;
 
-			register_pc++;	// adjust so return address is correct
+	m->caches->blocks_flushed = 0;
 
-			prog_memory[register_sp--] = (unsigned char)(register_pc & 0xff);
-			prog_memory[register_sp--] = (unsigned char)((register_pc >> 8) & 0xff);
-			register_pc = dest;
+	while(*executed != budget) {
+		address = m->register_pc;
 
-			sprintf((char *)print_buffer, "CALL (X) : pc=%08x\n", dest);
+		execute(m);
+		(*executed)++;
 
-			inc_sim_time(5);
+		// uncached, stopped or wrote over code, don't keep it
+		if((m->decoded == &m->caches->fetched) || !m->running || m->caches->blocks_flushed) {
+			break;
 		}
-		executed_call_instruction = 1;
-		break;
-
-	case CALL_REG_IND_OFF_SHORT:
-		register_pc += 2;
-		if(precode_90) {
-			// (short,Y)
-			short_address = get_data_memory_byte(register_pc+1);
-			
-			temp = register_y;
 
-			prog_memory[register_sp--] = (unsigned char)(register_pc & 0xff); // save return address on stack
-			prog_memory[register_sp--] = (unsigned char)((register_pc >> 8) & 0xff);
+		space = opcode_space(m->decoded->precode);
 
-			dest = short_address;
-			dest += temp;
-			register_pc = dest;
+		insn = &block->insns[block->count++];
+		insn->pc = address;
+		insn->handler = opcode_spaces[space][m->decoded->opcode];
+		insn->decoded = m->decoded;
+		insn->scoreboard = &m->scoreboard[space][m->decoded->opcode];
+		insn->instruction = m->decoded->opcode;
+		insn->precode = m->decoded->precode;
+		insn->cycles = opcode_cycles[space][m->decoded->opcode];
 
-			sprintf((char *)print_buffer, "CALL (%02x,Y) : pc=%08x\n", short_address, register_pc);
+		m->caches->block_code[(address >> 20) & 1][(address & 0x0000ffff) - ROM_START] = 1;
 
-			inc_sim_time(7);
-			precode_90 = 0;
+		// the recompiler trusts the spec lengths, so check them here too
+		if(m->block_check && !(opcode_flags[space][m->decoded->opcode] & INSN_FLOW) && (m->register_pc != (address + opcode_lengths[space][m->decoded->opcode]))) {
+			sim_printf(m, "\n*** Block check: %02x %02x @ %08x is %d bytes, the spec says %d\n", insn->precode, insn->instruction, address, m->register_pc - address, opcode_lengths[space][m->decoded->opcode]);
+		}
 
-		} else if(precode_92) {
-			// ([short],X)
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			
-			temp = register_x;
+		if((opcode_flags[space][m->decoded->opcode] & INSN_FLOW) || (block->count == MAX_BLOCK_LENGTH)) {
+			break;
+		}
+
+		// next one is in front of a split, uncached or a data breakpoint fired
+		if(block_split(m, m->register_pc) || !DECODE_CACHED(m->register_pc) || (m->data_breakpoint_triggered_number != -1)) {
+			break;
+		}
+	}
 
-			prog_memory[register_sp--] = (unsigned char)(register_pc & 0xff); // save return address on stack
-			prog_memory[register_sp--] = (unsigned char)((register_pc >> 8) & 0xff);
+	if(!block->count || m->caches->blocks_flushed) {
+		return(NULL);
+	}
 
-			dest = short_address;
-			dest += temp;
-			register_pc = dest;
+	m->caches->block_map[(block->pc >> 20) & 1][(block->pc & 0x0000ffff) - ROM_START] = block;
+	m->caches->num_blocks++;
+	m->caches->num_block_insns += block->count;
 
-			sprintf((char *)print_buffer, "CALL ([%02x],X) : pc=%08x\n", indirect_address, register_pc);
+	return(block);
+}
 
-			inc_sim_time(8);
-			precode_92 = 0;
+//
+// block check found a difference, stop the machine
+//
+void block_check_failed(struct machine *m)
+{
+	m->aabnormal_termination = 1;
+	m->running = 0;
+}
 
-		} else if(precode_91) {
-			// ([short],Y)
-			indirect_address = get_data_memory_byte(register_pc+1);
-			short_address = get_data_memory_byte(indirect_address);
-			
-			temp = register_y;
+//
+// make sure a block instruction is what execute() would run at the pc, decoded
+// afresh from memory, not out of the decode cache the block was recorded from
+// stops the machine if it isn't
+//
+int check_block_insn(struct machine *m, struct block_insn *insn)
+{
+	struct decode_entry fresh;
 
-			prog_memory[register_sp--] = (unsigned char)(register_pc & 0xff); // save return address on stack
-			prog_memory[register_sp--] = (unsigned char)((register_pc >> 8) & 0xff);
+	if((m->register_pc == insn->pc) && fetch_instruction(m, m->register_pc, &fresh)) {
+		if((fresh.precode == insn->precode) && (fresh.opcode == insn->instruction) && (fresh.precode == insn->decoded->precode) &&
+			(fresh.opcode == insn->decoded->opcode) && !memcmp(fresh.operand, insn->decoded->operand, sizeof(fresh.operand)) &&
+			(opcode_spaces[fresh.space][fresh.opcode] == insn->handler)) {
+			return(1);
+		}
+	}
 
-			dest = short_address;
-			dest += temp;
-			register_pc = dest;
+	sim_printf(m, "\n*** Block check failed @ pc=%08x, block has %02x %02x @ %08x\n", m->register_pc, insn->precode, insn->instruction, insn->pc);
+	block_check_failed(m);
+	return(0);
+}
 
-			sprintf((char *)print_buffer, "CALL ([%02x],Y) : pc=%08x\n", indirect_address, register_pc);
+//
+// the block is about to run, make the block check machine the same as this one
+// returns it, NULL if there isn't enough memory for it
+//
+struct machine *start_block_check(struct machine *m)
+{
+	if(m->block_check_machine == NULL) {
+		m->block_check_machine = new_machine();
+		if(m->block_check_machine == NULL) {
+			sim_printf(m, "*** Not enough memory to run blocks through execute(), only the decode is checked\n");
+			return(NULL);
+		}
+	}
 
-			inc_sim_time(8);
-			precode_91 = 0;
+	fork_machine(m->block_check_machine, m);
+	m->block_check_machine->quiet = 1;
+	return(m->block_check_machine);
+}
 
-		} else {
-			// (short,X)
-			short_address = get_data_memory_byte(register_pc+1);
-			
-			temp = register_x;
+//
+// insn ran, run it through execute() on check and see that both came out the same
+// stops the machine if they didn't
+//
+int check_block_step(struct machine *m, struct machine *check, struct block_insn *insn)
+{
+	execute(check);
 
-			prog_memory[register_sp--] = (unsigned char)(register_pc & 0xff); // save return address on stack
-			prog_memory[register_sp--] = (unsigned char)((register_pc >> 8) & 0xff);
+	if((m->register_pc == check->register_pc) && (m->register_a == check->register_a) && (m->register_x == check->register_x) &&
+		(m->register_y == check->register_y) && (m->register_cc == check->register_cc) && (m->register_sp == check->register_sp) &&
+		(m->sim_cycles == check->sim_cycles)) {
+		return(1);
+	}
 
-			dest = short_address;
-			dest += temp;
-			register_pc = dest;
+	sim_printf(m, "\n*** Block check failed after %02x %02x @ %08x, block/execute():\n", insn->precode, insn->instruction, insn->pc);
+	sim_printf(m, "PC=%08x/%08x CC=%02x/%02x A=%02x/%02x X=%02x/%02x Y=%02x/%02x SP=%04x/%04x cycles=%llu/%llu\n",
+		m->register_pc, check->register_pc, m->register_cc, check->register_cc, m->register_a, check->register_a,
+		m->register_x, check->register_x, m->register_y, check->register_y, m->register_sp, check->register_sp, m->sim_cycles, check->sim_cycles);
+	block_check_failed(m);
+	return(0);
+}
 
-			sprintf((char *)print_buffer, "CALL (%02x,X) : pc=%08x\n", short_address, register_pc);
+//
+// the block is done, its writes have to be the ones execute() made
+// stops the machine if they aren't
+//
+void end_block_check(struct machine *m, struct machine *check)
+{
+	static const char *memory_names[NUM_MEMORIES] = { "page 00", "page 10", "flash" };
+	int x, address;
 
-			inc_sim_time(6);
+	for(x = 0; x != NUM_MEMORIES; x++) {
+		address = compare_memory_pages(m->memory[x], check->memory[x]);
+		if(address != -1) {
+			sim_printf(m, "\n*** Block check failed, %s %04x is %02x, execute() has %02x\n", memory_names[x], address,
+				get_memory_byte(m->memory[x], address), get_memory_byte(check->memory[x], address));
+			block_check_failed(m);
+			return;
 		}
-		executed_call_instruction = 1;
-		break;
-
-	case CALL_REG_IND_OFF_LONG:
-		if(precode_90) {
-			// (long,Y)
-			long_address = get_data_memory_byte(register_pc+1) << 8;
-			long_address |= get_data_memory_byte(register_pc+2);
-			
-			temp = register_y;
-
-			register_pc += 3;	// adjust so return address is correct
+	}
+}
 
-			prog_memory[register_sp--] = (unsigned char)(register_pc & 0xff);	// save returnj address on stack
-			prog_memory[register_sp--] = (unsigned char)((register_pc >> 8) & 0xff);
+//
+// run at most budget instructions of a block, returns how many were run
+//
+inline unsigned int run_block(struct machine *m, struct block *block, unsigned int budget)
+{
+	struct block_insn *insn, *end;
+	struct machine *check;
 
-			dest = long_address;
-			dest += temp;
-			register_pc = dest;
+	insn = block->insns;
+	end = insn + ((block->count < budget) ? block->count : budget);
 
-			sprintf((char *)print_buffer, "CALL (%04x,Y) : pc=%08x\n", long_address, register_pc);
+	check = m->block_check ? start_block_check(m) : NULL;
 
-			inc_sim_time(8);
-			precode_90 = 0;
+	while(insn != end) {
+		if(m->block_check) {
+			if(!check_block_insn(m, insn)) {
+				check = NULL;
+				break;
+			}
+		}
 
-		} else if(precode_92) {
-			// ([long],X)
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = get_data_memory_byte(indirect_address) << 8;
-			long_address |= get_data_memory_byte(indirect_address);
-			
-			temp = register_x;
+		m->previous_register_pc = m->register_pc;
+		m->previous_register_sp = m->register_sp;
 
-			register_pc += 2;// adjust so return address is correct
+		// step over the precode
+		if(insn->precode) {
+			m->register_pc++;
+		}
 
-			prog_memory[register_sp--] = (unsigned char)(register_pc & 0xff);	// save returnj address on stack
-			prog_memory[register_sp--] = (unsigned char)((register_pc >> 8) & 0xff);
+		m->decoded = insn->decoded;
+		m->operand_pc = m->register_pc;
+		m->operand_count = 4;
 
-			dest = long_address;
-			dest += temp;
-			register_pc = dest;
+		inc_sim_time(m, insn->cycles);
 
-			sprintf((char *)print_buffer, "CALL ([%02x.w],X) : pc=%08x\n", indirect_address, register_pc);
+		insn->scoreboard->executions++;
+		insn->scoreboard->cycles += insn->cycles;
+		insn->handler(m, insn->instruction);
+		insn++;
 
-			inc_sim_time(9);
-			precode_92 = 0;
+		if((check != NULL) && !check_block_step(m, check, insn - 1)) {
+			check = NULL;
+			break;
+		}
 
-		} else if(precode_91) {
-			// ([long],Y)
-			indirect_address = get_data_memory_byte(register_pc+1);
-			long_address = get_data_memory_byte(indirect_address) << 8;
-			long_address = get_data_memory_byte(indirect_address) << 8;
-			
-			temp = register_y;
+		if(!m->running || (m->data_breakpoint_triggered_number != -1) || m->caches->blocks_flushed) {
+			break;
+		}
+	}
 
-			register_pc += 2;	// adjust so return address is correct
+	if(check != NULL) {
+		end_block_check(m, check);
+	}
+	return((unsigned int)(insn - block->insns));
+}
 
-			prog_memory[register_sp--] = (unsigned char)(register_pc & 0xff);	// save returnj address on stack
-			prog_memory[register_sp--] = (unsigned char)((register_pc >> 8) & 0xff);
+//
+// run the block at the pc, recording it if it's new
+// returns the number of instructions executed
+//
+unsigned int execute_block(struct machine *m, unsigned int budget)
+{
+	struct block *block;
+	unsigned int count;
 
-			dest = long_address;
-			dest += temp;
-			register_pc = dest;
+	m->caches->blocks_flushed = 0;
 
-			sprintf((char *)print_buffer, "CALL ([%02x.w],Y) : pc=%08x\n", indirect_address, register_pc);
+	block = lookup_block(m, m->register_pc);
+	if(block) {
+		return(run_block(m, block, budget));
+	}
 
-			inc_sim_time(9);
-			precode_91 = 0;
+	record_block(m, budget, &count);
+	return(count);
+}
 
-		} else {
-			// (long,X)
-			long_address = get_data_memory_byte(register_pc+1) << 8;
-			long_address |= get_data_memory_byte(register_pc+2);
-			
-			temp = register_x;
+//
+// Execute up to budget instructions a block at a time
+//
+// comes back early when the machine stops, a data breakpoint fires or the
+// next pc is on the split list or the return address of a call being stepped
+// over, returns the number of instructions executed
+//
+unsigned int execute_blocks(struct machine *m, unsigned int budget)
+{
+	struct block *block, *next;
+	unsigned int executed, count, pc;
 
-			register_pc += 3;	// adjust so return address is correct
+	executed = 0;
+	m->caches->blocks_flushed = 0;
+	m->aabnormal_termination = 0;
 
-			prog_memory[register_sp--] = (unsigned char)(register_pc & 0xff);	// save returnj address on stack
-			prog_memory[register_sp--] = (unsigned char)((register_pc >> 8) & 0xff);
+	block = lookup_block(m, m->register_pc);
 
-			dest = long_address;
-			dest += temp;
-			register_pc = dest;
+	while(1) {
+		if(block) {
+			executed += run_block(m, block, budget - executed);
+		} else {
+			// first time here, run it the slow way and remember it
+			block = record_block(m, budget - executed, &count);
+			executed += count;
+		}
 
-			sprintf((char *)print_buffer, "CALL (%04x,X) : pc=%08x\n", long_address, register_pc);
+		if(!m->running || (m->data_breakpoint_triggered_number != -1) || m->caches->blocks_flushed || (executed == budget) || !block) {
+			break;
+		}
 
-			inc_sim_time(7);
+		// back at the return address of a call being stepped over, the run loop decides
+		pc = m->register_pc;
+		if(pc == m->in_function_call_pc) {
+			break;
 		}
-		executed_call_instruction = 1;
-		break;
 
-	case CALLR_SHORT:
-		if(precode_92) {
-			indirect_address = get_data_memory_byte(register_pc+1);
-			displacement = get_data_memory_byte(indirect_address);
+		// follow the chain, look it up only if we haven't been there from here
+		if(block->chain_pc[0] == pc) {
+			next = block->chain[0];
+		} else if(block->chain_pc[1] == pc) {
+			next = block->chain[1];
+		} else {
+			next = lookup_block(m, pc);
+			if(next) {
+				block->chain_pc[block->chain_next] = pc;
+				block->chain[block->chain_next] = next;
+				block->chain_next ^= 1;
+			} else if(block_split(m, pc)) {
+				break;
+			}
+		}
 
-			register_pc += 2;	// adjust so return address is correct
+		if(next && next->split) {
+			break;
+		}
+		block = next;
+	}
+	return(executed);
+}
 
-			prog_memory[register_sp--] = (unsigned char)(register_pc & 0xff);	// save returnj address on stack
-			prog_memory[register_sp--] = (unsigned char)((register_pc >> 8) & 0xff);
+//----------------------------------------------
+// Recompiled ROM
+//----------------------------------------------
+//
+// The recompiler (recompiler.cpp) turns the firmware into C++, one function
+// per routine with every instruction a direct call of its handler. Built with
+// RECOMPILED_ROM defined the generated st7xrom.h is included here and
+// execute_recompiled() runs it, anything it doesn't know (indirect jump targets
+// it never saw, uncached code) goes through the block cache instead.
+//
+// Before any of it runs every recompiled instruction is checked against the
+// decoder, a write into the covered ROM sends it back to be checked again.
+//
 
-			if(displacement & 0x0080) {
-				displacement |= 0xff00;
-			}
-			register_pc += displacement;
-			
-			sprintf((char *)print_buffer, "CALLR [%02x]=%d : pc=%08x\n", indirect_address, displacement, register_pc);
+#define RECOMPILED_UNCHECKED	0
+#define RECOMPILED_OK			1
+#define RECOMPILED_MISMATCH		2
 
-			inc_sim_time(8);
-			precode_92 = 0;
+//
+// memory got reloaded, check it all again before it's used
+//
+void invalidate_recompiled(struct machine *m)
+{
+	m->recompiled_state = RECOMPILED_UNCHECKED;
+}
 
-		} else {
-			displacement = get_data_memory_byte(register_pc+1);
+#ifdef RECOMPILED_ROM
 
-			register_pc += 2;	// adjust so return address is correct
+// one per recompiled instruction, what the decoder has to agree with
+struct recompiled_insn {
+	unsigned int pc;
+	struct decode_entry entry;
+};
 
-			prog_memory[register_sp--] = (unsigned char)(register_pc & 0xff);	// save returnj address on stack
-			prog_memory[register_sp--] = (unsigned char)((register_pc >> 8) & 0xff);
+//
+// one recompiled instruction, returns from the routine when it has to stop
+//
+#define RC_EXECUTE(pc, space, opcode, handler)																\
+	if((m->recompiled_executed == m->recompiled_budget) ||														\
+	   (m->recompiled_executed && m->caches->block_split_map[((pc) >> 20) & 1][((pc) & 0x0000ffff) - ROM_START])) {		\
+		return;																								\
+	}																										\
+	m->previous_register_pc = m->register_pc;																		\
+	m->previous_register_sp = m->register_sp;																		\
+	if((space) != SPACE_PRIMARY) {																			\
+		m->register_pc++;																						\
+	}																										\
+	m->decoded = &m->caches->decode_cache[((pc) >> 20) & 1][((pc) & 0x0000ffff) - ROM_START];								\
+	m->operand_pc = m->register_pc;																				\
+	m->operand_count = 4;																						\
+	inc_sim_time(m, opcode_cycles[space][opcode]);																\
+	m->scoreboard[space][opcode].executions++;																	\
+	m->scoreboard[space][opcode].cycles += opcode_cycles[space][opcode];										\
+	handler(m, opcode);																					\
+	m->recompiled_executed++;																					\
+	if(!m->running || (m->data_breakpoint_triggered_number != -1) || (m->recompiled_state != RECOMPILED_OK)) {		\
+		return;																								\
+	}
 
-			if(displacement & 0x0080) {
-					displacement |= 0xff00;
-			}
-			register_pc += displacement;	
-	
-			sprintf((char *)print_buffer, "CALLR %d : pc=%08x\n", displacement, register_pc);
+// straight line instruction, back to the dispatcher if it didn't end up at next
+#define RC_INSN(pc, space, opcode, handler, next)															\
+	RC_EXECUTE(pc, space, opcode, handler)																	\
+	if(m->register_pc != (next)) {																				\
+		return;																								\
+	}
 
-			inc_sim_time(6);
-		}
-		executed_call_instruction = 1;
-		break;
+// jump, call or return, the generated code sorts out where it went
+#define RC_FLOW(pc, space, opcode, handler)																	\
+	RC_EXECUTE(pc, space, opcode, handler)
 
-	case CALL_FAR:
-		dword_address = get_data_memory_byte(register_pc+1) << 16;
-		dword_address |= get_data_memory_byte(register_pc+2) << 8;
-		dword_address |= get_data_memory_byte(register_pc+3);
+#include "st7xrom.h"
 
-		register_pc += 4;	// adjust so return address is correct
+//
+// compare every recompiled instruction with the decoder
+//
+void check_recompiled(struct machine *m)
+{
+	struct decode_entry *entry;
+	unsigned int x, pc;
 
-		prog_memory[register_sp--] = (unsigned char)(register_pc & 0xff);	// save returnj address on stack (long format)
-		prog_memory[register_sp--] = (unsigned char)((register_pc >> 8) & 0xff);
-		prog_memory[register_sp--] = (unsigned char)((register_pc >> 16) & 0xff);
+	memset(m->caches->recompiled_code, 0, sizeof(m->caches->recompiled_code));
 
-		if(dword_address & 0xffff0000) {
-//			sprintf((char *)print_buffer, "*INTER-SEGMENT CALL to %08x", dword_address);
+	for(x = 0; x != RECOMPILED_INSNS; x++) {
+		pc = recompiled_insns[x].pc;
+		entry = lookup_decode_cache(m, pc);
+		if(!entry || (entry->precode != recompiled_insns[x].entry.precode) || (entry->opcode != recompiled_insns[x].entry.opcode) ||
+		   memcmp(entry->operand, recompiled_insns[x].entry.operand, sizeof(entry->operand))) {
+			printf("\n*** Recompiled ROM doesn't match memory @ pc=%08x, not used\n", pc);
+			m->recompiled_state = RECOMPILED_MISMATCH;
+			return;
 		}
-		register_pc = dword_address;
-
-		sprintf((char *)print_buffer, "CALLF %08x : pc=%08x\n", dword_address, register_pc);
-
-		inc_sim_time(10);
-		executed_call_instruction = 1;
-		break;
+		m->caches->recompiled_code[(pc >> 20) & 1][(pc & 0x0000ffff) - ROM_START] = 1;
+	}
+	m->recompiled_state = RECOMPILED_OK;
+}
 
-	case RET:
-		// protection for stack underflow
-/*		if(register_sp >= 0x1000) {
-			sprintf((char *)print_buffer, "*** STACK UNDERFLOW @ %08x\n", register_pc);
-			running = 0;
-		} else {
-*/
-			dest = get_data_memory_byte(++register_sp) << 8;	// get return address from stack
-			dest |= get_data_memory_byte(++register_sp);
+//
+// a byte at address changed, check everything again if recompiled code depends on it
+//
+void invalidate_recompiled_address(struct machine *m, unsigned int address)
+{
+	unsigned int offset, x;
 
-			sprintf((char *)print_buffer, "RET (%04x)\n", dest);
+	if(m->recompiled_state != RECOMPILED_OK) {
+		return;
+	}
 
-		if(((dest & 0x0000ffff) >= XIO_START) && ((dest & 0x0000ffff) <= XIO_END)) {
-			sprintf((char *)print_buffer, "\n*** FETCHING FROM IO REGION: pc=%08x, address=%08x previous_pc=%08x\n", register_pc, dest, previous_register_pc);
-			simulator_output();
-			running = 0;
-			aabnormal_termination = 1;
-			return(0);
-		}
+	offset = address & 0x0000ffff;
 
-		if(((dest & 0x0000ffff) >= IO_START) && ((dest & 0x0000ffff) <= IO_END)) {
-			sprintf((char *)print_buffer, "\n*** FETCHING FROM IO REGION: pc=%08x, address=%08x previous_pc=%08x\n", register_pc, dest, previous_register_pc);
-			simulator_output();
-			aabnormal_termination = 1;
-			running = 0;
-			return(0);
+	for(x = 0; x != DECODE_WINDOW; x++) {
+		if((offset >= (ROM_START + x)) && ((offset - x) <= DECODE_CACHE_END)) {
+			if(m->caches->recompiled_code[0][offset - x - ROM_START] | m->caches->recompiled_code[1][offset - x - ROM_START]) {
+				m->recompiled_state = RECOMPILED_UNCHECKED;
+				return;
+			}
 		}
+	}
+}
 
-		if(((dest & 0x0000ffff) >= RAM_START) && ((dest & 0x0000ffff) <= RAM_END)) {
-			sprintf((char *)print_buffer, "\n*** FETCHING FROM RAM REGION: pc=%08x, address=%08x previous_pc=%08x\n", register_pc, dest, previous_register_pc);
-			simulator_output();
-			aabnormal_termination = 1;
-			running = 0;
-			return(0);
-		}
-		register_pc &= 0xffff0000;
-		register_pc |= dest;
-//		}
-		executed_return_instruction = 1;
-		inc_sim_time(6);
-		break;
+//
+// instructions in the recompiled ROM, 0 if there is none
+//
+unsigned int recompiled_rom_size(void)
+{
+	return(RECOMPILED_INSNS);
+}
 
-	case RETF:
-		// protection for stack underflow
-/*		if(register_sp >= 0x1000) {
-			sprintf((char *)print_buffer, "*** STACK UNDERFLOW @ %08x\n", register_pc);
-			running = 0;
-		} else {
-*/
-			dword_address = get_data_memory_byte(++register_sp) << 16;	// save returnj address on stack (long format)
-			dword_address |= get_data_memory_byte(++register_sp) << 8;
-			dword_address |= get_data_memory_byte(++register_sp);
+//
+// Execute up to budget instructions of recompiled code
+//
+// same rules as execute_blocks(), falls back to it when the recompiled ROM
+// doesn't match memory and a block at a time for code it doesn't cover
+//
+unsigned int execute_recompiled(struct machine *m, unsigned int budget)
+{
+	if(m->recompiled_state == RECOMPILED_UNCHECKED) {
+		check_recompiled(m);
+	}
+	if(m->recompiled_state != RECOMPILED_OK) {
+		return(execute_blocks(m, budget));
+	}
 
-			sprintf((char *)print_buffer, "RETF (%08x)\n", dword_address);
+	m->recompiled_budget = budget;
+	m->recompiled_executed = 0;
+	m->aabnormal_termination = 0;
 
-		if(((dword_address & 0x0000ffff) >= XIO_START) && ((dword_address & 0x0000ffff) <= XIO_END)) {
-			sprintf((char *)print_buffer, "\n*** FETCHING FROM IO REGION: pc=%08x, address=%08x previous_pc=%08x\n", register_pc, dword_address, previous_register_pc);
-			simulator_output();
-			running = 0;
-			aabnormal_termination = 1;
-			return(0);
+	while(1) {
+		if(!recompiled_dispatch(m)) {
+			m->recompiled_executed += execute_block(m, budget - m->recompiled_executed);
 		}
 
-		if(((dword_address & 0x0000ffff) >= IO_START) && ((dword_address & 0x0000ffff) <= IO_END)) {
-			sprintf((char *)print_buffer, "\n*** FETCHING FROM IO REGION: pc=%08x, address=%08x previous_pc=%08x\n", register_pc, dword_address, previous_register_pc);
-			simulator_output();
-			aabnormal_termination = 1;
-			running = 0;
-			return(0);
+		if(!m->running || (m->data_breakpoint_triggered_number != -1) || (m->recompiled_executed == budget) || (m->recompiled_state != RECOMPILED_OK)) {
+			break;
 		}
-
-		if(((dword_address & 0x0000ffff) >= RAM_START) && ((dword_address & 0x0000ffff) <= RAM_END)) {
-			sprintf((char *)print_buffer, "\n*** FETCHING FROM RAM REGION: pc=%08x, address=%08x previous_pc=%08x\n", register_pc, dword_address, previous_register_pc);
-			simulator_output();
-			aabnormal_termination = 1;
-			running = 0;
-			return(0);
+		if(block_split(m, m->register_pc) || (m->register_pc == m->in_function_call_pc)) {
+			break;
 		}
+	}
+	return(m->recompiled_executed);
+}
 
-		register_pc = dword_address;
-//		}
-		inc_sim_time(8);
-		executed_return_instruction = 1;
-		break;
-
-	case TRAP:	// this is st7 style
-		register_pc++;
-
-		prog_memory[register_sp--] = (unsigned char)(register_pc & 0xff);	// save registers to stack
-		prog_memory[register_sp--] = (unsigned char)((register_pc >> 8) & 0xff);
-		prog_memory[register_sp--] = register_x;
-		prog_memory[register_sp--] = register_a;
-		prog_memory[register_sp--] = register_cc;
-
-		register_cc |= (INTERRUPT_MASK_L0_BIT|INTERRUPT_MASK_L1_BIT);
+#else
 
-		dest = get_data_memory_byte(SWI) << 8;
-		dest |= get_data_memory_byte(SWI+1);
-		register_pc = dest;
-		sprintf((char *)print_buffer, "TRAP %04x\n", dest);
-		
-		inc_sim_time(10);
-		break;
+void invalidate_recompiled_address(struct machine *m, unsigned int address)
+{
+}
 
-	case IRET:
-		register_cc = get_data_memory_byte(++register_sp);	// restore registers from stack
-		register_a = get_data_memory_byte(++register_sp);
-		register_x = get_data_memory_byte(++register_sp);
+unsigned int recompiled_rom_size(void)
+{
+	return(0);
+}
 
-		dest = get_data_memory_byte(++register_sp) << 8;
-		dest |= get_data_memory_byte(++register_sp);
+unsigned int execute_recompiled(struct machine *m, unsigned int budget)
+{
+	return(execute_blocks(m, budget));
+}
 
-		sprintf((char *)print_buffer, "IRET (%04x)\n", dest);
-		
+#endif
 
-		register_pc = dest;
-		inc_sim_time(9);
-		break;
+//
+// per machine decode, block and recompiled code bookkeeping
+// returns NULL if there isn't enough memory
+//
+struct processor_caches *alloc_processor_caches(void)
+{
+	return((struct processor_caches *)calloc(1, sizeof(struct processor_caches)));
+}
 
-	case WFI:	// we do what we can here
-		sprintf((char *)print_buffer, "WFI\n");
-		
-		register_cc &= ~(INTERRUPT_MASK_L0_BIT|INTERRUPT_MASK_L1_BIT);
-		inc_sim_time(2);
-		running = 0;
-//		while(1)
-//			;
-		break;
+void free_processor_caches(struct processor_caches *caches)
+{
+	free(caches);
+}
 
-	// Unknown instruction
-	default:
-		sprintf((char *)print_buffer, "*** Unknown instruction (%02x) @ pc=%08x\n", instruction, register_pc);
-		simulator_output();
-		aabnormal_termination = 1;
-		running = 0;
-		break;
-	}
+//
+// 1 if dst and src have the same pages where code can be, the rom in page 00 and
+// page 10 and the flash, code in the flash range comes out of the flash memory
+// (see get_instruction_bytes())
+//
+int same_code_pages(struct machine *dst, struct machine *src)
+{
+	unsigned int page;
 
-	// rely on the individual handlers to clear so we can detect unhandled precodes
-	if(precode_72) {
-		sprintf((char *)print_buffer, "*** Unhandled precode_72 @ pc=%08x\n", register_pc);
-		simulator_output();
-		aabnormal_termination = 1;
-		running = 0;
-	}
-	if(precode_90) {
-		sprintf((char *)print_buffer, "*** Unhandled precode_90 @ pc=%08x\n", register_pc);
-		simulator_output();
-		aabnormal_termination = 1;
-		running = 0;
-	}
-	if(precode_91) {
-		sprintf((char *)print_buffer, "*** Unhandled precode_91 @ pc=%08x\n", register_pc);
-		simulator_output();
-		aabnormal_termination = 1;
-		running = 0;
+	for(page = ROM_START >> MEMORY_PAGE_SHIFT; page != MEMORY_PAGES; page++) {
+		if((dst->prog_memory[page] != src->prog_memory[page]) || (dst->prog2_memory[page] != src->prog2_memory[page])) {
+			return(0);
+		}
 	}
-	if(precode_92) {
-		sprintf((char *)print_buffer, "*** Unhandled precode_92 @ pc=%08x\n", register_pc);
-		simulator_output();
-		aabnormal_termination = 1;
-		running = 0;
+	for(page = FLASH_START >> MEMORY_PAGE_SHIFT; page <= (FLASH_END >> MEMORY_PAGE_SHIFT); page++) {
+		if(dst->flash_memory[page] != src->flash_memory[page]) {
+			return(0);
+		}
 	}
+	return(1);
+}
 
-	// produce output
-	simulator_output();
+//
+// dst is about to become a fork of src (fork_machine), keep what it has cached if it still holds
+//
+// the decode, block and recompiled caches only depend on the code, which lives in
+// pages nobody writes, so forks of the same base keep theirs from one fork to the next
+//
+void fork_processor_caches(struct machine *dst, struct machine *src)
+{
+	if(!same_code_pages(dst, src)) {
+		invalidate_decode_cache(dst);
+	}
 
-	// tell caller to stop
-	return(0);
+	set_block_splits(dst, src->block_splits, src->num_block_splits);
 }
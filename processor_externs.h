@@ -10,36 +10,24 @@
 //-----------------------------------------------------------------------------
 
 
-// Processor memory
-extern unsigned char prog_memory[MEMSIZE];		// Page 00
-extern unsigned char prog2_memory[MEMSIZE];	// Page 10
-extern unsigned char flash_memory[MEMSIZE];	// Flash memory
-
-// Processor registers
-extern unsigned char register_a;
-extern unsigned char register_x;
-extern unsigned char register_y;
-extern unsigned int register_pc;
-extern unsigned short register_sp;
-extern unsigned char register_cc;
-extern unsigned int previous_register_pc;
-extern unsigned int previous_register_sp;
-
-// for function call deliniation
-extern int executed_call_instruction;
-extern int executed_return_instruction;
-
-extern unsigned int aabnormal_termination;
-
 //
 //--------------------------------------------------------
 // Function prototypes
 //--------------------------------------------------------
 //
 
-void display_scoreboard(void);
-void clear_scoreboard(void);
+void invalidate_decode_cache(struct machine *m);
+void invalidate_decode_cache_address(struct machine *m, unsigned int address);
+
+void flush_blocks(struct machine *m);
+void set_block_splits(struct machine *m, unsigned int *addresses, int count);
+void update_block_split_map(struct machine *m);
+unsigned int execute_blocks(struct machine *m, unsigned int budget);
+
+int describe_instruction(struct machine *m, unsigned int address, struct insn_description *insn);
+unsigned int recompiled_rom_size(void);
+unsigned int execute_recompiled(struct machine *m, unsigned int budget);
 
-void reset_processor(void);
+void reset_processor(struct machine *m);
 
-int execute(void);
\ No newline at end of file
+void execute(struct machine *m);
\ No newline at end of file
@@ -0,0 +1,362 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - flat profiler
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+// History:
+//
+//----------------------------------------------------------------------------
+//
+
+//
+// The profiler charges the cycles of every instruction to its pc, in
+// inc_sim_time(), as two adds to a counter array that covers page 00 and page
+// 10 (see profile.h). When it is off the counter array is a single counter in
+// the machine that nobody looks at, so the add is still there but the run
+// loops have no test for it, and it is cheap enough to leave on for batch
+// runs. Batch workers profile into their own and it is added to the base
+// machine when the batch is done.
+//
+// A symbol file names address ranges, a line per symbol, addresses in hex,
+// # starts a comment:
+//
+//	<address> <name>			runs up to the next symbol
+//	<address>-<last> <name>		just that range
+//
+// There is one set of symbols for all machines.
+//
+
+#include "stdafx.h"
+#include <stdio.h>
+#include <memory.h>
+#include <string.h>
+#include <stdlib.h>
+#include <windows.h>
+
+#include "st7xcpu.h"
+
+#include "machine.h"
+
+#include "profile.h"
+
+#define MAX_PROFILE_SYMBOLS		4096
+#define MAX_PROFILE_SYMBOL_NAME	48
+
+struct profile_symbol {
+	unsigned int address;
+	unsigned int last;
+	char name[MAX_PROFILE_SYMBOL_NAME];
+};
+
+struct profile_symbol profile_symbols[MAX_PROFILE_SYMBOLS];
+int num_profile_symbols;
+
+// the counters, and the symbol totals, sorted for display
+struct profile_line {
+	unsigned long long cycles;
+	unsigned long long executions;
+	unsigned int address;
+	int symbol;
+};
+
+//
+// start counting, from nothing
+// returns 0 if there isn't enough memory
+//
+int start_profile(struct machine *m)
+{
+	struct profile_counter *profile;
+
+	if(m->profile_mask) {
+		clear_profile(m);
+		return(1);
+	}
+
+	profile = (struct profile_counter *)calloc(PROFILE_ENTRIES, sizeof(struct profile_counter));
+	if(profile == NULL) {
+		return(0);
+	}
+	m->profile = profile;
+	m->profile_mask = PROFILE_INDEX_MASK;
+	return(1);
+}
+
+//
+// stop counting, back to the sink
+//
+void stop_profile(struct machine *m)
+{
+	if(m->profile_mask) {
+		free(m->profile);
+	}
+	m->profile = &m->profile_sink;
+	m->profile_mask = 0;
+}
+
+void clear_profile(struct machine *m)
+{
+	memset(m->profile, 0, (m->profile_mask + 1) * sizeof(struct profile_counter));
+}
+
+//
+// add what src counted to dst (a batch worker to the base)
+//
+void add_profile(struct machine *dst, struct machine *src)
+{
+	unsigned int x;
+
+	if(!dst->profile_mask || !src->profile_mask) {
+		return;
+	}
+
+	for(x = 0; x != PROFILE_ENTRIES; x++) {
+		dst->profile[x].executions += src->profile[x].executions;
+		dst->profile[x].cycles += src->profile[x].cycles;
+	}
+}
+
+int compare_profile_symbols(const void *a, const void *b)
+{
+	unsigned int address_a, address_b;
+
+	address_a = ((const struct profile_symbol *)a)->address;
+	address_b = ((const struct profile_symbol *)b)->address;
+	return((address_a > address_b) - (address_a < address_b));
+}
+
+//
+// load a symbol file, the symbols there were are gone
+// returns the number of symbols, -1 if the file couldn't be read
+//
+int load_profile_symbols(char *filename)
+{
+	char line[128], name[MAX_PROFILE_SYMBOL_NAME];
+	FILE *fp;
+	struct profile_symbol *symbol;
+	unsigned int address, last;
+	int x, fields;
+
+	fp = fopen(filename, "r");
+	if(fp == NULL) {
+		printf("Can't open %s!\n", filename);
+		return(-1);
+	}
+
+	num_profile_symbols = 0;
+
+	while(fgets(line, sizeof(line), fp) != NULL) {
+		if((line[strspn(line, " \t")] == '#') || (line[strspn(line, " \t\r\n")] == '\0')) {
+			continue;
+		}
+
+		fields = sscanf(line, "%x-%x %47s", &address, &last, name);
+		if(fields != 3) {
+			last = 0xffffffff;
+			fields = sscanf(line, "%x %47s", &address, name) + 1;
+		}
+		if((fields != 3) || (last < address)) {
+			printf("Bad symbol line: %s", line);
+			continue;
+		}
+		if(num_profile_symbols == MAX_PROFILE_SYMBOLS) {
+			printf("*** Too many symbols, only the first %d are used\n", MAX_PROFILE_SYMBOLS);
+			break;
+		}
+
+		symbol = &profile_symbols[num_profile_symbols++];
+		symbol->address = address;
+		symbol->last = last;
+		strcpy(symbol->name, name);
+	}
+	fclose(fp);
+
+	qsort(profile_symbols, num_profile_symbols, sizeof(struct profile_symbol), compare_profile_symbols);
+
+	// the open ended ones run up to the next one
+	for(x = 0; x != num_profile_symbols; x++) {
+		if(profile_symbols[x].last == 0xffffffff) {
+			if((x + 1 != num_profile_symbols) && (profile_symbols[x + 1].address > profile_symbols[x].address)) {
+				profile_symbols[x].last = profile_symbols[x + 1].address - 1;
+			} else {
+				profile_symbols[x].last = profile_symbols[x].address | 0x0000ffff;
+			}
+		}
+	}
+	return(num_profile_symbols);
+}
+
+//
+// the symbol address is in, -1 for none
+//
+int find_profile_symbol(unsigned int address)
+{
+	int low, high, middle;
+
+	// the last one that starts at or before address
+	low = 0;
+	high = num_profile_symbols;
+	while(low != high) {
+		middle = (low + high) / 2;
+		if(profile_symbols[middle].address <= address) {
+			low = middle + 1;
+		} else {
+			high = middle;
+		}
+	}
+
+	if(low && (address <= profile_symbols[low - 1].last)) {
+		return(low - 1);
+	}
+	return(-1);
+}
+
+//
+// name of address from the symbols, symbol+offset inside one, the address
+// when there isn't one, name has room for PROFILE_NAME_SIZE
+//
+void profile_address_name(unsigned int address, char *name)
+{
+	int symbol;
+
+	symbol = find_profile_symbol(address);
+	if(symbol == -1) {
+		sprintf(name, "%08x", address);
+	} else if(address == profile_symbols[symbol].address) {
+		strcpy(name, profile_symbols[symbol].name);
+	} else {
+		sprintf(name, "%s+%x", profile_symbols[symbol].name, address - profile_symbols[symbol].address);
+	}
+}
+
+//
+// most cycles first, the lower address first when they are the same
+//
+int compare_profile_lines(const void *a, const void *b)
+{
+	const struct profile_line *line_a, *line_b;
+
+	line_a = (const struct profile_line *)a;
+	line_b = (const struct profile_line *)b;
+	if(line_a->cycles != line_b->cycles) {
+		return((line_a->cycles < line_b->cycles) ? 1 : -1);
+	}
+	return((line_a->address > line_b->address) - (line_a->address < line_b->address));
+}
+
+//
+// the flat profile to fp, the symbols and then the top lines addresses, by cycles
+//
+void write_profile(struct machine *m, FILE *fp, int lines)
+{
+	struct profile_line *profile_lines, *symbol_lines, *line;
+	unsigned long long total_cycles, total_executions;
+	unsigned int x;
+	int count, num_symbol_lines, symbol;
+
+	profile_lines = (struct profile_line *)malloc(PROFILE_ENTRIES * sizeof(struct profile_line));
+	symbol_lines = (struct profile_line *)calloc(num_profile_symbols + 1, sizeof(struct profile_line));
+	if((profile_lines == NULL) || (symbol_lines == NULL)) {
+		printf("Not enough memory for the profile\n");
+		free(profile_lines);
+		free(symbol_lines);
+		return;
+	}
+
+	total_cycles = 0;
+	total_executions = 0;
+	count = 0;
+
+	for(x = 0; x != PROFILE_ENTRIES; x++) {
+		if(!m->profile[x].executions && !m->profile[x].cycles) {
+			continue;
+		}
+		line = &profile_lines[count++];
+		line->cycles = m->profile[x].cycles;
+		line->executions = m->profile[x].executions;
+		line->address = PROFILE_ADDRESS(x);
+		line->symbol = find_profile_symbol(line->address);
+
+		total_cycles += line->cycles;
+		total_executions += line->executions;
+
+		// what isn't in a symbol goes in the last one
+		symbol = (line->symbol != -1) ? line->symbol : num_profile_symbols;
+		symbol_lines[symbol].cycles += line->cycles;
+		symbol_lines[symbol].executions += line->executions;
+		symbol_lines[symbol].symbol = line->symbol;
+	}
+
+	fprintf(fp, "Flat profile: %llu cycles, %llu instructions at %d addresses\n", total_cycles, total_executions, count);
+	if(!total_cycles) {
+		total_cycles = 1;
+	}
+
+	if(num_profile_symbols) {
+		num_symbol_lines = num_profile_symbols + 1;
+		qsort(symbol_lines, num_symbol_lines, sizeof(struct profile_line), compare_profile_lines);
+
+		fprintf(fp, "\n      cycles   executions       %%  symbol\n");
+		for(symbol = 0; (symbol != num_symbol_lines) && symbol_lines[symbol].cycles; symbol++) {
+			line = &symbol_lines[symbol];
+			fprintf(fp, "%12llu %12llu %6.2f%%  %s\n", line->cycles, line->executions, (line->cycles * 100.0) / total_cycles,
+				(line->symbol != -1) ? profile_symbols[line->symbol].name : "(no symbol)");
+		}
+	}
+
+	qsort(profile_lines, count, sizeof(struct profile_line), compare_profile_lines);
+	if(count > lines) {
+		count = lines;
+	}
+
+	fprintf(fp, "\n      cycles   executions       %%  address   symbol\n");
+	for(x = 0; x != (unsigned int)count; x++) {
+		line = &profile_lines[x];
+		fprintf(fp, "%12llu %12llu %6.2f%%  %08x", line->cycles, line->executions, (line->cycles * 100.0) / total_cycles, line->address);
+		if(line->symbol != -1) {
+			fprintf(fp, "  %s+%x", profile_symbols[line->symbol].name, line->address - profile_symbols[line->symbol].address);
+		}
+		fprintf(fp, "\n");
+	}
+
+	free(profile_lines);
+	free(symbol_lines);
+}
+
+//
+// the top lines of the profile to the console
+//
+void display_profile(struct machine *m, int lines)
+{
+	if(!m->profile_mask) {
+		printf("Profile not active.\n");
+		return;
+	}
+	write_profile(m, stdout, lines);
+}
+
+//
+// all of the profile to a file
+// returns 0 if it couldn't
+//
+int save_profile(struct machine *m, char *filename)
+{
+	FILE *fp;
+
+	if(!m->profile_mask) {
+		printf("Profile not active.\n");
+		return(0);
+	}
+
+	fp = fopen(filename, "w");
+	if(fp == NULL) {
+		printf("Can't open %s!\n", filename);
+		return(0);
+	}
+	write_profile(m, fp, PROFILE_ENTRIES);
+	fclose(fp);
+	return(1);
+}
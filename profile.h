@@ -0,0 +1,39 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - flat profiler header
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+//----------------------------------------------------------------------------
+//
+
+//
+// A counter for every address of page 00 and page 10, same layout as the
+// instruction breakpoint map. A counter has how many times the address ran
+// and the cycles charged to it, 64 bits each so neither wraps or spills into
+// the other however long the runs and however many workers are added up.
+//
+#define PROFILE_INDEX(address)		((((address) >> 4) & 0x00010000) | ((address) & 0x0000ffff))
+#define PROFILE_ENTRIES				0x00020000
+#define PROFILE_INDEX_MASK			(PROFILE_ENTRIES - 1)
+
+// address of a counter
+#define PROFILE_ADDRESS(index)		((((index) & 0x00010000) << 4) | ((index) & 0x0000ffff))
+
+// room profile_address_name() needs, a symbol name and +ffffffff
+#define PROFILE_NAME_SIZE			64
+
+// lines display_profile() shows when nobody says otherwise
+#define PROFILE_LINES				40
+
+int start_profile(struct machine *m);
+void stop_profile(struct machine *m);
+void clear_profile(struct machine *m);
+void add_profile(struct machine *dst, struct machine *src);
+int load_profile_symbols(char *filename);
+void profile_address_name(unsigned int address, char *name);
+void display_profile(struct machine *m, int lines);
+int save_profile(struct machine *m, char *filename);
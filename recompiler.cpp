@@ -0,0 +1,461 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - ROM recompiler
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+// History:
+//
+//----------------------------------------------------------------------------
+//
+
+//
+// Walks the firmware in memory from the reset pc and every call target it can
+// work out and writes what it found as C++, one function per routine, for
+// processor.cpp to include (see execute_recompiled()).
+//
+// Only direct jumps and calls are followed, anything indirect is left to the
+// interpreter. The generated code checks the pc after every instruction so a
+// wrong guess here just means going back to the dispatcher, never running the
+// wrong code.
+//
+
+#include "stdafx.h"
+#include <stdio.h>
+#include <memory.h>
+#include <string.h>
+#include <stdlib.h>
+
+#include "st7xcpu.h"
+
+#include "processor_externs.h"
+
+#include "disasm.h"
+
+#include "application.h"
+#include "hooks.h"
+#include "recompiler.h"
+
+#define MAX_RECOMPILED_ROUTINES		4096
+#define MAX_RECOMPILED_INSNS		65536
+
+// long routines are cut up, compilers choke on huge functions full of gotos
+#define MAX_FUNCTION_INSNS			256
+
+// bytes a decode depends on, nothing near the flash is recompiled
+#define RECOMPILER_WINDOW			6
+
+struct recompiler_insn {
+	unsigned int pc;
+	int routine;
+	int function;				// index of the first instruction of its function
+	struct insn_description insn;
+};
+
+struct recompiler_insn recompiled[MAX_RECOMPILED_INSNS];
+int num_recompiled;
+
+// entry pc of each routine
+unsigned int routines[MAX_RECOMPILED_ROUTINES];
+int num_routines;
+
+// recompiled index + 1 of the instruction at each pc, [0] is page 00, [1] is page 10
+int recompiled_at[2][0x10000];
+
+// pcs still to look at in the routine being walked
+unsigned int recompiler_work[MAX_RECOMPILED_INSNS];
+int num_recompiler_work;
+
+// indirect jumps and calls, left to the interpreter
+int recompiler_unresolved;
+
+const char *space_names[NUM_OPCODE_SPACES] = { "SPACE_PRIMARY", "SPACE_90", "SPACE_91", "SPACE_92", "SPACE_72" };
+const char *precode_names[NUM_OPCODE_SPACES] = { "0", "PRECODE_90", "PRECODE_91", "PRECODE_92", "PRECODE_72" };
+
+//
+// recompiled instruction at pc, NULL if there isn't one
+//
+struct recompiler_insn *recompiler_insn_at(unsigned int pc)
+{
+	int x;
+
+	if(pc & 0xffef0000) {
+		return(NULL);
+	}
+	x = recompiled_at[(pc >> 20) & 1][pc & 0x0000ffff];
+	if(!x) {
+		return(NULL);
+	}
+	return(&recompiled[x - 1]);
+}
+
+//
+// start a new routine at pc unless there already is one
+//
+void add_routine(unsigned int pc)
+{
+	int x;
+
+	for(x = 0; x != num_routines; x++) {
+		if(routines[x] == pc) {
+			return;
+		}
+	}
+
+	if(num_routines == MAX_RECOMPILED_ROUTINES) {
+		printf("*** Too many routines, %08x not recompiled\n", pc);
+		return;
+	}
+	routines[num_routines++] = pc;
+}
+
+//
+// where a jump or call goes, returns 0 if that depends on registers or memory
+//
+int flow_target(unsigned int pc, struct insn_description *insn, unsigned int *target)
+{
+	unsigned int next;
+
+	next = pc + insn->length;
+
+	// 72 BTJx, long address then the displacement
+	if(insn->space == SPACE_72) {
+		if(insn->opcode <= BTJF_7) {
+			*target = next + (signed char)insn->operand[2];
+			return(1);
+		}
+		return(0);
+	}
+
+	// every other precoded form is indirect or indexed
+	if(insn->space != SPACE_PRIMARY) {
+		return(0);
+	}
+
+	if(insn->opcode <= BTJF_7) {
+		*target = next + (signed char)insn->operand[1];
+		return(1);
+	}
+
+	// JRxx are 0x20 - 0x2f
+	if(((insn->opcode & 0xf0) == JRA) || (insn->opcode == CALLR_SHORT)) {
+		*target = next + (signed char)insn->operand[0];
+		return(1);
+	}
+
+	switch(insn->opcode) {
+	case JP_LONG:
+	case CALL_LONG:
+		*target = (pc & 0xffff0000) | (insn->operand[0] << 8) | insn->operand[1];
+		return(1);
+
+	case JP_FAR:
+	case CALL_FAR:
+		*target = (insn->operand[0] << 16) | (insn->operand[1] << 8) | insn->operand[2];
+		return(1);
+	}
+	return(0);
+}
+
+//
+// does a jump always go somewhere else
+//
+int unconditional_jump(struct insn_description *insn)
+{
+	switch(insn->opcode) {
+	case JRA:
+	case JP_FAR:
+	case JP_LONG:
+	case JP_REG_IND:
+	case JP_REG_IND_OFF_SHORT:
+	case JP_REG_IND_OFF_LONG:
+		return(insn->space != SPACE_72);
+	}
+	return(0);
+}
+
+//
+// can this pc be recompiled
+//
+int recompilable(struct machine *m, unsigned int pc, struct insn_description *insn)
+{
+	unsigned int offset;
+
+	if(!describe_instruction(m, pc, insn)) {
+		return(0);
+	}
+
+	// flash gets written at run time
+	offset = pc & 0x0000ffff;
+	if(((offset + RECOMPILER_WINDOW) > FLASH_START) && (offset <= FLASH_END)) {
+		return(0);
+	}
+	return(1);
+}
+
+//
+// follow everything reachable from a routine entry that nobody has claimed yet
+//
+void walk_routine(struct machine *m, int routine)
+{
+	struct insn_description insn;
+	struct recompiler_insn *r;
+	unsigned int pc, next, target;
+	int has_target;
+
+	num_recompiler_work = 0;
+	recompiler_work[num_recompiler_work++] = routines[routine];
+
+	while(num_recompiler_work) {
+		pc = recompiler_work[--num_recompiler_work];
+
+		if(recompiler_insn_at(pc) || !recompilable(m, pc, &insn)) {
+			continue;
+		}
+
+		if(num_recompiled == MAX_RECOMPILED_INSNS) {
+			printf("*** Too many instructions, %08x not recompiled\n", pc);
+			continue;
+		}
+
+		r = &recompiled[num_recompiled++];
+		r->pc = pc;
+		r->routine = routine;
+		r->insn = insn;
+		recompiled_at[(pc >> 20) & 1][pc & 0x0000ffff] = num_recompiled;
+
+		next = pc + insn.length;
+
+		if(!(insn.flags & INSN_FLOW)) {
+			recompiler_work[num_recompiler_work++] = next;
+			continue;
+		}
+
+		has_target = 0;
+		if(insn.flags & (INSN_JUMP|INSN_CALL)) {
+			has_target = flow_target(pc, &insn, &target);
+			if(!has_target && (insn.opcode != TRAP)) {
+				recompiler_unresolved++;
+			}
+		}
+
+		if(insn.flags & INSN_CALL) {
+			if(has_target) {
+				add_routine(target);
+			}
+			// where it comes back to
+			recompiler_work[num_recompiler_work++] = next;
+		} else if(insn.flags & INSN_JUMP) {
+			if(has_target) {
+				recompiler_work[num_recompiler_work++] = target;
+			}
+			if(!unconditional_jump(&insn)) {
+				recompiler_work[num_recompiler_work++] = next;
+			}
+		}
+
+		// room for the next one
+		if(num_recompiler_work > (MAX_RECOMPILED_INSNS - 2)) {
+			printf("*** Recompiler work list full\n");
+			return;
+		}
+	}
+}
+
+//
+// order by routine then pc
+//
+int compare_recompiled(const void *a, const void *b)
+{
+	const struct recompiler_insn *ra = (const struct recompiler_insn *)a;
+	const struct recompiler_insn *rb = (const struct recompiler_insn *)b;
+
+	if(ra->routine != rb->routine) {
+		return((ra->routine < rb->routine) ? -1 : 1);
+	}
+	if(ra->pc != rb->pc) {
+		return((ra->pc < rb->pc) ? -1 : 1);
+	}
+	return(0);
+}
+
+//
+// write a goto for pc if it's in the same function, returns 1 if it did
+//
+int write_goto(FILE *fp, struct recompiler_insn *from, unsigned int pc, int conditional)
+{
+	struct recompiler_insn *to;
+
+	to = recompiler_insn_at(pc);
+	if(!to || (to->function != from->function)) {
+		return(0);
+	}
+
+	if(conditional) {
+		fprintf(fp, "\tif(m->register_pc == 0x%08x) goto L%08x;\n", pc, pc);
+	} else {
+		fprintf(fp, "\tgoto L%08x;\n", pc);
+	}
+	return(1);
+}
+
+//
+// one function per routine (or piece of one), a label per instruction
+//
+void write_routine(FILE *fp, int first, int count)
+{
+	struct recompiler_insn *r;
+	unsigned int next, target;
+	int x;
+
+	fprintf(fp, "\n//\n// routine %08x, %d instructions\n//\n", routines[recompiled[first].routine], count);
+	fprintf(fp, "void rc_%08x(struct machine *m)\n{\n", recompiled[first].pc);
+
+	fprintf(fp, "\tswitch(m->register_pc) {\n");
+	for(x = first; x != (first + count); x++) {
+		fprintf(fp, "\tcase 0x%08x: goto L%08x;\n", recompiled[x].pc, recompiled[x].pc);
+	}
+	fprintf(fp, "\t}\n\treturn;\n");
+
+	for(x = first; x != (first + count); x++) {
+		r = &recompiled[x];
+		next = r->pc + r->insn.length;
+
+		fprintf(fp, "\nL%08x:\n", r->pc);
+
+		if(!(r->insn.flags & INSN_FLOW)) {
+			fprintf(fp, "\tRC_INSN(0x%08x, %s, 0x%02x, op_%s<%s>, 0x%08x);\n", r->pc, space_names[r->insn.space], r->insn.opcode, r->insn.name, precode_names[r->insn.space], next);
+
+			// falls into the next label or jumps to it
+			if(((x + 1) != (first + count)) && (recompiled[x + 1].pc == next)) {
+				continue;
+			}
+			if(!write_goto(fp, r, next, 0)) {
+				fprintf(fp, "\treturn;\n");
+			}
+			continue;
+		}
+
+		fprintf(fp, "\tRC_FLOW(0x%08x, %s, 0x%02x, op_%s<%s>);\n", r->pc, space_names[r->insn.space], r->insn.opcode, r->insn.name, precode_names[r->insn.space]);
+
+		if(flow_target(r->pc, &r->insn, &target)) {
+			write_goto(fp, r, target, 1);
+		}
+		if((r->insn.flags & INSN_JUMP) && !unconditional_jump(&r->insn)) {
+			write_goto(fp, r, next, 1);
+		}
+		fprintf(fp, "\treturn;\n");
+	}
+
+	fprintf(fp, "}\n");
+}
+
+//
+// Recompile the firmware in memory into filename
+// returns 0 if the file couldn't be written
+//
+int recompile_rom(struct machine *m, char *filename)
+{
+	struct insn_description *insn;
+	FILE *fp;
+	unsigned int hook;
+	int x, y, count, routine, hooks_added;
+
+	num_recompiled = 0;
+	num_routines = 0;
+	recompiler_unresolved = 0;
+	memset(recompiled_at, 0, sizeof(recompiled_at));
+
+	// the reset pc, where we are now and the pc hooks
+	add_routine(PC_INITIAL_VALUE);
+	add_routine(m->register_pc);
+
+	hooks_added = 0;
+
+	// calls found on the way add more routines as we go
+	for(routine = 0; routine != num_routines; routine++) {
+		walk_routine(m, routine);
+
+		// the hooks only start routines if nothing else got there
+		if(((routine + 1) == num_routines) && !hooks_added) {
+			for(hook = next_pc_hook(0); hook != NO_PC_HOOK; hook = next_pc_hook(hook + 1)) {
+				if(!recompiler_insn_at(hook)) {
+					add_routine(hook);
+				}
+			}
+			hooks_added = 1;
+		}
+	}
+
+	if(!num_recompiled) {
+		printf("*** Nothing to recompile\n");
+		return(0);
+	}
+
+	qsort(recompiled, num_recompiled, sizeof(recompiled[0]), compare_recompiled);
+
+	memset(recompiled_at, 0, sizeof(recompiled_at));
+	for(x = 0; x != num_recompiled; x++) {
+		recompiled_at[(recompiled[x].pc >> 20) & 1][recompiled[x].pc & 0x0000ffff] = x + 1;
+
+		if(!x || (recompiled[x].routine != recompiled[x - 1].routine) || ((x - recompiled[x - 1].function) == MAX_FUNCTION_INSNS)) {
+			recompiled[x].function = x;
+		} else {
+			recompiled[x].function = recompiled[x - 1].function;
+		}
+	}
+
+	fp = fopen(filename, "w");
+	if(fp == NULL) {
+		printf("*** Can't open %s\n", filename);
+		return(0);
+	}
+
+	fprintf(fp, "//\n// ST7x Simulator - recompiled ROM\n//\n");
+	fprintf(fp, "// Written by recompile_rom() from the firmware in memory, don't edit.\n");
+	fprintf(fp, "// processor.cpp includes this when built with RECOMPILED_ROM defined.\n");
+	fprintf(fp, "//\n// %d routines, %d instructions, %d indirect jumps and calls left to the interpreter\n//\n\n", num_routines, num_recompiled, recompiler_unresolved);
+
+	fprintf(fp, "#define RECOMPILED_INSNS\t%d\n\n", num_recompiled);
+
+	// what the decoder has to agree with
+	fprintf(fp, "const struct recompiled_insn recompiled_insns[RECOMPILED_INSNS] = {\n");
+	for(x = 0; x != num_recompiled; x++) {
+		insn = &recompiled[x].insn;
+		fprintf(fp, "\t{ 0x%08x, { 1, %s, 0x%02x, 0x%02x, { 0x%02x, 0x%02x, 0x%02x, 0x%02x } } },\n", recompiled[x].pc, space_names[insn->space],
+			insn->precode, insn->opcode, insn->operand[0], insn->operand[1], insn->operand[2], insn->operand[3]);
+	}
+	fprintf(fp, "};\n");
+
+	for(x = 0; x != num_recompiled; x += count) {
+		for(count = 1; ((x + count) != num_recompiled) && (recompiled[x + count].function == x); count++) {
+			;
+		}
+		write_routine(fp, x, count);
+	}
+
+	// pc to function
+	fprintf(fp, "\n//\n// run the code the pc is in, returns 0 if there isn't any\n//\n");
+	fprintf(fp, "int recompiled_dispatch(struct machine *m)\n{\n\tswitch(m->register_pc) {\n");
+	for(x = 0; x != num_recompiled; x += count) {
+		for(count = 0; ((x + count) != num_recompiled) && (recompiled[x + count].function == x); count++) {
+			fprintf(fp, "\tcase 0x%08x:\n", recompiled[x + count].pc);
+		}
+		fprintf(fp, "\t\trc_%08x(m);\n\t\treturn(1);\n", recompiled[x].pc);
+	}
+	fprintf(fp, "\t}\n\treturn(0);\n}\n");
+
+	fclose(fp);
+
+	y = 0;
+	for(x = 0; x != num_recompiled; x++) {
+		y += recompiled[x].insn.length;
+	}
+	printf("Recompiled %d routines, %d instructions (%d bytes) into %s, %d indirect jumps and calls left to the interpreter\n",
+		num_routines, num_recompiled, y, filename, recompiler_unresolved);
+
+	return(1);
+}
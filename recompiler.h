@@ -0,0 +1,16 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - ROM recompiler header
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+//----------------------------------------------------------------------------
+//
+
+// file processor.cpp includes when built with RECOMPILED_ROM defined
+#define RECOMPILED_ROM_FILENAME		"st7xrom.h"
+
+int recompile_rom(struct machine *m, char *filename);
@@ -0,0 +1,388 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - instruction scoreboard
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+// History:
+//
+//----------------------------------------------------------------------------
+//
+
+//
+// The scoreboard counts how many times every opcode of every opcode space
+// (the primary one and one per precode) was executed and the cycles it was
+// charged, wherever the instruction was run, execute(), a block or recompiled
+// code. Sorted by executions it says which handlers are worth making faster,
+// and the mix is a fingerprint of whatever ran since it was cleared, a tag
+// command for instance.
+//
+// Every machine counts into its own, a fork doesn't take over the counts of
+// the machine it came from. Batch workers are added to the base machine when
+// the batch is done, like the profile.
+//
+// A scoreboard can be written to a file and two of them compared, the
+// opcodes whose share of the instructions changed the most first. A file
+// has a line per opcode that ran, # starts a comment:
+//
+//	<precode> <opcode> <executions> <cycles> <handler>
+//
+// in hex and decimal, precode 00 for the primary space. SCOREBOARD_CURRENT
+// in place of a file name is the machine's own scoreboard.
+//
+
+#include "stdafx.h"
+#include <stdio.h>
+#include <memory.h>
+#include <string.h>
+#include <stdlib.h>
+#include <windows.h>
+
+#include "st7xcpu.h"
+
+#include "machine.h"
+
+#include "scoreboard.h"
+
+// handler names, built with the other opcode tables (see build_opcode_spaces())
+extern const char *opcode_names[NUM_OPCODE_SPACES][256];
+
+// precode of each opcode space, 0 for the primary one
+const unsigned char scoreboard_precodes[NUM_OPCODE_SPACES] = { 0, PRECODE_90, PRECODE_91, PRECODE_92, PRECODE_72 };
+
+// an opcode of a scoreboard, or of two being compared, sorted for display
+struct scoreboard_line {
+	unsigned long long executions;
+	unsigned long long cycles;
+	unsigned long long executions_b;
+	unsigned long long cycles_b;
+	double change;							// share of the instructions b has less what a has
+	unsigned int space;
+	unsigned int opcode;
+};
+
+//
+// Clear scoreboard
+//
+void clear_scoreboard(struct machine *m)
+{
+	memset(m->scoreboard, 0, SCOREBOARD_SIZE);
+}
+
+//
+// src's counts into dst's, for batch workers
+//
+void add_scoreboard(struct machine *dst, struct machine *src)
+{
+	unsigned int space, opcode;
+
+	for(space = 0; space != NUM_OPCODE_SPACES; space++) {
+		for(opcode = 0; opcode != 256; opcode++) {
+			dst->scoreboard[space][opcode].executions += src->scoreboard[space][opcode].executions;
+			dst->scoreboard[space][opcode].cycles += src->scoreboard[space][opcode].cycles;
+		}
+	}
+}
+
+//
+// name of the handler of an opcode
+//
+const char *scoreboard_name(unsigned int space, unsigned int opcode)
+{
+	return(opcode_names[space][opcode] ? opcode_names[space][opcode] : "?");
+}
+
+//
+// the precode and opcode as they are in memory, "   xx" without a precode
+//
+void scoreboard_opcode(unsigned int space, unsigned int opcode, char *text)
+{
+	if(space == SPACE_PRIMARY) {
+		sprintf(text, "   %02x", opcode);
+	} else {
+		sprintf(text, "%02x %02x", scoreboard_precodes[space], opcode);
+	}
+}
+
+int compare_scoreboard_executions(const void *a, const void *b)
+{
+	const struct scoreboard_line *line_a, *line_b;
+
+	line_a = (const struct scoreboard_line *)a;
+	line_b = (const struct scoreboard_line *)b;
+	if(line_a->executions != line_b->executions) {
+		return((line_a->executions < line_b->executions) ? 1 : -1);
+	}
+	if(line_a->space != line_b->space) {
+		return((line_a->space > line_b->space) ? 1 : -1);
+	}
+	return((line_a->opcode > line_b->opcode) - (line_a->opcode < line_b->opcode));
+}
+
+int compare_scoreboard_changes(const void *a, const void *b)
+{
+	const struct scoreboard_line *line_a, *line_b;
+	double change_a, change_b;
+
+	line_a = (const struct scoreboard_line *)a;
+	line_b = (const struct scoreboard_line *)b;
+	change_a = (line_a->change < 0) ? -line_a->change : line_a->change;
+	change_b = (line_b->change < 0) ? -line_b->change : line_b->change;
+	if(change_a != change_b) {
+		return((change_a < change_b) ? 1 : -1);
+	}
+	return(compare_scoreboard_executions(a, b));
+}
+
+//
+// the scoreboard to fp, by opcode space and then the top lines opcodes, most executed first
+//
+void write_scoreboard(struct machine *m, FILE *fp, int lines)
+{
+	struct scoreboard_line *scoreboard_lines, *line;
+	unsigned long long space_executions[NUM_OPCODE_SPACES], space_cycles[NUM_OPCODE_SPACES];
+	unsigned long long total_executions, total_cycles;
+	unsigned int space, opcode;
+	int x, count;
+	char text[8];
+
+	scoreboard_lines = (struct scoreboard_line *)malloc(NUM_OPCODE_SPACES * 256 * sizeof(struct scoreboard_line));
+	if(scoreboard_lines == NULL) {
+		printf("Not enough memory for the scoreboard\n");
+		return;
+	}
+
+	total_executions = 0;
+	total_cycles = 0;
+	count = 0;
+
+	for(space = 0; space != NUM_OPCODE_SPACES; space++) {
+		space_executions[space] = 0;
+		space_cycles[space] = 0;
+
+		for(opcode = 0; opcode != 256; opcode++) {
+			if(!m->scoreboard[space][opcode].executions) {
+				continue;
+			}
+			line = &scoreboard_lines[count++];
+			line->executions = m->scoreboard[space][opcode].executions;
+			line->cycles = m->scoreboard[space][opcode].cycles;
+			line->space = space;
+			line->opcode = opcode;
+
+			space_executions[space] += line->executions;
+			space_cycles[space] += line->cycles;
+		}
+		total_executions += space_executions[space];
+		total_cycles += space_cycles[space];
+	}
+
+	fprintf(fp, "Scoreboard: %llu instructions, %llu cycles, %d opcodes\n", total_executions, total_cycles, count);
+	if(!total_executions) {
+		free(scoreboard_lines);
+		return;
+	}
+	if(!total_cycles) {
+		total_cycles = 1;
+	}
+
+	fprintf(fp, "\nprecode   executions       %%       cycles       %%\n");
+	for(space = 0; space != NUM_OPCODE_SPACES; space++) {
+		if(space == SPACE_PRIMARY) {
+			fprintf(fp, "   none");
+		} else {
+			fprintf(fp, "     %02x", scoreboard_precodes[space]);
+		}
+		fprintf(fp, " %12llu %6.2f%% %12llu %6.2f%%\n", space_executions[space], (space_executions[space] * 100.0) / total_executions,
+			space_cycles[space], (space_cycles[space] * 100.0) / total_cycles);
+	}
+
+	qsort(scoreboard_lines, count, sizeof(struct scoreboard_line), compare_scoreboard_executions);
+	if(count > lines) {
+		count = lines;
+	}
+
+	fprintf(fp, "\n  executions       %%       cycles       %%  cycles/ins  opcode  handler\n");
+	for(x = 0; x != count; x++) {
+		line = &scoreboard_lines[x];
+		scoreboard_opcode(line->space, line->opcode, text);
+		fprintf(fp, "%12llu %6.2f%% %12llu %6.2f%% %11.2f   %s  %s\n", line->executions, (line->executions * 100.0) / total_executions,
+			line->cycles, (line->cycles * 100.0) / total_cycles, (double)line->cycles / line->executions, text, scoreboard_name(line->space, line->opcode));
+	}
+
+	free(scoreboard_lines);
+}
+
+//
+// the top lines of the scoreboard to the console
+//
+void display_scoreboard(struct machine *m, int lines)
+{
+	write_scoreboard(m, stdout, lines);
+}
+
+//
+// the scoreboard to a file compare_scoreboards() can read
+// returns 0 if it couldn't
+//
+int save_scoreboard(struct machine *m, char *filename)
+{
+	FILE *fp;
+	unsigned int space, opcode;
+
+	fp = fopen(filename, "w");
+	if(fp == NULL) {
+		printf("Can't open %s!\n", filename);
+		return(0);
+	}
+
+	fprintf(fp, "# precode opcode executions cycles handler\n");
+	for(space = 0; space != NUM_OPCODE_SPACES; space++) {
+		for(opcode = 0; opcode != 256; opcode++) {
+			if(m->scoreboard[space][opcode].executions) {
+				fprintf(fp, "%02x %02x %llu %llu %s\n", scoreboard_precodes[space], opcode, m->scoreboard[space][opcode].executions,
+					m->scoreboard[space][opcode].cycles, scoreboard_name(space, opcode));
+			}
+		}
+	}
+	fclose(fp);
+	return(1);
+}
+
+//
+// read a scoreboard file into scoreboard, SCOREBOARD_CURRENT is m's own
+// returns 0 if it couldn't
+//
+int load_scoreboard(struct machine *m, char *filename, struct scoreboard_entry (*scoreboard)[256])
+{
+	char line[128];
+	FILE *fp;
+	unsigned int precode, opcode, space;
+	unsigned long long executions, cycles;
+
+	if(strcmp(filename, SCOREBOARD_CURRENT) == 0) {
+		memcpy(scoreboard, m->scoreboard, SCOREBOARD_SIZE);
+		return(1);
+	}
+
+	fp = fopen(filename, "r");
+	if(fp == NULL) {
+		printf("Can't open %s!\n", filename);
+		return(0);
+	}
+
+	memset(scoreboard, 0, SCOREBOARD_SIZE);
+
+	while(fgets(line, sizeof(line), fp) != NULL) {
+		if((line[strspn(line, " \t")] == '#') || (line[strspn(line, " \t\r\n")] == '\0')) {
+			continue;
+		}
+
+		if((sscanf(line, "%x %x %llu %llu", &precode, &opcode, &executions, &cycles) != 4) || (opcode > 0xff)) {
+			printf("Bad scoreboard line: %s", line);
+			continue;
+		}
+		for(space = 0; (space != NUM_OPCODE_SPACES) && (scoreboard_precodes[space] != precode); space++) {
+			;
+		}
+		if(space == NUM_OPCODE_SPACES) {
+			printf("Bad scoreboard line: %s", line);
+			continue;
+		}
+
+		scoreboard[space][opcode].executions += executions;
+		scoreboard[space][opcode].cycles += cycles;
+	}
+	fclose(fp);
+	return(1);
+}
+
+//
+// compare two scoreboards, by share of the instructions, the top lines opcodes that changed the most
+// returns 0 if one of them couldn't be read
+//
+int compare_scoreboards(struct machine *m, char *filename_a, char *filename_b, int lines)
+{
+	struct scoreboard_entry (*scoreboard_a)[256], (*scoreboard_b)[256];
+	struct scoreboard_line *scoreboard_lines, *line;
+	unsigned long long total_a, total_b, cycles_a, cycles_b;
+	unsigned int space, opcode;
+	int x, count;
+	char text[8];
+
+	scoreboard_a = (struct scoreboard_entry (*)[256])malloc(SCOREBOARD_SIZE);
+	scoreboard_b = (struct scoreboard_entry (*)[256])malloc(SCOREBOARD_SIZE);
+	scoreboard_lines = (struct scoreboard_line *)malloc(NUM_OPCODE_SPACES * 256 * sizeof(struct scoreboard_line));
+	if((scoreboard_a == NULL) || (scoreboard_b == NULL) || (scoreboard_lines == NULL)) {
+		printf("Not enough memory to compare scoreboards\n");
+		free(scoreboard_a);
+		free(scoreboard_b);
+		free(scoreboard_lines);
+		return(0);
+	}
+
+	if(!load_scoreboard(m, filename_a, scoreboard_a) || !load_scoreboard(m, filename_b, scoreboard_b)) {
+		free(scoreboard_a);
+		free(scoreboard_b);
+		free(scoreboard_lines);
+		return(0);
+	}
+
+	total_a = total_b = 0;
+	cycles_a = cycles_b = 0;
+	for(space = 0; space != NUM_OPCODE_SPACES; space++) {
+		for(opcode = 0; opcode != 256; opcode++) {
+			total_a += scoreboard_a[space][opcode].executions;
+			total_b += scoreboard_b[space][opcode].executions;
+			cycles_a += scoreboard_a[space][opcode].cycles;
+			cycles_b += scoreboard_b[space][opcode].cycles;
+		}
+	}
+
+	count = 0;
+	for(space = 0; space != NUM_OPCODE_SPACES; space++) {
+		for(opcode = 0; opcode != 256; opcode++) {
+			if(!scoreboard_a[space][opcode].executions && !scoreboard_b[space][opcode].executions) {
+				continue;
+			}
+			line = &scoreboard_lines[count++];
+			line->executions = scoreboard_a[space][opcode].executions;
+			line->cycles = scoreboard_a[space][opcode].cycles;
+			line->executions_b = scoreboard_b[space][opcode].executions;
+			line->cycles_b = scoreboard_b[space][opcode].cycles;
+			line->change = (total_b ? ((line->executions_b * 100.0) / total_b) : 0) - (total_a ? ((line->executions * 100.0) / total_a) : 0);
+			line->space = space;
+			line->opcode = opcode;
+		}
+	}
+
+	printf("a: %s, %llu instructions, %llu cycles\n", filename_a, total_a, cycles_a);
+	printf("b: %s, %llu instructions, %llu cycles\n", filename_b, total_b, cycles_b);
+	if(!total_a) {
+		total_a = 1;
+	}
+	if(!total_b) {
+		total_b = 1;
+	}
+
+	qsort(scoreboard_lines, count, sizeof(struct scoreboard_line), compare_scoreboard_changes);
+	if(count > lines) {
+		count = lines;
+	}
+
+	printf("\nexecutions a       %%  executions b       %%   change     cycles a     cycles b  opcode  handler\n");
+	for(x = 0; x != count; x++) {
+		line = &scoreboard_lines[x];
+		scoreboard_opcode(line->space, line->opcode, text);
+		printf("%12llu %6.2f%%  %12llu %6.2f%%  %+7.2f %12llu %12llu   %s  %s\n", line->executions, (line->executions * 100.0) / total_a,
+			line->executions_b, (line->executions_b * 100.0) / total_b, line->change, line->cycles, line->cycles_b, text, scoreboard_name(line->space, line->opcode));
+	}
+
+	free(scoreboard_a);
+	free(scoreboard_b);
+	free(scoreboard_lines);
+	return(1);
+}
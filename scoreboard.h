@@ -0,0 +1,23 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - instruction scoreboard header
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+//----------------------------------------------------------------------------
+//
+
+// lines display_scoreboard() and compare_scoreboards() show when nobody says otherwise
+#define SCOREBOARD_LINES		40
+
+// a scoreboard file name that stands for the machine's own scoreboard
+#define SCOREBOARD_CURRENT		"-"
+
+void clear_scoreboard(struct machine *m);
+void add_scoreboard(struct machine *dst, struct machine *src);
+void display_scoreboard(struct machine *m, int lines);
+int save_scoreboard(struct machine *m, char *filename);
+int compare_scoreboards(struct machine *m, char *filename_a, char *filename_b, int lines);
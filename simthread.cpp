@@ -0,0 +1,128 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - sim thread
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+// History:
+//
+//----------------------------------------------------------------------------
+//
+
+//
+// An interactive run goes on a thread of its own. The console thread stays
+// behind, looks at the keyboard every SIM_CONSOLE_POLL_MS and posts what it
+// finds to the machine as a command, the run loop picks them up in between
+// blocks. The only thing the run loop pays for is one memory read, no system
+// call, and the console is still there while a long run is going.
+//
+// The commands go through a ring in the machine with one writer on each end,
+// the console moves the head and the sim thread the tail, so it needs no lock.
+//
+// Keys while running: s says where it is, t turns trace on or off, anything
+// else breaks.
+//
+
+#include "stdafx.h"
+#include <stdio.h>
+#include <memory.h>
+#include <string.h>
+#include <conio.h>									// for kbhit()
+#include <stdlib.h>
+#include <windows.h>
+
+#include "st7xcpu.h"
+
+#include "machine.h"
+
+#include "simulator.h"
+#include "simthread.h"
+
+//
+// post a command to the machine, from the console thread
+// returns 0 if there are too many waiting already
+//
+int post_sim_command(struct machine *m, int command)
+{
+	if((m->sim_command_head - m->sim_command_tail) == SIM_COMMAND_QUEUE) {
+		return(0);
+	}
+
+	m->sim_commands[m->sim_command_head & (SIM_COMMAND_QUEUE - 1)] = command;
+
+	// the command is there before the sim thread can see it
+	InterlockedIncrement(&m->sim_command_head);
+	return(1);
+}
+
+//
+// next command, from the sim thread
+// returns 0 if there aren't any
+//
+int next_sim_command(struct machine *m)
+{
+	int command;
+
+	if(!sim_command_pending(m)) {
+		return(0);
+	}
+
+	command = m->sim_commands[m->sim_command_tail & (SIM_COMMAND_QUEUE - 1)];
+	InterlockedIncrement(&m->sim_command_tail);
+	return(command);
+}
+
+//
+// forget the commands nobody picked up, a break that came in as the last run
+// ended is not for the next one
+//
+void flush_sim_commands(struct machine *m)
+{
+	m->sim_command_tail = m->sim_command_head;
+}
+
+DWORD WINAPI sim_thread(LPVOID param)
+{
+	run_simulation((struct machine *)param);
+	return(0);
+}
+
+//
+// run the machine on the sim thread and look after the keyboard until it stops
+// returns the stop reason
+//
+int run_on_sim_thread(struct machine *m)
+{
+	HANDLE thread;
+	int c;
+
+	flush_sim_commands(m);
+
+	thread = CreateThread(NULL, 0, sim_thread, m, 0, NULL);
+	if(thread == NULL) {
+		// run it right here then, there is just no way to break it
+		printf("*** Can't start the sim thread, running without the keyboard\n");
+		return(run_simulation(m));
+	}
+
+	while(WaitForSingleObject(thread, SIM_CONSOLE_POLL_MS) == WAIT_TIMEOUT) {
+		if(!_kbhit()) {
+			continue;
+		}
+
+		c = _getch();
+		if((c == 's') || (c == 'S')) {
+			post_sim_command(m, SIM_COMMAND_STATUS);
+		} else if((c == 't') || (c == 'T')) {
+			post_sim_command(m, SIM_COMMAND_TRACE);
+		} else {
+			post_sim_command(m, SIM_COMMAND_BREAK);
+		}
+	}
+	CloseHandle(thread);
+
+	return(m->stop_reason);
+}
@@ -0,0 +1,32 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - sim thread header
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+//----------------------------------------------------------------------------
+//
+
+// commands the console posts to a running machine
+#define SIM_COMMAND_BREAK		1		// stop the run, STOP_USER_BREAK
+#define SIM_COMMAND_STATUS		2		// say where it is
+#define SIM_COMMAND_TRACE		3		// trace on or off
+
+// how often the console looks at the keyboard while a run is going
+#define SIM_CONSOLE_POLL_MS		50
+
+//
+// is there a command waiting, all the run loop looks at
+//
+inline int sim_command_pending(struct machine *m)
+{
+	return(m->sim_command_head != m->sim_command_tail);
+}
+
+int post_sim_command(struct machine *m, int command);
+int next_sim_command(struct machine *m);
+void flush_sim_commands(struct machine *m);
+int run_on_sim_thread(struct machine *m);
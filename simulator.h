@@ -10,78 +10,38 @@
 //-----------------------------------------------------------------------------
 
 
-//
-//--------------------------------------------------------
-// simulator internals - breakpoint mechanism definitions
-//--------------------------------------------------------
-//
-
-// Execution breakpoints
-extern struct breakpoint ins_breakpoints[NUM_INS_BREAKPOINTS];
-
-// Trigger breakpoint
-extern struct breakpoint application_breakpoint;
-
-// Data Breakpoint
-extern struct breakpoint data_breakpoints[NUM_DATA_BREAKPOINTS];
-
-//
-//--------------------------------------------------------
-// simulator internals - machine control and timing
-//--------------------------------------------------------
-//
-
-// true if we are in run mode
-extern int running;
-
-extern int stop_reason;
-
-extern int trace; // for selective printing
-
-extern int step_over;
-
-extern unsigned long instruction_count;
-
-extern int break_on_all_calls;
-
-// timers
-extern unsigned long sim_time_ns;	// nanoseconds elapsed
-
-extern unsigned char print_buffer[1024]; // the processor prints stuff to here
-
-//
-//--------------------------------------------------------
-// simulator internals - trace execution to a file
-//--------------------------------------------------------
-//
-extern int run_log_enable;
-extern int run_log_triggered;
-extern FILE *run_log_fp;
-
 //
 //--------------------------------------------------------
 // Function prototypes
 //--------------------------------------------------------
 //
 
-void simulator_output(void);
+void simulator_output(struct machine *m);
+int sim_printf(struct machine *m, const char *format, ...);
+
+int run_internals(struct machine *m);
+int run_simulation(struct machine *m);
 
-int run_internals(void);
+void inc_sim_time(struct machine *m, unsigned int quantity);
+void inc_sim_time_branch(struct machine *m, unsigned int quantity);
+unsigned long long get_sim_time(struct machine *m);
+void set_sim_time(struct machine *m, unsigned long long cycles);
+unsigned long long cycles_to_ns(struct machine *m, unsigned long long cycles);
+int set_clock_frequency(struct machine *m, unsigned int frequency_hz);
 
-void inc_sim_time(unsigned int quantity);
-unsigned long get_sim_time(void);
-void set_sim_time(unsigned long time);
+unsigned char get_data_memory_byte_internal(struct machine *m, unsigned int address, int rawflag);
+unsigned char get_data_memory_byte_raw(struct machine *m, unsigned int address);
+unsigned char get_data_memory_byte(struct machine *m, unsigned int address);
 
-unsigned char get_data_memory_byte_internal(unsigned int address, int rawflag);
-unsigned char get_data_memory_byte_raw(unsigned int address);
-unsigned char get_data_memory_byte(unsigned int address);
+void put_data_memory_byte_internal(struct machine *m, unsigned int address, unsigned char data, int rawflag);
+void put_data_memory_byte_raw(struct machine *m, unsigned int address, unsigned char data);
+void put_data_memory_byte(struct machine *m, unsigned int address, unsigned char data);
 
-void put_data_memory_byte_internal(unsigned int address, unsigned char data, int rawflag);
-void put_data_memory_byte_raw(unsigned int address, unsigned char data);
-void put_data_memory_byte(unsigned int address, unsigned char data);
+unsigned char get_prog_memory_byte(struct machine *m, unsigned int address);
+void get_instruction_bytes(struct machine *m, unsigned int address, unsigned char *bytes, unsigned int count);
 
-unsigned char get_prog_memory_byte(unsigned int address);
+void update_watched_pages(struct machine *m);
 
-void display_registers(int pre_post_flag);
-void display_data_memory(unsigned int address, unsigned short size);
-void display_data_memory_to_run_log(unsigned int address, unsigned short size);
\ No newline at end of file
+void display_registers(struct machine *m, int pre_post_flag);
+void display_data_memory(struct machine *m, unsigned int address, unsigned short size);
+void display_data_memory_to_run_log(struct machine *m, unsigned int address, unsigned short size);
\ No newline at end of file
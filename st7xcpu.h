@@ -404,6 +404,27 @@
 #define PRECODE_91	0x91 // PIY
 #define PRECODE_92	0x92 // PIX
 
+// Opcode spaces, the primary one and one per precode
+#define SPACE_PRIMARY		0
+#define SPACE_90			1
+#define SPACE_91			2
+#define SPACE_92			3
+#define SPACE_72			4
+#define NUM_OPCODE_SPACES	5
+
+// opcode space masks, used by the instruction spec (st7xisa.h)
+#define IN_PRIMARY	(1 << SPACE_PRIMARY)
+#define IN_90		(1 << SPACE_90)
+#define IN_91		(1 << SPACE_91)
+#define IN_92		(1 << SPACE_92)
+#define IN_72		(1 << SPACE_72)
+
+// instruction flags, also for the instruction spec
+#define INSN_JUMP	0x01	// jumps and branches
+#define INSN_CALL	0x02	// calls and traps
+#define INSN_RETURN	0x04	// returns
+#define INSN_FLOW	(INSN_JUMP|INSN_CALL|INSN_RETURN)
+
 // Condition Code Register Bits
 #define OVERFLOW_BIT			0x80
 #define INTERRUPT_MASK_L1_BIT	0x20
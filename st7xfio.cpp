@@ -53,7 +53,7 @@ int fgetline(FILE *fp, char *buff)
 
 
 // load a Motorola S-record file
-void load_srec(void)
+void load_srec(struct machine *m)
 {
 	char filename[128], line[128], bcstring[3], addressstring[5], bytestring[3];
 	FILE *fp;
@@ -90,7 +90,7 @@ void load_srec(void)
 			while(bytecount--) {
 				strncpy(&bytestring[0], &line[x], 2);
 				sscanf(&bytestring[0], "%02x", &byte);
-				prog_memory[address++] = byte;
+				put_memory_byte(m->prog_memory, address++, byte);
 				x += 2;
 			}
 
@@ -109,10 +109,12 @@ void load_srec(void)
 		}
 	}
 	fclose(fp);
+
+	invalidate_decode_cache(m);
 }
 
 // load a binary file
-void load_bin(char *filenamebase)
+void load_bin(struct machine *m, char *filenamebase)
 {
 	char filename[128];
 	FILE *fp;
@@ -144,20 +146,22 @@ void load_bin(char *filenamebase)
 	}
 	while((c = fgetc(fp)) != EOF) {
 		if(segment == 0) {
-			prog_memory[address++] = c;
+			put_memory_byte(m->prog_memory, address++, c);
 		} else {
-			prog2_memory[address++] = c;
+			put_memory_byte(m->prog2_memory, address++, c);
 		}
 		bytecount++;
 	}
 
 	printf("Loaded %d bytes.\n", bytecount);
 	fclose(fp);
+
+	invalidate_decode_cache(m);
 }
 
 
 // load a binary file
-void load_bin1(char *filenamebase)
+void load_bin1(struct machine *m, char *filenamebase)
 {
 	char filename[128];
 	FILE *fp;
@@ -180,16 +184,18 @@ void load_bin1(char *filenamebase)
 	address = 0x8000;
 
 	while((c = fgetc(fp)) != EOF) {
-		prog2_memory[address++] = c;
+		put_memory_byte(m->prog2_memory, address++, c);
 		bytecount++;
 	}
 	printf("Loaded %d bytes.\n", bytecount);
 	fclose(fp);
+
+	invalidate_decode_cache(m);
 }
 
 
 // load a flash text file
-void load_flash_text(void)
+void load_flash_text(struct machine *m)
 {
 	char filename[128];
 	FILE *fp;
@@ -214,15 +220,17 @@ void load_flash_text(void)
 		if(fscanf(fp, "%02x", &byte) != 1) {
 			break;
 		}
-		flash_memory[address++] = byte;
+		put_memory_byte(m->flash_memory, address++, byte);
 		bytecount++;
 	}
 	printf("Read %d bytes.\n", bytecount);
 	fclose(fp);
+
+	invalidate_decode_cache(m);
 }
 
 // load rom text into segment 0 memory
-void load_rom_text(void)
+void load_rom_text(struct machine *m)
 {
 	char filename[128];
 	FILE *fp;
@@ -248,16 +256,18 @@ void load_rom_text(void)
 		if(fscanf(fp, "%02x", &byte) != 1) {
 			break;
 		}
-		prog_memory[address++] = byte;
+		put_memory_byte(m->prog_memory, address++, byte);
 		bytecount++;
 	}
 	printf("Read %d bytes.\n", bytecount);
 	fclose(fp);
+
+	invalidate_decode_cache(m);
 }
 
 
 // load rom0 binary file
-void load_rom0(char *filenamebase)
+void load_rom0(struct machine *m, char *filenamebase)
 {
 	char filename[128];
 	FILE *fp;
@@ -277,16 +287,18 @@ void load_rom0(char *filenamebase)
 	bytecount = 0;
 	address = ROM_START;
 	while((c = fgetc(fp)) != EOF) {
-		prog_memory[address++] = c;
+		put_memory_byte(m->prog_memory, address++, c);
 		bytecount++;
 	}
 
 	printf("Loaded %d bytes.\n", bytecount);
 	fclose(fp);
+
+	invalidate_decode_cache(m);
 }
 
 // load rom1 binary file
-void load_rom1(char *filenamebase)
+void load_rom1(struct machine *m, char *filenamebase)
 {
 	char filename[128];
 	FILE *fp;
@@ -306,15 +318,17 @@ void load_rom1(char *filenamebase)
 	bytecount = 0;
 	address = ROM1_START;
 	while((c = fgetc(fp)) != EOF) {
-		prog2_memory[address++] = c;
+		put_memory_byte(m->prog2_memory, address++, c);
 		bytecount++;
 	}
 	printf("Loaded %d bytes.\n", bytecount);
 	fclose(fp);
+
+	invalidate_decode_cache(m);
 }
 
 // load ramio binary file
-void load_ramio(char *filenamebase)
+void load_ramio(struct machine *m, char *filenamebase)
 {
 	char filename[128];
 	FILE *fp;
@@ -336,18 +350,20 @@ void load_ramio(char *filenamebase)
 	while((c = fgetc(fp)) != EOF) {
 
 		// the ram and io are kept in both page 00 and page 80 images
-		prog_memory[address] = c;
-		prog2_memory[address] = c;
+		put_memory_byte(m->prog_memory, address, c);
+		put_memory_byte(m->prog2_memory, address, c);
 
 		address++;
 		bytecount++;
 	}
 	printf("Loaded %d bytes\n", bytecount);
 	fclose(fp);
+
+	invalidate_decode_cache(m);
 }
 
 // load flash bin
-void load_flash(char *filenamebase)
+void load_flash(struct machine *m, char *filenamebase)
 {
 	char filename[128];
 	FILE *fp;
@@ -367,15 +383,17 @@ void load_flash(char *filenamebase)
 	bytecount = 0;
 	address = FLASH_START;
 	while((c = fgetc(fp)) != EOF) {
-		flash_memory[address++] = c;
+		put_memory_byte(m->flash_memory, address++, c);
 		bytecount++;
 	}
 	printf("Loaded %d bytes\n", bytecount);
 	fclose(fp);
+
+	invalidate_decode_cache(m);
 }
 
 // save memory segment 0 to a binary file
-void save_rom0(char *filenamebase)
+void save_rom0(struct machine *m, char *filenamebase)
 {
 	char filename[128];
 	FILE *fp;
@@ -395,7 +413,7 @@ void save_rom0(char *filenamebase)
 	bytecount = 0;
 	address = ROM_START;
 	while(address != MEMSIZE) {
-		c = prog_memory[address++];
+		c = get_memory_byte(m->prog_memory, address++);
 		fputc(c, fp);
 		bytecount++;
 	}
@@ -404,7 +422,7 @@ void save_rom0(char *filenamebase)
 }
 
 // save memory segment 1 to a binary file
-void save_rom1(char *filenamebase)
+void save_rom1(struct machine *m, char *filenamebase)
 {
 	char filename[128];
 	FILE *fp;
@@ -424,7 +442,7 @@ void save_rom1(char *filenamebase)
 	bytecount = 0;
 	address = ROM1_START;
 	while(address != MEMSIZE) {
-		c = prog2_memory[address++];
+		c = get_memory_byte(m->prog2_memory, address++);
 		fputc(c, fp);
 		bytecount++;
 	}
@@ -433,7 +451,7 @@ void save_rom1(char *filenamebase)
 }
 
 // save memory ram/io to a binary file
-void save_ramio(char *filenamebase)
+void save_ramio(struct machine *m, char *filenamebase)
 {
 	char filename[128];
 	FILE *fp;
@@ -454,7 +472,7 @@ void save_ramio(char *filenamebase)
 	address = 0x0;
 	while(address != FLASH_START) {
 		// we could have taken this from either page image
-		c = prog_memory[address++];
+		c = get_memory_byte(m->prog_memory, address++);
 		fputc(c, fp);
 		bytecount++;
 	}
@@ -463,7 +481,7 @@ void save_ramio(char *filenamebase)
 }
 
 // save flash to a binary file
-void save_flash(char *filenamebase)
+void save_flash(struct machine *m, char *filenamebase)
 {
 	char filename[128];
 	FILE *fp;
@@ -483,7 +501,7 @@ void save_flash(char *filenamebase)
 	bytecount = 0;
 	address = FLASH_START;
 	while(address != ROM_START) {
-		c = flash_memory[address++];
+		c = get_memory_byte(m->flash_memory, address++);
 		fputc(c, fp);
 		bytecount++;
 	}
@@ -492,7 +510,7 @@ void save_flash(char *filenamebase)
 }
 
 // save selected memory to a binary file
-void save_bin(char *filenamebase)
+void save_bin(struct machine *m, char *filenamebase)
 {
 	char filename[128];
 	FILE *fp;
@@ -517,9 +535,9 @@ void save_bin(char *filenamebase)
 	address = 0;
 	while(address != MEMSIZE) {
 		if(segment == 0) {
-			c = prog_memory[address++];
+			c = get_memory_byte(m->prog_memory, address++);
 		} else {
-			c = prog2_memory[address++];
+			c = get_memory_byte(m->prog2_memory, address++);
 		}
 		fputc(c, fp);
 		bytecount++;
@@ -529,7 +547,7 @@ void save_bin(char *filenamebase)
 }
 
 // save processor state to a file
-void save_state(char *filenamebase)
+void save_state(struct machine *m, char *filenamebase)
 {
 	char filename[128];
 	FILE *fp;
@@ -544,24 +562,25 @@ void save_state(char *filenamebase)
 		return;
 	}
 
-	fprintf(fp, "REG_A %02x\n", register_a);
-	fprintf(fp, "REG_X %02x\n", register_x);
-	fprintf(fp, "REG_Y %02x\n", register_y);
-	fprintf(fp, "REG_SP %04x\n", register_sp);
-	fprintf(fp, "REG_PC %08x\n", register_pc);
-	fprintf(fp, "REG_CC %02x\n", register_cc);
-	fprintf(fp, "SIMTIME %d\n", get_sim_time());
+	fprintf(fp, "REG_A %02x\n", m->register_a);
+	fprintf(fp, "REG_X %02x\n", m->register_x);
+	fprintf(fp, "REG_Y %02x\n", m->register_y);
+	fprintf(fp, "REG_SP %04x\n", m->register_sp);
+	fprintf(fp, "REG_PC %08x\n", m->register_pc);
+	fprintf(fp, "REG_CC %02x\n", m->register_cc);
+	fprintf(fp, "SIMCYCLES %llu\n", get_sim_time(m));
 
 	fclose(fp);
 	printf("Done.\n");
 }
 
 // load processor state file
-void load_state(char *filenamebase)
+void load_state(struct machine *m, char *filenamebase)
 {
-	char filename[128];
+	char filename[128], keyword[16];
 	FILE *fp;
 	unsigned int val;
+	unsigned long long cycles;
 
 	// Construct filename
 	strcpy(filename, filenamebase);
@@ -575,32 +594,37 @@ void load_state(char *filenamebase)
 
 	// Read state
 	fscanf(fp, "REG_A %02x\n", &val);
-	register_a = val;
+	m->register_a = val;
 
 	fscanf(fp, "REG_X %02x\n", &val);
-	register_x = val;
+	m->register_x = val;
 
 	fscanf(fp, "REG_Y %02x\n", &val);
-	register_y = val;
+	m->register_y = val;
 
 	fscanf(fp, "REG_SP %04x\n", &val);
-	register_sp = val;
+	m->register_sp = val;
 
 	fscanf(fp, "REG_PC %08x\n", &val);
-	register_pc = val;
+	m->register_pc = val;
 
 	fscanf(fp, "REG_CC %02x\n", &val);
-	register_cc = val;
+	m->register_cc = val;
 
-	fscanf(fp, "SIMTIME %d\n", &val);
-	set_sim_time(val);
+	// older state files have the time in ns
+	if(fscanf(fp, "%15s %llu\n", keyword, &cycles) == 2) {
+		if(!strcmp(keyword, "SIMTIME")) {
+			cycles = (cycles * (m->clock_frequency_hz / CLOCKS_PER_INSTRUCTION_CYCLE)) / 1000000000;
+		}
+		set_sim_time(m, cycles);
+	}
 
 	fclose(fp);
 	printf("Done.\n");
 }
 
 // Load and Save Snapshots
-void snapshot(void)
+void snapshot(struct machine *m)
 {
 	int c;
 	char filename[128];
@@ -620,15 +644,15 @@ void snapshot(void)
 		scanf("%s", &filename[0]);
 		getchar();
 
-		load_rom0(filename);
-		load_rom1(filename);
-		load_flash(filename);
-		load_ramio(filename);
-		load_state(filename);
+		load_rom0(m, filename);
+		load_rom1(m, filename);
+		load_flash(m, filename);
+		load_ramio(m, filename);
+		load_state(m, filename);
 
 		// RJS this is because of a bug
 		printf("Reloading Rom1...\n");
-		load_bin1("hp_laser_rom_108000");
+		load_bin1(m, "hp_laser_rom_108000");
 
 		printf("Snapshot Components Loaded.\n");
 
@@ -638,11 +662,11 @@ void snapshot(void)
 		scanf("%s", &filename[0]);
 		getchar();
 
-		save_rom0(filename);
-		save_rom1(filename);
-		save_flash(filename);
-		save_ramio(filename);
-		save_state(filename);
+		save_rom0(m, filename);
+		save_rom1(m, filename);
+		save_flash(m, filename);
+		save_ramio(m, filename);
+		save_state(m, filename);
 
 		printf("Snapshot Components Saved.\n");
 	}
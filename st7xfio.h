@@ -11,19 +11,19 @@
 //
 
 int fgetline(FILE *fp, char *buff);
-void load_srec(void);
-void load_bin(char *filenamebase);
-void load_flash_text(void);
-void load_rom_text(void);
-void load_rom0(char *filenamebase);
-void load_rom1(char *filenamebase);
-void load_ramio(char *filenamebase);
-void load_flash(char *filenamebase);
-void save_rom0(char *filenamebase);
-void save_rom1(char *filenamebase);
-void save_ramio(char *filenamebase);
-void save_flash(char *filenamebase);
-void save_bin(char *filenamebase);
-void save_state(char *filenamebase);
-void load_state(char *filenamebase);
-void snapshot(void);
+void load_srec(struct machine *m);
+void load_bin(struct machine *m, char *filenamebase);
+void load_flash_text(struct machine *m);
+void load_rom_text(struct machine *m);
+void load_rom0(struct machine *m, char *filenamebase);
+void load_rom1(struct machine *m, char *filenamebase);
+void load_ramio(struct machine *m, char *filenamebase);
+void load_flash(struct machine *m, char *filenamebase);
+void save_rom0(struct machine *m, char *filenamebase);
+void save_rom1(struct machine *m, char *filenamebase);
+void save_ramio(struct machine *m, char *filenamebase);
+void save_flash(struct machine *m, char *filenamebase);
+void save_bin(struct machine *m, char *filenamebase);
+void save_state(struct machine *m, char *filenamebase);
+void load_state(struct machine *m, char *filenamebase);
+void snapshot(struct machine *m);
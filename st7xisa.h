@@ -0,0 +1,328 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - instruction spec
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+// History:
+//
+//----------------------------------------------------------------------------
+//
+
+//
+// Every instruction the processor knows, one line per opcode:
+//
+//	INSN(opcode, handler, spaces, length, flags, CYCLES(primary, 90, 91, 92, 72), taken)
+//
+// opcode is the name from st7xcpu.h, handler is op_<handler>() in processor.cpp,
+// spaces are the opcode spaces (IN_PRIMARY, IN_90, IN_91, IN_92, IN_72)
+// the handler does something sensible in and flags say if it changes the flow
+// (INSN_JUMP, INSN_CALL, INSN_RETURN or 0).
+//
+// length is the size in bytes without a precode as found in the primary space,
+// the 90 forms are the same size. The 91 and 92 forms take a short pointer
+// instead of the operand (2 bytes) and the 72 forms a long address (3 bytes,
+// 4 for BTJx which still has its displacement), see build_opcode_spaces().
+//
+// CYCLES() is what the instruction takes in each opcode space, precode fetch
+// included, 0 in the spaces it isn't in. taken is what a conditional branch
+// takes on top of that when it goes (the handler calls branch_taken()).
+// execute() and the block and recompiled runners charge these, the handlers
+// don't touch the clock.
+//
+// No include guard, the includer defines INSN() and CYCLES() to whatever it needs.
+//
+
+INSN(EXGW,						exgw,						IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+
+INSN(EXG_A_X,					exg_a_x,					IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(EXG_A_Y,					exg_a_y,					IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(EXG_A_LONG,				exg_a_long,					IN_PRIMARY,							3,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+
+INSN(LDF_A_FAR,					ldf_a_far,					IN_PRIMARY,							4,	0,				CYCLES(1, 0, 0, 0, 0),		0)
+INSN(LDF_A_REG_IND,				ldf_a_reg_ind,				IN_PRIMARY|IN_72,					4,	0,				CYCLES(1, 0, 0, 0, 3),		0)
+INSN(LDF_FAR_A,					ldf_far_a,					IN_PRIMARY,							4,	0,				CYCLES(1, 0, 0, 0, 0),		0)
+INSN(LDF_REG_IND_A,				ldf_reg_ind_a,				IN_PRIMARY|IN_72,					4,	0,				CYCLES(1, 0, 0, 0, 3),		0)
+
+INSN(MOV_LONG_IMMED,			mov_long_immed,				IN_PRIMARY,							4,	0,				CYCLES(1, 0, 0, 0, 0),		0)
+INSN(MOV_SHORT_SHORT,			mov_short_short,			IN_PRIMARY,							3,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(MOV_LONG_LONG,				mov_long_long,				IN_PRIMARY,							5,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+
+INSN(OPCODE_0x65,				opcode_0x65,				IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(OPCODE_0x75,				opcode_0x75,				IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+
+INSN(HALT,						halt,						IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(ADD_SP,					add_sp,						IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(RSP,						rsp,						IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(LDW_SP_X,					ldw_sp_x,					IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(DIV,						div,						IN_PRIMARY,							1,	0,				CYCLES(17, 0, 0, 0, 0),		0)
+
+INSN(MUL,						mul,						IN_PRIMARY|IN_90,					1,	0,				CYCLES(11, 14, 0, 0, 0),	0)
+INSN(MUL1,						mul,						IN_PRIMARY|IN_90,					1,	0,				CYCLES(11, 14, 0, 0, 0),	0)
+
+INSN(RCF,						rcf,						IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(SCF,						scf,						IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(CCF,						ccf,						IN_PRIMARY,							1,	0,				CYCLES(3, 0, 0, 0, 0),		0)
+INSN(RIM,						rim,						IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(SIM,						sim,						IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+
+INSN(BRES_0,					bres,						IN_PRIMARY|IN_90|IN_72,				2,	0,				CYCLES(5, 3, 0, 0, 7),		0)
+INSN(BRES_1,					bres,						IN_PRIMARY|IN_90|IN_72,				2,	0,				CYCLES(5, 3, 0, 0, 7),		0)
+INSN(BRES_2,					bres,						IN_PRIMARY|IN_90|IN_72,				2,	0,				CYCLES(5, 3, 0, 0, 7),		0)
+INSN(BRES_3,					bres,						IN_PRIMARY|IN_90|IN_72,				2,	0,				CYCLES(5, 3, 0, 0, 7),		0)
+INSN(BRES_4,					bres,						IN_PRIMARY|IN_90|IN_72,				2,	0,				CYCLES(5, 3, 0, 0, 7),		0)
+INSN(BRES_5,					bres,						IN_PRIMARY|IN_90|IN_72,				2,	0,				CYCLES(5, 3, 0, 0, 7),		0)
+INSN(BRES_6,					bres,						IN_PRIMARY|IN_90|IN_72,				2,	0,				CYCLES(5, 3, 0, 0, 7),		0)
+INSN(BRES_7,					bres,						IN_PRIMARY|IN_90|IN_72,				2,	0,				CYCLES(5, 3, 0, 0, 7),		0)
+
+INSN(BSET_0,					bset,						IN_PRIMARY|IN_90|IN_72,				2,	0,				CYCLES(5, 3, 0, 0, 7),		0)
+INSN(BSET_1,					bset,						IN_PRIMARY|IN_90|IN_72,				2,	0,				CYCLES(5, 3, 0, 0, 7),		0)
+INSN(BSET_2,					bset,						IN_PRIMARY|IN_90|IN_72,				2,	0,				CYCLES(5, 3, 0, 0, 7),		0)
+INSN(BSET_3,					bset,						IN_PRIMARY|IN_90|IN_72,				2,	0,				CYCLES(5, 3, 0, 0, 7),		0)
+INSN(BSET_4,					bset,						IN_PRIMARY|IN_90|IN_72,				2,	0,				CYCLES(5, 3, 0, 0, 7),		0)
+INSN(BSET_5,					bset,						IN_PRIMARY|IN_90|IN_72,				2,	0,				CYCLES(5, 3, 0, 0, 7),		0)
+INSN(BSET_6,					bset,						IN_PRIMARY|IN_90|IN_72,				2,	0,				CYCLES(5, 3, 0, 0, 7),		0)
+INSN(BSET_7,					bset,						IN_PRIMARY|IN_90|IN_72,				2,	0,				CYCLES(5, 3, 0, 0, 7),		0)
+
+INSN(BTJF_0,					btjf,						IN_PRIMARY|IN_72,					3,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 7),		0)
+INSN(BTJF_1,					btjf,						IN_PRIMARY|IN_72,					3,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 7),		0)
+INSN(BTJF_2,					btjf,						IN_PRIMARY|IN_72,					3,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 7),		0)
+INSN(BTJF_3,					btjf,						IN_PRIMARY|IN_72,					3,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 7),		0)
+INSN(BTJF_4,					btjf,						IN_PRIMARY|IN_72,					3,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 7),		0)
+INSN(BTJF_5,					btjf,						IN_PRIMARY|IN_72,					3,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 7),		0)
+INSN(BTJF_6,					btjf,						IN_PRIMARY|IN_72,					3,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 7),		0)
+INSN(BTJF_7,					btjf,						IN_PRIMARY|IN_72,					3,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 7),		0)
+
+INSN(BTJT_0,					btjt,						IN_PRIMARY|IN_72,					3,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 7),		0)
+INSN(BTJT_1,					btjt,						IN_PRIMARY|IN_72,					3,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 7),		0)
+INSN(BTJT_2,					btjt,						IN_PRIMARY|IN_72,					3,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 7),		0)
+INSN(BTJT_3,					btjt,						IN_PRIMARY|IN_72,					3,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 7),		0)
+INSN(BTJT_4,					btjt,						IN_PRIMARY|IN_72,					3,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 7),		0)
+INSN(BTJT_5,					btjt,						IN_PRIMARY|IN_72,					3,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 7),		0)
+INSN(BTJT_6,					btjt,						IN_PRIMARY|IN_72,					3,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 7),		0)
+INSN(BTJT_7,					btjt,						IN_PRIMARY|IN_72,					3,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 7),		0)
+
+INSN(JRC,						jrc,						IN_PRIMARY,							2,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 0),		0)
+INSN(JREQ,						jreq,						IN_PRIMARY,							2,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 0),		0)
+INSN(JRF,						jrf,						IN_PRIMARY,							2,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 0),		0)
+INSN(JRH,						jrh,						IN_PRIMARY,							2,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 0),		0)
+INSN(JRIH,						jrih,						IN_PRIMARY,							2,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 0),		0)
+INSN(JRIL,						jril,						IN_PRIMARY,							2,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 0),		0)
+INSN(JRM,						jrm,						IN_PRIMARY,							2,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 0),		0)
+INSN(JRMI,						jrmi,						IN_PRIMARY,							2,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 0),		0)
+INSN(JRNC,						jrnc,						IN_PRIMARY,							2,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 0),		0)
+INSN(JRNE,						jrne,						IN_PRIMARY,							2,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 0),		0)
+INSN(JRNH,						jrnh,						IN_PRIMARY,							2,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 0),		0)
+INSN(JRNM,						jrnm,						IN_PRIMARY,							2,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 0),		0)
+INSN(JRPL,						jrpl,						IN_PRIMARY,							2,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 0),		0)
+INSN(JRUGT,						jrugt,						IN_PRIMARY,							2,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 0),		0)
+INSN(JRULE,						jrule,						IN_PRIMARY,							2,	INSN_JUMP,		CYCLES(5, 0, 0, 0, 0),		0)
+INSN(JRA,						jra,						IN_PRIMARY,							2,	INSN_JUMP,		CYCLES(3, 0, 0, 0, 0),		0)
+
+INSN(JP_LONG,					jp_long,					IN_PRIMARY|IN_92,					3,	INSN_JUMP,		CYCLES(3, 0, 0, 7, 0),		0)
+INSN(JP_FAR,					jp_far,						IN_PRIMARY|IN_92,					4,	INSN_JUMP,		CYCLES(2, 0, 0, 8, 0),		0)
+INSN(JP_REG_IND,				jp_reg_ind,					IN_PRIMARY|IN_90,					1,	INSN_JUMP,		CYCLES(2, 5, 0, 0, 0),		0)
+INSN(JP_REG_IND_OFF_SHORT,		jp_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	INSN_JUMP,		CYCLES(3, 5, 7, 7, 0),		0)
+INSN(JP_REG_IND_OFF_LONG,		jp_reg_ind_off_long,		IN_PRIMARY|IN_90|IN_91|IN_92,		3,	INSN_JUMP,		CYCLES(6, 8, 8, 8, 0),		0)
+
+INSN(NOP,						nop,						IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+
+INSN(ADC_IMMED,					adc_immed,					IN_PRIMARY,							2,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(ADC_SHORT,					adc_short,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(3, 0, 0, 7, 0),		0)
+INSN(ADC_LONG,					adc_long,					IN_PRIMARY|IN_92,					3,	0,				CYCLES(4, 0, 0, 8, 0),		0)
+INSN(ADC_REG_IND,				adc_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(3, 6, 0, 0, 0),		0)
+INSN(ADC_REG_IND_OFF_SHORT,		adc_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(4, 6, 8, 8, 0),		0)
+INSN(ADC_REG_IND_OFF_LONG,		adc_reg_ind_off_long,		IN_PRIMARY|IN_90|IN_91|IN_92,		3,	0,				CYCLES(4, 6, 8, 8, 0),		0)
+
+INSN(ADD_IMMED,					add_immed,					IN_PRIMARY,							2,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(ADD_SHORT,					add_short,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(3, 0, 0, 7, 0),		0)
+INSN(ADD_LONG,					add_long,					IN_PRIMARY|IN_92,					3,	0,				CYCLES(4, 0, 0, 8, 0),		0)
+INSN(ADD_REG_IND,				add_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(3, 6, 0, 0, 0),		0)
+INSN(ADD_REG_IND_OFF_SHORT,		add_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(4, 6, 8, 8, 0),		0)
+INSN(ADD_REG_IND_OFF_LONG,		add_reg_ind_off_long,		IN_PRIMARY|IN_90|IN_91|IN_92,		3,	0,				CYCLES(6, 8, 9, 9, 0),		0)
+
+INSN(AND_IMMED,					and_immed,					IN_PRIMARY,							2,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(AND_SHORT,					and_short,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(3, 0, 0, 7, 0),		0)
+INSN(AND_LONG,					and_long,					IN_PRIMARY|IN_92,					3,	0,				CYCLES(4, 0, 0, 8, 0),		0)
+INSN(AND_REG_IND,				and_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(3, 6, 0, 0, 0),		0)
+INSN(AND_REG_IND_OFF_SHORT,		and_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(4, 6, 8, 8, 0),		0)
+INSN(AND_REG_IND_OFF_LONG,		and_reg_ind_off_long,		IN_PRIMARY|IN_90|IN_91|IN_92,		3,	0,				CYCLES(5, 7, 9, 9, 0),		0)
+
+INSN(BCP_IMMED,					bcp_immed,					IN_PRIMARY,							2,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(BCP_SHORT,					bcp_short,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(3, 0, 0, 7, 0),		0)
+INSN(BCP_LONG,					bcp_long,					IN_PRIMARY|IN_92,					3,	0,				CYCLES(4, 0, 0, 8, 0),		0)
+INSN(BCP_REG_IND,				bcp_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(3, 6, 0, 0, 0),		0)
+INSN(BCP_REG_IND_OFF_SHORT,		bcp_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(4, 6, 8, 8, 0),		0)
+INSN(BCP_REG_IND_OFF_LONG,		bcp_reg_ind_off_long,		IN_PRIMARY|IN_90|IN_91|IN_92,		3,	0,				CYCLES(5, 7, 9, 8, 0),		0)
+
+INSN(CP_IMMED,					cp_immed,					IN_PRIMARY,							2,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(CP_SHORT,					cp_short,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(3, 0, 0, 7, 0),		0)
+INSN(CP_LONG,					cp_long,					IN_PRIMARY|IN_92,					3,	0,				CYCLES(4, 0, 0, 8, 0),		0)
+INSN(CP_REG_IND,				cp_reg_ind,					IN_PRIMARY|IN_90,					1,	0,				CYCLES(4, 6, 0, 0, 0),		0)
+INSN(CP_REG_IND_OFF_SHORT,		cp_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(4, 6, 8, 8, 0),		0)
+INSN(CP_REG_IND_OFF_LONG,		cp_reg_ind_off_long,		IN_PRIMARY|IN_90|IN_91|IN_92|IN_72,	3,	0,				CYCLES(5, 7, 9, 9, 10),		0)
+INSN(CP_X_IMMED,				cp_x_immed,					IN_PRIMARY|IN_90,					2,	0,				CYCLES(2, 5, 0, 0, 0),		0)
+INSN(CP_X_SHORT,				cp_x_short,					IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(3, 6, 7, 7, 0),		0)
+INSN(CP_X_LONG,					cp_x_long,					IN_PRIMARY|IN_90|IN_91|IN_92,		3,	0,				CYCLES(4, 7, 8, 8, 0),		0)
+INSN(CP_X_REG_IND,				cp_x_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(3, 6, 0, 0, 0),		0)
+INSN(CP_X_REG_IND_OFF_SHORT,	cp_x_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(4, 7, 7, 6, 0),		0)
+INSN(CP_X_REG_IND_OFF_LONG,		cp_x_reg_ind_off_long,		IN_PRIMARY|IN_90|IN_91|IN_92,		3,	0,				CYCLES(5, 8, 9, 7, 0),		0)
+
+INSN(OR_IMMED,					or_immed,					IN_PRIMARY,							2,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(OR_SHORT,					or_short,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(3, 0, 0, 6, 0),		0)
+INSN(OR_LONG,					or_long,					IN_PRIMARY|IN_92,					3,	0,				CYCLES(5, 0, 0, 9, 0),		0)
+INSN(OR_REG_IND,				or_reg_ind,					IN_PRIMARY|IN_90,					1,	0,				CYCLES(3, 6, 0, 0, 0),		0)
+INSN(OR_REG_IND_OFF_SHORT,		or_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(4, 7, 8, 8, 0),		0)
+INSN(OR_REG_IND_OFF_LONG,		or_reg_ind_off_long,		IN_PRIMARY|IN_90|IN_91|IN_92,		3,	0,				CYCLES(5, 8, 9, 9, 0),		0)
+
+INSN(XOR_IMMED,					xor_immed,					IN_PRIMARY,							2,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(XOR_SHORT,					xor_short,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(3, 0, 0, 7, 0),		0)
+INSN(XOR_LONG,					xor_long,					IN_PRIMARY|IN_92,					3,	0,				CYCLES(5, 0, 0, 9, 0),		0)
+INSN(XOR_REG_IND,				xor_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(3, 6, 0, 0, 0),		0)
+INSN(XOR_REG_IND_OFF_SHORT,		xor_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(4, 6, 6, 6, 0),		0)
+INSN(XOR_REG_IND_OFF_LONG,		xor_reg_ind_off_long,		IN_PRIMARY|IN_90|IN_91|IN_92,		3,	0,				CYCLES(6, 9, 9, 9, 0),		0)
+
+INSN(SBC_IMMED,					sbc_immed,					IN_PRIMARY,							2,	0,				CYCLES(3, 0, 0, 0, 0),		0)
+INSN(SBC_SHORT,					sbc_short,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(3, 0, 0, 7, 0),		0)
+INSN(SBC_LONG,					sbc_long,					IN_PRIMARY|IN_92,					3,	0,				CYCLES(4, 0, 0, 7, 0),		0)
+INSN(SBC_REG_IND,				sbc_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(3, 6, 0, 0, 0),		0)
+INSN(SBC_REG_IND_OFF_SHORT,		sbc_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(4, 7, 8, 8, 0),		0)
+INSN(SBC_REG_IND_OFF_LONG,		sbc_reg_ind_off_long,		IN_PRIMARY|IN_90|IN_91|IN_92,		3,	0,				CYCLES(5, 8, 9, 9, 0),		0)
+
+INSN(SUB_IMMED,					sub_immed,					IN_PRIMARY,							2,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(SUB_SHORT,					sub_short,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(3, 0, 0, 7, 0),		0)
+INSN(SUB_LONG,					sub_long,					IN_PRIMARY|IN_92,					3,	0,				CYCLES(5, 0, 0, 9, 0),		0)
+INSN(SUB_REG_IND,				sub_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(3, 6, 0, 0, 0),		0)
+INSN(SUB_REG_IND_OFF_SHORT,		sub_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(5, 8, 9, 9, 0),		0)
+INSN(SUB_REG_IND_OFF_LONG,		sub_reg_ind_off_long,		IN_PRIMARY|IN_90|IN_91|IN_92,		3,	0,				CYCLES(6, 9, 10, 10, 0),	0)
+
+INSN(LD_A_X,					ld_a_x,						IN_PRIMARY|IN_90,					1,	0,				CYCLES(2, 4, 0, 0, 0),		0)
+INSN(LD_X_A,					ld_x_a,						IN_PRIMARY|IN_90,					1,	0,				CYCLES(2, 4, 0, 0, 0),		0)
+INSN(LD_X_Y,					ld_x_y,						IN_PRIMARY|IN_90,					1,	0,				CYCLES(2, 4, 0, 0, 0),		0)
+INSN(LD_A_S,					ld_a_s,						IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(LD_S_A,					ld_s_a,						IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(LD_X_S,					ld_x_s,						IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(LD_S_X,					ld_s_x,						IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(LD_A_IMMED,				ld_a_immed,					IN_PRIMARY,							2,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(LD_A_SHORT,				ld_a_short,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(6, 0, 0, 8, 0),		0)
+INSN(LD_A_LONG,					ld_a_long,					IN_PRIMARY|IN_92,					3,	0,				CYCLES(6, 0, 0, 9, 0),		0)
+INSN(LD_A_REG_IND,				ld_a_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(5, 9, 0, 0, 0),		0)
+INSN(LD_A_REG_IND_OFF_SHORT,	ld_a_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(5, 8, 9, 9, 0),		0)
+INSN(LD_A_REG_IND_OFF_LONG,		ld_a_reg_ind_off_long,		IN_PRIMARY|IN_90|IN_91|IN_92,		3,	0,				CYCLES(5, 10, 10, 9, 0),	0)
+INSN(LD_A_SP_IND,				ld_a_sp_ind,				IN_PRIMARY,							2,	0,				CYCLES(5, 0, 0, 0, 0),		0)
+INSN(LD_SHORT_A,				ld_short_a,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(4, 0, 0, 7, 0),		0)
+INSN(LD_LONG_A,					ld_long_a,					IN_PRIMARY|IN_92,					3,	0,				CYCLES(5, 0, 0, 9, 0),		0)
+INSN(LD_REG_IND_A,				ld_reg_ind_a,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(5, 9, 0, 0, 0),		0)
+INSN(LD_REG_IND_OFF_SHORT_A,	ld_reg_ind_off_short_a,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(5, 8, 9, 9, 0),		0)
+INSN(LD_REG_IND_OFF_LONG_A,		ld_reg_ind_off_long_a,		IN_PRIMARY|IN_90|IN_91|IN_92|IN_72,	3,	0,				CYCLES(7, 10, 10, 9, 10),	0)
+INSN(LD_SP_IND_A,				ld_sp_ind_a,				IN_PRIMARY,							2,	0,				CYCLES(5, 0, 0, 0, 0),		0)
+INSN(LD_X_IMMED,				ld_x_immed,					IN_PRIMARY|IN_90,					2,	0,				CYCLES(2, 5, 0, 0, 0),		0)
+INSN(LD_X_SHORT,				ld_x_short,					IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(3, 6, 7, 7, 0),		0)
+INSN(LD_X_LONG,					ld_x_long,					IN_PRIMARY|IN_90|IN_91|IN_92,		3,	0,				CYCLES(4, 7, 7, 7, 0),		0)
+INSN(LD_X_REG_IND,				ld_x_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(3, 6, 0, 0, 0),		0)
+INSN(LD_X_REG_IND_OFF_SHORT,	ld_x_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(4, 8, 9, 7, 0),		0)
+INSN(LD_X_REG_IND_OFF_LONG,		ld_x_reg_ind_off_long,		IN_PRIMARY|IN_90|IN_91|IN_92,		3,	0,				CYCLES(5, 8, 9, 9, 0),		0)
+INSN(LD_SHORT_X,				ld_short_x,					IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(4, 7, 9, 8, 0),		0)
+INSN(LD_LONG_X,					ld_long_x,					IN_PRIMARY|IN_90|IN_91|IN_92,		3,	0,				CYCLES(5, 8, 9, 8, 0),		0)
+INSN(LD_REG_IND_X,				ld_reg_ind_x,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(4, 6, 0, 0, 0),		0)
+INSN(LD_REG_IND_OFF_SHORT_X,	ld_reg_ind_off_short_x,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(4, 7, 9, 8, 0),		0)
+INSN(LD_REG_IND_OFF_LONG_X,		ld_reg_ind_off_long_x,		IN_PRIMARY|IN_90|IN_91|IN_92,		3,	0,				CYCLES(8, 10, 10, 10, 0),	0)
+
+INSN(CLR_A,						clr_a,						IN_PRIMARY|IN_72,					1,	0,				CYCLES(2, 0, 0, 0, 6),		0)
+INSN(CLR_X,						clr_x,						IN_PRIMARY|IN_90|IN_72,				1,	0,				CYCLES(3, 6, 0, 0, 6),		0)
+INSN(CLR_REG_IND,				clr_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(5, 8, 0, 0, 0),		0)
+INSN(CLR_SHORT,					clr_short,					IN_PRIMARY|IN_92|IN_72,				2,	0,				CYCLES(5, 0, 0, 9, 11),		0)
+INSN(CLR_REG_IND_OFF_SHORT,		clr_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(6, 9, 10, 10, 0),	0)
+
+INSN(RLC_A,						rlc_a,						IN_PRIMARY,							1,	0,				CYCLES(3, 0, 0, 0, 0),		0)
+INSN(RLC_X,						rlc_x,						IN_PRIMARY|IN_90|IN_72,				1,	0,				CYCLES(3, 6, 0, 0, 7),		0)
+INSN(RLC_REG_IND,				rlc_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(5, 8, 0, 0, 0),		0)
+INSN(RLC_SHORT,					rlc_short,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(5, 0, 0, 9, 0),		0)
+INSN(RLC_REG_IND_OFF_SHORT,		rlc_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(7, 10, 10, 9, 0),	0)
+
+INSN(RRC_A,						rrc_a,						IN_PRIMARY,							1,	0,				CYCLES(3, 0, 0, 0, 0),		0)
+INSN(RRC_X,						rrc_x,						IN_PRIMARY|IN_90,					1,	0,				CYCLES(3, 6, 0, 0, 0),		0)
+INSN(RRC_REG_IND,				rrc_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(5, 8, 0, 0, 0),		0)
+INSN(RRC_SHORT,					rrc_short,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(5, 0, 0, 9, 0),		0)
+INSN(RRC_REG_IND_OFF_SHORT,		rrc_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(6, 10, 10, 9, 0),	0)
+
+INSN(SLA_A,						sla_a,						IN_PRIMARY,							1,	0,				CYCLES(3, 0, 0, 0, 0),		0)
+INSN(SLA_X,						sla_x,						IN_PRIMARY|IN_90|IN_72,				1,	0,				CYCLES(3, 6, 0, 0, 7),		0)
+INSN(SLA_REG_IND,				sla_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(5, 8, 0, 0, 0),		0)
+INSN(SLA_SHORT,					sla_short,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(5, 0, 0, 9, 0),		0)
+INSN(SLA_REG_IND_OFF_SHORT,		sla_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(6, 9, 10, 10, 0),	0)
+
+INSN(SRA_A,						sra_a,						IN_PRIMARY,							1,	0,				CYCLES(3, 0, 0, 0, 0),		0)
+INSN(SRA_X,						sra_x,						IN_PRIMARY|IN_90,					1,	0,				CYCLES(3, 6, 0, 0, 0),		0)
+INSN(SRA_REG_IND,				sra_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(5, 8, 0, 0, 0),		0)
+INSN(SRA_SHORT,					sra_short,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(5, 0, 0, 9, 0),		0)
+INSN(SRA_REG_IND_OFF_SHORT,		sra_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(6, 9, 10, 10, 0),	0)
+
+INSN(SRL_A,						srl_a,						IN_PRIMARY,							1,	0,				CYCLES(3, 0, 0, 0, 0),		0)
+INSN(SRL_X,						srl_x,						IN_PRIMARY|IN_90,					1,	0,				CYCLES(3, 6, 0, 0, 0),		0)
+INSN(SRL_REG_IND,				srl_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(5, 9, 0, 0, 0),		0)
+INSN(SRL_SHORT,					srl_short,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(5, 0, 0, 9, 0),		0)
+INSN(SRL_REG_IND_OFF_SHORT,		srl_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(6, 9, 10, 10, 0),	0)
+
+INSN(SWAP_A,					swap_a,						IN_PRIMARY,							1,	0,				CYCLES(3, 0, 0, 0, 0),		0)
+INSN(SWAP_X,					swap_x,						IN_PRIMARY|IN_90,					1,	0,				CYCLES(3, 6, 0, 0, 0),		0)
+INSN(SWAP_REG_IND,				swap_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(5, 8, 0, 0, 0),		0)
+INSN(SWAP_SHORT,				swap_short,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(5, 0, 0, 9, 0),		0)
+INSN(SWAP_REG_IND_OFF_SHORT,	swap_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(6, 9, 10, 10, 0),	0)
+
+INSN(INC_A,						inc_a,						IN_PRIMARY,							1,	0,				CYCLES(3, 0, 0, 0, 0),		0)
+INSN(INC_X,						inc_x,						IN_PRIMARY|IN_90|IN_72,				1,	0,				CYCLES(3, 6, 0, 0, 8),		0)
+INSN(INC_REG_IND,				inc_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(5, 8, 0, 0, 0),		0)
+INSN(INC_SHORT,					inc_short,					IN_PRIMARY|IN_92|IN_72,				2,	0,				CYCLES(5, 0, 0, 9, 11),		0)
+INSN(INC_REG_IND_OFF_SHORT,		inc_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(6, 9, 10, 10, 0),	0)
+
+INSN(DEC_A,						dec_a,						IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
+INSN(DEC_X,						dec_x,						IN_PRIMARY|IN_90|IN_72,				1,	0,				CYCLES(3, 6, 0, 0, 8),		0)
+INSN(DEC_REG_IND,				dec_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(5, 9, 0, 0, 0),		0)
+INSN(DEC_SHORT,					dec_short,					IN_PRIMARY|IN_92|IN_72,				2,	0,				CYCLES(5, 0, 0, 9, 11),		0)
+INSN(DEC_REG_IND_OFF_SHORT,		dec_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(6, 9, 10, 10, 0),	0)
+
+INSN(NEG_A,						neg_a,						IN_PRIMARY,							1,	0,				CYCLES(3, 0, 0, 0, 0),		0)
+INSN(NEG_X,						neg_x,						IN_PRIMARY|IN_90,					1,	0,				CYCLES(3, 6, 0, 0, 0),		0)
+INSN(NEG_REG_IND,				neg_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(5, 9, 0, 0, 0),		0)
+INSN(NEG_SHORT,					neg_short,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(5, 0, 0, 9, 0),		0)
+INSN(NEG_REG_IND_OFF_SHORT,		neg_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(6, 9, 10, 10, 0),	0)
+
+INSN(CPL_A,						cpl_a,						IN_PRIMARY,							1,	0,				CYCLES(3, 0, 0, 0, 0),		0)
+INSN(CPL_X,						cpl_x,						IN_PRIMARY|IN_90,					1,	0,				CYCLES(3, 6, 0, 0, 0),		0)
+INSN(CPL_REG_IND,				cpl_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(5, 9, 0, 0, 0),		0)
+INSN(CPL_SHORT,					cpl_short,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(5, 0, 0, 9, 0),		0)
+INSN(CPL_REG_IND_OFF_SHORT,		cpl_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(6, 9, 10, 10, 0),	0)
+
+INSN(TNZ_A,						tnz_a,						IN_PRIMARY,							1,	0,				CYCLES(3, 0, 0, 0, 0),		0)
+INSN(TNZ_X,						tnz_x,						IN_PRIMARY|IN_90|IN_72,				1,	0,				CYCLES(3, 6, 0, 0, 7),		0)
+INSN(TNZ_REG_IND,				tnz_reg_ind,				IN_PRIMARY|IN_90,					1,	0,				CYCLES(5, 9, 0, 0, 0),		0)
+INSN(TNZ_SHORT,					tnz_short,					IN_PRIMARY|IN_92,					2,	0,				CYCLES(5, 0, 0, 9, 0),		0)
+INSN(TNZ_REG_IND_OFF_SHORT,		tnz_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	0,				CYCLES(6, 9, 10, 10, 0),	0)
+
+INSN(PUSH_A,					push_a,						IN_PRIMARY,							1,	0,				CYCLES(3, 0, 0, 0, 0),		0)
+INSN(PUSH_X,					push_x,						IN_PRIMARY|IN_90,					1,	0,				CYCLES(3, 6, 0, 0, 0),		0)
+INSN(PUSH_CC,					push_cc,					IN_PRIMARY,							1,	0,				CYCLES(3, 0, 0, 0, 0),		0)
+INSN(PUSH_LONG,					push_long,					IN_PRIMARY,							3,	0,				CYCLES(3, 0, 0, 0, 0),		0)
+INSN(PUSH_IMMED,				push_immed,					IN_PRIMARY,							2,	0,				CYCLES(3, 0, 0, 0, 0),		0)
+
+INSN(POP_A,						pop_a,						IN_PRIMARY,							1,	0,				CYCLES(3, 0, 0, 0, 0),		0)
+INSN(POP_X,						pop_x,						IN_PRIMARY|IN_90,					1,	0,				CYCLES(3, 6, 0, 0, 0),		0)
+INSN(POP_CC,					pop_cc,						IN_PRIMARY,							1,	0,				CYCLES(3, 0, 0, 0, 0),		0)
+INSN(POP_LONG,					pop_long,					IN_PRIMARY,							3,	0,				CYCLES(3, 0, 0, 0, 0),		0)
+
+INSN(CALL_LONG,					call_long,					IN_PRIMARY|IN_92,					3,	INSN_CALL,		CYCLES(6, 0, 0, 10, 0),		0)
+INSN(CALL_REG_IND,				call_reg_ind,				IN_PRIMARY|IN_90,					1,	INSN_CALL,		CYCLES(5, 8, 0, 0, 0),		0)
+INSN(CALL_REG_IND_OFF_SHORT,	call_reg_ind_off_short,		IN_PRIMARY|IN_90|IN_91|IN_92,		2,	INSN_CALL,		CYCLES(6, 9, 10, 10, 0),	0)
+INSN(CALL_REG_IND_OFF_LONG,		call_reg_ind_off_long,		IN_PRIMARY|IN_90|IN_91|IN_92,		3,	INSN_CALL,		CYCLES(7, 10, 11, 11, 0),	0)
+
+INSN(CALLR_SHORT,				callr_short,				IN_PRIMARY|IN_92,					2,	INSN_CALL,		CYCLES(6, 0, 0, 10, 0),		0)
+INSN(CALL_FAR,					call_far,					IN_PRIMARY,							4,	INSN_CALL,		CYCLES(10, 0, 0, 0, 0),		0)
+INSN(RET,						ret,						IN_PRIMARY,							1,	INSN_RETURN,	CYCLES(6, 0, 0, 0, 0),		0)
+INSN(RETF,						retf,						IN_PRIMARY,							1,	INSN_RETURN,	CYCLES(8, 0, 0, 0, 0),		0)
+INSN(TRAP,						trap,						IN_PRIMARY,							1,	INSN_CALL,		CYCLES(10, 0, 0, 0, 0),		0)
+INSN(IRET,						iret,						IN_PRIMARY,							1,	INSN_RETURN,	CYCLES(9, 0, 0, 0, 0),		0)
+INSN(WFI,						wfi,						IN_PRIMARY,							1,	0,				CYCLES(2, 0, 0, 0, 0),		0)
@@ -22,8 +22,8 @@
 #include <stdio.h>
 #include <memory.h>
 #include <string.h>
-#include <conio.h>									// for kbhit()
 #include <stdlib.h>
+#include <stdarg.h>
 #include <time.h>
 #include <windows.h>
 
@@ -31,118 +31,391 @@
 #include "st7xfio.h"
 
 #include "breakpoints.h"
+#include "condition.h"
+#include "calls.h"
+#include "callgraph.h"
+#include "profile.h"
+#include "scoreboard.h"
+#include "stats.h"
 
 #include "processor_externs.h"
 
+#include "disasm.h"
+
 #include "application.h"
 
+#include "recompiler.h"
+
+#include "hooks.h"
+
+#include "simthread.h"
+
 #include "st7xsim.h"
 
-//
-//--------------------------------------------------------
-// simulator internals - breakpoint mechanism definitions
-//--------------------------------------------------------
-//
+#define RUN_BURST			4096		// instructions in between console commands when nothing needs the run loop every instruction
 
-// Execution breakpoints
-struct breakpoint ins_breakpoints[NUM_INS_BREAKPOINTS];
-int any_ins_breakpoint_enabled;							// to speed up code
+// forward function definitions
+unsigned char get_data_memory_byte_internal(struct machine *m, unsigned int address, int rawflag);
+unsigned char get_data_memory_byte_raw(struct machine *m, unsigned int address);
+unsigned char get_data_memory_byte(struct machine *m, unsigned int address);
 
-// Application Trigger/break point
-struct breakpoint application_breakpoint;
+void put_data_memory_byte_internal(struct machine *m, unsigned int address, unsigned char data, int rawflag);
+void put_data_memory_byte_raw(struct machine *m, unsigned int address, unsigned char data);
+void put_data_memory_byte(struct machine *m, unsigned int address, unsigned char data);
 
-// Data Breakpoint
-struct breakpoint data_breakpoints[NUM_DATA_BREAKPOINTS];
-int data_breakpoint_triggered_number;						// number of the data breakpoint that triggered the stop, -1 = none
-int any_data_breakpoint_enabled;						// to speed up code
+unsigned char get_prog_memory_byte(struct machine *m, unsigned int address);
+void get_instruction_bytes(struct machine *m, unsigned int address, unsigned char *bytes, unsigned int count);
 
-int in_function_call;
-unsigned int in_function_call_sp;
 
 //
-//--------------------------------------------------------
-// simulator internals - capture io writes to a file
-//--------------------------------------------------------
+//------------------------------------------------------------------------------
+// Beginning of functions
+//------------------------------------------------------------------------------
 //
-unsigned int capture_address;
-int capture_enable;
-FILE *capture_fp;
 
 //
-//--------------------------------------------------------
-// simulator internals - trace execution to a file
-//--------------------------------------------------------
+// The memory bus, what is behind each 256 byte page of the 24 bit address space.
+// Page 10 has its own memory, flash is the same in every bank and everything
+// else is page 00. Plain pages are read and written with one look here, only
+// the flagged ones (and pages the machine watches, see update_watched_pages())
+// go the long way round.
 //
-int run_log_enable;
-int run_log_triggered;
-FILE *run_log_fp;
+#define BUS_ROM				0x01		// firmware, writes invalidate the decode cache and get reported
+#define BUS_FLASH			0x02		// flash, writes invalidate the decode cache
+#define BUS_DEVICE			0x04		// simulated peripherals on it, see device_map
+
+struct bus_page {
+	unsigned char flags;
+	unsigned char memory;				// PROG_MEMORY, PROG2_MEMORY or FLASH_MEMORY
+	unsigned char device;				// device_map entry of a BUS_DEVICE page
+	unsigned char region;				// BUS_REGION_*, the accesses are counted by it
+};
+
+struct bus_page memory_bus[BUS_PAGES];
+
+// a bit for each address of a BUS_DEVICE page the application intercepts
+#define MAX_DEVICE_PAGES	16
+
+unsigned int device_map[MAX_DEVICE_PAGES][MEMORY_PAGE_SIZE / 32];
+
+#define DEVICE_ADDRESS(bus, address)	(((bus)->flags & BUS_DEVICE) && (device_map[(bus)->device][((address) >> 5) & ((MEMORY_PAGE_SIZE / 32) - 1)] & (1 << ((address) & 31))))
+
+// the machines watched_pages bit of an address
+#define WATCHED_WORD(m, address)		((m)->watched_pages[((address) >> (MEMORY_PAGE_SHIFT + 5)) & ((BUS_PAGES / 32) - 1)])
+#define WATCHED_BIT(address)			(1 << (((address) >> MEMORY_PAGE_SHIFT) & 31))
+
+#define PAGE_WATCHED(m, address)		(WATCHED_WORD(m, address) & WATCHED_BIT(address))
 
 //
-//--------------------------------------------------------
-// simulator internals - machine control and timing
-//--------------------------------------------------------
+// fill in the memory bus, the same for every machine so only done once
 //
+void build_memory_bus(void)
+{
+	static int built = 0;
+	unsigned int devices[MAX_APPLICATION_DEVICES];
+	struct bus_page *bus;
+	unsigned int page, address;
+	int x, count, num_device_pages;
+
+	if(built) {
+		return;
+	}
+	built = 1;
+
+	for(page = 0; page != BUS_PAGES; page++) {
+		bus = &memory_bus[page];
+		address = page << MEMORY_PAGE_SHIFT;
+
+		if(((address & 0x0000ffff) >= FLASH_START) && ((address & 0x0000ffff) <= FLASH_END)) {
+			bus->flags = BUS_FLASH;
+			bus->memory = FLASH_MEMORY;
+		} else {
+			bus->flags = ((address & 0x0000ffff) >= ROM_START) ? BUS_ROM : 0;
+			bus->memory = ((address & 0xffff0000) == 0x00100000) ? PROG2_MEMORY : PROG_MEMORY;
+		}
 
-// true if we are in run mode
-int running;
+		// the io registers share page 0000 with ram, it is counted on its own
+		if(bus->flags & BUS_FLASH) {
+			bus->region = BUS_REGION_FLASH;
+		} else if(bus->flags & BUS_ROM) {
+			bus->region = BUS_REGION_ROM;
+		} else if((address & 0x0000ffff) <= 0x000000ff) {
+			bus->region = BUS_REGION_SHORT;
+		} else if((address & 0x0000ffff) <= RAM_END) {
+			bus->region = BUS_REGION_RAM;
+		} else if(((address & 0x0000ffff) >= XIO_START) && ((address & 0x0000ffff) <= XIO_END)) {
+			bus->region = BUS_REGION_XIO;
+		} else {
+			bus->region = BUS_REGION_OTHER;
+		}
+	}
 
-int stop_reason;
+	// the peripherals
+	count = application_get_device_addresses(devices, MAX_APPLICATION_DEVICES);
+	num_device_pages = 0;
+	for(x = 0; x != count; x++) {
+		bus = &memory_bus[(devices[x] >> MEMORY_PAGE_SHIFT) & (BUS_PAGES - 1)];
+		if(!(bus->flags & BUS_DEVICE)) {
+			if(num_device_pages == MAX_DEVICE_PAGES) {
+				printf("*** Too many device pages, %08x not simulated\n", devices[x]);
+				continue;
+			}
+			bus->flags |= BUS_DEVICE;
+			bus->device = num_device_pages++;
+		}
+		device_map[bus->device][(devices[x] >> 5) & ((MEMORY_PAGE_SIZE / 32) - 1)] |= 1 << (devices[x] & 31);
+	}
+}
 
-int trace; // for selective printing
+//
+// mark the bus pages with an enabled data breakpoint or the capture address on them
+// has to be called whenever either changes
+//
+void update_watched_pages(struct machine *m)
+{
+	unsigned int page, last;
+	int x;
+
+	memset(m->watched_pages, 0, sizeof(m->watched_pages));
+
+	for(x = 0; x != m->num_data_breakpoints; x++) {
+		if(m->data_breakpoints[x].enable) {
+			// every page the range touches
+			page = (m->data_breakpoints[x].address >> MEMORY_PAGE_SHIFT) & (BUS_PAGES - 1);
+			last = (m->data_breakpoints[x].end_address >> MEMORY_PAGE_SHIFT) & (BUS_PAGES - 1);
+			while(1) {
+				WATCHED_WORD(m, page << MEMORY_PAGE_SHIFT) |= WATCHED_BIT(page << MEMORY_PAGE_SHIFT);
+				if(page >= last) {
+					break;
+				}
+				page++;
+			}
+		}
+	}
 
-int step_over;
+	if(m->capture_enable) {
+		WATCHED_WORD(m, m->capture_address) |= WATCHED_BIT(m->capture_address);
+	}
+}
 
-unsigned long instruction_count;
+//
+// make a new machine, everything starts out zeroed
+// returns NULL if there isn't enough memory
+//
+struct machine *new_machine(void)
+{
+	struct machine *m;
 
-int break_on_all_calls;
+	m = (struct machine *)calloc(1, sizeof(struct machine));
+	if(m == NULL) {
+		return(NULL);
+	}
 
-int enable_pre_instruction_register_display;
-int enable_post_instruction_register_display;
+	build_memory_bus();
 
-// timers
-unsigned long sim_time_ns;							// nanoseconds elapsed
+	m->in_function_call_pc = NO_STEP_OVER_PC;
+	m->profile = &m->profile_sink;
+	m->clock_frequency_hz = CLOCK_FREQUENCY;
 
-unsigned char print_buffer[1024]; // the processor prints stuff to here
+	m->caches = alloc_processor_caches();
+	m->ins_breakpoint_map = (unsigned int *)calloc(INS_BREAKPOINT_WORDS, sizeof(unsigned int));
+	m->scoreboard = (struct scoreboard_entry (*)[256])calloc(1, SCOREBOARD_SIZE);
+	if((m->caches == NULL) || (m->ins_breakpoint_map == NULL) || (m->scoreboard == NULL) || !alloc_memory_pages(m->prog_memory) || !alloc_memory_pages(m->prog2_memory) || !alloc_memory_pages(m->flash_memory)) {
+		free_machine(m);
+		return(NULL);
+	}
+	return(m);
+}
 
-unsigned int instruction_cycle_duration_ns;			// in nanoseconds
+//
+// done with a machine
+//
+void free_machine(struct machine *m)
+{
+	if(m->fork_base != NULL) {
+		free_machine(m->fork_base);
+	}
+	if(m->block_check_machine != NULL) {
+		free_machine(m->block_check_machine);
+	}
+	free_memory_pages(m->prog_memory);
+	free_memory_pages(m->prog2_memory);
+	free_memory_pages(m->flash_memory);
+	free_processor_caches(m->caches);
+	free(m->ins_breakpoint_map);
+	free(m->scoreboard);
+	free(m->data_breakpoints);
+	free(m->ins_conditions);
+	stop_call_log(m);
+	stop_profile(m);
+	stop_callgraph(m);
+	free(m);
+}
 
-// forward function definitions
-unsigned char get_data_memory_byte_internal(unsigned int address, int rawflag);
-unsigned char get_data_memory_byte_raw(unsigned int address);
-unsigned char get_data_memory_byte(unsigned int address);
+//
+// make dst the same tag as src, registers, memory, peripherals and all
+//
+// the memory is shared with src until one of them writes to it (see pages.cpp),
+// so this is cheap enough to do for every command of a batch.
+// dst keeps its own caches, capture and run log files, call log, profiles, host stats, scoreboard, fork base and
+// block check machine, the breakpoints are copied into its own
+//
+void fork_machine(struct machine *dst, struct machine *src)
+{
+	struct processor_caches *caches;
+	struct machine *fork_base, *block_check_machine;
+	struct breakpoint *data_breakpoints;
+	struct ins_condition *ins_conditions;
+	struct call_event *call_log;
+	struct profile_counter *profile;
+	struct callgraph *callgraph;
+	struct host_stats stats, run_stats;
+	struct scoreboard_entry (*scoreboard)[256];
+	FILE *capture_fp, *run_log_fp;
+	unsigned int capture_address, *ins_breakpoint_map, num_ins_breakpoints, call_log_size, call_log_head, profile_mask;
+	int recompiled_state, capture_enable, run_log_enable, run_log_triggered, ins_breakpoints_changed;
+	int num_data_breakpoints, max_data_breakpoints, num_ins_conditions, max_ins_conditions;
+
+	// before the memory changes, what dst has cached may still be good
+	fork_processor_caches(dst, src);
+
+	share_memory_pages(dst->prog_memory, src->prog_memory);
+	share_memory_pages(dst->prog2_memory, src->prog2_memory);
+	share_memory_pages(dst->flash_memory, src->flash_memory);
+
+	// dst's shadow call stack ends where dst is now
+	if(dst->callgraph != NULL) {
+		close_callgraph_stack(dst);
+	}
 
-void put_data_memory_byte_internal(unsigned int address, unsigned char data, int rawflag);
-void put_data_memory_byte_raw(unsigned int address, unsigned char data);
-void put_data_memory_byte(unsigned int address, unsigned char data);
+	caches = dst->caches;
+	recompiled_state = dst->recompiled_state;
+	capture_address = dst->capture_address;
+	capture_enable = dst->capture_enable;
+	capture_fp = dst->capture_fp;
+	run_log_enable = dst->run_log_enable;
+	run_log_triggered = dst->run_log_triggered;
+	run_log_fp = dst->run_log_fp;
+	fork_base = dst->fork_base;
+	block_check_machine = dst->block_check_machine;
+	call_log = dst->call_log;
+	call_log_size = dst->call_log_size;
+	call_log_head = dst->call_log_head;
+	profile = dst->profile;
+	profile_mask = dst->profile_mask;
+	callgraph = dst->callgraph;
+	stats = dst->stats;
+	run_stats = dst->run_stats;
+	scoreboard = dst->scoreboard;
+	ins_breakpoint_map = dst->ins_breakpoint_map;
+	num_ins_breakpoints = dst->num_ins_breakpoints;
+	ins_breakpoints_changed = dst->ins_breakpoints_changed;
+	ins_conditions = dst->ins_conditions;
+	num_ins_conditions = dst->num_ins_conditions;
+	max_ins_conditions = dst->max_ins_conditions;
+	data_breakpoints = dst->data_breakpoints;
+	num_data_breakpoints = dst->num_data_breakpoints;
+	max_data_breakpoints = dst->max_data_breakpoints;
+
+	memcpy(dst, src, sizeof(struct machine));
+
+	dst->caches = caches;
+	dst->recompiled_state = recompiled_state;
+	dst->capture_address = capture_address;
+	dst->capture_enable = capture_enable;
+	dst->capture_fp = capture_fp;
+	dst->run_log_enable = run_log_enable;
+	dst->run_log_triggered = run_log_triggered;
+	dst->run_log_fp = run_log_fp;
+	dst->fork_base = fork_base;
+	dst->block_check_machine = block_check_machine;
+	dst->call_log = call_log;
+	dst->call_log_size = call_log_size;
+	dst->call_log_head = call_log_head;
+	dst->profile = profile;
+	dst->profile_mask = profile_mask;
+	dst->callgraph = callgraph;
+	dst->stats = stats;
+	dst->run_stats = run_stats;
+	dst->scoreboard = scoreboard;
+	dst->ins_breakpoint_map = ins_breakpoint_map;
+	dst->num_ins_breakpoints = num_ins_breakpoints;
+	dst->ins_breakpoints_changed = ins_breakpoints_changed;
+	dst->ins_conditions = ins_conditions;
+	dst->num_ins_conditions = num_ins_conditions;
+	dst->max_ins_conditions = max_ins_conditions;
+	dst->data_breakpoints = data_breakpoints;
+	dst->num_data_breakpoints = num_data_breakpoints;
+	dst->max_data_breakpoints = max_data_breakpoints;
+
+	copy_ins_breakpoints(dst, src);
+	copy_data_breakpoints(dst, src);
+
+	if(dst->callgraph != NULL) {
+		open_callgraph_stack(dst);
+	}
 
-unsigned char get_prog_memory_byte(unsigned int address);
+	// commands were for src's run
+	dst->sim_command_head = 0;
+	dst->sim_command_tail = 0;
 
+	dst->decoded = NULL;
+	dst->operand_count = 0;
+}
 
 //
-//------------------------------------------------------------------------------
-// Beginning of functions
-//------------------------------------------------------------------------------
+// console output of a machine, batch workers keep quiet
+// returns what vprintf() does, 0 if nothing went out
 //
+int sim_printf(struct machine *m, const char *format, ...)
+{
+	va_list args;
+	int length;
+
+	if(m->quiet) {
+		return(0);
+	}
 
+	va_start(args, format);
+	length = vprintf(format, args);
+	va_end(args);
+
+	return(length);
+}
 
 //
-// called by the processor module to print stuff to whereever
+// turn the processors decode record into text
 //
-void simulator_output(void)
+int format_decode_record(struct machine *m, char *buffer, int size)
 {
-	int stupid;
+	unsigned int *args;
+
+	if(m->decode_record.format == NULL) {
+		buffer[0] = 0;
+		return(0);
+	}
+
+	args = m->decode_record.args;
+	return(snprintf(buffer, size, m->decode_record.format, args[0], args[1], args[2], args[3], args[4], args[5], args[6], args[7]));
+}
 
-	if(trace) {
 //
-// for debug only
-		if(print_buffer[0] == 0) { // so i can catch empty buffer in output guy
-			stupid = 1;
+// called by the processor module to print stuff to whereever
+//
+// the processor only leaves a decode record behind, so the formatting
+// is only paid for when somebody is actually looking, never on a quiet machine
+//
+void simulator_output(struct machine *m)
+{
+	if(m->trace && !m->quiet) {
+		if(format_decode_record(m, (char *)m->print_buffer, sizeof(m->print_buffer)) == 0) {
+			return;
 		}
-		printf((char *)print_buffer);
+		m->stats.trace_bytes += sim_printf(m, "%s", (char *)m->print_buffer);
 	
-		if(run_log_enable) {
-			if(run_log_triggered) {
-				fprintf(run_log_fp, (char *)print_buffer);
+		if(m->run_log_enable) {
+			if(m->run_log_triggered) {
+				m->stats.trace_bytes += fprintf(m->run_log_fp, "%s", (char *)m->print_buffer);
 			}
 		}
 	}
@@ -151,88 +424,56 @@ void simulator_output(void)
 //
 // Read a byte from the data memory
 // 
-unsigned char get_data_memory_byte_internal(unsigned int address, int rawflag)
+unsigned char get_data_memory_byte_internal(struct machine *m, unsigned int address, int rawflag)
 {
-	register int x;
-	unsigned char application_value;
-
-	if(!rawflag) {
-		// Check for a data breakpoint
-		if(any_data_breakpoint_enabled) {
-			x = 0;
-			while(x != NUM_DATA_BREAKPOINTS) {
-				if(data_breakpoints[x].enable) {
-					if((address == data_breakpoints[x].address) && (data_breakpoints[x].type & DBRK_TYPE_READ)) {
-						// Break triggered
-						data_breakpoints[x].triggered = 1;
-						data_breakpoint_triggered_number = x;	
-					}
-				}
-				x++;
-			}
-		}
-	}
+	unsigned char data;
+	struct bus_page *bus;
 
-	//
-	// call application specific so it can simulate io space peripherals
-	//
-	if(application_get_data_memory_byte(address, &application_value)) {
-		return(application_value);
+	bus = &memory_bus[(address >> MEMORY_PAGE_SHIFT) & (BUS_PAGES - 1)];
+
+	m->stats.bus_reads[bus->region]++;
+
+	// plain memory nobody is watching, ram, rom and flash alike
+	if(!(bus->flags & BUS_DEVICE) && (rawflag || !PAGE_WATCHED(m, address))) {
+		return(get_memory_byte(m->memory[bus->memory], address));
 	}
 
 	//
-	// memory emulation
+	// call application specific so it can simulate io space peripherals,
+	// otherwise memory emulation, the bus page says which memory
 	//
-
-	// just a check
-//	if(((address & 0x0000ffff) >= XIO_START) && ((address & 0x0000ffff) <= XIO_END)) {
-//		printf("\n*** READING FROM IO REGION: pc=%08x, address=%08x\n", register_pc, address);
-//	}
-
-	// just a check
-//	if(((address & 0x0000ffff) >= IO_START) && ((address & 0x0000ffff) <= IO_END)) {
-//		printf("\n*** READING FROM IO REGION: pc=%08x, address=%08x\n", register_pc, address);
-//	}
-
-	// just a check
-//	if(((address & 0x0000ffff) >= RAM_START) && ((address & 0x0000ffff) <= RAM_END)) {
-//		printf("\n*** READING FROM RAM REGION: pc=%08x, address=%08x\n", register_pc, address);
-//	}
-
-	// Flash
-	if(((address & 0x0000ffff) >= FLASH_START) && ((address & 0x0000ffff) <= FLASH_END)) {
-		// Return a byte from FLASH
-//		if(!rawflag) {
-//		printf("\n*** READING FROM FLASH: pc=%08x, address=%08x\n", register_pc, address);
-//		}
-
-		return(flash_memory[address]);
+	if(DEVICE_ADDRESS(bus, address)) {
+		m->stats.device_calls++;
+		if(!application_get_data_memory_byte(m, address, &data)) {
+			data = get_memory_byte(m->memory[bus->memory], address);
+		}
+	} else {
+		data = get_memory_byte(m->memory[bus->memory], address);
 	}
 
-	// ram and I/O
-	if((address & 0xffff0000) == 0x00100000) {
-		// page 10
-		return(prog2_memory[address & 0x0000ffff]);
-	} else {
-		// page 00, just return the byte in the data memory
-		return(prog_memory[address & 0x0000ffff]);
+	// Check for a data breakpoint
+	if(!rawflag && PAGE_WATCHED(m, address)) {
+		m->stats.data_breakpoint_checks++;
+		check_data_breakpoints(m, address, DBRK_TYPE_READ, data, data);
 	}
+
+	return(data);
 }
 
 //
 // read a raw byte, is not subject to breakpoints
 //
-unsigned char get_data_memory_byte_raw(unsigned int address)
+unsigned char get_data_memory_byte_raw(struct machine *m, unsigned int address)
 {
-	return(get_data_memory_byte_internal(address, 1));
+	return(get_data_memory_byte_internal(m, address, 1));
 }
 
 //
 // Read a processed byte from the memory, subject to breakpoints
 //
-unsigned char get_data_memory_byte(unsigned int address)
+unsigned char get_data_memory_byte(struct machine *m, unsigned int address)
 {
-	return(get_data_memory_byte_internal(address, 0));
+	return(get_data_memory_byte_internal(m, address, 0));
 }
 
 //
@@ -240,39 +481,54 @@ unsigned char get_data_memory_byte(unsigned int address)
 // can set global abnormal termination flag
 // and clear the simulations running flag
 //
-unsigned char get_prog_memory_byte(unsigned int address)
+unsigned char get_prog_memory_byte(struct machine *m, unsigned int address)
 {
 	// check
 	if(((address & 0x0000ffff) >= XIO_START) && ((address & 0x0000ffff) <= XIO_END)) {
-		printf("\n*** FETCHING FROM IO REGION: pc=%08x, address=%08x previous_pc=%08x\n", register_pc, address, previous_register_pc);
-		running = 0;
-		aabnormal_termination = 1;
+		sim_printf(m, "\n*** FETCHING FROM IO REGION: pc=%08x, address=%08x previous_pc=%08x\n", m->register_pc, address, m->previous_register_pc);
+		m->running = 0;
+		m->aabnormal_termination = 1;
 		return(0);
 	}
 
 	// check
 	if(((address & 0x0000ffff) >= IO_START) && ((address & 0x0000ffff) <= IO_END)) {
-		printf("\n*** FETCHING FROM IO REGION: pc=%08x, address=%08x previous_pc=%08x\n", register_pc, address, previous_register_pc);
-		aabnormal_termination = 1;
-		running = 0;
+		sim_printf(m, "\n*** FETCHING FROM IO REGION: pc=%08x, address=%08x previous_pc=%08x\n", m->register_pc, address, m->previous_register_pc);
+		m->aabnormal_termination = 1;
+		m->running = 0;
 		return(0);
 	}
 
 	// check
 	if(((address & 0x0000ffff) >= RAM_START) && ((address & 0x0000ffff) <= RAM_END)) {
-		printf("\n*** FETCHING FROM RAM REGION: pc=%08x, address=%08x previous_pc=%08x\n", register_pc, address, previous_register_pc);
-		aabnormal_termination = 1;
-		running = 0;
+		sim_printf(m, "\n*** FETCHING FROM RAM REGION: pc=%08x, address=%08x previous_pc=%08x\n", m->register_pc, address, m->previous_register_pc);
+		m->aabnormal_termination = 1;
+		m->running = 0;
 		return(0);
 	}
 	
 	// flash, ram and io
 	if((address & 0xffff0000) == 0x00100000) {
 		// fetch from segment 1 (page 10)
-		return(prog2_memory[address & 0x0000ffff]);
+		return(get_memory_byte(m->prog2_memory, address & 0x0000ffff));
 	} else {
 		// page 00
-		return(prog_memory[address & 0x0000ffff]);
+		return(get_memory_byte(m->prog_memory, address & 0x0000ffff));
+	}
+}
+
+//
+// read count bytes of the instruction stream from address on, as the memory bus has them
+// but without the peripherals and data breakpoints, operands aren't data accesses
+//
+void get_instruction_bytes(struct machine *m, unsigned int address, unsigned char *bytes, unsigned int count)
+{
+	struct bus_page *bus;
+
+	while(count) {
+		bus = &memory_bus[(address >> MEMORY_PAGE_SHIFT) & (BUS_PAGES - 1)];
+		*bytes++ = get_memory_byte(m->memory[bus->memory], address++);
+		count--;
 	}
 }
 
@@ -283,28 +539,30 @@ unsigned char get_prog_memory_byte(unsigned int address)
 //  data capture
 //  emulated peripherals
 //
-void put_data_memory_byte_internal(unsigned int address, unsigned char data, int rawflag)
+void put_data_memory_byte_internal(struct machine *m, unsigned int address, unsigned char data, int rawflag)
 {
-	register int x;
-
-	if(!rawflag) {
-		x = 0;
-		while(x != NUM_DATA_BREAKPOINTS) {
-			if(data_breakpoints[x].enable) {
-				if((address == data_breakpoints[x].address) && (data_breakpoints[x].type & DBRK_TYPE_WRITE)) {
-					// Break triggered
-					data_breakpoints[x].triggered = 1;
-					data_breakpoint_triggered_number = x;
-				}
-			}
-			x++;
-		}
+	struct bus_page *bus;
+
+	bus = &memory_bus[(address >> MEMORY_PAGE_SHIFT) & (BUS_PAGES - 1)];
+
+	m->stats.bus_writes[bus->region]++;
+
+	// plain ram nobody is watching
+	if(!bus->flags && (rawflag || !PAGE_WATCHED(m, address))) {
+		put_memory_byte(m->memory[bus->memory], address, data);
+		return;
+	}
+
+	if(!rawflag && PAGE_WATCHED(m, address)) {
+		// Check for a data breakpoint, against what is there now
+		m->stats.data_breakpoint_checks++;
+		check_data_breakpoints(m, address, DBRK_TYPE_WRITE, get_memory_byte(m->memory[bus->memory], address), data);
 
 		// check for capture
-		if(capture_enable) {
-			if(address == capture_address) {
+		if(m->capture_enable) {
+			if(address == m->capture_address) {
 				// write the data to the file
-				fprintf(capture_fp, "%02x\n", data);
+				fprintf(m->capture_fp, "%02x\n", data);
 			}
 		}
 	}
@@ -312,140 +570,153 @@ void put_data_memory_byte_internal(unsigned int address, unsigned char data, int
 	//
 	// call application specific so it can simulate io space peripherals
 	//
-	if(application_put_data_memory_byte(address, data)) {
-		return;
+	if(DEVICE_ADDRESS(bus, address)) {
+		m->stats.device_calls++;
+		if(application_put_data_memory_byte(m, address, data)) {
+			return;
+		}
 	}
 
 	//
 	// simulated memory
 	//
-	if(((address & 0x0000ffff) >= XIO_START) && ((address & 0x0000ffff) <= XIO_END)) {
-//		printf("\n*** WRITE TO XIO REGION DETECTED: pc=%08x, address=%08x, data=%02x\n", register_pc, address, data);
-	}
-
-	if(((address & 0x0000ffff) >= IO_START) && ((address & 0x0000ffff) <= IO_END)) {
-//		printf("\n*** WRITE TO IO REGION DETECTED: pc=%08x, address=%08x, data=%02x\n", register_pc, address, data);
-	}
-
-	if(((address & 0x0000ffff) >= RAM_START) && ((address & 0x0000ffff) <= RAM_END)) {
-//		printf("\n*** WRITE TO RAM REGION DETECTED: pc=%08x, address=%08x, data=%02x\n", register_pc, address, data);
-	}
 
-	if(((address & 0x0000ffff) >= FLASH_START) && ((address & 0x0000ffff) <= FLASH_END)) {
-//		if(!rawflag) {
-//			printf("\n*** WRITE TO FLASH REGION DETECTED: pc=%08x, address=%08x, data=%02x\n", register_pc, address, data);
-//		}
-		// put the byte in the data memory
-		flash_memory[address] = data;
-		return;
+	// anything from here up may be cached firmware
+	if(bus->flags & (BUS_ROM | BUS_FLASH)) {
+		invalidate_decode_cache_address(m, address);
 	}
 
 	// catch writes to read-only space
-	if((address & 0x0000ffff) >= ROM_START) {
-//		if(!rawflag) {
-			printf("\n*** WRITE TO READ ONLY REGION DETECTED: pc=%08x, address=%08x, data=%02x\n", register_pc, address, data);
+	if(bus->flags & BUS_ROM) {
+		if(!rawflag) {	// raw writes are patches, they know what they are doing
+			sim_printf(m, "\n*** WRITE TO READ ONLY REGION DETECTED: pc=%08x, address=%08x, data=%02x\n", m->register_pc, address, data);
 //			return;
-//		}
+		}
 	}
 
-	if((address & 0xffff0000) == 0x00100000) {
-		// page 10
-		// put the byte in the data memory
-		prog2_memory[address & 0x0000ffff] = data;
-	} else {
-		// page 0
-		// put the byte in the data memory
-		prog_memory[address & 0x0000ffff] = data;
-	}
+	// put the byte in the data memory, flash has its own
+	put_memory_byte(m->memory[bus->memory], address, data);
 }
 
 //
 // write a byte to data memory, not subject to breakpoints
 //
-void put_data_memory_byte_raw(unsigned int address, unsigned char data)
+void put_data_memory_byte_raw(struct machine *m, unsigned int address, unsigned char data)
 {
-	put_data_memory_byte_internal(address, data, 1); // raw
+	put_data_memory_byte_internal(m, address, data, 1); // raw
 }
 
 //
 // write a byte to data memory, not subject to breakpoints
 //
-void put_data_memory_byte(unsigned int address, unsigned char data)
+void put_data_memory_byte(struct machine *m, unsigned int address, unsigned char data)
 {
-	put_data_memory_byte_internal(address, data, 0);	// cooked
+	put_data_memory_byte_internal(m, address, data, 0);	// cooked
 }
 
 //
 // simulation time functions
 //
-void reset_sim_time(void)
+// The clock counts instruction cycles in 64 bits (a 32 bit count of ns ran
+// out after 4.3 seconds of simulated time), what an instruction takes comes
+// from the instruction spec (st7xisa.h). Time in ns is only worked out for
+// display, at whatever clock frequency the machine is set to.
+//
+void reset_sim_time(struct machine *m)
 {
-	unsigned int clock_frequency_hz;					// in hertz
-	unsigned int clocks_per_instruction_cycle;			// 
-	float ins_dur_f;
-	double ins_dur_ns;
-	float period_secs;
+	// reset timers
+	m->sim_cycles = 0;
 
-	// Establish simulation timebase
-	clock_frequency_hz = CLOCK_FREQUENCY;
-	clocks_per_instruction_cycle = CLOCKS_PER_INSTRUCTION_CYCLE;
-	period_secs = (float)(1.0 / clock_frequency_hz);
+	printf("*** Simulation Time Reset ***\n");
+}
 
-	ins_dur_f = period_secs * clocks_per_instruction_cycle;	// .000000250
-	ins_dur_ns = ins_dur_f * 1000000000.0; 	// 250
-	instruction_cycle_duration_ns = ins_dur_ns;
+//
+// increment the simulation clock by some number of instruction cycles, once per instruction
+//
+void inc_sim_time(struct machine *m, unsigned int quantity)
+{
+	struct profile_counter *counter;
 
-	// reset timers
-	sim_time_ns = 0;
+	m->sim_cycles += quantity;
 
-	printf("*** Simulation Time Reset ***\n");
+	// it goes to the sink when the profiler is off
+	counter = &m->profile[PROFILE_INDEX(m->previous_register_pc) & m->profile_mask];
+	counter->executions++;
+	counter->cycles += quantity;
 }
 
 //
-// increment the simulation clock by some number of instruction cycles
+// more cycles for the instruction being executed, a conditional branch that went
 //
-void inc_sim_time(unsigned int quantity)
+void inc_sim_time_branch(struct machine *m, unsigned int quantity)
 {
-	if(!quantity) {
-		fprintf(stderr, "ERROR: instruction had 0 duration specified\n");
-	}
-	sim_time_ns += (quantity*instruction_cycle_duration_ns);
+	m->sim_cycles += quantity;
+
+	// the instruction was already counted by inc_sim_time(), just the cycles
+	m->profile[PROFILE_INDEX(m->previous_register_pc) & m->profile_mask].cycles += quantity;
+}
+
+//
+// set the simulation clock, in instruction cycles
+//
+void set_sim_time(struct machine *m, unsigned long long cycles)
+{
+	m->sim_cycles = cycles;
 }
 
 //
-// set the simulation clock
+// get the simulation clock, in instruction cycles
 //
-void set_sim_time(unsigned long time)
+unsigned long long get_sim_time(struct machine *m)
 {
-	sim_time_ns = time;
+	return(m->sim_cycles);
 }
 
 //
-// get the simulation clock
+// how long cycles instruction cycles take at the machine's clock frequency
 //
+// whole seconds and the rest are done apart so nothing overflows before the
+// count itself would
+//
+unsigned long long cycles_to_ns(struct machine *m, unsigned long long cycles)
+{
+	unsigned long long cycles_per_second;
 
-unsigned long get_sim_time(void)
+	cycles_per_second = m->clock_frequency_hz / CLOCKS_PER_INSTRUCTION_CYCLE;
+
+	return(((cycles / cycles_per_second) * 1000000000) + (((cycles % cycles_per_second) * 1000000000) / cycles_per_second));
+}
+
+//
+// run the cpu at another clock frequency, only changes what the cycles come to in ns
+// returns 0 if the frequency can't be used
+//
+int set_clock_frequency(struct machine *m, unsigned int frequency_hz)
 {
-	return(sim_time_ns);
+	if(frequency_hz < CLOCKS_PER_INSTRUCTION_CYCLE) {
+		return(0);
+	}
+	m->clock_frequency_hz = frequency_hz;
+	return(1);
 }
 
 //
 // Reset the simulator
 //
-void reset_simulator(void)
+void reset_simulator(struct machine *m)
 {
 	// Clear Ram and I/O
-	memset(&prog_memory[XIO_START], 0x00, (XIO_END-XIO_START));
+	fill_memory_pages(m->prog_memory, XIO_START, (XIO_END-XIO_START), 0x00);
 
-	data_breakpoint_triggered_number = -1;
+	m->data_breakpoint_triggered_number = -1;
 
-	reset_sim_time();
+	reset_sim_time(m);
 
 	// reset application specific stuff
-	application_reset();
+	application_reset(m);
 
 	// load initial io values
-	application_load_io_and_memory_initial_values();
+	application_load_io_and_memory_initial_values(m);
 
 	printf("*** Simulator Reset ***\n");
 }
@@ -455,11 +726,13 @@ void reset_simulator(void)
 //
 // what about ram and io?
 //
-void clear_memory(void)
+void clear_memory(struct machine *m)
 {
-	memset(prog_memory, 0, MEMSIZE);
-	memset(prog2_memory, 0, MEMSIZE);
-	memset(flash_memory, 0x0, MEMSIZE);	// set flash to 0x0
+	fill_memory_pages(m->prog_memory, 0, MEMSIZE, 0);
+	fill_memory_pages(m->prog2_memory, 0, MEMSIZE, 0);
+	fill_memory_pages(m->flash_memory, 0, MEMSIZE, 0x0);	// set flash to 0x0
+
+	invalidate_decode_cache(m);
 
 	printf("*** Memory Cleared ***\n");
 }
@@ -467,49 +740,49 @@ void clear_memory(void)
 //
 // Display/log processor registers
 //
-void display_registers(int pre_post_flag)
+void display_registers(struct machine *m, int pre_post_flag)
 {
 	if(pre_post_flag == POST) {
 
-		if(trace) {
-			printf("Post: ");
+		if(m->trace) {
+			m->stats.trace_bytes += sim_printf(m, "Post: ");
 
-			if(run_log_enable) {
-				if(run_log_triggered) {
-					fprintf(run_log_fp, "Post: ");
+			if(m->run_log_enable) {
+				if(m->run_log_triggered) {
+					m->stats.trace_bytes += fprintf(m->run_log_fp, "Post: ");
 				}
 			}
 		}
 	} else if(pre_post_flag == PRE) {
-		if(trace) {
-			printf("\nPre: ");
+		if(m->trace) {
+			m->stats.trace_bytes += sim_printf(m, "\nPre: ");
 
-			if(run_log_enable) {
-				if(run_log_triggered) {
-					fprintf(run_log_fp, "\nPre: ");
+			if(m->run_log_enable) {
+				if(m->run_log_triggered) {
+					m->stats.trace_bytes += fprintf(m->run_log_fp, "\nPre: ");
 				}
 			}
 		}
 
 	} else {
-		if(trace) {
-			printf("Current: ");
+		if(m->trace) {
+			m->stats.trace_bytes += sim_printf(m, "Current: ");
 
-			if(run_log_enable) {
-				if(run_log_triggered) {
-					fprintf(run_log_fp, "Current: ");
+			if(m->run_log_enable) {
+				if(m->run_log_triggered) {
+					m->stats.trace_bytes += fprintf(m->run_log_fp, "Current: ");
 				}
 			}
 		}
 	}
 
-	if(trace) {
-		printf("PC=%08x, CC=%02x A=%02x X=%02x Y=%02x SP=%04x Simtime=%uns\n",
-			register_pc,register_cc, register_a, register_x, register_y, register_sp, sim_time_ns);
-		if(run_log_enable) {
-			if(run_log_triggered) {
-				fprintf(run_log_fp, "PC=%08x, CC=%02x A=%02x X=%02x Y=%02x SP=%04x Simtime=%uns\n",
-					register_pc,register_cc, register_a, register_x, register_y, register_sp, sim_time_ns);
+	if(m->trace) {
+		m->stats.trace_bytes += sim_printf(m, "PC=%08x, CC=%02x A=%02x X=%02x Y=%02x SP=%04x Simtime=%lluns\n",
+			m->register_pc,m->register_cc, m->register_a, m->register_x, m->register_y, m->register_sp, cycles_to_ns(m, m->sim_cycles));
+		if(m->run_log_enable) {
+			if(m->run_log_triggered) {
+				m->stats.trace_bytes += fprintf(m->run_log_fp, "PC=%08x, CC=%02x A=%02x X=%02x Y=%02x SP=%04x Simtime=%lluns\n",
+					m->register_pc,m->register_cc, m->register_a, m->register_x, m->register_y, m->register_sp, cycles_to_ns(m, m->sim_cycles));
 			}
 		}
 	}
@@ -518,7 +791,7 @@ void display_registers(int pre_post_flag)
 //
 // Displays processor data memory
 //
-void display_data_memory(unsigned int address, unsigned short size)
+void display_data_memory(struct machine *m, unsigned int address, unsigned short size)
 {
 	unsigned int bytes;
 
@@ -526,7 +799,7 @@ void display_data_memory(unsigned int address, unsigned short size)
 
 	printf("%08x: ", address);
 	while(size--) {
-		printf("%02x ", get_data_memory_byte_raw(address));
+		printf("%02x ", get_data_memory_byte_raw(m, address));
 		bytes++;
 		address++;
 		if(bytes == 16) {
@@ -541,275 +814,461 @@ void display_data_memory(unsigned int address, unsigned short size)
 // logs processor data memory
 // be sure run log file is opened!
 //
-void display_data_memory_to_run_log(unsigned int address, unsigned short size)
+void display_data_memory_to_run_log(struct machine *m, unsigned int address, unsigned short size)
 {
 	unsigned int bytes;
 
 	bytes = 0;
 
-	fprintf(run_log_fp, "%08x: ", address);
+	fprintf(m->run_log_fp, "%08x: ", address);
 	while(size--) {
-		fprintf(run_log_fp, "%02x ", get_data_memory_byte_raw(address));
+		fprintf(m->run_log_fp, "%02x ", get_data_memory_byte_raw(m, address));
 		bytes++;
 		address++;
 		if(bytes == 16) {
-			fprintf(run_log_fp, "\n%08x: ", address);
+			fprintf(m->run_log_fp, "\n%08x: ", address);
 			bytes = 0;
 		}
 	}
-	fprintf(run_log_fp, "\n");
+	fprintf(m->run_log_fp, "\n");
 }
 
 //
 // Step to the next instruction
 //
-void step(void)
+void step(struct machine *m)
 {
 	// display registers before the instruction
-	if(enable_pre_instruction_register_display) {
-		display_registers(PRE);
+	if(m->enable_pre_instruction_register_display) {
+		display_registers(m, PRE);
 	} else {
 		// just print the program counter and a space
-		if(trace) {
-			printf("%08x: ", register_pc);
-			if(run_log_enable) {
-				if(run_log_triggered) {
-					fprintf(run_log_fp, "%08x: ", register_pc);
+		if(m->trace) {
+			m->stats.trace_bytes += sim_printf(m, "%08x: ", m->register_pc);
+			if(m->run_log_enable) {
+				if(m->run_log_triggered) {
+					m->stats.trace_bytes += fprintf(m->run_log_fp, "%08x: ", m->register_pc);
 				}
 			}
 		}
 	}
 
-	while(execute()) {	// returns 0 when full instruction is complete or abnormal termination occurs
-		;
-	}
+	execute(m);
 
-	instruction_count++;
+	m->instruction_count++;
 
 	// display registers after the instruction
-	if(enable_post_instruction_register_display) {
-		display_registers(POST);
+	if(m->enable_post_instruction_register_display) {
+		display_registers(m, POST);
 	}
 }
 
 //
-// run the code until breakpoint hit, user termination by keypress or abnormal event occurs
-// sets stop_reason
+// tell the block cache every address the run loop has to see the pc at
+//
+// the instruction breakpoints and pc hooks it reads out of their maps itself
 //
-int run_internals(void)
+void update_block_splits(struct machine *m)
 {
-	int x, save_trace;
-	unsigned int beginning_tick_count, ending_tick_count;
-
-	// determine if there are any breakpoints enabled and set the global flags accordingly
-	// (for code speed-up)
-	any_ins_breakpoint_enabled = 0;
-	x = 0;
-	while(x < NUM_INS_BREAKPOINTS) {
-		if(ins_breakpoints[x].enable) {
-			any_ins_breakpoint_enabled = 1;
-		}
-		x++;
+	unsigned int splits[1];
+	int count;
+
+	count = 0;
+
+	if(m->application_breakpoint.enable) {
+		splits[count++] = m->application_breakpoint.address;
 	}
 
-	any_data_breakpoint_enabled = 0;
-	x = 0;
-	while(x < NUM_DATA_BREAKPOINTS) {
-		if(data_breakpoints[x].enable) {
-			any_data_breakpoint_enabled = 1;
-		}
-		x++;
+	set_block_splits(m, splits, count);
+
+	if(m->ins_breakpoints_changed) {
+		update_block_split_map(m);
+		m->ins_breakpoints_changed = 0;
 	}
+}
+
+//
+// The run loop, compiled once for each set of things it has to look at, so a
+// run with nothing armed doesn't pay for the checks:
+//
+//	RUN_LEAN		nothing armed, runs instructions (or blocks) in bursts and
+//					only looks for console commands in between
+//	RUN_PC_CHECKS	instruction breakpoints, pc hooks, the application
+//					breakpoint or the return address of a call being stepped
+//					over, the pc is looked at before every instruction
+//	RUN_FULL		data breakpoints, step over, break on calls, trace or
+//					register display, everything every instruction
+//
+// run_features() picks one from what is armed when the run starts, and again
+// when a console command changes it
+//
+#define RUN_PC_CHECKS		0x01
+#define RUN_DEBUG			0x02
+
+#define RUN_LEAN			0
+#define RUN_FULL			(RUN_PC_CHECKS | RUN_DEBUG)
+
+//
+// 1 if the trace or the register display wants to see every instruction,
+// a quiet machine has nobody to show them to
+//
+int showing_instructions(struct machine *m)
+{
+	return(!m->quiet && (m->trace || m->enable_pre_instruction_register_display || m->enable_post_instruction_register_display));
+}
 
-	// set the start time
-	beginning_tick_count = GetTickCount();
+//
+// which run loop this machine needs
+//
+unsigned int run_features(struct machine *m)
+{
+	// a call being stepped over runs without trace, all it needs is the return address
+	if(m->num_data_breakpoints || m->break_on_calls || (m->trace && !m->quiet) ||
+		(!m->in_function_call && (m->step_over || showing_instructions(m)))) {
+		return(RUN_FULL);
+	}
+	if(m->in_function_call || m->num_ins_breakpoints || num_pc_hooks || m->application_breakpoint.enable) {
+		return(RUN_PC_CHECKS);
+	}
+	return(RUN_LEAN);
+}
 
-	running = 1;
+//
+// step over: a call was just executed, the callee runs without trace and as
+// fast as it can until it is back at the return address at the stack level of
+// the call, stop is for a single step over
+//
+void enter_function_call(struct machine *m, int stop)
+{
+	unsigned int sp;
 
-	instruction_count = 0;
+	// the return address the call pushed
+	sp = m->register_sp;
+	if((m->previous_register_sp - sp) == 3) {
+		m->in_function_call_pc = (get_data_memory_byte_raw(m, sp + 1) << 16) | (get_data_memory_byte_raw(m, sp + 2) << 8) | get_data_memory_byte_raw(m, sp + 3);
+	} else {
+		m->in_function_call_pc = (m->previous_register_pc & 0xffff0000) | (get_data_memory_byte_raw(m, sp + 1) << 8) | get_data_memory_byte_raw(m, sp + 2);
+	}
+	m->in_function_call_sp = m->previous_register_sp;	// record stack level before the call
+	m->in_function_call_trace = m->trace;
+	m->in_function_call_stop = stop;
+	m->in_function_call = 1;
 
-	while(running) {	// running flag is cleared by processor module when some form of abnormal event occurs
+	if(m->trace) {
+		sim_printf(m, "Trace disabled in function call, sp=%04x\n", m->previous_register_sp);
 
-		// if key hit, stop running
-		if (_kbhit()) {
-			printf("*** User Break - pc=%08x!\n", register_pc);
-			stop_reason = STOP_USER_BREAK;
-			break;	// go immediately to exit
+		if(m->run_log_enable) {
+			if(m->run_log_triggered) {
+				fprintf(m->run_log_fp, "Trace disabled in function call, sp=%04x\n", m->previous_register_sp);
+			}
 		}
+	}
+	m->trace = 0;
+}
 
-		// Check breakpoints
-		if(any_ins_breakpoint_enabled) {
-			x = 0;
-			while(x < NUM_INS_BREAKPOINTS) {
-				if(ins_breakpoints[x].enable) {
-					if(register_pc == ins_breakpoints[x].address) {
-						printf("\n*** Breakpoint #%d @ pc=%08x hit!\n", x, ins_breakpoints[x].address);
-						stop_reason = STOP_INS_BREAK;
-						goto run_exit; // go immediately to exit
-					}
-				}
-				x++;
+//
+// the call came back
+//
+void leave_function_call(struct machine *m)
+{
+	m->in_function_call = 0;
+	m->in_function_call_pc = NO_STEP_OVER_PC;
+	m->trace = m->in_function_call_trace;
+}
+
+//
+// do the commands the console posted, from the sim thread
+// returns SIM_COMMAND_BREAK if the run has to stop, SIM_COMMAND_TRACE if trace
+// changed, 0 otherwise
+//
+int run_sim_commands(struct machine *m)
+{
+	int command, result;
+
+	result = 0;
+
+	while((command = next_sim_command(m)) != 0) {
+		switch(command) {
+		case SIM_COMMAND_BREAK:
+			sim_printf(m, "*** User Break - pc=%08x!\n", m->register_pc);
+			result = SIM_COMMAND_BREAK;
+			break;
+		case SIM_COMMAND_STATUS:
+			sim_printf(m, "*** Running - pc=%08x, %llu instructions, simtime=%lluns\n", m->register_pc, m->instruction_count, cycles_to_ns(m, m->sim_cycles));
+			break;
+		case SIM_COMMAND_TRACE:
+			m->trace = !m->trace;
+			sim_printf(m, "*** Trace %s\n", m->trace ? "on" : "off");
+			if(result != SIM_COMMAND_BREAK) {
+				result = SIM_COMMAND_TRACE;
 			}
+			break;
 		}
+	}
+	return(result);
+}
 
-		//
-		// Permanent trigger/breakpoints
-		//
+//
+// returns 1 if it has to be picked again (see run_features()), 0 when the run is over
+//
+template<unsigned int FEATURES> int run_loop(struct machine *m)
+{
+	int command;
+	unsigned int count;
+	struct breakpoint *breakpoint;
 
-		// Aplication triggers and breakpoints
-		application_triggers_and_breakpoints();
+	while(m->running) {	// running flag is cleared by processor module when some form of abnormal event occurs
 
-		//
-		// Check for application break/trigger point
-		// application trigger point is used in send command
-		//
-		if(application_breakpoint.enable) {
-			if(register_pc == application_breakpoint.address) {
+		// commands from the console (see simthread.cpp), one memory read unless there is one
+		if(sim_command_pending(m)) {
+			command = run_sim_commands(m);
+			if(command == SIM_COMMAND_BREAK) {
+				m->stop_reason = STOP_USER_BREAK;
+				break;	// go immediately to exit
+			}
+			if((command == SIM_COMMAND_TRACE) && (FEATURES != RUN_FULL)) {
+				return(1);	// trace needs another loop
+			}
+		}
 
-				printf("\n*** Application Break/Trigger point @ pc=%08x hit!\n", application_breakpoint.address);
+		if(FEATURES & RUN_PC_CHECKS) {
+			// back from a call that is being stepped over
+			if((m->register_pc == m->in_function_call_pc) && (m->register_sp == m->in_function_call_sp)) {
+				leave_function_call(m);
+				if(m->in_function_call_stop) {
+					sim_printf(m, "\n*** Stepped over call - pc=%08x\n", m->register_pc);
+					m->stop_reason = STOP_STEP_OVER;
+					break;	// go immediately to exit
+				}
+				if(FEATURES != RUN_FULL) {
+					return(1);	// back to stepping
+				}
+			}
 
-				stop_reason = STOP_APPLICATION_BREAK;
+			// Check breakpoints, one bit per address, a condition only when it's set
+			m->stats.ins_breakpoint_checks++;
+			if(ins_breakpoint(m, m->register_pc) && ins_breakpoint_hit(m, m->register_pc)) {
+				sim_printf(m, "\n*** Breakpoint @ pc=%08x hit!\n", m->register_pc);
+				m->stop_reason = STOP_INS_BREAK;
 				break;	// go immediately to exit
 			}
+
+			//
+			// Permanent trigger/breakpoints, from the hook file
+			//
+			if(pc_hooked(m->register_pc)) {
+				m->stats.pc_hook_calls++;
+				if(run_pc_hooks(m)) {
+					m->stop_reason = STOP_INS_BREAK;
+					break;	// go immediately to exit
+				}
+			}
+
+			//
+			// Check for application break/trigger point
+			// application trigger point is used in send command
+			//
+			if(m->application_breakpoint.enable) {
+				if(m->register_pc == m->application_breakpoint.address) {
+
+					sim_printf(m, "\n*** Application Break/Trigger point @ pc=%08x hit!\n", m->application_breakpoint.address);
+
+					m->stop_reason = STOP_APPLICATION_BREAK;
+					break;	// go immediately to exit
+				}
+			}
 		}
 
 		// Check if data breakpoint has been triggered
-		if(data_breakpoint_triggered_number != -1) {
+		if((FEATURES & RUN_DEBUG) && (m->data_breakpoint_triggered_number != -1)) {
+
+			breakpoint = &m->data_breakpoints[m->data_breakpoint_triggered_number];
 
 			// reset the flag
-			data_breakpoints[data_breakpoint_triggered_number].triggered = 0;
+			breakpoint->triggered = 0;
 
-			printf("\n*** Data breakpoint @ %08x hit - pc=%08x\n", data_breakpoints[data_breakpoint_triggered_number].address, previous_register_pc);
+			sim_printf(m, "\n*** Data breakpoint #%d @ %08x hit (%02x -> %02x, hit %d) - pc=%08x\n", m->data_breakpoint_triggered_number,
+				breakpoint->hit_address, breakpoint->hit_old_data, breakpoint->hit_data, breakpoint->count, m->previous_register_pc);
 
-			stop_reason = STOP_DATA_BREAK;
-			data_breakpoint_triggered_number = -1;
+			m->stop_reason = STOP_DATA_BREAK;
+			m->data_breakpoint_triggered_number = -1;
 			break;// go immediately to exit
 		}
 
 		// step ahead to next instruction
-		// for "step over" feature
-		if(step_over) {
-			if(in_function_call) {
+		// for "step over" feature, the call itself is traced and what it calls runs on a faster loop
+		if((FEATURES & RUN_DEBUG) && m->step_over && !m->in_function_call) {
+			step(m); // executes one complete instruction wih possible precode can clear running flag on abnormal termination
 
-				step(); // executes one complete instruction wih possible precode can clear running flag on abnormal termination
-
-				if(executed_return_instruction) {
-					if(register_sp == in_function_call_sp) { // have we returned to the same stack level as when we left?
-						in_function_call = 0;
-						trace = save_trace;
-					}
-				}
+			if(m->executed_call_instruction) {
+				enter_function_call(m, 0);
+				return(1);
+			}
+		} else if((m->block_mode || m->recompiled_mode) && (!(FEATURES & RUN_DEBUG) ||
+			(!m->break_on_calls && !showing_instructions(m)))) {
+			// nothing to show, run whole blocks up to the next address we have to look at
+			if(m->recompiled_mode) {
+				m->instruction_count += execute_recompiled(m, RUN_BURST);
 			} else {
-				step(); // executes one complete instruction wih possible precode can clear running flag on abnormal termination
-
-				if(executed_call_instruction) {
-					in_function_call = 1;
-					if(trace) {
-						printf("Trace disabled in function call, sp=%04x\n", previous_register_sp);
-	
-						if(run_log_enable) {
-							if(run_log_triggered) {
-								fprintf(run_log_fp, "Trace disabled in function call, sp=%04x\n", previous_register_sp);
-							}
-						}
-					}
-					in_function_call_sp = previous_register_sp;	// record stack level before the call
-					save_trace = trace;
-					trace = 0;
-				}
+				m->instruction_count += execute_blocks(m, RUN_BURST);
 			}
+		} else if(!(FEATURES & RUN_PC_CHECKS)) {
+			// nothing armed, no need to come back around the loop for every instruction
+			for(count = 0; (count != RUN_BURST) && m->running; count++) {
+				execute(m);
+			}
+			m->instruction_count += count;
+		} else if(!(FEATURES & RUN_DEBUG)) {
+			// nothing to show either
+			execute(m);
+			m->instruction_count++;
 		} else {
-			step(); // executes one complete instruction wih possible precode can clear running flag on abnormal termination
+			step(m); // executes one complete instruction wih possible precode can clear running flag on abnormal termination
 
-			if(break_on_all_calls) {
-				if(executed_call_instruction) {
+			if(m->break_on_calls) {
+				if(m->executed_call_instruction && call_breakpoint_hit(m)) {
 
-					printf("Call Instruction Breakpoint hit - pc=%08x\n", previous_register_pc);
+					sim_printf(m, "Call Instruction Breakpoint hit - pc=%08x, calls %08x\n", m->previous_register_pc, m->register_pc);
 
-					stop_reason = STOP_CALL_INS_BREAK;
+					m->stop_reason = STOP_CALL_INS_BREAK;
 					break; // go immediately to exit
 				}
 			}
 		}
 	}
-run_exit:
-	if(aabnormal_termination) {
-		stop_reason = STOP_ABNORMAL_TERMINATION;
-	}
-
-	ending_tick_count = GetTickCount();
-
-	printf("\n%ld Instructions Executed.\nSimulation Elapsed Time = %ldns, Elapsed Wall Clock Time=%d ticks/ms)\n\n", instruction_count, sim_time_ns, (ending_tick_count-beginning_tick_count));
-
-	// return the reason we stopped
-	return(stop_reason);	// I know it's a global
+	return(0);
 }
 
-
 //
-// Run the code
+// run the code until breakpoint hit, user break or abnormal event occurs, on this thread
+// sets stop_reason
 //
-void run(void)
+int run_simulation(struct machine *m)
 {
-	printf("\nExecuting @ %08x...\n", register_pc);
+	struct host_stats start;
+	int again;
 
-	run_internals();		// this will stop at breakpoints or on user termination by keypress
-							// stop reason is ignored here
+	// only the pages with data breakpoints on them get looked at
+	update_watched_pages(m);
 
-	display_registers(CURRENT);
-}
+	if(m->block_mode || m->recompiled_mode) {
+		update_block_splits(m);
+	}
 
-//
-// Capture I/O writes to a file
-//
-void capture_io_writes_to_a_file(void)
-{
-	char filename[128];
-	int c;
+	// set the start time, and where the host counters were
+	start_run_stats(m, &start);
 
-	printf("\n<B>egin capture\n");
-	printf("<E>nd capture\n\n");
-	printf("> ");
+	m->running = 1;
 
-	c = getchar();
-	getchar();
-	c = tolower(c);
+	m->instruction_count = 0;
+
+	do {
+		switch(run_features(m)) {
+		case RUN_LEAN:
+			again = run_loop<RUN_LEAN>(m);
+			break;
+		case RUN_PC_CHECKS:
+			again = run_loop<RUN_PC_CHECKS>(m);
+			break;
+		default:
+			again = run_loop<RUN_FULL>(m);
+			break;
+		}
+	} while(again);
+
+	if(m->aabnormal_termination) {
+		m->stop_reason = STOP_ABNORMAL_TERMINATION;
+	}
+
+	end_run_stats(m, &start);
+
+	sim_printf(m, "\n%llu Instructions Executed.\nSimulation Elapsed Time = %lluns (%llu cycles), Elapsed Wall Clock Time=%lluus (%.3f MIPS)\n\n", m->instruction_count,
+		cycles_to_ns(m, m->sim_cycles), m->sim_cycles, m->run_stats.wall_ns / 1000, host_stats_mips(&m->run_stats));
+
+	// return the reason we stopped
+	return(m->stop_reason);	// I know it's a global
+}
+
+//
+// run the code until breakpoint hit, user termination by keypress or abnormal event occurs
+// sets stop_reason
+//
+int run_internals(struct machine *m)
+{
+	// batch workers are on a thread already and nobody is at the keyboard for them
+	if(m->quiet) {
+		return(run_simulation(m));
+	}
+	return(run_on_sim_thread(m));
+}
+
+
+//
+// Run the code
+//
+void run(struct machine *m)
+{
+	printf("\nExecuting @ %08x... (<S>tatus, <T>race, any other key breaks)\n", m->register_pc);
+
+	run_internals(m);		// this will stop at breakpoints or on user termination by keypress
+							// stop reason is ignored here
+
+	display_registers(m, CURRENT);
+}
+
+//
+// Capture I/O writes to a file
+//
+void capture_io_writes_to_a_file(struct machine *m)
+{
+	char filename[128];
+	int c;
+
+	printf("\n<B>egin capture\n");
+	printf("<E>nd capture\n\n");
+	printf("> ");
+
+	c = getchar();
+	getchar();
+	c = tolower(c);
 
 	switch(c) {
 	case 'b':
 		// Begin capture
-		if(capture_enable) {
-			printf("Already capturing %08x writes\n", capture_address);
+		if(m->capture_enable) {
+			printf("Already capturing %08x writes\n", m->capture_address);
 		} else {
 			printf("Filename? ");
 			scanf("%s", &filename[0]);
 			getchar();
 
-			if((capture_fp = fopen(filename, "w")) == (FILE *)NULL) {
+			if((m->capture_fp = fopen(filename, "w")) == (FILE *)NULL) {
 				printf("Can't open %s!\n", filename);
 				return;
 			}
 
 			printf("Address? ");
-			scanf("%x", &capture_address);
+			scanf("%x", &m->capture_address);
 			getchar();
 
 			// write a file header
-			fprintf(capture_fp, "I/O - Memory Write Capture Log - capturing writes to %08x\n\n", capture_address);
+			fprintf(m->capture_fp, "I/O - Memory Write Capture Log - capturing writes to %08x\n\n", m->capture_address);
 
 			// set capture address and enable
-			capture_enable = 1;
+			m->capture_enable = 1;
+			update_watched_pages(m);
 
-			printf("Capturing %08x writes to file: %s\n", capture_address, filename);
+			printf("Capturing %08x writes to file: %s\n", m->capture_address, filename);
 		}
 		break;
 
 	case 'e':
 		// End capture
-		if(capture_enable) {
-			capture_enable = 0;
-			fclose(capture_fp);
-			printf("Ending Capture of %08x writes to file: %s\n", capture_address, filename);
+		if(m->capture_enable) {
+			m->capture_enable = 0;
+			update_watched_pages(m);
+			fclose(m->capture_fp);
+			printf("Ending Capture of %08x writes to file: %s\n", m->capture_address, filename);
 		} else {
 			printf("Capture not active.\n");
 		}
@@ -820,7 +1279,7 @@ void capture_io_writes_to_a_file(void)
 //
 // execute and log
 //
-void run_log(void)
+void run_log(struct machine *m)
 {
 	char filename[128];
 	int c;
@@ -836,29 +1295,29 @@ void run_log(void)
 	switch(c) {
 	case 'b':
 		// Begin log
-		if(run_log_enable) {
+		if(m->run_log_enable) {
 			printf("Already logging\n");
 		} else {
 			printf("Filename? ");
 			scanf("%s", &filename[0]);
 			getchar();
 
-			if((run_log_fp = fopen(filename, "w")) == (FILE *)NULL) {
+			if((m->run_log_fp = fopen(filename, "w")) == (FILE *)NULL) {
 				printf("Can't open %s!\n", filename);
 				return;
 			}
 			printf("Logging to file: %s\n", filename);
-			run_log_enable = 1;
-			run_log_triggered = 1;
+			m->run_log_enable = 1;
+			m->run_log_triggered = 1;
 		}
 		break;
 
 	case 'e':
 		// End log
-		if(run_log_enable) {
-			fclose(run_log_fp);
+		if(m->run_log_enable) {
+			fclose(m->run_log_fp);
 			printf("Ending log\n");
-			run_log_enable = 0;
+			m->run_log_enable = 0;
 		} else {
 			printf("Not logging\n");
 		}
@@ -880,7 +1339,7 @@ void edit_help(void)
 //
 // Edit register
 //
-void edit_register(void)
+void edit_register(struct machine *m)
 {
 	int c;
 	unsigned char byte;
@@ -899,19 +1358,19 @@ void edit_register(void)
 		printf("Data? ");
 		scanf("%x", &byte);
 		getchar();
-		register_a = byte;
+		m->register_a = byte;
 		break;
 	case 'x':
 		printf("Data? ");
 		scanf("%x", &byte);
 		getchar();
-		register_x = byte;
+		m->register_x = byte;
 		break;
 	case 'y':
 		printf("Data? ");
 		scanf("%x", &byte);
 		getchar();
-		register_y = byte;
+		m->register_y = byte;
 		break;
 	default:
 		break;
@@ -921,7 +1380,7 @@ void edit_register(void)
 //
 // Edit memory
 //
-void edit_memory(void)
+void edit_memory(struct machine *m)
 {
 	unsigned int address, byte;
 
@@ -933,13 +1392,13 @@ void edit_memory(void)
 	scanf("%x", &byte);
 	getchar();
 
-	put_data_memory_byte_raw(address, byte);
+	put_data_memory_byte_raw(m, address, byte);
 }
 
 //
 // Edit 
 //
-void edit(void)
+void edit(struct machine *m)
 {
 	int c;
 
@@ -955,10 +1414,10 @@ void edit(void)
 
 		switch(c) {
 		case 'r':
-			edit_register();
+			edit_register(m);
 			break;
 		case 'm':
-			edit_memory();
+			edit_memory(m);
 			break;
 		case 'q':
 			goto l_eggs_it;
@@ -977,170 +1436,573 @@ l_eggs_it:
 //
 // Instruction break points
 //
-void instruction_breakpoint_menu(void)
+void instruction_breakpoint_menu(struct machine *m)
 {
-	int c, bn;
+	int c;
+	unsigned int address;
+	char filename[128];
+	struct condition condition, *has_condition;
 
-	printf("<S>et/<C>lear/<D>isplay? ");
+	printf("<S>et/<C>lear/<D>isplay/Clear <A>ll/<L>oad file/<W>rite file? ");
 	c = getchar();
 	getchar();
 	c = tolower(c);
 
-	// set
 	if(c == 's') {
-		// find next available one and use it
-		for(bn = 0; bn < NUM_INS_BREAKPOINTS; bn++) {
-			if(!ins_breakpoints[bn].used) {
-				break;
-			}
-		}
-		if(bn == NUM_INS_BREAKPOINTS) {
-			printf("No breakpoints available\n");
-		} else {
-			printf("Address? ");
-			scanf("%x", &ins_breakpoints[bn].address);
-			getchar();
-
-			ins_breakpoints[bn].used = 1;
-			ins_breakpoints[bn].enable = 1;
+		// set
+		printf("Address? ");
+		scanf("%x", &address);
+		getchar();
 
-			printf("Breakpoint #%d at: %08x\n", bn, ins_breakpoints[bn].address);
+		if(!read_condition(&condition)) {
+			return;
+		}
 
+		if(set_ins_breakpoint_condition(m, address, &condition)) {
+			printf("Breakpoint at: %08x\n", address);
+		} else {
+			printf("Breakpoints can only go in page 00 or page 10\n");
 		}
 	} else if(c == 'c') {
 		// clear
-getitagain1:
-		printf("Breakpoint #? ");
-		scanf("%d", &bn);
+		printf("Address? ");
+		scanf("%x", &address);
 		getchar();
 
-		if(bn > NUM_INS_BREAKPOINTS) {
-			printf("Invalid breakpoint number\n");
-			goto getitagain1;
+		if(!clear_ins_breakpoint(m, address)) {
+			printf("No breakpoint at: %08x\n", address);
 		}
-
-		ins_breakpoints[bn].address = 0;
-		ins_breakpoints[bn].enable = 0;
-		ins_breakpoints[bn].used = 0;
 	} else if(c == 'd') {
 		// display
-		for(bn = 0; bn < NUM_INS_BREAKPOINTS; bn++) {
-			if(ins_breakpoints[bn].used) {
-				printf("Breakpoint #%d at: %08x\n", bn, ins_breakpoints[bn].address);
+		for(address = next_ins_breakpoint(m, 0); address != NO_INS_BREAKPOINT; address = next_ins_breakpoint(m, address + 1)) {
+			has_condition = ins_breakpoint_condition(m, address);
+			if(has_condition != NULL) {
+				printf("Breakpoint at: %08x if %s\n", address, has_condition->text);
+			} else {
+				printf("Breakpoint at: %08x\n", address);
 			}
 		}
+		printf("%d breakpoints\n", m->num_ins_breakpoints);
+	} else if(c == 'a') {
+		clear_all_ins_breakpoints(m);
+	} else if(c == 'l') {
+		printf("Filename? ");
+		scanf("%s", &filename[0]);
+		getchar();
+
+		load_ins_breakpoints(m, filename);
+	} else if(c == 'w') {
+		printf("Filename? ");
+		scanf("%s", &filename[0]);
+		getchar();
+
+		save_ins_breakpoints(m, filename);
+	}
+}
+
+//
+// show a data breakpoint
+//
+void display_data_breakpoint(struct machine *m, int bn)
+{
+	struct breakpoint *breakpoint;
+
+	breakpoint = &m->data_breakpoints[bn];
+
+	printf("Data Breakpoint #%d at: %08x", bn, breakpoint->address);
+	if(breakpoint->end_address != breakpoint->address) {
+		printf("-%08x", breakpoint->end_address);
+	}
+	printf(" TYPE: ");
+	if(breakpoint->type & DBRK_TYPE_READ) {
+		printf("R");
 	}
+	if(breakpoint->type & DBRK_TYPE_WRITE) {
+		printf("W");
+	}
+	if(breakpoint->type & DBRK_TYPE_VAL) {
+		printf(" VALUE: %02x/%02x", breakpoint->value, breakpoint->mask);
+	}
+	if(breakpoint->type & DBRK_TYPE_SUB) {
+		printf(" OLD: %02x/%02x", breakpoint->old_value, breakpoint->old_mask);
+	}
+	if(breakpoint->type & DBRK_TYPE_CHANGE) {
+		printf(" CHANGED");
+	}
+	if(breakpoint->type & BRK_TYPE_COUNT) {
+		printf(" FROM HIT: %d", breakpoint->terminal_count);
+	}
+	if(breakpoint->condition.length) {
+		printf(" IF: %s", breakpoint->condition.text);
+	}
+	printf(" HITS: %d\n", breakpoint->count);
+}
+
+//
+// ask a yes/no question
+//
+int data_breakpoint_question(const char *question)
+{
+	int c;
+
+	printf("%s (Y|N)? ", question);
+	c = getchar();
+	getchar();
+	return(tolower(c) == 'y');
 }
 
 //
 // Data breakpoints
 //
-void data_breakpoint_menu(void)
+void data_breakpoint_menu(struct machine *m)
 {
 	int c, bn;
+	struct breakpoint breakpoint;
 
-	printf("<S>et/<C>lear/<D>isplay? ");
+	printf("<S>et/<C>lear/<D>isplay/Clear <A>ll? ");
 	c = getchar();
 	getchar();
 	c = tolower(c);
 
 	if(c == 's') {
 		// set
-		// find next available one and use it
-		for(bn = 0; bn < NUM_DATA_BREAKPOINTS; bn++) {
-			if(!data_breakpoints[bn].used) {
-				break;
-			}
+		memset(&breakpoint, 0, sizeof(breakpoint));
+
+		printf("Address? ");
+		scanf("%x", &breakpoint.address);
+		getchar();
+
+		printf("Last address (same address for one byte)? ");
+		scanf("%x", &breakpoint.end_address);
+		getchar();
+
+		printf("Type (R|W|B)? ");
+		c = getchar();
+		c = tolower(c);
+		getchar();
+		if(c == 'r') {
+			breakpoint.type = DBRK_TYPE_READ;
+		} else if(c == 'w') {
+			breakpoint.type = DBRK_TYPE_WRITE;
+		} else if(c == 'b') {
+			breakpoint.type = DBRK_TYPE_RW;
 		}
-		if(bn == NUM_DATA_BREAKPOINTS) {
-			printf("No breakpoints available\n");
-		} else {
-			printf("Address? ");
-			scanf("%x", &data_breakpoints[bn].address);
+
+		if(data_breakpoint_question("Only on a value")) {
+			breakpoint.type |= DBRK_TYPE_VAL;
+			printf("Value? ");
+			scanf("%x", &breakpoint.value);
+			printf("Mask? ");
+			scanf("%x", &breakpoint.mask);
 			getchar();
+			breakpoint.value &= breakpoint.mask;
+		}
 
-			printf("Type (R|W|B)? ");
-			c = getchar();
-			c = tolower(c);
+		if(data_breakpoint_question("Only on an old value")) {
+			breakpoint.type |= DBRK_TYPE_SUB;
+			printf("Old value? ");
+			scanf("%x", &breakpoint.old_value);
+			printf("Mask? ");
+			scanf("%x", &breakpoint.old_mask);
 			getchar();
-			if(c == 'r') {
-				data_breakpoints[bn].type = DBRK_TYPE_READ;
-			} else if(c == 'w') {
-				data_breakpoints[bn].type = DBRK_TYPE_WRITE;
-			} else if(c == 'b') {
-				data_breakpoints[bn].type = DBRK_TYPE_RW;
-			}
-			data_breakpoints[bn].enable = 1;
-			data_breakpoints[bn].used = 1;
+			breakpoint.old_value &= breakpoint.old_mask;
+		}
 
+		if((breakpoint.type & DBRK_TYPE_WRITE) && data_breakpoint_question("Only writes that change it")) {
+			breakpoint.type |= DBRK_TYPE_CHANGE;
+		}
 
-			printf("Data Breakpoint #%d at: %08x TYPE: ", bn, data_breakpoints[bn].address);
-			if(data_breakpoints[bn].type & DBRK_TYPE_READ) {
-				printf("R");
-			}
-			if(data_breakpoints[bn].type & DBRK_TYPE_WRITE) {
-				printf("W");
-			}
-			printf("\n");
+		// value and old are the byte, a, x, y... the registers at the access
+		if(!read_condition(&breakpoint.condition)) {
+			return;
+		}
+
+		printf("Break from hit number (0 = every hit)? ");
+		scanf("%d", &breakpoint.terminal_count);
+		getchar();
+		if(breakpoint.terminal_count > 1) {
+			breakpoint.type |= BRK_TYPE_COUNT;
+		}
 
+		bn = add_data_breakpoint(m, &breakpoint);
+		if(bn == -1) {
+			printf("No breakpoints available\n");
+		} else {
+			display_data_breakpoint(m, bn);
 		}
 	} else if(c == 'c') {
 		// clear
-getitagainsam:
 		printf("Breakpoint #? ");
 		scanf("%d", &bn);
 		getchar();
 
-		if(bn > NUM_DATA_BREAKPOINTS) {
+		if(!delete_data_breakpoint(m, bn)) {
 			printf("Invalid breakpoint number\n");
-			goto getitagainsam;
 		}
-
-		data_breakpoints[bn].address = 0;
-		data_breakpoints[bn].type = 0;
-		data_breakpoints[bn].enable = 0;
-		data_breakpoints[bn].used = 0;
 	} else if(c == 'd') {
 		// display
-		for(bn = 0; bn < NUM_DATA_BREAKPOINTS; bn++) {
-			if(data_breakpoints[bn].used) {
-				printf("Data Breakpoint #%d at: %08x TYPE: ", bn, data_breakpoints[bn].address);
-				if(data_breakpoints[bn].type & DBRK_TYPE_READ) {
-					printf("R");
-				}
-				if(data_breakpoints[bn].type & DBRK_TYPE_WRITE) {
-					printf("W");
-				}
-				printf("\n");
+		for(bn = 0; bn < m->num_data_breakpoints; bn++) {
+			if(m->data_breakpoints[bn].used) {
+				display_data_breakpoint(m, bn);
 			}
 		}
+	} else if(c == 'a') {
+		clear_all_data_breakpoints(m);
+	}
+
+	update_watched_pages(m);
+}
+
+//
+// show the call breakpoint
+//
+void display_call_breakpoint(struct machine *m)
+{
+	struct call_breakpoint *breakpoint;
+	int x;
+
+	if(!m->break_on_calls) {
+		printf("Break on calls is disabled\n");
+		return;
+	}
+
+	breakpoint = &m->call_breakpoint;
+
+	printf("Break on calls");
+	if(breakpoint->type & CBRK_TYPE_TARGET) {
+		printf(" TO:");
+		for(x = 0; x != breakpoint->num_targets; x++) {
+			printf(" %08x", breakpoint->targets[x]);
+		}
 	}
+	if(breakpoint->type & CBRK_TYPE_CALLER) {
+		printf(" FROM: %08x-%08x", breakpoint->caller_start, breakpoint->caller_end);
+	}
+	if(breakpoint->type & CBRK_TYPE_DEPTH) {
+		printf(" DEPTH: %d-%d", breakpoint->min_depth, breakpoint->max_depth);
+	}
+	if(breakpoint->type & BRK_TYPE_COUNT) {
+		printf(" FROM HIT: %d", breakpoint->terminal_count);
+	}
+	printf(" HITS: %d DEPTH NOW: %d\n", breakpoint->count, m->call_depth);
 }
 
 //
 // break on calls menu
 //
-void break_on_all_calls_menu(void)
+void break_on_calls_menu(struct machine *m)
 {
 	int c;
+	struct call_breakpoint breakpoint;
+	char line[128], *p, *end;
+	unsigned int address;
 
 	printf("<S>et/<C>lear/<D>isplay? ");
 	c = getchar();
 	getchar();
 	c = tolower(c);
 	if(c == 's') {
-		break_on_all_calls = 1;
+		memset(&breakpoint, 0, sizeof(breakpoint));
+
+		printf("Only calls to (up to %d addresses, empty for any)? ", MAX_CALL_TARGETS);
+		if(fgets(line, sizeof(line), stdin) == NULL) {
+			line[0] = '\0';
+		}
+		for(p = line; breakpoint.num_targets != MAX_CALL_TARGETS; p = end) {
+			address = strtoul(p, &end, 16);
+			if(end == p) {
+				break;
+			}
+			breakpoint.targets[breakpoint.num_targets++] = address;
+		}
+		if(breakpoint.num_targets) {
+			breakpoint.type |= CBRK_TYPE_TARGET;
+		}
+
+		if(data_breakpoint_question("Only calls from an address range")) {
+			breakpoint.type |= CBRK_TYPE_CALLER;
+			printf("First address? ");
+			scanf("%x", &breakpoint.caller_start);
+			printf("Last address? ");
+			scanf("%x", &breakpoint.caller_end);
+			getchar();
+		}
+
+		if(data_breakpoint_question("Only calls so many calls deep")) {
+			breakpoint.type |= CBRK_TYPE_DEPTH;
+			printf("Least depth (a call made from here is 1)? ");
+			scanf("%d", &breakpoint.min_depth);
+			printf("Most depth? ");
+			scanf("%d", &breakpoint.max_depth);
+			getchar();
+		}
+
+		printf("Break from hit number (0 = every hit)? ");
+		scanf("%d", &breakpoint.terminal_count);
+		getchar();
+		if(breakpoint.terminal_count > 1) {
+			breakpoint.type |= BRK_TYPE_COUNT;
+		}
+
+		set_call_breakpoint(m, &breakpoint);
+		display_call_breakpoint(m);
 	} else if(c == 'c') {
-		break_on_all_calls = 0;
+		m->break_on_calls = 0;
+	} else if(c == 'd') {
+		display_call_breakpoint(m);
+	}
+}
+
+//
+// call log menu
+//
+void call_log_menu(struct machine *m)
+{
+	int c;
+	unsigned int count;
+	char filename[128];
+
+	printf("<S>tart/<E>nd/<D>isplay/<W>rite file? ");
+	c = getchar();
+	getchar();
+	c = tolower(c);
+	if(c == 's') {
+		printf("Events to keep (0 for %d)? ", CALL_LOG_SIZE);
+		scanf("%u", &count);
+		getchar();
+
+		if(!start_call_log(m, count ? count : CALL_LOG_SIZE)) {
+			printf("Not enough memory for the call log\n");
+		} else {
+			printf("Keeping the last %u calls and returns\n", m->call_log_size);
+		}
+	} else if(c == 'e') {
+		stop_call_log(m);
+	} else if(c == 'd') {
+		printf("How many (0 for all)? ");
+		scanf("%u", &count);
+		getchar();
+
+		display_call_log(m, count ? count : m->call_log_size);
+	} else if(c == 'w') {
+		printf("Filename? ");
+		scanf("%s", &filename[0]);
+		getchar();
+
+		if(save_call_log(m, filename)) {
+			printf("Call log written to: %s\n", filename);
+		}
+	}
+}
+
+//
+// call graph menu
+//
+void callgraph_menu(struct machine *m)
+{
+	int c, lines;
+	char filename[128];
+
+	printf("Call graph <S>tart/<E>nd/<D>isplay/<W>rite callgrind file? ");
+	c = getchar();
+	getchar();
+	c = tolower(c);
+	if(c == 's') {
+		if(!start_callgraph(m)) {
+			printf("Not enough memory for the call graph\n");
+		} else {
+			printf("Call graph from here\n");
+		}
+	} else if(c == 'e') {
+		stop_callgraph(m);
 	} else if(c == 'd') {
-		if(break_on_all_calls) {
-			printf("Break on all calls is enabled\n");
+		printf("Lines (0 for %d)? ", CALLGRAPH_LINES);
+		scanf("%d", &lines);
+		getchar();
+
+		display_callgraph(m, (lines > 0) ? lines : CALLGRAPH_LINES);
+	} else if(c == 'w') {
+		printf("Filename? ");
+		scanf("%s", &filename[0]);
+		getchar();
+
+		if(save_callgrind(m, filename)) {
+			printf("Call graph written to: %s\n", filename);
+		}
+	}
+}
+
+//
+// profile menu
+//
+void profile_menu(struct machine *m)
+{
+	int c, lines;
+	char filename[128];
+
+	printf("<S>tart/<E>nd/<D>isplay/<W>rite file/Load s<Y>mbols/<C>all graph? ");
+	c = getchar();
+	getchar();
+	c = tolower(c);
+	if(c == 's') {
+		if(!start_profile(m)) {
+			printf("Not enough memory for the profile\n");
 		} else {
-			printf("Break on all calls is disabled\n");
+			printf("Profiling from here\n");
+		}
+	} else if(c == 'e') {
+		stop_profile(m);
+	} else if(c == 'd') {
+		printf("Lines (0 for %d)? ", PROFILE_LINES);
+		scanf("%d", &lines);
+		getchar();
+
+		display_profile(m, (lines > 0) ? lines : PROFILE_LINES);
+	} else if(c == 'w') {
+		printf("Filename? ");
+		scanf("%s", &filename[0]);
+		getchar();
+
+		if(save_profile(m, filename)) {
+			printf("Profile written to: %s\n", filename);
+		}
+	} else if(c == 'y') {
+		printf("Filename? ");
+		scanf("%s", &filename[0]);
+		getchar();
+
+		lines = load_profile_symbols(filename);
+		if(lines != -1) {
+			printf("%d symbols\n", lines);
+		}
+	} else if(c == 'c') {
+		callgraph_menu(m);
+	}
+}
+
+//
+// simulation time menu
+//
+void sim_time_menu(struct machine *m)
+{
+	int c;
+	unsigned int frequency_hz;
+
+	printf("%llu cycles, %lluns at %uHz\n", m->sim_cycles, cycles_to_ns(m, m->sim_cycles), m->clock_frequency_hz);
+	printf("<R>eset/<C>lock frequency? ");
+	c = getchar();
+	getchar();
+	c = tolower(c);
+	if(c == 'r') {
+		reset_sim_time(m);
+	} else if(c == 'c') {
+		printf("Frequency in Hz (%u)? ", CLOCK_FREQUENCY);
+		scanf("%u", &frequency_hz);
+		getchar();
+
+		if(!set_clock_frequency(m, frequency_hz)) {
+			printf("Can't run at %uHz\n", frequency_hz);
+		}
+	}
+}
+
+//
+// instruction scoreboard menu
+//
+void scoreboard_menu(struct machine *m)
+{
+	int c, lines;
+	char filename[128], filename_b[128];
+
+	printf("<D>isplay/<W>rite file/<C>ompare files/<R>eset? ");
+	c = getchar();
+	getchar();
+	c = tolower(c);
+	if(c == 'd') {
+		printf("Lines (0 for %d)? ", SCOREBOARD_LINES);
+		scanf("%d", &lines);
+		getchar();
+
+		display_scoreboard(m, (lines > 0) ? lines : SCOREBOARD_LINES);
+	} else if(c == 'w') {
+		printf("Filename? ");
+		scanf("%s", &filename[0]);
+		getchar();
+
+		if(save_scoreboard(m, filename)) {
+			printf("Scoreboard written to: %s\n", filename);
+		}
+	} else if(c == 'c') {
+		printf("First filename (%s for this one)? ", SCOREBOARD_CURRENT);
+		scanf("%s", &filename[0]);
+		printf("Second filename (%s for this one)? ", SCOREBOARD_CURRENT);
+		scanf("%s", &filename_b[0]);
+		printf("Lines (0 for %d)? ", SCOREBOARD_LINES);
+		scanf("%d", &lines);
+		getchar();
+
+		compare_scoreboards(m, filename, filename_b, (lines > 0) ? lines : SCOREBOARD_LINES);
+	} else if(c == 'r') {
+		clear_scoreboard(m);
+	}
+}
+
+//
+// host statistics menu
+//
+void host_stats_menu(struct machine *m)
+{
+	int c;
+	char filename[128];
+
+	printf("<D>isplay/<W>rite JSON file/<C>lear? ");
+	c = getchar();
+	getchar();
+	c = tolower(c);
+	if(c == 'd') {
+		display_host_stats(m);
+	} else if(c == 'w') {
+		printf("Filename? ");
+		scanf("%s", &filename[0]);
+		getchar();
+
+		if(save_host_stats(m, filename)) {
+			printf("Host statistics written to: %s\n", filename);
 		}
+	} else if(c == 'c') {
+		clear_host_stats(m);
 	}
 }
 
+//
+// pc hooks menu
+//
+void pc_hook_menu(void)
+{
+	int c, count;
+	char filename[128];
+
+	printf("<L>oad/<D>isplay/<C>lear? ");
+	c = getchar();
+	getchar();
+	c = tolower(c);
+	if(c == 'l') {
+		printf("Filename? ");
+		scanf("%s", &filename[0]);
+		getchar();
+
+		count = load_pc_hooks(filename);
+		if(count == -1) {
+			printf("Can't open %s!\n", filename);
+		} else {
+			printf("%d hooks loaded from %s\n", count, filename);
+		}
+	} else if(c == 'd') {
+		display_pc_hooks();
+	} else if(c == 'c') {
+		clear_pc_hooks();
+	}
+}
 
 //
 // Main menu help/menu
@@ -1169,10 +2031,12 @@ void help(void)
 	printf("\tE<x>ecute\n");
 	printf("\t<L>og execution to file (start/stop)\n");
 	printf("\tCap<t>ure I/O or memory writes to a file\n");
-	printf("\t<B>reakpoints\n");
-	printf("\t<#> Reset Simulation Time\n");
+	printf("\t<B>reakpoints (and pc hooks, call log)\n");
+	printf("\t<#> Simulation Time (reset, clock frequency)\n");
+	printf("\t<%%> Host Statistics (MIPS, bus accesses, hooks, breakpoint checks, trace output)\n");
 	printf("\t<@> Reset Instruction Scoreboard\n");
-	printf("\t<$> Display Instruction Scoreboard\n");
+	printf("\t<$> Instruction Scoreboard (executions and cycles by opcode, write, compare)\n");
+	printf("\tProfile <M>enu (cycles by pc, with symbols, and the call graph)\n");
 	printf("\t<+> Set Trace Flag\n");
 	printf("\t<-> Clear Trace Flag\n");
 	printf("\t<(> Set Global StepOver Flag\n");
@@ -1184,6 +2048,11 @@ void help(void)
 	printf("\t<{> Enable Post-Instruction Regiser Display\n");
 	printf("\t<}> Disable Post-Instruction Regiser Display\n");
 
+	printf("\tBloc<k> Mode (on/off), only used with trace and register display off\n");
+	printf("\tBlock Chec<K> (on/off), checks every block instruction against a fresh decode and execute()\n");
+	printf("\t<G>enerate C++ from the ROM (%s is built in with RECOMPILED_ROM defined)\n", RECOMPILED_ROM_FILENAME);
+	printf("\tRecompiled M<o>de (on/off), like block mode with the built in recompiled ROM\n");
+
 	// for application user interface help text
 	application_ui_help();
 
@@ -1199,29 +2068,42 @@ int main(int argc, char* argv[])
 	int c, save_trace, save_step_over;
 	unsigned int address, length;
 	char filename[128];
+	struct machine *m;
 
 	printf("ST7/8 Microprocesor Simulator Version 03.00 (9/07/2017)\n\n");
 
+	// the one tag the user interface works on
+	m = new_machine();
+	if(m == NULL) {
+		printf("Not enough memory for the machine\n");
+		exit(1);
+	}
+
 	// Seed the random-number generator with current time so that the numbers will be different every time we run.
-	srand( (unsigned)time( NULL ) );
+	m->random_seed = (unsigned)time( NULL );
 
 	help();
 
+	// the permanent trigger/breakpoints of the firmware
+	if(load_pc_hooks(PC_HOOK_FILENAME) == -1) {
+		printf("No %s, running without pc hooks\n", PC_HOOK_FILENAME);
+	}
+
 	// Clear memory
-	clear_memory();
+	clear_memory(m);
 
 	// Reset the simulator
-	reset_simulator();
+	reset_simulator(m);
 
 	// Reset the processor
-	reset_processor();
+	reset_processor(m);
 
-	step_over = 0;
-	trace = 1;
-	break_on_all_calls = 0;
+	m->step_over = 0;
+	m->trace = 1;
+	m->break_on_calls = 0;
 	
-	enable_pre_instruction_register_display = 1;
-	enable_post_instruction_register_display = 1;
+	m->enable_pre_instruction_register_display = 1;
+	m->enable_post_instruction_register_display = 1;
 
 	// process commands
 	while(1) {
@@ -1231,21 +2113,21 @@ int main(int argc, char* argv[])
 		c = getchar();
 		getchar();
 
-		if(application_ui_parse(c)) {
+		if(application_ui_parse(m, c)) {
 			;
 		} else {
 
 		switch(c) {
 		case 'a':
-			snapshot();
+			snapshot(m);
 			break;
 
 		case 'h':
-			load_flash_text();
+			load_flash_text(m);
 			break;
 
 		case '0':
-			load_rom_text();
+			load_rom_text(m);
 			break;
 
 		case 'w':
@@ -1253,19 +2135,19 @@ int main(int argc, char* argv[])
 			scanf("%s", &filename[0]);
 			getchar();
 
-			save_bin(filename);
+			save_bin(m, filename);
 			break;
 
 		case 't':
-			capture_io_writes_to_a_file();
+			capture_io_writes_to_a_file(m);
 			break;
 
 		case 'e':
-			edit();
+			edit(m);
 			break;
 
 		case 'f':
-			load_srec();
+			load_srec(m);
 			break;
 
 		case 'n':
@@ -1273,7 +2155,7 @@ int main(int argc, char* argv[])
 			scanf("%s", &filename[0]);
 			getchar();
 
-			load_bin(filename);
+			load_bin(m, filename);
 			break;
 
 		case '?':
@@ -1285,59 +2167,67 @@ int main(int argc, char* argv[])
 			break;
 
 		case 'x':
-			run();
+			run(m);
 			break;
 
 		case 'X':
-			run_log();
+			run_log(m);
 			break;
 
 		case 'z':
-			reset_simulator();
-			reset_processor();
+			reset_simulator(m);
+			reset_processor(m);
 			break;
 
 		case 'p':
 			printf("Address? ");
-			scanf("%x", &register_pc);
+			scanf("%x", &m->register_pc);
 			getchar();
 			break;
 
 		case 'r':
-			save_trace = trace;
-			trace = 1;
-			display_registers(CURRENT);
-			trace = save_trace;
+			save_trace = m->trace;
+			m->trace = 1;
+			display_registers(m, CURRENT);
+			m->trace = save_trace;
 			break;
 
 		case 'c':
-			clear_memory();
+			clear_memory(m);
 			break;
 
 		case 's':
 			// step
-			save_trace = trace;
-			trace = 1;
-			save_step_over = step_over;
-			step_over = 0;
+			save_trace = m->trace;
+			m->trace = 1;
+			save_step_over = m->step_over;
+			m->step_over = 0;
 
-			step();
+			step(m);
 
-			step_over = save_step_over;
-			trace = save_trace;
+			m->step_over = save_step_over;
+			m->trace = save_trace;
 			break;
 
 		case 'S':
-			// step over
-			save_trace = trace;
-			trace = 1;
-			save_step_over = step_over;
-			step_over = 1;
+			// step over, a call runs at full speed until it is back
+			save_trace = m->trace;
+			m->trace = 1;
+
+			step(m);
 
-			step();
+			if(m->executed_call_instruction) {
+				enter_function_call(m, 1);
+				m->in_function_call_trace = save_trace;
 
-			step_over = save_step_over;
-			trace = save_trace;
+				// stopped inside the call, a later run mustn't stop when the return address comes around
+				if((run_internals(m) != STOP_STEP_OVER) && m->in_function_call) {
+					leave_function_call(m);
+				}
+				m->in_function_call_stop = 0;
+			}
+
+			m->trace = save_trace;
 			break;
 
 		case 'y':
@@ -1347,20 +2237,24 @@ int main(int argc, char* argv[])
 			scanf("%d", &length);
 			getchar();
 
-			display_data_memory(address, length);
+			display_data_memory(m, address, length);
 			break;
 
 		case 'b':
-			printf("<I>nstruction/<D>ata/<C>alls? ");
+			printf("<I>nstruction/<D>ata/<C>alls/Call <L>og/<H>ooks? ");
 			c = getchar();
 			getchar();
 			c = tolower(c);
 			if(c == 'i') {
-				instruction_breakpoint_menu();
+				instruction_breakpoint_menu(m);
 			} else if(c == 'd') {
-				data_breakpoint_menu();
+				data_breakpoint_menu(m);
 			} else if(c == 'c') {
-				break_on_all_calls_menu();
+				break_on_calls_menu(m);
+			} else if(c == 'l') {
+				call_log_menu(m);
+			} else if(c == 'h') {
+				pc_hook_menu();
 			}
 			break;
 
@@ -1368,51 +2262,86 @@ int main(int argc, char* argv[])
 			printf("Filename? ");
 			scanf("%s", &filename[0]);
 			getchar();
-			load_flash(filename);
+			load_flash(m, filename);
 			break;
 
 		case '#':
-			reset_sim_time();
+			sim_time_menu(m);
+			break;
+
+		case '%':
+			host_stats_menu(m);
 			break;
 
 		case '$':
-			display_scoreboard();
+			scoreboard_menu(m);
 			break;
 
 		case '@':
-			clear_scoreboard();
+			clear_scoreboard(m);
 			break;
 
 		case '+':
-			trace = 1;
+			m->trace = 1;
 			break;
 
 		case '-':
-			trace = 0;
+			m->trace = 0;
 			break;
 
 		case '(':
-			step_over = 1;
+			m->step_over = 1;
 			break;
 
 		case ')':
-			step_over = 0;
+			m->step_over = 0;
 			break;
 
 		case '[':
-			enable_pre_instruction_register_display = 1;
+			m->enable_pre_instruction_register_display = 1;
 			break;
 
 		case ']':
-			enable_pre_instruction_register_display = 0;
+			m->enable_pre_instruction_register_display = 0;
 			break;
 
 		case '{':
-			enable_post_instruction_register_display = 1;
+			m->enable_post_instruction_register_display = 1;
 			break;
 
 		case '}':
-			enable_post_instruction_register_display = 0;
+			m->enable_post_instruction_register_display = 0;
+			break;
+
+		case 'm':
+			profile_menu(m);
+			break;
+
+		case 'k':
+			m->block_mode = !m->block_mode;
+			printf("Block mode %s\n", m->block_mode ? "on" : "off");
+			break;
+
+		case 'K':
+			m->block_check = !m->block_check;
+			printf("Block check %s\n", m->block_check ? "on" : "off");
+			break;
+
+		case 'g':
+			printf("Filename? ");
+			scanf("%s", &filename[0]);
+			getchar();
+
+			recompile_rom(m, filename);
+			break;
+
+		case 'o':
+			if(!recompiled_rom_size()) {
+				printf("*** No recompiled ROM in this build\n");
+				break;
+			}
+			m->recompiled_mode = !m->recompiled_mode;
+			printf("Recompiled mode %s (%d instructions)\n", m->recompiled_mode ? "on" : "off", recompiled_rom_size());
 			break;
 
 		default:
@@ -1423,12 +2352,18 @@ int main(int argc, char* argv[])
 
 eggsit:
 	// cleanup anything that might need it
-	if(capture_enable) {
-		fclose(capture_fp);
+	if(m->capture_enable) {
+		fclose(m->capture_fp);
 	}
-	if(run_log_enable) {
-		fclose(run_log_fp);
+	if(m->run_log_enable) {
+		fclose(m->run_log_fp);
 	}
+
+	// throughput of this build, to compare with the next
+	save_host_stats(m, HOST_STATS_FILENAME);
+
+	free_machine(m);
+
 	// that's all folks
 	exit(0);
 }
@@ -0,0 +1,273 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - host statistics
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+// History:
+//
+//----------------------------------------------------------------------------
+//
+
+//
+// How hard the simulator had to work to run the tag, as opposed to what the
+// tag did: wall time off the performance counter, instructions and cycles per
+// run, memory bus accesses by region, calls to the simulated peripherals and pc
+// hooks, breakpoint lookups and trace output. From those come the MIPS, the ns
+// per instruction and how much faster than the real thing it ran.
+//
+// The counters are bumped in place where the work is done, into stats, which
+// is everything since the machine was made. run_simulation() takes a copy when
+// it starts and works out run_stats from it when it is done. Batch workers
+// count into their own machines, which are added to the base machine when the
+// batch is done, so their wall time is the sum over all the workers.
+//
+// The whole lot is written to HOST_STATS_FILENAME as JSON when the simulator
+// quits, to compare one build of the simulator with the next.
+//
+
+#include "stdafx.h"
+#include <stdio.h>
+#include <memory.h>
+#include <string.h>
+#include <stdlib.h>
+#include <windows.h>
+
+#include "st7xcpu.h"
+
+#include "machine.h"
+
+#include "simulator.h"
+#include "stats.h"
+
+// names of the BUS_REGION_*
+const char *bus_region_names[NUM_BUS_REGIONS] = {
+	"short",
+	"ram",
+	"xio",
+	"rom",
+	"flash",
+	"other"
+};
+
+//
+// the host clock in ns, only good for differences
+//
+unsigned long long host_time_ns(void)
+{
+	static unsigned long long frequency = 0;
+	LARGE_INTEGER counter;
+
+	if(frequency == 0) {
+		QueryPerformanceFrequency(&counter);
+		frequency = counter.QuadPart;
+	}
+	QueryPerformanceCounter(&counter);
+
+	// whole seconds and the rest apart, the count times 10^9 could overflow
+	return((((unsigned long long)counter.QuadPart / frequency) * 1000000000) + ((((unsigned long long)counter.QuadPart % frequency) * 1000000000) / frequency));
+}
+
+//
+// a run is starting, start is where the counters were and when
+//
+void start_run_stats(struct machine *m, struct host_stats *start)
+{
+	*start = m->stats;
+	start->wall_ns = host_time_ns();
+	start->sim_cycles = m->sim_cycles;
+}
+
+//
+// the run that started at start is over, work out what it took and count it
+//
+void end_run_stats(struct machine *m, struct host_stats *start)
+{
+	struct host_stats *run;
+	int x;
+
+	run = &m->run_stats;
+
+	run->runs = 1;
+	run->wall_ns = host_time_ns() - start->wall_ns;
+	run->instructions = m->instruction_count;
+	run->sim_cycles = m->sim_cycles - start->sim_cycles;
+	for(x = 0; x != NUM_BUS_REGIONS; x++) {
+		run->bus_reads[x] = m->stats.bus_reads[x] - start->bus_reads[x];
+		run->bus_writes[x] = m->stats.bus_writes[x] - start->bus_writes[x];
+	}
+	run->device_calls = m->stats.device_calls - start->device_calls;
+	run->pc_hook_calls = m->stats.pc_hook_calls - start->pc_hook_calls;
+	run->ins_breakpoint_checks = m->stats.ins_breakpoint_checks - start->ins_breakpoint_checks;
+	run->data_breakpoint_checks = m->stats.data_breakpoint_checks - start->data_breakpoint_checks;
+	run->trace_bytes = m->stats.trace_bytes - start->trace_bytes;
+
+	// the rest were counted as they happened
+	m->stats.runs++;
+	m->stats.wall_ns += run->wall_ns;
+	m->stats.instructions += run->instructions;
+	m->stats.sim_cycles += run->sim_cycles;
+}
+
+//
+// src's counters into dst's, for batch workers
+//
+void add_host_stats(struct machine *dst, struct machine *src)
+{
+	int x;
+
+	dst->stats.runs += src->stats.runs;
+	dst->stats.wall_ns += src->stats.wall_ns;
+	dst->stats.instructions += src->stats.instructions;
+	dst->stats.sim_cycles += src->stats.sim_cycles;
+	for(x = 0; x != NUM_BUS_REGIONS; x++) {
+		dst->stats.bus_reads[x] += src->stats.bus_reads[x];
+		dst->stats.bus_writes[x] += src->stats.bus_writes[x];
+	}
+	dst->stats.device_calls += src->stats.device_calls;
+	dst->stats.pc_hook_calls += src->stats.pc_hook_calls;
+	dst->stats.ins_breakpoint_checks += src->stats.ins_breakpoint_checks;
+	dst->stats.data_breakpoint_checks += src->stats.data_breakpoint_checks;
+	dst->stats.trace_bytes += src->stats.trace_bytes;
+}
+
+//
+// start counting from nothing
+//
+void clear_host_stats(struct machine *m)
+{
+	memset(&m->stats, 0, sizeof(m->stats));
+	memset(&m->run_stats, 0, sizeof(m->run_stats));
+}
+
+//
+// millions of instructions per second of wall time
+//
+double host_stats_mips(struct host_stats *s)
+{
+	if(s->wall_ns == 0) {
+		return(0);
+	}
+	return(((double)s->instructions * 1000) / s->wall_ns);
+}
+
+//
+// wall time per instruction
+//
+double host_stats_ns_per_instruction(struct host_stats *s)
+{
+	if(s->instructions == 0) {
+		return(0);
+	}
+	return((double)s->wall_ns / s->instructions);
+}
+
+//
+// simulated time over wall time, more than 1 is faster than the real tag
+//
+double host_stats_sim_to_wall(struct machine *m, struct host_stats *s)
+{
+	if(s->wall_ns == 0) {
+		return(0);
+	}
+	return((double)cycles_to_ns(m, s->sim_cycles) / s->wall_ns);
+}
+
+//
+// last run and total side by side
+//
+void display_host_stats(struct machine *m)
+{
+	struct host_stats *run, *total;
+	int x;
+
+	run = &m->run_stats;
+	total = &m->stats;
+
+	printf("%-30s %20s %20s\n", "", "last run", "total");
+	printf("%-30s %20llu %20llu\n", "runs", run->runs, total->runs);
+	printf("%-30s %20llu %20llu\n", "instructions", run->instructions, total->instructions);
+	printf("%-30s %20llu %20llu\n", "simulated cycles", run->sim_cycles, total->sim_cycles);
+	printf("%-30s %20llu %20llu\n", "simulated ns", cycles_to_ns(m, run->sim_cycles), cycles_to_ns(m, total->sim_cycles));
+	printf("%-30s %20llu %20llu\n", "wall ns", run->wall_ns, total->wall_ns);
+	printf("%-30s %20.3f %20.3f\n", "MIPS", host_stats_mips(run), host_stats_mips(total));
+	printf("%-30s %20.3f %20.3f\n", "ns/instruction", host_stats_ns_per_instruction(run), host_stats_ns_per_instruction(total));
+	printf("%-30s %20.3f %20.3f\n", "simulated/wall time", host_stats_sim_to_wall(m, run), host_stats_sim_to_wall(m, total));
+	for(x = 0; x != NUM_BUS_REGIONS; x++) {
+		printf("bus reads  %-19s %20llu %20llu\n", bus_region_names[x], run->bus_reads[x], total->bus_reads[x]);
+	}
+	for(x = 0; x != NUM_BUS_REGIONS; x++) {
+		printf("bus writes %-19s %20llu %20llu\n", bus_region_names[x], run->bus_writes[x], total->bus_writes[x]);
+	}
+	printf("%-30s %20llu %20llu\n", "peripheral calls", run->device_calls, total->device_calls);
+	printf("%-30s %20llu %20llu\n", "pc hook calls", run->pc_hook_calls, total->pc_hook_calls);
+	printf("%-30s %20llu %20llu\n", "instruction breakpoint checks", run->ins_breakpoint_checks, total->ins_breakpoint_checks);
+	printf("%-30s %20llu %20llu\n", "data breakpoint checks", run->data_breakpoint_checks, total->data_breakpoint_checks);
+	printf("%-30s %20llu %20llu\n", "trace bytes", run->trace_bytes, total->trace_bytes);
+}
+
+//
+// one set of counters as a JSON object, indent is of the line it starts on
+//
+void write_host_stats_json(struct machine *m, FILE *fp, struct host_stats *s, const char *indent)
+{
+	int x;
+
+	fprintf(fp, "{\n");
+	fprintf(fp, "%s\t\"runs\": %llu,\n", indent, s->runs);
+	fprintf(fp, "%s\t\"instructions\": %llu,\n", indent, s->instructions);
+	fprintf(fp, "%s\t\"sim_cycles\": %llu,\n", indent, s->sim_cycles);
+	fprintf(fp, "%s\t\"sim_ns\": %llu,\n", indent, cycles_to_ns(m, s->sim_cycles));
+	fprintf(fp, "%s\t\"wall_ns\": %llu,\n", indent, s->wall_ns);
+	fprintf(fp, "%s\t\"mips\": %.3f,\n", indent, host_stats_mips(s));
+	fprintf(fp, "%s\t\"ns_per_instruction\": %.3f,\n", indent, host_stats_ns_per_instruction(s));
+	fprintf(fp, "%s\t\"sim_to_wall\": %.6f,\n", indent, host_stats_sim_to_wall(m, s));
+
+	fprintf(fp, "%s\t\"bus_reads\": {", indent);
+	for(x = 0; x != NUM_BUS_REGIONS; x++) {
+		fprintf(fp, "%s\"%s\": %llu", x ? ", " : " ", bus_region_names[x], s->bus_reads[x]);
+	}
+	fprintf(fp, " },\n");
+	fprintf(fp, "%s\t\"bus_writes\": {", indent);
+	for(x = 0; x != NUM_BUS_REGIONS; x++) {
+		fprintf(fp, "%s\"%s\": %llu", x ? ", " : " ", bus_region_names[x], s->bus_writes[x]);
+	}
+	fprintf(fp, " },\n");
+
+	fprintf(fp, "%s\t\"peripheral_calls\": %llu,\n", indent, s->device_calls);
+	fprintf(fp, "%s\t\"pc_hook_calls\": %llu,\n", indent, s->pc_hook_calls);
+	fprintf(fp, "%s\t\"ins_breakpoint_checks\": %llu,\n", indent, s->ins_breakpoint_checks);
+	fprintf(fp, "%s\t\"data_breakpoint_checks\": %llu,\n", indent, s->data_breakpoint_checks);
+	fprintf(fp, "%s\t\"trace_bytes\": %llu\n", indent, s->trace_bytes);
+	fprintf(fp, "%s}", indent);
+}
+
+//
+// the counters as JSON, with what build of the simulator counted them
+// returns 0 if it couldn't
+//
+int save_host_stats(struct machine *m, char *filename)
+{
+	FILE *fp;
+
+	fp = fopen(filename, "w");
+	if(fp == NULL) {
+		printf("Can't open %s!\n", filename);
+		return(0);
+	}
+
+	fprintf(fp, "{\n");
+	fprintf(fp, "\t\"build\": \"%s %s\",\n", __DATE__, __TIME__);
+	fprintf(fp, "\t\"clock_frequency_hz\": %u,\n", m->clock_frequency_hz);
+	fprintf(fp, "\t\"last_run\": ");
+	write_host_stats_json(m, fp, &m->run_stats, "\t");
+	fprintf(fp, ",\n\t\"total\": ");
+	write_host_stats_json(m, fp, &m->stats, "\t");
+	fprintf(fp, "\n}\n");
+
+	fclose(fp);
+	return(1);
+}
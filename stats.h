@@ -0,0 +1,23 @@
+//
+//---------------------------------------------------------------------------
+//
+// ST7x Simulator - host statistics header
+//
+// Author: Rick Stievenart
+//
+// Genesis: 10/17/2026
+//
+//----------------------------------------------------------------------------
+//
+
+// written when the simulator quits, in the current directory
+#define HOST_STATS_FILENAME		"st7xsim.stats.json"
+
+unsigned long long host_time_ns(void);
+void start_run_stats(struct machine *m, struct host_stats *start);
+void end_run_stats(struct machine *m, struct host_stats *start);
+void add_host_stats(struct machine *dst, struct machine *src);
+void clear_host_stats(struct machine *m);
+double host_stats_mips(struct host_stats *s);
+void display_host_stats(struct machine *m);
+int save_host_stats(struct machine *m, char *filename);